@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+#include "core/BufferPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// ARENAS
+// Bump allocators for the small, short-lived metadata of one operation: an
+// install (PFS0 tables, tickets, CNMT, NCA copy buffer) or a dump layout
+// (PFS0 header, ticket). Nothing is freed on its own; arenaReset returns every
+// block to the buffer pool at once, so these allocations never scatter small
+// holes through the heap around the big transfer buffers.
+// ============================================================================
+
+#define ARENA_ALIGN             16
+#define ARENA_INSTALL_BLOCK     (64 * 1024)
+#define ARENA_LAYOUT_BLOCK      (4 * 1024)      // PFS0 header and a ticket, usually
+
+typedef enum {
+    ARENA_KIND_INSTALL = 0,
+    ARENA_KIND_LAYOUT,
+    ARENA_KIND_COUNT
+} ArenaKind;
+
+typedef struct {
+    PoolBuffer* head;           // Newest block; each block starts with a link to the previous one
+    u32 cursor;                 // Next free byte in head
+    u32 blockSize;
+    u64 used;                   // Bytes handed out since the last reset
+    u64 held;                   // Bytes in blocks
+    ArenaKind kind;
+} Arena;
+
+typedef struct {
+    u64 operations;             // Resets of an arena that had allocated something
+    u64 live;                   // Held right now by arenas of this kind
+    u64 lastPeak;               // Held by the last operation when it was reset
+    u64 maxPeak;
+    u64 failures;
+} ArenaStats;
+
+void arenaInit(Arena* arena, ArenaKind kind, u32 block_size);
+
+// ARENA_ALIGN aligned, NULL when the pool refuses a new block. Requests larger
+// than a block get a block of their own.
+void* arenaAlloc(Arena* arena, size_t size);
+void* arenaCalloc(Arena* arena, size_t size);
+
+// Release everything; the arena stays usable
+void arenaReset(Arena* arena);
+
+void arenaGetStats(ArenaKind kind, ArenaStats* out);
+const char* arenaKindName(ArenaKind kind);
+
+#ifdef __cplusplus
+}
+#endif
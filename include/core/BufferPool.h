@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// BUFFER POOL
+// Large transfer buffers for MTP, USB, install and dump come from one pool.
+// Every buffer is page aligned, so it can be handed to usbDs directly, and is
+// reference counted, so a stage can pass it on instead of copying out of it.
+// Memory is taken from the heap on first use, kept for reuse once released
+// (up to BUFFER_POOL_IDLE_MAX) and never grows past BUFFER_POOL_BUDGET.
+// ============================================================================
+
+#define BUFFER_POOL_ALIGN       0x1000
+#define BUFFER_POOL_BUDGET      (96 * 1024 * 1024)
+#define BUFFER_POOL_IDLE_MAX    (32 * 1024 * 1024)  // Released buffers kept for reuse
+
+typedef enum {
+    BUFFER_TAG_MTP = 0,         // Protocol rx/tx/alt buffers
+    BUFFER_TAG_USB,             // Bounce buffers in usb_mtp
+    BUFFER_TAG_INSTALL,         // Stream install ring and NCA write buffer
+    BUFFER_TAG_DUMP,            // Game dump copy buffer
+    BUFFER_TAG_ARENA,           // Arena blocks (core/Arena.h)
+    BUFFER_TAG_COUNT
+} BufferTag;
+
+typedef struct PoolBuffer {
+    u8* data;                   // BUFFER_POOL_ALIGN aligned
+    size_t size;                // At least what was asked for
+    // Owned by BufferPool.cpp
+    u32 refs;
+    BufferTag tag;
+    struct PoolBuffer* next;
+} PoolBuffer;
+
+typedef struct {
+    u64 budget;
+    u64 inUse;                  // Bytes in buffers someone holds
+    u64 cached;                 // Bytes in released buffers kept for reuse
+    u64 peakInUse;
+    u64 peakHeld;               // High-water mark of inUse + cached, the pool's heap footprint
+    u64 tagInUse[BUFFER_TAG_COUNT];
+    u64 acquires;
+    u64 heapAllocs;             // Acquires that had to go to the heap
+    u64 failures;               // Over budget or out of memory
+} BufferPoolStats;
+
+// A buffer of at least size bytes with one reference, or NULL if it would
+// exceed the budget. Contents are undefined.
+PoolBuffer* bufferPoolAcquire(size_t size, BufferTag tag);
+
+void bufferRetain(PoolBuffer* buffer);
+
+// Drops a reference; the last one returns the buffer to the pool. NULL is ignored.
+void bufferRelease(PoolBuffer* buffer);
+
+// Give every idle buffer back to the heap
+void bufferPoolTrim(void);
+
+void bufferPoolGetStats(BufferPoolStats* out);
+const char* bufferTagName(BufferTag tag);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,23 +3,40 @@
 //
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
-#include <memory>
+#include <new>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <mutex>
 #include <algorithm>
 
 namespace Javelin {
 
-using EventTypeID = uint32_t;
+// Event types are identified by the address of a per-type tag, so ids are
+// fixed at compile time and need neither RTTI nor a hand-kept numbering.
+using EventTypeID = const void*;
+
+namespace detail {
+template<typename T>
+struct EventTypeTag {
+    static constexpr char tag = 0;
+};
+} // namespace detail
+
+template<typename T>
+constexpr EventTypeID eventTypeId() {
+    return &detail::EventTypeTag<T>::tag;
+}
 
 class Event {
 public:
     virtual ~Event() = default;
 
-    virtual EventTypeID getEventType() const = 0;
     virtual const char* getEventName() const { return "Event"; }
 
     bool isCancelled() const { return cancelled; }
@@ -31,6 +48,76 @@ public:
 template<typename T>
 using EventListener = std::function<void(T&)>;
 
+// Type-erased void(Event&) callable. Callables up to InlineSize bytes (a
+// lambda capturing a few pointers) live inside the delegate; larger ones go
+// to the heap. Invoking is a single indirect call into the typed thunk.
+class EventDelegate {
+public:
+    static constexpr size_t InlineSize = 4 * sizeof(void*);
+
+    EventDelegate() = default;
+
+    template<typename T, typename F>
+    static EventDelegate make(F&& fn) {
+        using Fn = typename std::decay<F>::type;
+        EventDelegate d;
+        if constexpr (fitsInline<Fn>()) {
+            new (d.storage_) Fn(std::forward<F>(fn));
+            d.invoke_ = [](void* self, Event& e) {
+                (*static_cast<Fn*>(self))(static_cast<T&>(e));
+            };
+            d.manage_ = [](void* dst, const void* src) {
+                if (src) new (dst) Fn(*static_cast<const Fn*>(src));
+                else static_cast<Fn*>(dst)->~Fn();
+            };
+        } else {
+            *reinterpret_cast<Fn**>(d.storage_) = new Fn(std::forward<F>(fn));
+            d.invoke_ = [](void* self, Event& e) {
+                (**static_cast<Fn**>(self))(static_cast<T&>(e));
+            };
+            d.manage_ = [](void* dst, const void* src) {
+                if (src) *static_cast<Fn**>(dst) = new Fn(**static_cast<Fn* const*>(src));
+                else delete *static_cast<Fn**>(dst);
+            };
+        }
+        return d;
+    }
+
+    EventDelegate(const EventDelegate& other) : invoke_(other.invoke_), manage_(other.manage_) {
+        if (manage_) manage_(storage_, other.storage_);
+    }
+
+    EventDelegate& operator=(const EventDelegate& other) {
+        if (this != &other) {
+            reset();
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+            if (manage_) manage_(storage_, other.storage_);
+        }
+        return *this;
+    }
+
+    ~EventDelegate() { reset(); }
+
+    void operator()(Event& event) const { invoke_(const_cast<unsigned char*>(storage_), event); }
+
+private:
+    template<typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= InlineSize && alignof(Fn) <= alignof(std::max_align_t);
+    }
+
+    void reset() {
+        if (manage_) manage_(storage_, nullptr);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[InlineSize];
+    void (*invoke_)(void*, Event&) = nullptr;
+    void (*manage_)(void* dst, const void* src) = nullptr;  // Copy from src, or destroy dst if null
+};
+
 class EventBus {
 public:
     static EventBus& getInstance() {
@@ -38,30 +125,24 @@ public:
         return instance;
     }
 
-    template<typename T>
-    uint64_t subscribe(EventListener<T> listener, int priority = 0) {
+    template<typename T, typename F>
+    uint64_t subscribe(F&& listener, int priority = 0) {
         std::lock_guard<std::mutex> lock(mutex_);
 
         uint64_t id = nextListenerId_++;
+        EventTypeID eventType = eventTypeId<T>();
+        std::atomic<const ListenerArray*>& slot = listenerSlot<T>;
+        slots_[eventType] = &slot;
+        handleTypes_[id] = eventType;
 
-        EventTypeID eventType = T::StaticEventType;
-        auto& listeners = eventListeners_[eventType];
-
-        listeners.push_back({
-            id,
-            priority,
-            [listener](void* eventPtr) {
-                T* event = static_cast<T*>(eventPtr);
-                if (!event->isCancelled()) {
-                    listener(*event);
-                }
-            }
-        });
-
-        std::sort(listeners.begin(), listeners.end(),
-            [](const ListenerInfo& a, const ListenerInfo& b) {
-                return a.priority > b.priority;
-            });
+        // Copy, insert after every listener of equal or higher priority, publish
+        const ListenerArray* current = slot.load(std::memory_order_relaxed);
+        ListenerArray* next = new ListenerArray();
+        if (current) next->items = current->items;
+        auto pos = std::find_if(next->items.begin(), next->items.end(),
+            [priority](const ListenerInfo& info) { return info.priority < priority; });
+        next->items.insert(pos, ListenerInfo{ id, priority, EventDelegate::make<T>(std::forward<F>(listener)) });
+        publish(slot, next);
 
         return id;
     }
@@ -69,62 +150,138 @@ public:
     void unsubscribe(uint64_t handle) {
         std::lock_guard<std::mutex> lock(mutex_);
 
-        for (auto& pair : eventListeners_) {
-            auto& listeners = pair.second;
-            listeners.erase(
-                std::remove_if(listeners.begin(), listeners.end(),
-                    [handle](const ListenerInfo& info) {
-                        return info.id == handle;
-                    }),
-                listeners.end()
-            );
+        auto typeIt = handleTypes_.find(handle);
+        if (typeIt == handleTypes_.end()) return;
+        std::atomic<const ListenerArray*>& slot = *slots_[typeIt->second];
+        handleTypes_.erase(typeIt);
+
+        const ListenerArray* current = slot.load(std::memory_order_relaxed);
+        if (!current) return;
+        ListenerArray* next = new ListenerArray();
+        for (const ListenerInfo& info : current->items) {
+            if (info.id != handle) next->items.push_back(info);
         }
+        publish(slot, next);
     }
 
     template<typename T>
     void unsubscribeAll() {
         std::lock_guard<std::mutex> lock(mutex_);
-        eventListeners_.erase(T::StaticEventType);
+        publish(listenerSlot<T>, nullptr);
     }
 
     void unsubscribeAll() {
         std::lock_guard<std::mutex> lock(mutex_);
-        eventListeners_.clear();
+        for (auto& pair : slots_) publish(*pair.second, nullptr);
+        handleTypes_.clear();
     }
 
+    // Run the listeners for this event on the calling thread. Takes no lock:
+    // listener arrays are immutable once published.
     template<typename T>
     bool post(T& event) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        EventTypeID eventType = event.getEventType();
-        auto it = eventListeners_.find(eventType);
-
-        if (it != eventListeners_.end()) {
-            for (const auto& listenerInfo : it->second) {
-                if (!event.isCancelled()) {
-                    listenerInfo.callback(&event);
-                }
+        const ListenerArray* listeners = listenerSlot<T>.load(std::memory_order_acquire);
+        if (listeners) {
+            for (const ListenerInfo& info : listeners->items) {
                 if (event.isCancelled()) break;
+                info.callback(event);
             }
         }
 
         return !event.isCancelled();
     }
 
+    // Queue a copy of the event for the UI thread and return immediately.
+    // Never takes the bus mutex or runs a listener, so it is safe from worker
+    // threads. Events sharing a non-zero coalesceKey (per event type) are
+    // collapsed to the newest one still queued when the UI drains.
+    template<typename T>
+    void postAsync(const T& event, uint64_t coalesceKey = 0) {
+        QueuedEvent* node = new QueuedEventOf<T>(event);
+        node->type = eventTypeId<T>();
+        node->coalesceKey = coalesceKey;
+
+        QueuedEvent* head = queueHead_.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!queueHead_.compare_exchange_weak(head, node,
+                     std::memory_order_release, std::memory_order_relaxed));
+
+        // First event since the last drain: let the UI know there is work
+        if (!head) {
+            void (*hook)() = wakeHook_.load(std::memory_order_acquire);
+            if (hook) hook();
+        }
+    }
+
+    // Called on the posting thread when postAsync finds the queue empty.
+    // Must not block or post events.
+    void setWakeHook(void (*hook)()) {
+        wakeHook_.store(hook, std::memory_order_release);
+    }
+
+    // Run every queued event through post(). UI thread only, once per frame.
+    size_t dispatchQueued() {
+        QueuedEvent* node = queueHead_.exchange(nullptr, std::memory_order_acquire);
+
+        // The queue is newest-first: drop events superseded by a newer one
+        // with the same key, and reverse the rest back into posting order
+        QueuedEvent* ordered = nullptr;
+        coalesced_.clear();
+        while (node) {
+            QueuedEvent* next = node->next;
+            bool superseded = false;
+            if (node->coalesceKey != 0) {
+                for (const auto& seen : coalesced_) {
+                    if (seen.first == node->type && seen.second == node->coalesceKey) {
+                        superseded = true;
+                        break;
+                    }
+                }
+                if (!superseded) coalesced_.push_back({node->type, node->coalesceKey});
+            }
+            if (superseded) {
+                delete node;
+            } else {
+                node->next = ordered;
+                ordered = node;
+            }
+            node = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+            QueuedEvent* next = ordered->next;
+            ordered->dispatch(*this);
+            delete ordered;
+            ordered = next;
+            count++;
+        }
+        return count;
+    }
+
     template<typename T>
     size_t getListenerCount() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = eventListeners_.find(T::StaticEventType);
-        return it != eventListeners_.end() ? it->second.size() : 0;
+        const ListenerArray* listeners = listenerSlot<T>.load(std::memory_order_acquire);
+        return listeners ? listeners->items.size() : 0;
     }
 
     void clear() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        eventListeners_.clear();
+        unsubscribeAll();
     }
 
 private:
     EventBus() = default;
-    ~EventBus() = default;
+    ~EventBus() {
+        QueuedEvent* node = queueHead_.exchange(nullptr);
+        while (node) {
+            QueuedEvent* next = node->next;
+            delete node;
+            node = next;
+        }
+        for (auto& pair : slots_) delete pair.second->exchange(nullptr);
+        for (const ListenerArray* list : retired_) delete list;
+    }
 
     EventBus(const EventBus&) = delete;
     EventBus& operator=(const EventBus&) = delete;
@@ -132,12 +289,48 @@ private:
     struct ListenerInfo {
         uint64_t id;
         int priority;
-        std::function<void(void*)> callback;
+        EventDelegate callback;
+    };
+
+    // Sorted by descending priority, never modified after publication
+    struct ListenerArray {
+        std::vector<ListenerInfo> items;
+    };
+
+    // A poster may still be walking the array being replaced, so replaced
+    // arrays are kept until shutdown. Subscriptions change rarely.
+    void publish(std::atomic<const ListenerArray*>& slot, const ListenerArray* next) {
+        const ListenerArray* previous = slot.exchange(next, std::memory_order_acq_rel);
+        if (previous) retired_.push_back(previous);
+    }
+
+    template<typename T>
+    static inline std::atomic<const ListenerArray*> listenerSlot{nullptr};
+
+    struct QueuedEvent {
+        QueuedEvent* next = nullptr;
+        EventTypeID type = nullptr;
+        uint64_t coalesceKey = 0;
+        virtual ~QueuedEvent() = default;
+        virtual void dispatch(EventBus& bus) = 0;
     };
 
-    mutable std::mutex mutex_;
-    std::unordered_map<EventTypeID, std::vector<ListenerInfo>> eventListeners_;
+    template<typename T>
+    struct QueuedEventOf : QueuedEvent {
+        T event;
+        explicit QueuedEventOf(const T& e) : event(e) {}
+        void dispatch(EventBus& bus) override { bus.post(event); }
+    };
+
+    mutable std::mutex mutex_;                                 // Serialises subscription changes
+    std::unordered_map<EventTypeID, std::atomic<const ListenerArray*>*> slots_;
+    std::unordered_map<uint64_t, EventTypeID> handleTypes_;
+    std::vector<const ListenerArray*> retired_;
     uint64_t nextListenerId_ = 1;
+
+    std::atomic<QueuedEvent*> queueHead_{nullptr};             // Lock-free MPSC stack
+    std::atomic<void (*)()> wakeHook_{nullptr};
+    std::vector<std::pair<EventTypeID, uint64_t>> coalesced_;  // Drain scratch (UI thread)
 };
 
 } // namespace Javelin
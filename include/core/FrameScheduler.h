@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+#include <atomic>
+
+namespace Javelin {
+
+// ============================================================================
+// FRAME SCHEDULER
+// Decides whether the UI loop renders on a given iteration. The loop renders
+// at full rate while the controller or touch screen is in use; otherwise it
+// polls input, runs its housekeeping and sleeps, redrawing when a worker marks
+// the UI dirty (capped to a low rate) and on a slow heartbeat. A static screen
+// then costs the transfer threads almost nothing.
+// ============================================================================
+
+#define FRAME_ACTIVE_GRACE_NS     1500000000ULL   // Full rate this long after the last input
+#define FRAME_DIRTY_INTERVAL_NS   100000000ULL    // Fastest redraw for worker updates (10 Hz)
+#define FRAME_IDLE_INTERVAL_NS    500000000ULL    // Heartbeat when nothing is marked dirty
+#define FRAME_POLL_INTERVAL_NS    16666667ULL     // Input poll period between rendered frames
+
+class FrameScheduler {
+public:
+    static FrameScheduler& getInstance() {
+        static FrameScheduler instance;
+        return instance;
+    }
+
+    // Any thread: something on screen changed
+    void markDirty() {
+        if (dirty_.load(std::memory_order_relaxed)) return;
+        if (!dirty_.exchange(true, std::memory_order_release)) wake();
+    }
+
+    // UI thread only
+    void noteInput();                   // Input arrived this iteration
+    void requestFullRate();             // Render the next iteration too (animation, modal input)
+    bool shouldRender();                // Once per loop iteration, after polling input
+    void beginFrame();                  // Before draining events for a rendered frame
+    void waitForWork();                 // Sleep until the next input poll or a dirty mark
+
+private:
+    FrameScheduler();
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    void wake();
+
+    std::atomic<bool> dirty_{true};
+    Mutex mutex_;
+    CondVar cond_;
+    u64 lastInputTick_ = 0;
+    u64 lastRenderTick_ = 0;
+    bool fullRate_ = false;
+};
+
+} // namespace Javelin
@@ -8,29 +8,17 @@
 
 namespace Javelin {
 
-enum EventTypes {
-    EventType_Gui = 1000,
-    EventType_ButtonClick,
-    EventType_ScreenChange,
-    EventType_Notification
-};
-
 class ScreenChangeEvent : public Event {
 public:
-    static constexpr EventTypeID StaticEventType = EventType_ScreenChange;
-
     ScreenChangeEvent(int screenId) : screenId(screenId) {}
 
     const char* getEventName() const override { return "ScreenChangeEvent"; }
-    EventTypeID getEventType() const override { return StaticEventType; }
 
     int screenId;
 };
 
 class NotificationEvent : public Event {
 public:
-    static constexpr EventTypeID StaticEventType = EventType_Notification;
-
     enum class Type {
         Info,
         Success,
@@ -42,7 +30,6 @@ public:
         : message(message), type(type), durationMs(durationMs) {}
 
     const char* getEventName() const override { return "NotificationEvent"; }
-    EventTypeID getEventType() const override { return StaticEventType; }
 
     std::string message;
     Type type;
@@ -51,8 +38,9 @@ public:
 
 inline void showNotification(const std::string& message,
                             NotificationEvent::Type type = NotificationEvent::Type::Info) {
+    // Queued: notifications are raised from worker threads too
     NotificationEvent event(message, type);
-    EventBus::getInstance().post(event);
+    EventBus::getInstance().postAsync(event);
 }
 
 inline void showInfo(const std::string& message) {
@@ -31,30 +31,27 @@ struct Notification {
     float endTime;
 };
 
+// Counters, speed and install stage are read live from the TransferTable slot
+// while running. The slot is freed on completion, so a finished modal shows
+// the final state copied here.
 struct TransferProgress {
+    TransferId id;
     std::string filePath;
-    uint64_t bytesTransferred;
     uint64_t totalBytes;
-    float progressPercent;
-    float speedMBps;
+    uint64_t bytesTransferred;  // Final count, set on completion
     bool isComplete;
     bool success;
     std::string errorMessage;
-    bool* cancelledPtr;  // Pointer to cancelled flag in the event
 };
 
 struct InstallProgress {
+    TransferId id;
     std::string titleName;
     std::string filePath;
-    float progressPercent;
-    std::string currentFile;
-    uint64_t bytesWritten;
-    uint64_t totalBytes;
-    std::string stage;
+    uint64_t bytesWritten;      // Final count, set on completion
     bool isComplete;
     bool success;
     std::string errorMessage;
-    bool* cancelledPtr;  // Pointer to cancelled flag in the event
 };
 
 struct PersonalizedTicketPrompt {
@@ -91,23 +88,23 @@ private:
     void onScreenChange(const ScreenChangeEvent& event);
     void onNotification(const NotificationEvent& event);
     void onTransferStart(const TransferStartEvent& event);
-    void onTransferProgress(const TransferProgressEvent& event);
     void onTransferComplete(const TransferCompleteEvent& event);
     void onInstallStart(const InstallStartEvent& event);
-    void onInstallProgress(const InstallProgressEvent& event);
     void onInstallComplete(const InstallCompleteEvent& event);
     void onPersonalizedTicket(const PersonalizedTicketEvent& event);
 
     ImVec4 getNotificationColor(NotificationEvent::Type type) const;
     const char* getNotificationIcon(NotificationEvent::Type type) const;
     bool renderTransferModal(const TransferProgress& transfer);
-    void renderInstallModal(const InstallProgress& install);
+    bool renderInstallModal(const InstallProgress& install);
+    void releaseTransfer(TransferId id);
+    void warnNoTransferSlot(const std::string& name);
     void renderPersonalizedTicketModal();
 
     int currentScreen = Screen_MainMenu;
     std::vector<Notification> notifications;
-    std::unordered_map<std::string, TransferProgress> activeTransfers;
-    std::unordered_map<std::string, InstallProgress> activeInstalls;
+    std::unordered_map<TransferId, TransferProgress> activeTransfers;
+    std::unordered_map<TransferId, InstallProgress> activeInstalls;
     PersonalizedTicketPrompt ticketPrompt;
     std::vector<uint64_t> eventSubscriptions;
 };
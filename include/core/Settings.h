@@ -5,6 +5,7 @@
 
 #include <switch.h>
 #include <stddef.h>
+#include "core/ThreadRoles.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,6 +22,8 @@ extern "C" {
 typedef struct {
     char language[8];      // Language code (e.g., "en", "es")
     u32 mtp_buffer_size;   // MTP transfer buffer size in bytes
+    bool log_to_file;      // Mirror the log to sdmc:/switch/Javelin/logs/
+    ThreadLayout thread_layout; // Core and priority assignment for worker threads
 } Settings;
 
 /**
@@ -46,6 +49,18 @@ void settingsSetLanguage(const char* langCode);
  */
 void settingsSetMtpBufferSize(u32 size);
 
+/**
+ * Enable or disable writing the log to the SD card.
+ * @param enabled true to keep a log file
+ */
+void settingsSetLogToFile(bool enabled);
+
+/**
+ * Set the thread layout. Threads started afterwards use it.
+ * @param layout One of THREAD_LAYOUT_*
+ */
+void settingsSetThreadLayout(ThreadLayout layout);
+
 /**
  * Save current settings to disk.
  * @return true if successful, false otherwise
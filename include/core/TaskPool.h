@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// TASK POOL
+// Short CPU or service jobs (NACP lookups, hashing, layout work, scans) are
+// submitted here instead of each starting its own thread. One worker runs per
+// core the background role may use (unpinned on the default core when the
+// layout gives it no mask); every worker owns a deque per priority,
+// takes its own newest job first and steals the oldest job of another worker
+// when it runs dry. Long-lived loops (USB, install, dump) keep their threads.
+// ============================================================================
+
+#define TASK_POOL_MAX_WORKERS   3       // Cores available to applications
+#define TASK_POOL_STACK_SIZE    0x20000
+
+typedef enum {
+    TASK_PRIORITY_HIGH = 0,             // The UI is waiting on the result
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW,                  // Prefetching, cache warming
+    TASK_PRIORITY_COUNT
+} TaskPriority;
+
+typedef enum {
+    TASK_STATE_QUEUED = 0,              // Includes continuations waiting on their parent
+    TASK_STATE_RUNNING,
+    TASK_STATE_DONE,
+    TASK_STATE_CANCELLED,               // Never ran
+} TaskState;
+
+// Shared by any number of tasks; zero-initialized means not cancelled. Tasks
+// that have not started when it fires are dropped, running ones poll it.
+typedef struct {
+    volatile u32 cancelled;
+} TaskCancelToken;
+
+typedef struct Task Task;               // Reference counted handle
+typedef void (*TaskFunc)(void* arg);
+
+typedef struct {
+    TaskFunc run;
+    void* arg;
+    TaskFunc release;                   // Optional; called with arg once, after run or instead of it
+    TaskPriority priority;
+    const TaskCancelToken* cancel;      // Optional; must outlive the task
+    Task* after;                        // Optional; start once this task is done, drop if it was cancelled
+} TaskDesc;
+
+// Start the workers. Before this (and after taskPoolExit) tasks run inline
+// on the submitting thread.
+void taskPoolInit(void);
+
+// Let the workers finish what is queued, then join them
+void taskPoolExit(void);
+
+u32 taskPoolWorkerCount(void);
+
+// Both return a handle the caller must release. NULL means the task could not
+// be allocated; it has run inline by then.
+Task* taskSubmitDesc(const TaskDesc* desc);
+Task* taskSubmit(TaskFunc run, void* arg, TaskPriority priority, const TaskCancelToken* cancel);
+Task* taskThen(Task* parent, TaskFunc run, void* arg, TaskPriority priority, const TaskCancelToken* cancel);
+
+// Block until the task has finished or been dropped. A pool worker runs other
+// queued tasks meanwhile, so tasks may wait on tasks they submitted.
+void taskWait(Task* task);
+TaskState taskGetState(const Task* task);
+bool taskIsFinished(const Task* task);
+void taskRelease(Task* task);
+
+static inline void taskCancel(TaskCancelToken* token) {
+    __atomic_store_n(&token->cancelled, 1, __ATOMIC_RELEASE);
+}
+
+static inline bool taskCancelled(const TaskCancelToken* token) {
+    return token && __atomic_load_n(&token->cancelled, __ATOMIC_ACQUIRE) != 0;
+}
+
+static inline void taskCancelReset(TaskCancelToken* token) {
+    __atomic_store_n(&token->cancelled, 0, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace Javelin {
+
+// ----------------------------------------------------------------------------
+// Futures
+// taskRun(f) runs a callable on the pool and returns a TaskFuture holding its
+// result; then(g) chains g onto the result without blocking.
+// ----------------------------------------------------------------------------
+
+template<typename T> class TaskFuture;
+
+namespace detail {
+
+template<typename T>
+struct TaskSlot {
+    std::optional<T> value;
+};
+
+template<>
+struct TaskSlot<void> {};
+
+template<typename F, typename R>
+struct TaskClosure {
+    F fn;
+    std::shared_ptr<TaskSlot<R>> slot;
+
+    static void run(void* arg) {
+        TaskClosure* c = (TaskClosure*)arg;
+        if constexpr (std::is_void_v<R>) c->fn();
+        else c->slot->value.emplace(c->fn());
+    }
+    static void release(void* arg) { delete (TaskClosure*)arg; }
+};
+
+template<typename R, typename F>
+TaskFuture<R> submitClosure(F&& fn, TaskPriority priority, const TaskCancelToken* cancel, Task* after);
+
+} // namespace detail
+
+template<typename T>
+class TaskFuture {
+public:
+    TaskFuture() = default;
+    TaskFuture(Task* task, std::shared_ptr<detail::TaskSlot<T>> slot) : task_(task), slot_(std::move(slot)) {}
+    ~TaskFuture() { if (task_) taskRelease(task_); }
+
+    TaskFuture(TaskFuture&& o) noexcept : task_(o.task_), slot_(std::move(o.slot_)) { o.task_ = nullptr; }
+    TaskFuture& operator=(TaskFuture&& o) noexcept {
+        if (this != &o) {
+            if (task_) taskRelease(task_);
+            task_ = o.task_;
+            slot_ = std::move(o.slot_);
+            o.task_ = nullptr;
+        }
+        return *this;
+    }
+    TaskFuture(const TaskFuture&) = delete;
+    TaskFuture& operator=(const TaskFuture&) = delete;
+
+    bool valid() const { return slot_ != nullptr; }
+    bool ready() const { return !task_ || taskIsFinished(task_); }
+    bool cancelled() const { return task_ && taskGetState(task_) == TASK_STATE_CANCELLED; }
+    void wait() { if (task_) taskWait(task_); }
+
+    // Waits; nullptr if the task was cancelled
+    template<typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    U* get() {
+        wait();
+        return slot_ && slot_->value ? &*slot_->value : nullptr;
+    }
+
+    // g(T&) (or g() for void) runs on the pool once this result exists
+    template<typename G>
+    auto then(G&& g, TaskPriority priority = TASK_PRIORITY_NORMAL, const TaskCancelToken* cancel = nullptr) {
+        if constexpr (std::is_void_v<T>) {
+            using R = std::invoke_result_t<G>;
+            return detail::submitClosure<R>(std::forward<G>(g), priority, cancel, task_);
+        } else {
+            using R = std::invoke_result_t<G, T&>;
+            std::shared_ptr<detail::TaskSlot<T>> slot = slot_;
+            return detail::submitClosure<R>(
+                [slot, g = std::forward<G>(g)]() mutable { return g(*slot->value); },
+                priority, cancel, task_);
+        }
+    }
+
+private:
+    Task* task_ = nullptr;
+    std::shared_ptr<detail::TaskSlot<T>> slot_;
+};
+
+namespace detail {
+
+template<typename R, typename F>
+TaskFuture<R> submitClosure(F&& fn, TaskPriority priority, const TaskCancelToken* cancel, Task* after) {
+    using Closure = TaskClosure<std::decay_t<F>, R>;
+    auto slot = std::make_shared<TaskSlot<R>>();
+    Closure* c = new Closure{ std::forward<F>(fn), slot };
+
+    TaskDesc desc = { Closure::run, c, Closure::release, priority, cancel, after };
+    return TaskFuture<R>(taskSubmitDesc(&desc), std::move(slot));
+}
+
+} // namespace detail
+
+template<typename F>
+auto taskRun(F&& fn, TaskPriority priority = TASK_PRIORITY_NORMAL, const TaskCancelToken* cancel = nullptr) {
+    using R = std::invoke_result_t<F>;
+    return detail::submitClosure<R>(std::forward<F>(fn), priority, cancel, nullptr);
+}
+
+} // namespace Javelin
+
+#endif // __cplusplus
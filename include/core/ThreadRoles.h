@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Every thread the app starts belongs to a role; the active layout maps each
+// role to a core and a priority. Lower priority values run first.
+
+typedef enum {
+    THREAD_ROLE_UI = 0,         // Main thread: input and rendering
+    THREAD_ROLE_USB,            // MTP protocol loop, the USB pump
+    THREAD_ROLE_IO,             // Dump, install and hashing workers
+    THREAD_ROLE_BACKGROUND,     // Index scans, saves refresh, metadata fetch, log writer
+    THREAD_ROLE_COUNT
+} ThreadRole;
+
+typedef enum {
+    THREAD_LAYOUT_PINNED = 0,   // USB on core 1, I/O on core 2, UI and background on core 0
+    THREAD_LAYOUT_SHARED,       // Everything on the default core at the default priority
+    THREAD_LAYOUT_COUNT
+} ThreadLayout;
+
+typedef struct {
+    s32 core;                   // Preferred core, or -2 for the process default
+    u32 coreMask;               // Cores the thread may run on; 0 keeps the default
+    int priority;
+} ThreadRoleConfig;
+
+// Select the layout and apply the UI role to the calling (main) thread.
+// Threads that are already running keep their placement.
+void threadRolesSetLayout(ThreadLayout layout);
+ThreadLayout threadRolesGetLayout(void);
+
+const ThreadRoleConfig* threadRoleGet(ThreadRole role);
+const char* threadLayoutName(ThreadLayout layout);
+ThreadLayout threadLayoutFromName(const char* name);
+
+// threadCreate with the core and priority of the role
+Result threadCreateForRole(Thread* t, ThreadFunc entry, void* arg, size_t stack_sz, ThreadRole role);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <cstdint>
+
+// ============================================================================
+// SPAN TRACING
+// Build with TRACE=1 to record begin/end spans into per-thread rings and dump
+// them as Chrome trace-event JSON (open in chrome://tracing or Perfetto).
+// With tracing off every macro below compiles to nothing.
+// ============================================================================
+
+#ifndef JAVELIN_TRACE
+#define JAVELIN_TRACE 0
+#endif
+
+#define TRACE_MAX_THREADS        8
+#define TRACE_EVENTS_PER_THREAD  4096   // Oldest spans are overwritten
+#define TRACE_THREAD_NAME_MAX    32
+#define TRACE_DIR                "sdmc:/switch/Javelin/traces"
+
+#if JAVELIN_TRACE
+
+#include <atomic>
+#ifdef __SWITCH__
+#include <switch.h>
+#else
+#include <chrono>
+#endif
+
+namespace Javelin {
+
+struct TraceEvent {
+    uint64_t start;
+    uint64_t end;
+    const char* name;       // Must be a string literal (or otherwise static)
+    uint64_t arg;
+};
+
+// Timestamps in system ticks on the console, nanoseconds on the host
+inline uint64_t traceNow() {
+#ifdef __SWITCH__
+    return armGetSystemTick();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void traceRecord(const char* name, uint64_t start, uint64_t end, uint64_t arg);
+
+// Label the calling thread in the trace. A thread that reuses a name (the
+// install thread, say) also reuses the previous owner's ring.
+void traceSetThreadName(const char* name);
+
+void traceSetEnabled(bool enabled);
+bool traceIsEnabled();
+void traceClear();
+
+// Write everything recorded so far. Recording pauses while the file is written.
+bool traceDump(const char* path);
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, uint64_t arg = 0)
+        : name_(name), arg_(arg), start_(traceNow()) {}
+    ~TraceScope() { traceRecord(name_, start_, traceNow(), arg_); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t arg_;
+    uint64_t start_;
+};
+
+} // namespace Javelin
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+
+// Span covering the rest of the enclosing block
+#define TRACE_SCOPE(name)               Javelin::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg)      Javelin::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name, (uint64_t)(arg))
+#define TRACE_THREAD_NAME(name)         Javelin::traceSetThreadName(name)
+
+#else
+
+// Arguments are not evaluated, only kept referenced
+#define TRACE_SCOPE(name)               do { (void)sizeof(name); } while (0)
+#define TRACE_SCOPE_ARG(name, arg)      do { (void)sizeof(name); (void)sizeof(arg); } while (0)
+#define TRACE_THREAD_NAME(name)         do { (void)sizeof(name); } while (0)
+
+#endif // JAVELIN_TRACE
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include "core/FrameScheduler.h"
+#include <atomic>
+#include <cstdint>
+
+namespace Javelin {
+
+#define TRANSFER_TABLE_SIZE 16
+#define TRANSFER_NAME_MAX   256
+
+// Identifies one transfer for its whole life. 0 is never handed out.
+using TransferId = uint32_t;
+constexpr TransferId InvalidTransferId = 0;
+
+// Live state of one transfer. The worker that owns it stores the counters;
+// the UI loads them directly every frame. name and kind are written before
+// the id is published and never change afterwards.
+struct TransferSlot {
+    std::atomic<bool> claimed;
+    std::atomic<TransferId> id;         // InvalidTransferId while free
+    std::atomic<uint64_t> bytesDone;
+    std::atomic<uint64_t> totalBytes;
+    std::atomic<float> speedMBps;
+    std::atomic<const char*> stage;     // Static string (install stage), or nullptr
+    std::atomic<bool> cancelRequested;
+    std::atomic<bool> finished;
+    char name[TRANSFER_NAME_MAX];
+};
+
+// Fixed table of in-flight transfers. Nothing here allocates or locks, so
+// the transfer loops can report progress and poll for cancellation freely.
+// Progress marks the UI dirty so an idle screen still redraws.
+class TransferTable {
+public:
+    static TransferTable& getInstance() {
+        static TransferTable instance;
+        return instance;
+    }
+
+    // Claim a slot. Returns InvalidTransferId when every slot is in use;
+    // all other calls accept that id and do nothing. The UI releases a slot
+    // as soon as its transfer completes, so only running transfers hold one.
+    TransferId begin(const char* name, uint64_t totalBytes);
+
+    // Worker side
+    void update(TransferId id, uint64_t bytesDone, float speedMBps) {
+        TransferSlot* slot = find(id);
+        if (!slot) return;
+        slot->bytesDone.store(bytesDone, std::memory_order_relaxed);
+        slot->speedMBps.store(speedMBps, std::memory_order_relaxed);
+        FrameScheduler::getInstance().markDirty();
+    }
+
+    void setTotal(TransferId id, uint64_t totalBytes) {
+        TransferSlot* slot = find(id);
+        if (slot) slot->totalBytes.store(totalBytes, std::memory_order_relaxed);
+    }
+
+    void setStage(TransferId id, const char* stage) {
+        TransferSlot* slot = find(id);
+        if (!slot) return;
+        slot->stage.store(stage, std::memory_order_relaxed);
+        FrameScheduler::getInstance().markDirty();
+    }
+
+    bool isCancelled(TransferId id) const {
+        const TransferSlot* slot = find(id);
+        return slot && slot->cancelRequested.load(std::memory_order_acquire);
+    }
+
+    // The worker is done with the slot; it stays readable until released
+    void finish(TransferId id) {
+        TransferSlot* slot = find(id);
+        if (!slot) return;
+        slot->finished.store(true, std::memory_order_release);
+        FrameScheduler::getInstance().markDirty();
+    }
+
+    // UI side
+    void cancel(TransferId id) {
+        TransferSlot* slot = find(id);
+        if (slot) slot->cancelRequested.store(true, std::memory_order_release);
+    }
+
+    const TransferSlot* get(TransferId id) const { return find(id); }
+
+    // Free the slot once the UI has copied the result
+    void release(TransferId id);
+
+private:
+    TransferTable() = default;
+
+    TransferTable(const TransferTable&) = delete;
+    TransferTable& operator=(const TransferTable&) = delete;
+
+    TransferSlot* find(TransferId id) {
+        if (id == InvalidTransferId) return nullptr;
+        TransferSlot* slot = &slots_[id % TRANSFER_TABLE_SIZE];
+        return slot->id.load(std::memory_order_acquire) == id ? slot : nullptr;
+    }
+
+    const TransferSlot* find(TransferId id) const {
+        return const_cast<TransferTable*>(this)->find(id);
+    }
+
+    TransferSlot slots_[TRANSFER_TABLE_SIZE] = {};
+    std::atomic<uint32_t> nextSerial_{1};
+};
+
+} // namespace Javelin
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <switch.h>
+#include "core/Arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,14 +45,15 @@ typedef struct {
 typedef struct {
     bool computed;
     u64 total_nsp_size;             // Full NSP size (header + data)
-    u8* pfs0_header;                // PFS0 header + file entries + string table
+    u8* pfs0_header;                // PFS0 header + file entries + string table (arena)
     u32 pfs0_header_size;           // Size of header region
     DumpNspFileEntry files[DUMP_MAX_FILES_PER_NSP];
     u32 file_count;
-    u8* ticket_data;                // Exported ticket (heap alloc, nullable)
+    u8* ticket_data;                // Exported ticket (arena, nullable)
     u32 ticket_size;
-    u8* cert_data;                  // Cert chain (heap alloc, nullable)
+    u8* cert_data;                  // Cert chain (arena, nullable)
     u32 cert_size;
+    Arena arena;                    // Everything above, released together in free_layout
 } DumpNspLayout;
 
 // Individual content meta entry for separate mode
@@ -86,17 +88,17 @@ typedef struct {
     u32 game_count;
     u32 max_games;
 
-    // NCM handles
-    NcmContentStorage sd_storage;
-    NcmContentStorage nand_storage;
-    NcmContentMetaDatabase sd_meta_db;
-    NcmContentMetaDatabase nand_meta_db;
+    // NCM handles, shared through service/services.h
+    NcmContentStorage* sd_storage;
+    NcmContentStorage* nand_storage;
+    NcmContentMetaDatabase* sd_meta_db;
+    NcmContentMetaDatabase* nand_meta_db;
     bool sd_storage_open, nand_storage_open;
     bool sd_meta_db_open, nand_meta_db_open;
-    bool ncm_initialized;
+    bool ncm_initialized;           // Holding a service reference
     bool ns_initialized;
 
-    // ES service state (managed by libnx-ext)
+    // ES service reference (taken on first ticket export)
     bool es_initialized;
 
     bool games_enumerated;
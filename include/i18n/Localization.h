@@ -3,8 +3,9 @@
 //
 #pragma once
 
+#include "i18n/EmbeddedTranslations.h"
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace Javelin {
@@ -27,6 +28,9 @@ public:
     const char* getLanguage() const { return currentLanguage.c_str(); }
     const char* getLanguageName(const char* code) const;
 
+    const char* tr(StringId id) const { return strings[(size_t)id]; }
+
+    // Runtime key lookup, for keys that are not literals
     const char* tr(const char* key) const;
     const char* tr(const char* key, const char* fallback) const;
 
@@ -34,14 +38,33 @@ public:
     bool hasLanguage(const char* langCode) const;
 
 private:
+    // A language whose strings were overridden from RomFS
+    struct LanguageTable {
+        std::string code;
+        const char* strings[kStringCount];
+        std::unique_ptr<char[]> arena;          // The file, values unescaped in place
+    };
 
     std::string currentLanguage;
-    std::unordered_map<std::string, std::string> strings;
-    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> allStrings;
+    const char* const* strings = kEmbeddedLanguages[0].strings;
+    std::vector<std::unique_ptr<LanguageTable>> romfsTables;
 
+    const char* const* findTable(const char* langCode) const;
+    bool hasRomfsTable(const char* langCode) const;
     bool loadFromRomfs(const char* langCode);
 };
 
+// Checked at compile time: an unknown key fails the build
+template<int Id>
+struct StringIdOf {
+    static_assert(Id >= 0, "Unknown translation key; add it to romfs/javelin/i18n/en.json");
+    static constexpr StringId value = (StringId)Id;
+};
+
+inline const char* tr(StringId id) {
+    return Localization::getInstance().tr(id);
+}
+
 inline const char* tr(const char* key) {
     return Localization::getInstance().tr(key);
 }
@@ -52,4 +75,5 @@ inline const char* tr(const char* key, const char* fallback) {
 
 }
 
-#define TR(key) Javelin::tr(key)
+// Key must be a string literal; it resolves to a table index at compile time
+#define TR(key) Javelin::tr(Javelin::StringIdOf<Javelin::findStringId(key)>::value)
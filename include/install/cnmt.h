@@ -4,6 +4,7 @@
 #pragma once
 
 #include <switch.h>
+#include "core/Arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,9 +46,11 @@ typedef struct {
 bool cnmtParse(CnmtContext* ctx, const u8* data, size_t size);
 void cnmtFree(CnmtContext* ctx);
 NcmContentMetaKey cnmtGetContentMetaKey(const CnmtContext* ctx);
+// The buffer comes from arena and lives until it is reset
 Result cnmtBuildInstallContentMeta(const CnmtContext* ctx,
                                    const NcmContentInfo* cnmt_content_info,
                                    bool ignore_req_firmware,
+                                   Arena* arena,
                                    u8** out_buffer,
                                    size_t* out_size);
 void cnmtGetDisplayVersion(const CnmtContext* ctx, char* out_version, size_t out_size);
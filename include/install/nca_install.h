@@ -4,6 +4,7 @@
 #pragma once
 
 #include <switch.h>
+#include "core/Arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,8 +19,8 @@ typedef enum {
 typedef void (*NcaInstallProgressCb)(u64 bytes_written, u64 total_bytes, void* user_data);
 
 typedef struct {
-    NcmContentStorage content_storage;
-    NcmContentMetaDatabase meta_db;
+    NcmContentStorage* content_storage;     // Shared handles from service/services.h
+    NcmContentMetaDatabase* meta_db;
     NcmStorageId storage_id;
     bool storage_open;
     bool meta_db_open;
@@ -27,6 +28,11 @@ typedef struct {
 
     InstallTarget target;
 
+    // Metadata and the NCA copy buffer of the running install, released when
+    // the next one starts and on exit
+    Arena arena;
+    u8* transfer_buffer;
+
     NcaInstallProgressCb progress_cb;
     void* progress_user_data;
 } NcaInstallContext;
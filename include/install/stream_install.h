@@ -6,6 +6,7 @@
 #include <switch.h>
 #include "install/nca_install.h"
 #include "install/cnmt.h"
+#include "core/BufferPool.h"
 #include <string.h>
 #include <stdlib.h>
 #include <sys/statvfs.h>
@@ -33,6 +34,7 @@ typedef enum {
 
 typedef struct {
     // Buffer management
+    PoolBuffer* buffer_block;
     u8* buffer;
     u64 buffer_size;
     u64 buffer_pos;     // Current write position
@@ -50,7 +52,7 @@ typedef struct {
         u64 string_table_size;
         u64 data_offset;
         bool header_parsed;
-        // Cached file entries and string table for random access
+        // Cached file entries and string table for random access, in nca_ctx->arena
         u8* file_entries;       // Pfs0FileEntry array
         u64 file_entries_size;
         char* string_table;     // Null-terminated strings
@@ -82,7 +84,7 @@ typedef struct {
     u64 cnmt_size;
     bool cnmt_scanned;  // Track if we've already scanned for CNMT location
 
-    // Ticket/Certificate caching for encrypted content
+    // Ticket/Certificate caching for encrypted content, in nca_ctx->arena
     u8* ticket_data;
     u32 ticket_size;
     u8* cert_data;
@@ -94,6 +96,7 @@ typedef struct {
     bool ticket_event_posted;  // Track if PersonalizedTicketEvent was already posted
 
     // Pre-allocated write buffer for NCA installation (avoids per-call malloc)
+    PoolBuffer* write_block;
     u8* write_buffer;
     u64 write_buffer_size;
 
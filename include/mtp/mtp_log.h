@@ -4,6 +4,7 @@
 #pragma once
 
 #include <switch.h>
+#include "core/Debug.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,12 +22,233 @@ void mtpLogClear(void);
 int mtpLogGetCount(void);
 const char* mtpLogGetEntry(int index);
 MtpLogLevel mtpLogGetLevel(int index);
+
+// Queue an already formatted message
 void mtpLogAdd(MtpLogLevel level, const char* message);
-#define LOG_ERROR(fmt, ...)   do { char buf[512]; snprintf(buf, sizeof(buf), fmt, ##__VA_ARGS__); mtpLogAdd(MTP_LOG_ERROR, buf); } while(0)
-#define LOG_WARN(fmt, ...)    do { char buf[512]; snprintf(buf, sizeof(buf), fmt, ##__VA_ARGS__); mtpLogAdd(MTP_LOG_WARNING, buf); } while(0)
-#define LOG_INFO(fmt, ...)    do { char buf[512]; snprintf(buf, sizeof(buf), fmt, ##__VA_ARGS__); mtpLogAdd(MTP_LOG_INFO, buf); } while(0)
-#define LOG_DEBUG(fmt, ...)   do { char buf[512]; snprintf(buf, sizeof(buf), fmt, ##__VA_ARGS__); mtpLogAdd(MTP_LOG_DEBUG, buf); } while(0)
+
+// Format queued records into the log view (and the file sink, if running).
+// Called once per frame by the UI.
+void mtpLogPump(void);
+
+// The log view is also fed by the file writer thread; hold this while
+// reading entries
+void mtpLogLockView(void);
+void mtpLogUnlockView(void);
+
+// SD file sink. A writer thread drains the log in batches and appends it to
+// MTP_LOG_FILE_DIR, rotating by size. Logging threads never wait on it.
+#define MTP_LOG_FILE_DIR        "sdmc:/switch/Javelin/logs"
+#define MTP_LOG_FILE_MAX_SIZE   (1024 * 1024)   // Rotate after this many bytes
+#define MTP_LOG_FILE_KEEP       4               // javelin.log plus three older files
+
+void mtpLogFileStart(void);
+void mtpLogFileStop(void);
+bool mtpLogFileRunning(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+// ============================================================================
+// Structured records
+// LOG_* macros do not format anything. They copy the format pointer and the
+// raw arguments into a slot of a lock-free ring; mtpLogPump formats them
+// later on the UI or log writer thread. Format strings must be literals.
+// ============================================================================
+
+// Levels below this are compiled out. Debug records are only kept when a
+// component debug flag is on.
+#ifndef MTP_LOG_MIN_LEVEL
+    #if DEBUG_INSTALL || DEBUG_MTP_PROTO || DEBUG_MTP_STORAGE || DEBUG_USB || DEBUG_SAVES || DEBUG_GUI || DEBUG_MEMORY
+        #define MTP_LOG_MIN_LEVEL 0
+    #else
+        #define MTP_LOG_MIN_LEVEL 1
+    #endif
+#endif
+
+#define MTP_LOG_RING_SIZE   512     // Records, power of two
+#define MTP_LOG_MAX_ARGS    8
+#define MTP_LOG_STR_SPACE   408     // Copied %s arguments, or a preformatted message; 512-byte records
+
+typedef enum {
+    MTP_LOG_ARG_INT = 0,
+    MTP_LOG_ARG_UINT,
+    MTP_LOG_ARG_DOUBLE,
+    MTP_LOG_ARG_STR,                // Value is an offset into strings
+    MTP_LOG_ARG_PTR,
+} MtpLogArgKind;
+
+typedef struct {
+    u32 seq;                        // Ring sequence, owned by mtp_log.cpp
+    u8 level;
+    u8 argc;
+    u16 strUsed;
+    u32 thread;
+    u8 kinds[MTP_LOG_MAX_ARGS];
+    bool overflow;                  // A %s argument did not fit in strings
+    u64 tick;
+    const char* fmt;                // nullptr: strings holds the finished message
+    u64 args[MTP_LOG_MAX_ARGS];
+    char strings[MTP_LOG_STR_SPACE];
+} MtpLogRecord;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Claim a ring slot; nullptr when the logger is not up or the ring is full
+MtpLogRecord* mtpLogBeginRecord(MtpLogLevel level, const char* fmt);
+void mtpLogCommitRecord(MtpLogRecord* record);
+
+// Never called; lets the compiler check LOG_* arguments against the format
+static inline void __attribute__((format(printf, 1, 2))) mtpLogCheckFormat(const char* fmt, ...) { (void)fmt; }
 
 #ifdef __cplusplus
 }
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace mtplog {
+
+// Bit i is set when argument i is a string printed with a "*" precision,
+// which the argument before it holds. Such strings need not be terminated.
+inline u32 starPrecisionStrings(const char* fmt) {
+    u32 mask = 0;
+    u32 arg = 0;
+    for (const char* p = fmt; (p = strchr(p, '%')) != nullptr && arg < MTP_LOG_MAX_ARGS; ) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        while (*p && strchr("-+ #0", *p)) p++;
+        if (*p == '*') {
+            p++;
+            arg++;
+        }
+        while (*p >= '0' && *p <= '9') p++;
+        bool starPrecision = false;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                p++;
+                arg++;
+                starPrecision = true;
+            }
+            while (*p >= '0' && *p <= '9') p++;
+        }
+        while (*p && strchr("hlzjtL", *p)) p++;
+        if (!*p) break;
+        if (*p++ == 's' && starPrecision && arg < MTP_LOG_MAX_ARGS) mask |= 1u << arg;
+        arg++;
+    }
+    return mask;
+}
+
+// maxLen < 0: the string is terminated. Otherwise at most maxLen bytes are read.
+inline void putString(MtpLogRecord* r, const char* s, long maxLen) {
+    u8 i = r->argc++;
+    r->kinds[i] = MTP_LOG_ARG_STR;
+    if (!s) {
+        s = "(null)";
+        maxLen = -1;
+    }
+    size_t avail = MTP_LOG_STR_SPACE - r->strUsed;
+    if (avail == 0) {
+        r->args[i] = MTP_LOG_STR_SPACE - 1;     // Points at the terminator
+        r->overflow = true;
+        return;
+    }
+    size_t limit = avail - 1;
+    if (maxLen >= 0 && (size_t)maxLen < limit) limit = (size_t)maxLen;
+    size_t len = strnlen(s, limit);
+    // Cut short by the slot rather than by the string's end or precision
+    if (len == avail - 1 && (maxLen < 0 || (size_t)maxLen > len) && s[len] != '\0') r->overflow = true;
+    memcpy(r->strings + r->strUsed, s, len);
+    r->strings[r->strUsed + len] = '\0';
+    r->args[i] = r->strUsed;
+    r->strUsed += (u16)(len + 1);
+}
+
+template<typename T>
+inline void putArg(MtpLogRecord* r, u32 boundedStrings, T v) {
+    if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+        u8 i = r->argc;
+        long maxLen = -1;
+        if (i > 0 && (boundedStrings >> i) & 1) {
+            int precision = (int)(s64)r->args[i - 1];
+            maxLen = precision;     // Negative means no precision, as in printf
+        }
+        putString(r, v, maxLen);
+        return;
+    } else {
+        u8 i = r->argc++;
+        if constexpr (std::is_floating_point_v<T>) {
+            double d = (double)v;
+            memcpy(&r->args[i], &d, sizeof(d));
+            r->kinds[i] = MTP_LOG_ARG_DOUBLE;
+        } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+            r->args[i] = (u64)(uintptr_t)v;
+            r->kinds[i] = MTP_LOG_ARG_PTR;
+        } else if constexpr (std::is_enum_v<T>) {
+            r->args[i] = (u64)(s64)(std::underlying_type_t<T>)v;
+            r->kinds[i] = MTP_LOG_ARG_INT;
+        } else if constexpr (std::is_signed_v<T>) {
+            r->args[i] = (u64)(s64)v;
+            r->kinds[i] = MTP_LOG_ARG_INT;
+        } else {
+            r->args[i] = (u64)v;
+            r->kinds[i] = MTP_LOG_ARG_UINT;
+        }
+    }
+}
+
+template<typename... Args>
+inline void record(MtpLogLevel level, const char* fmt, Args... args) {
+    MtpLogRecord* r = mtpLogBeginRecord(level, fmt);
+    if (!r) return;
+    if constexpr (sizeof...(Args) <= MTP_LOG_MAX_ARGS) {
+        u32 bounded = 0;
+        if constexpr (sizeof...(Args) >= 2) {
+            if (strchr(fmt, '*')) bounded = starPrecisionStrings(fmt);
+        }
+        (putArg(r, bounded, args), ...);
+        if (r->overflow) {
+            // Strings too long for the slot: keep the whole message instead
+            snprintf(r->strings, sizeof(r->strings), fmt, args...);
+            r->fmt = nullptr;
+        }
+    } else {
+        // Rare wide dumps: format now rather than grow every record
+        snprintf(r->strings, sizeof(r->strings), fmt, args...);
+        r->fmt = nullptr;
+    }
+    mtpLogCommitRecord(r);
+}
+
+} // namespace mtplog
+
+#define MTP_LOG_EMIT(level, fmt, ...) do { \
+        if (0) mtpLogCheckFormat(fmt, ##__VA_ARGS__); \
+        mtplog::record(level, fmt, ##__VA_ARGS__); \
+    } while(0)
+
+#endif // __cplusplus
+
+// Elided levels still type-check their arguments and keep them "used"
+#define MTP_LOG_ELIDE(fmt, ...) do { if (0) mtpLogCheckFormat(fmt, ##__VA_ARGS__); } while(0)
+
+#define LOG_ERROR(fmt, ...)   MTP_LOG_EMIT(MTP_LOG_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)    MTP_LOG_EMIT(MTP_LOG_WARNING, fmt, ##__VA_ARGS__)
+#if MTP_LOG_MIN_LEVEL <= 1
+    #define LOG_INFO(fmt, ...)    MTP_LOG_EMIT(MTP_LOG_INFO, fmt, ##__VA_ARGS__)
+#else
+    #define LOG_INFO(fmt, ...)    MTP_LOG_ELIDE(fmt, ##__VA_ARGS__)
+#endif
+#if MTP_LOG_MIN_LEVEL <= 0
+    #define LOG_DEBUG(fmt, ...)   MTP_LOG_EMIT(MTP_LOG_DEBUG, fmt, ##__VA_ARGS__)
+#else
+    #define LOG_DEBUG(fmt, ...)   MTP_LOG_ELIDE(fmt, ##__VA_ARGS__)
 #endif
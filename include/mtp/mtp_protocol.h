@@ -9,6 +9,7 @@
 #include "mtp_saves.h"
 #include "mtp_dump.h"
 #include "mtp_gamecard.h"
+#include "core/BufferPool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,9 @@ extern "C" {
 #define MTP_OP_SEND_OBJECT_INFO             0x100C
 #define MTP_OP_SEND_OBJECT                  0x100D
 #define MTP_OP_DELETE_OBJECT                0x100B
+#define MTP_OP_SET_OBJECT_PROP_VALUE        0x9804
+
+#define MTP_PROP_OBJECT_FILE_NAME           0xDC07
 
 #define MTP_RESP_OK                         0x2001
 #define MTP_RESP_GENERAL_ERROR              0x2002
@@ -48,6 +52,7 @@ extern "C" {
 #define MTP_RESP_STORE_READ_ONLY            0x200E
 #define MTP_RESP_OBJECT_WRITE_PROTECTED     0x200F
 #define MTP_RESP_TRANSACTION_CANCELLED      0x201F
+#define MTP_RESP_INVALID_OBJECT_PROP_CODE   0xA801
 
 typedef struct {
     u32 length;
@@ -69,8 +74,11 @@ typedef struct {
 
     u8* rx_buffer;
     u8* tx_buffer;
-    u8* alt_buffer;
+    u8* alt_buffer;                 // Second half of double-buffered transfers, NULL between operations
     size_t buffer_size;
+    PoolBuffer* rx_block;
+    PoolBuffer* tx_block;
+    PoolBuffer* alt_block;
 
     MtpStorageContext storage;
     InstallContext install;
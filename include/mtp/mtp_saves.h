@@ -10,51 +10,101 @@
 extern "C" {
 #endif
 
-// Maximum counts
-#define MTP_SAVES_MAX_GAMES         512
+// Limits
 #define MTP_SAVES_MAX_USERS         8       // Max accounts on Switch
-#define MTP_SAVES_MAX_USER_FOLDERS  4096    // games * users
-#define MTP_SAVES_MAX_TYPES         16384   // Save type subfolders
-#define MTP_SAVES_MAX_FILES         8192
+#define MTP_SAVES_MAX_MOUNTS        8       // Save filesystems kept open at once (LRU)
+#define MTP_SAVES_MAX_BUILT_GAMES   24      // Games whose browsed subtree stays in memory (LRU)
+
+// Handle scheme for DBI-style hierarchy. Each range is a slot space of a pool in
+// SavesContext; bits 28-31 (outside MTP_HANDLE_MASK) carry the slot's generation,
+// so a handle to a freed entry never resolves to the entry that reuses its slot.
+#define MTP_HANDLE_SAVES_GEN_SHIFT          28
 
-// Handle scheme for DBI-style hierarchy:
 // Category folders (Installed/Not Installed)
 #define MTP_HANDLE_SAVES_CATEGORY_START     0x00070001
 #define MTP_HANDLE_SAVES_CATEGORY_INSTALLED 0x00070001
 #define MTP_HANDLE_SAVES_CATEGORY_NOT_INST  0x00070002
+#define MTP_HANDLE_SAVES_SNAPSHOTS          0x00070003  // "Snapshots" folder at the root
 #define MTP_HANDLE_SAVES_CATEGORY_END       0x0007000F
 
 // Game folder handles
 #define MTP_HANDLE_SAVES_GAME_START         0x00070010
-#define MTP_HANDLE_SAVES_GAME_END           0x000701FF
+#define MTP_HANDLE_SAVES_GAME_END           0x000707FF
+
+// Snapshot browser nodes (titles, snapshot folders, snapshot archives)
+#define MTP_HANDLE_SAVES_SNAPSHOT_START     0x00070800
+#define MTP_HANDLE_SAVES_SNAPSHOT_END       0x00070FFF
 
 // User folder handles (per-game user subfolders)
-#define MTP_HANDLE_SAVES_USER_START         0x00070200
-#define MTP_HANDLE_SAVES_USER_END           0x00070FFF
+#define MTP_HANDLE_SAVES_USER_START         0x00071000
+#define MTP_HANDLE_SAVES_USER_END           0x00071FFF
 
 // Save type handles (Account/Device/BCAT/Cache under user or game)
-#define MTP_HANDLE_SAVES_TYPE_START         0x00071000
-#define MTP_HANDLE_SAVES_TYPE_END           0x00074FFF
+#define MTP_HANDLE_SAVES_TYPE_START         0x00072000
+#define MTP_HANDLE_SAVES_TYPE_END           0x00073FFF
+
+// Whole-save archive handles (one virtual .tar per save type, type handle + 0x2000)
+#define MTP_HANDLE_SAVES_ARCHIVE_START      0x00074000
+#define MTP_HANDLE_SAVES_ARCHIVE_END        0x00075FFF
 
 // File handles
-#define MTP_HANDLE_SAVES_FILE_START         0x00075000
+#define MTP_HANDLE_SAVES_FILE_START         0x00076000
+#define MTP_HANDLE_SAVES_FILE_END           0x0007FFFF
+
+// Name suffix of the virtual archive object in each save type folder
+#define MTP_SAVES_ARCHIVE_EXT               ".tar"
+
+// An entry's pool slot is its handle minus the range base. Folders keep their
+// children as a linked list of handles so enumeration only touches the folder
+// being browsed.
+typedef struct {
+    u32 next_sibling;           // Next child of the same parent (0 = last)
+    u32 first_child;
+    u32 last_child;
+    u32 child_count;
+} SaveNodeLinks;
+
+// Growable pool of fixed-size entries. Entries live in chunks that never move,
+// so entry pointers stay valid while the pool grows; released slots are reused.
+typedef struct {
+    void** chunks;
+    u32 chunk_count;
+    u32 entry_size;
+    u32 count;                  // Slots handed out so far (high-water mark)
+    u32 live;                   // Slots currently in use
+    u32* free_slots;            // Released slots, reused before the pool grows
+    u32 free_count;
+    u32 free_capacity;
+} SavesPool;
+
+// Append-only string arena. Names are interned, so the many saves sharing a
+// file name ("save.dat", "Account", ...) store it once. Reset by savesRefresh.
+typedef struct SavesNameBlock SavesNameBlock;
+typedef struct {
+    SavesNameBlock* blocks;
+    const char** table;         // Open-addressing set of interned strings
+    u32 table_size;
+    u32 count;
+    u64 bytes;
+} SavesNames;
 
 // User account entry (tracks user subfolders under games)
 typedef struct {
     AccountUid uid;
-    char username[32];          // From AccountProfileBase.nickname
-    u32 handle;                 // Virtual handle for this user folder
+    u32 handle;                 // Virtual handle for this user folder (0 = free slot)
     u32 parent_game_handle;     // Which game this user folder belongs to
-    u32 game_index;             // Index in games array
-    s32 user_index;             // Index in user_uids array
-    bool types_scanned;         // Have we scanned save types for this user/game?
+    u32 game_index;             // Index in games pool
+    s32 user_index;             // Index in user_uids / user_names
+    u8 generation;              // Slot generation, kept across reuse
+    SaveNodeLinks links;        // Save types under this user
 } UserFolderEntry;
 
 // Save type subfolder (Account, Device, Cache, BCAT, etc.)
 typedef struct {
     u8 save_type;               // FsSaveDataType
     u8 space_id;                // FsSaveDataSpaceId (User, System, SdCache)
-    char name[48];              // Display name (e.g., "Account", "Device", "SD_Cache")
+    u8 generation;
+    const char* name;           // Display name (e.g., "Account", "Device", "SD_Cache"), interned
     u32 handle;
     u32 parent_handle;          // User folder handle OR game folder (for Device/BCAT)
     u32 game_index;
@@ -62,35 +112,67 @@ typedef struct {
     s16 cache_index;            // For cache saves (-1 if not cache)
     bool scanned;
     bool mounted;
-    FsFileSystem save_fs;
-    char mount_name[32];
+    bool mount_failed;          // Last mount attempt failed (no archive shown)
+    FsFileSystem save_fs;       // Valid while mounted; reopened on demand after eviction
+    u64 last_used;              // LRU stamp from SavesContext::mount_clock
+    u64 archive_size;           // Size of the virtual .tar of this save
+    bool archive_sized;         // archive_size is valid (cleared on any write)
+    bool pending_commit;        // Has writes waiting for savesCommitPending()
+    u16 open_files;             // Open SavesFileHandles (pin the mount, commit waits for these)
+    SaveNodeLinks links;        // Top-level files of the save
 } SaveTypeEntry;
 
-// Save file entry (files and subdirectories within a save type)
+// Save file entry (files and subdirectories within a save type). The path inside
+// the save is not stored; it is rebuilt from the parent chain when needed.
 typedef struct {
-    char filename[256];
-    char full_path[512];
+    const char* filename;       // Interned
     u64 size;
-    bool is_directory;
-    bool scanned;               // For directories: have we scanned contents?
     u32 handle;
     u32 parent_handle;          // Handle of parent folder (save type or subdir)
     u32 game_index;             // Which game this belongs to
-    u32 type_index;             // Which save type this belongs to
+    u32 type_index;             // Slot of the save type this belongs to
+    bool is_directory;
+    bool scanned;               // For directories: have we scanned contents?
+    u8 generation;
+    SaveNodeLinks links;        // Directory contents
 } SaveFileEntry;
 
 // Game save entry (represents a game/DLC/update folder in the saves view)
 // Title ID format: 0xTTTTBBBBBBBBBBBB where TTTT=type (0100=app, 0101=DLC, 0102=update)
 typedef struct {
     u64 application_id;         // Application ID (base app, DLC, or update)
-    char game_name[256];        // Human-readable name (e.g., "Game Name [DLC 1]" or "Game Name [Update]")
+    const char* game_name;      // Human-readable name (e.g., "Game Name [DLC 1]"), interned
     u32 folder_handle;          // MTP handle for this game's folder
-    u32 game_index;             // Index in games array
+    u32 game_index;             // Index in games pool
     bool is_installed;          // true if nsGetApplicationControlData succeeded (for base apps)
     u32 category_handle;        // Parent handle (Installed or Not Installed)
-    bool users_scanned;         // Have we scanned user saves for this game?
+    bool users_scanned;         // Subtree built (freed again when not browsed for a while)
+    u64 last_browsed;           // LRU stamp from SavesContext::browse_clock
+    SaveNodeLinks links;        // User folders, then device-wide save types
 } GameSaveEntry;
 
+// Node of the Snapshots folder, mirroring SNAPSHOT_ROOT on the SD card
+typedef enum {
+    SNAPSHOT_NODE_TITLE = 0,    // <title id> folder
+    SNAPSHOT_NODE_DIR,          // <yyyymmdd-hhmmss> folder, one per snapshot run
+    SNAPSHOT_NODE_ARCHIVE,      // One .jsnap manifest, shown as a read-only .tar
+    SNAPSHOT_NODE_RECEIPT,      // Progress/result folder returned for a snapshot/restore request
+} SnapshotNodeKind;
+
+typedef struct {
+    u8 kind;                    // SnapshotNodeKind
+    u8 generation;
+    const char* name;           // Display name, interned
+    const char* sd_name;        // Name on the SD card, interned (NULL for receipts)
+    u32 handle;
+    u32 parent_handle;
+    u64 application_id;
+    u64 size;                   // Archive size, valid once sized
+    bool sized;
+    bool scanned;
+    SaveNodeLinks links;
+} SnapshotNode;
+
 // Saves context
 typedef struct {
     bool initialized;
@@ -106,28 +188,27 @@ typedef struct {
     u32 installed_game_count;
     u32 not_installed_game_count;
 
-    // List of games with save data
-    GameSaveEntry* games;
-    u32 game_count;
-    u32 max_games;
-
-    // User subfolders per game
-    UserFolderEntry* user_folders;
-    u32 user_folder_count;
-    u32 max_user_folders;
-    u32 next_user_handle;
-
-    // Save type subfolders (Account, Device, Cache, etc.)
-    SaveTypeEntry* types;
-    u32 type_count;
-    u32 max_types;
-    u32 next_type_handle;
-
-    // Global pool of all files/subdirs across all saves
-    SaveFileEntry* files;
-    u32 file_count;
-    u32 max_files;
-    u32 next_file_handle;
+    // Games with save data, then the lazily built per-game subtrees
+    SavesPool games;            // GameSaveEntry
+    SavesPool user_folders;     // UserFolderEntry
+    SavesPool types;            // SaveTypeEntry (Account, Device, Cache, etc.)
+    SavesPool files;            // SaveFileEntry, all files/subdirs across all saves
+    SavesPool snapshot_nodes;   // SnapshotNode
+    SaveNodeLinks snapshot_root;
+    bool snapshots_scanned;
+    SavesNames names;
+
+    // Games with a built subtree, bounded by MTP_SAVES_MAX_BUILT_GAMES
+    u32 built_game_count;
+    u64 browse_clock;
+
+    // Saves with uncommitted writes
+    u32 pending_commit_count;
+
+    // Mounted save types (indices into types), bounded by MTP_SAVES_MAX_MOUNTS
+    u32 mounted_types[MTP_SAVES_MAX_MOUNTS];
+    u32 mounted_count;
+    u64 mount_clock;
 
     // Thread safety
     Mutex saves_mutex;
@@ -168,22 +249,56 @@ u32 savesEnumObjects(SavesContext* ctx, u32 storage_id, u32 parent_handle, u32*
 // Get object info for a saves handle
 bool savesGetObjectInfo(SavesContext* ctx, u32 handle, MtpObject* out);
 
-// Read save file data (for backup/download)
+// Read save file data (for backup/download).
+// Reading an archive handle streams the whole save as a ustar archive.
 s64 savesReadObject(SavesContext* ctx, u32 handle, u64 offset, void* buffer, u64 size);
 
-// Create object in saves (for restore/upload)
+// Create object in saves (for restore/upload).
+// A ".tar" created directly in a save type folder restores the whole save: its
+// contents replace the save in a single pass and are committed once at the end.
+// Creating a folder in the Snapshots tree runs a snapshot request instead: a
+// folder named "Snapshot..." in the Snapshots folder snapshots every save, in a
+// title folder that title's saves, and one named "Restore..." in a snapshot
+// folder restores that snapshot. Any other name makes a plain folder that starts
+// the request once renamed. The request runs in the background; the folder is a
+// receipt whose name shows its progress and result. One request runs at a time.
 u32 savesCreateObject(SavesContext* ctx, u32 storage_id, u32 parent_handle,
                       const char* filename, u16 format, u64 size);
 
+// Rename a folder created in the Snapshots tree. A request name starts the
+// request as if the folder had been created with it (hosts that make "New folder"
+// first). Receipts of a running request cannot be renamed.
+bool savesRenameObject(SavesContext* ctx, u32 handle, const char* filename);
+
+// Streaming access to a save file or archive, native fsFile on the mounted save.
+// Reads/writes continue from the previous position; closing a written file joins
+// the save's pending transaction (see savesCommitPending).
+typedef struct SavesFileHandle SavesFileHandle;
+SavesFileHandle* savesOpenRead(SavesContext* ctx, u32 handle);
+s64 savesReadFile(SavesFileHandle* fh, void* buffer, u64 size);
+SavesFileHandle* savesOpenWrite(SavesContext* ctx, u32 handle);
+s64 savesWriteFile(SavesFileHandle* fh, const void* buffer, u64 size);
+u64 savesGetFileSize(SavesFileHandle* fh);
+void savesCloseFile(SavesFileHandle* fh);
+
 // Write save file data (for restore/upload)
 s64 savesWriteObject(SavesContext* ctx, u32 handle, u64 offset, const void* buffer, u64 size);
 
-// Delete save file
+// Delete save file (on an archive being restored, discards the restore uncommitted).
+// In the Snapshots tree this deletes snapshots from the SD card, refused while a
+// snapshot job runs, and then compacts the chunk store in the background.
 bool savesDeleteObject(SavesContext* ctx, u32 handle);
 
-// Commit changes to save data (required after writes)
+// Finish an uploaded object. Regular files join their save's pending transaction;
+// archive restores are committed (or rolled back) immediately.
 bool savesCommitObject(SavesContext* ctx, u32 handle);
 
+// True if any save has writes that have not been committed yet
+bool savesHasPendingCommits(SavesContext* ctx);
+
+// Commit every save with pending writes (end of a host batch, session close, exit)
+bool savesCommitPending(SavesContext* ctx);
+
 // Refresh the list of games with save data
 Result savesRefresh(SavesContext* ctx);
 
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// On-device save snapshots.
+//
+// Files are split with content-defined chunking and stored once per SHA-256 in
+// append-only pack files, so a snapshot of a save that barely changed only adds
+// the changed chunks. Each snapshot of one save is a small manifest:
+//
+//   SNAPSHOT_ROOT/<title id>/<yyyymmdd-hhmmss>/<label>.jsnap
+//   SNAPSHOT_ROOT/.store/pack-NNNN.bin, index.bin
+
+#define SNAPSHOT_ROOT           "sdmc:/switch/Javelin/saves"
+#define SNAPSHOT_EXT            ".jsnap"
+#define SNAPSHOT_DIR_NAME_LEN   16      // "yyyymmdd-hhmmss"
+
+// Identifies the save a manifest was taken from (and restores into)
+typedef struct {
+    u64 application_id;
+    AccountUid uid;
+    u8 save_type;               // FsSaveDataType
+    u8 space_id;                // FsSaveDataSpaceId
+    u16 cache_index;
+} SnapshotSaveId;
+
+typedef struct {
+    u32 files;
+    u32 chunks;
+    u32 new_chunks;
+    u64 bytes;                  // Logical size of the save
+    u64 new_bytes;              // Chunk data actually added to the store
+} SnapshotStats;
+
+// Folder name for a snapshot taken now
+void snapshotMakeDirName(char* out, size_t size);
+
+// Snapshot a mounted save into snapshot_dir/<label>.jsnap (directories created as needed)
+Result snapshotCreate(FsFileSystem* save_fs, const SnapshotSaveId* id, const char* snapshot_dir,
+                      const char* label, SnapshotStats* stats);
+
+// Replace the contents of a mounted save with a snapshot. Chunks are verified
+// against their hashes; the caller commits on success (or closes the save to roll back).
+Result snapshotRestore(FsFileSystem* save_fs, const char* manifest_path);
+
+// Read the save identity stored in a manifest
+bool snapshotReadSaveId(const char* manifest_path, SnapshotSaveId* out);
+
+// Read-only ustar view of a snapshot, in the same layout as the live save archives
+typedef struct SnapshotArchive SnapshotArchive;
+SnapshotArchive* snapshotArchiveOpen(const char* manifest_path);
+u64 snapshotArchiveSize(const SnapshotArchive* a);
+s64 snapshotArchiveRead(SnapshotArchive* a, u64 offset, void* buffer, u64 size);
+void snapshotArchiveClose(SnapshotArchive* a);
+
+// Close pack files and drop the in-memory chunk index
+void snapshotStoreClose(void);
+
+// Reclaim the space of chunks no manifest under SNAPSHOT_ROOT uses any more,
+// including manifests deleted by hand. Packs that are at least a quarter dead
+// are rewritten. Must not run alongside snapshotCreate; *stop (may be NULL)
+// aborts it, leaving the store as it was.
+Result snapshotStoreCompact(const bool* stop);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Protocol metrics. Writers (the MTP thread, USB layer, install/dump paths)
+// bump relaxed atomics; the UI copies everything out with mtpStatsSnapshot.
+
+#define MTP_STATS_OP_COUNT      14      // Handled operations plus "Unsupported"
+#define MTP_STATS_HIST_SUB      8       // Histogram sub-buckets per power of two
+#define MTP_STATS_HIST_BUCKETS  256     // Covers latencies well past an hour, in us
+#define MTP_STATS_DIR           "sdmc:/switch/Javelin/stats"
+
+typedef enum {
+    MTP_BACKEND_SD = 0,
+    MTP_BACKEND_NAND,
+    MTP_BACKEND_INSTALL,
+    MTP_BACKEND_SAVES,
+    MTP_BACKEND_ALBUM,
+    MTP_BACKEND_GAMECARD,
+    MTP_BACKEND_DUMP,
+    MTP_BACKEND_COUNT
+} MtpBackend;
+
+typedef enum {
+    MTP_GAUGE_EVENT_QUEUE = 0,      // Events drained by the last dispatchQueued
+    MTP_GAUGE_LOG_RING,             // Log records waiting to be formatted
+    MTP_GAUGE_INSTALL_BUFFER,       // Bytes buffered ahead of the stream installer
+    MTP_GAUGE_COUNT
+} MtpGauge;
+
+typedef struct {
+    u64 count;
+    u64 bytes;                      // USB payload moved while the operation ran
+    u64 totalUs;
+    u64 maxUs;
+    u32 hist[MTP_STATS_HIST_BUCKETS];
+} MtpOpStats;
+
+typedef struct {
+    u64 reads;
+    u64 readBytes;
+    u64 readNs;
+    u64 writes;
+    u64 writeBytes;
+    u64 writeNs;
+} MtpBackendStats;
+
+typedef struct {
+    u64 bytesIn;                    // Host to console
+    u64 bytesOut;
+    u64 transfersIn;
+    u64 transfersOut;
+    u64 shortIn;                    // Fewer bytes than requested; normal at the end of a container
+    u64 shortOut;                   // A short write is always an anomaly
+    u64 retries;                    // PostBufferAsync retries
+    u64 retryFailures;              // USB_MAX_RETRIES reached
+    u64 timeouts;                   // Data-phase completions that timed out
+} MtpUsbStats;
+
+typedef struct {
+    u64 current;
+    u64 max;
+} MtpGaugeStats;
+
+typedef struct {
+    u64 elapsedNs;                  // Since the last reset
+    MtpOpStats ops[MTP_STATS_OP_COUNT];
+    MtpBackendStats backends[MTP_BACKEND_COUNT];
+    MtpUsbStats usb;
+    MtpGaugeStats gauges[MTP_GAUGE_COUNT];
+} MtpStatsSnapshot;
+
+// Writers
+void mtpStatsRecordOp(u16 opcode, u64 ticks, u64 bytes);
+void mtpStatsRecordStorage(MtpBackend backend, bool write, u64 bytes, u64 ticks);
+void mtpStatsUsbTransfer(bool in, size_t requested, size_t transferred);
+void mtpStatsUsbRetry(bool exhausted);
+void mtpStatsUsbTimeout(void);
+void mtpStatsSetGauge(MtpGauge gauge, u64 value);
+
+// USB bytes moved so far in both directions; the difference across an
+// operation is the payload attributed to it
+u64 mtpStatsUsbBytes(void);
+
+MtpBackend mtpStatsBackendForStorage(u32 storage_id);
+const char* mtpOperationName(u16 opcode);
+const char* mtpStatsOpName(int index);
+const char* mtpStatsBackendName(MtpBackend backend);
+const char* mtpStatsGaugeName(MtpGauge gauge);
+
+// Readers
+void mtpStatsSnapshot(MtpStatsSnapshot* out);
+u64 mtpStatsPercentileUs(const MtpOpStats* op, double percentile);
+void mtpStatsReset(void);
+bool mtpStatsExportJson(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#pragma once
+
+#include <switch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Minimal ustar support used for whole-save archive objects.
+// Paths longer than the 100-byte ustar name field are emitted with a
+// GNU "././@LongLink" entry, which tar, bsdtar and 7-Zip all understand.
+
+#define TAR_BLOCK_SIZE      512
+#define TAR_MAX_PATH        1024
+
+// Round a data size up to the next block boundary
+static inline u64 tarPaddedSize(u64 size) {
+    return (size + TAR_BLOCK_SIZE - 1) & ~(u64)(TAR_BLOCK_SIZE - 1);
+}
+
+// Number of bytes of header blocks emitted for an entry (including any long-name blocks)
+u32 tarHeaderSize(const char* path, bool is_directory);
+
+// Write the header blocks for an entry into out (must hold tarHeaderSize() bytes).
+// Directory paths get a trailing '/' appended. Returns the number of bytes written.
+// Headers are regenerated on every read of an archive, so mtime must be fixed for
+// the archive's lifetime or a header split across reads gets a mixed checksum.
+u32 tarWriteHeader(u8* out, const char* path, u64 size, bool is_directory, u64 mtime);
+
+// Streaming extractor callbacks. Paths are relative, sanitized and never contain "..".
+// Returning false from any callback aborts extraction.
+typedef struct {
+    bool (*on_directory)(void* user, const char* path);
+    bool (*on_file_begin)(void* user, const char* path, u64 size);
+    bool (*on_file_data)(void* user, const void* data, u64 size);
+    bool (*on_file_end)(void* user);
+    void* user;
+} TarCallbacks;
+
+typedef enum {
+    TAR_STATE_HEADER = 0,   // Collecting a 512-byte header block
+    TAR_STATE_DATA,         // Streaming entry data to the callbacks
+    TAR_STATE_LONGNAME,     // Collecting a GNU long name
+    TAR_STATE_SKIP,         // Skipping data of an unsupported entry type
+    TAR_STATE_PADDING,      // Skipping padding up to the next block
+    TAR_STATE_END,          // End-of-archive marker seen
+    TAR_STATE_ERROR,
+} TarState;
+
+typedef struct {
+    TarCallbacks cb;
+    TarState state;
+    u8 block[TAR_BLOCK_SIZE];
+    u32 block_fill;
+    u64 entry_remaining;    // Data bytes left in the current entry
+    u64 pad_remaining;      // Padding bytes left after the current entry
+    char longname[TAR_MAX_PATH];   // GNU long name or pax "path=" value for the next entry
+    u32 longname_len;
+    char name_type;                 // 'L' or 'x' while collecting a name record
+    bool have_longname;
+    u32 zero_blocks;
+    u32 entry_count;
+} TarParser;
+
+// Initialize an extractor
+void tarParserInit(TarParser* p, const TarCallbacks* cb);
+
+// Feed the next bytes of the archive. Returns false once the archive is malformed
+// or a callback failed; the parser stays in TAR_STATE_ERROR afterwards.
+bool tarParserFeed(TarParser* p, const void* data, u64 size);
+
+// True if the archive ended on an entry boundary (with or without end marker)
+bool tarParserComplete(const TarParser* p);
+
+#ifdef __cplusplus
+}
+#endif
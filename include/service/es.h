@@ -12,14 +12,24 @@
 extern "C" {
 #endif
 
-// These functions are defined in source/service/es.cpp
+// These functions are defined in source/service/es_ext.cpp
 // They extend the ES service with additional commands
 #include <switch.h>
 #include <ipcext/es.h>
 
+// Reference-counted "es" session shared by the commands below. Holding a
+// reference across a run of calls avoids a service-manager round trip per call.
+Result esExtInitialize(void);
+void esExtExit(void);
+
 Result esGetTitleKey(const EsRightsId *rights_id, u32 key_generation, void *outBuf, size_t bufSize);
 Result esGetCommonTicketData(u64 *out_size, const EsRightsId *rights_id, void *outBuf, size_t bufSize);
 
+// Batch variant: entry i is written to outBuf + i * stride. Per-entry results
+// go to out_results (optional); the call fails only if every entry failed.
+Result esGetCommonTicketDataBatch(const EsRightsId *rights_ids, u32 count, void *outBuf, size_t stride,
+                                  u64 *out_sizes, Result *out_results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+// System service registry. ncm, ns, es and account are opened on first use
+// and shared by installs, dumps, saves, the ticket browser and the title
+// cache. Sessions stay open when the last reference is released, so the
+// next operation does not pay for setup again; servicesExit closes them.
+// Content storage and meta database handles are opened once per storage id
+// and shared the same way.
+//
+#pragma once
+
+#include <switch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SERVICE_NCM = 0,
+    SERVICE_NS,
+    SERVICE_ES,                 // es plus the extended-command session (service/es.h)
+    SERVICE_ACCOUNT,            // AccountServiceType_System
+    SERVICE_COUNT
+} ServiceId;
+
+// Take a reference, opening the service on first use
+Result servicesAcquire(ServiceId id);
+void servicesRelease(ServiceId id);
+
+// Shared handles for SD, user and system storage, valid until servicesExit.
+// Do not close them. Game card handles go stale when the card is swapped and
+// are refused here.
+Result servicesGetContentStorage(NcmStorageId storage_id, NcmContentStorage** out);
+Result servicesGetContentMetaDatabase(NcmStorageId storage_id, NcmContentMetaDatabase** out);
+
+// Close every handle and session, whatever the reference counts
+void servicesExit(void);
+
+#ifdef __cplusplus
+}
+#endif
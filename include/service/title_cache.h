@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+// Title name cache shared by the saves view, dumps and the ticket browser.
+// Names are read from each title's NACP once, on pool tasks, and kept in
+// a compact file on the SD card so later runs can list them immediately.
+// Each name is stored with the title's installed version and read again when
+// that changes; titles that are no longer installed drop out of the file.
+//
+#pragma once
+
+#include <switch.h>
+#include <stddef.h>
+#include "core/TaskPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TITLE_CACHE_PATH        "sdmc:/switch/Javelin/title_cache.bin"
+#define TITLE_CACHE_WORKERS     3       // Concurrent NACP lookups in titleCacheFetch, caller included
+
+// Load the cache file (safe to call more than once)
+void titleCacheInit(void);
+
+// Write pending changes and free the cache
+void titleCacheExit(void);
+
+// Copy the cached name of a title. Returns false if the title has no known name
+// (not fetched yet, or not installed); out is left untouched in that case.
+bool titleCacheLookup(u64 title_id, char* out, size_t out_size);
+
+// Fetch every title of the list that is not cached yet, and revalidate names
+// loaded from the file, spread over up to TITLE_CACHE_WORKERS pool tasks.
+// Blocks until done, then persists the changes.
+void titleCacheFetch(const u64* title_ids, u32 count);
+
+// Same, returning early once cancel fires: titles already being read finish,
+// the rest are left for a later fetch
+void titleCacheFetchCancellable(const u64* title_ids, u32 count, const TaskCancelToken* cancel);
+
+// Lookup, fetching the title first if it was never resolved
+bool titleCacheGetName(u64 title_id, char* out, size_t out_size);
+
+// Write the cache file if names changed since the last write
+void titleCacheFlush(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,6 +6,7 @@
 #include <switch.h>
 #include <vector>
 #include <string>
+#include "core/TaskPool.h"
 
 extern "C" {
 #include "ipcext/es.h"
@@ -54,10 +55,48 @@ struct TicketEntry {
     EsRightsId rightsId;
 };
 
+// Name resolved by the loader for the ticket at a load-order position
+struct TicketNameUpdate {
+    u32 index;
+    std::string name;
+};
+
+// Background enumeration. The loader thread publishes tickets and names in
+// batches; the UI thread merges them into the list every frame.
+struct TicketLoader {
+    Task* task;                     // Pool job, released once it has finished
+    bool running;                   // Results still to be merged (UI thread only)
+    TaskCancelToken cancel;
+    Mutex mutex;                    // Guards everything below
+    bool finished;
+    std::vector<TicketEntry> incoming;
+    std::vector<TicketNameUpdate> names;
+    u32 listed;                     // Tickets published so far
+    u32 named;                      // Of those, tickets with a resolved name
+};
+
+// title.keys export. The worker reads common tickets in batches, unwraps
+// their title keys and streams them to the output file.
+struct TicketExportJob {
+    Thread thread;
+    bool running;                   // Started and not yet reported (UI thread only)
+    bool threadStarted;
+    volatile bool cancel;
+    Mutex mutex;                    // Guards everything below
+    bool finished;
+    u32 total;                      // Common tickets to process
+    u32 done;
+    u32 exported;                   // Keys written to the file
+    Result result;
+};
+
 struct TicketBrowserState {
     std::vector<TicketEntry> tickets;
     bool initialized;
     bool loading;
+    bool servicesOpen;              // ns/es references held while the browser is in use
+    TicketLoader loader;
+    TicketExportJob exportJob;
     int selectedFilter;
     char searchBuf[128];
     int selectedTicket;
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/Arena.h"
+#include <string.h>
+
+// Room for the link to the previous block, keeping the payload aligned
+#define BLOCK_HEADER ARENA_ALIGN
+
+static Mutex s_mutex = {0};     // Zero-initialized is valid for libnx Mutex
+static ArenaStats s_stats[ARENA_KIND_COUNT];
+
+static const char* const kKindNames[ARENA_KIND_COUNT] = { "Install", "Layout" };
+
+static inline PoolBuffer** blockLink(PoolBuffer* block) {
+    return (PoolBuffer**)block->data;
+}
+
+void arenaInit(Arena* arena, ArenaKind kind, u32 block_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->kind = (unsigned)kind < ARENA_KIND_COUNT ? kind : ARENA_KIND_INSTALL;
+    arena->blockSize = block_size > BLOCK_HEADER ? block_size : ARENA_INSTALL_BLOCK;
+}
+
+void* arenaAlloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    PoolBuffer* head = arena->head;
+    if (head && arena->cursor + size <= head->size) {
+        void* ptr = head->data + arena->cursor;
+        arena->cursor += (u32)size;
+        arena->used += size;
+        return ptr;
+    }
+
+    size_t need = size + BLOCK_HEADER;
+    bool oversized = need > arena->blockSize;
+    PoolBuffer* block = bufferPoolAcquire(oversized ? need : arena->blockSize, BUFFER_TAG_ARENA);
+
+    mutexLock(&s_mutex);
+    if (block) s_stats[arena->kind].live += block->size;
+    else s_stats[arena->kind].failures++;
+    mutexUnlock(&s_mutex);
+    if (!block) return NULL;
+
+    arena->held += block->size;
+    arena->used += size;
+
+    // A one-off large block goes behind the current one, which may still have room
+    if (oversized && head) {
+        *blockLink(block) = *blockLink(head);
+        *blockLink(head) = block;
+        return block->data + BLOCK_HEADER;
+    }
+
+    *blockLink(block) = head;
+    arena->head = block;
+    arena->cursor = (u32)need;
+    return block->data + BLOCK_HEADER;
+}
+
+void* arenaCalloc(Arena* arena, size_t size) {
+    void* ptr = arenaAlloc(arena, size);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+}
+
+void arenaReset(Arena* arena) {
+    if (!arena->head) return;
+
+    u64 held = arena->held;
+    PoolBuffer* block = arena->head;
+    while (block) {
+        PoolBuffer* prev = *blockLink(block);
+        bufferRelease(block);
+        block = prev;
+    }
+    arena->head = NULL;
+    arena->cursor = 0;
+    arena->used = 0;
+    arena->held = 0;
+
+    mutexLock(&s_mutex);
+    ArenaStats* st = &s_stats[arena->kind];
+    st->operations++;
+    st->live -= held;
+    st->lastPeak = held;
+    if (held > st->maxPeak) st->maxPeak = held;
+    mutexUnlock(&s_mutex);
+}
+
+void arenaGetStats(ArenaKind kind, ArenaStats* out) {
+    mutexLock(&s_mutex);
+    *out = s_stats[(unsigned)kind < ARENA_KIND_COUNT ? kind : ARENA_KIND_INSTALL];
+    mutexUnlock(&s_mutex);
+}
+
+const char* arenaKindName(ArenaKind kind) {
+    return (unsigned)kind < ARENA_KIND_COUNT ? kKindNames[kind] : "?";
+}
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/BufferPool.h"
+#include "mtp/mtp_log.h"
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Mutex s_mutex = {0};     // Zero-initialized is valid for libnx Mutex
+static PoolBuffer* s_idle = NULL;
+static BufferPoolStats s_stats = { BUFFER_POOL_BUDGET };
+
+static const char* const kTagNames[BUFFER_TAG_COUNT] = { "MTP", "USB", "Install", "Dump", "Arena" };
+
+// Caller holds s_mutex
+static void updatePeaks(void) {
+    if (s_stats.inUse > s_stats.peakInUse) s_stats.peakInUse = s_stats.inUse;
+    u64 held = s_stats.inUse + s_stats.cached;
+    if (held > s_stats.peakHeld) s_stats.peakHeld = held;
+}
+
+// Smallest idle buffer that fits without wasting more than half of it, so a
+// small request never pins a large buffer. Caller holds s_mutex.
+static PoolBuffer* takeIdle(size_t size) {
+    PoolBuffer** best = NULL;
+    for (PoolBuffer** link = &s_idle; *link; link = &(*link)->next) {
+        size_t have = (*link)->size;
+        if (have < size || have / 2 > size) continue;
+        if (!best || have < (*best)->size) best = link;
+    }
+    if (!best) return NULL;
+
+    PoolBuffer* buffer = *best;
+    *best = buffer->next;
+    buffer->next = NULL;
+    s_stats.cached -= buffer->size;
+    return buffer;
+}
+
+static void freeBuffer(PoolBuffer* buffer) {
+    free(buffer->data);
+    free(buffer);
+}
+
+// Free the largest idle buffer. Caller holds s_mutex.
+static bool dropLargestIdle(void) {
+    PoolBuffer** largest = NULL;
+    for (PoolBuffer** link = &s_idle; *link; link = &(*link)->next) {
+        if (!largest || (*link)->size > (*largest)->size) largest = link;
+    }
+    if (!largest) return false;
+
+    PoolBuffer* buffer = *largest;
+    *largest = buffer->next;
+    s_stats.cached -= buffer->size;
+    freeBuffer(buffer);
+    return true;
+}
+
+PoolBuffer* bufferPoolAcquire(size_t size, BufferTag tag) {
+    if (size == 0) size = 1;
+    size = (size + BUFFER_POOL_ALIGN - 1) & ~(size_t)(BUFFER_POOL_ALIGN - 1);
+    if ((unsigned)tag >= BUFFER_TAG_COUNT) tag = BUFFER_TAG_MTP;
+
+    mutexLock(&s_mutex);
+    s_stats.acquires++;
+
+    PoolBuffer* buffer = takeIdle(size);
+    if (!buffer) {
+        // Make room under the budget with idle memory first
+        while (s_stats.inUse + s_stats.cached + size > s_stats.budget && dropLargestIdle()) {}
+
+        if (s_stats.inUse + size <= s_stats.budget) {
+            buffer = (PoolBuffer*)calloc(1, sizeof(PoolBuffer));
+            if (buffer) {
+                buffer->data = (u8*)memalign(BUFFER_POOL_ALIGN, size);
+                // The heap may be too fragmented while idle buffers are still held
+                while (!buffer->data && dropLargestIdle()) buffer->data = (u8*)memalign(BUFFER_POOL_ALIGN, size);
+                if (!buffer->data) {
+                    free(buffer);
+                    buffer = NULL;
+                }
+            }
+            if (buffer) {
+                buffer->size = size;
+                s_stats.heapAllocs++;
+            }
+        }
+    }
+
+    if (!buffer) {
+        s_stats.failures++;
+        u64 inUse = s_stats.inUse;
+        mutexUnlock(&s_mutex);
+        LOG_WARN("BufferPool: %s buffer of %zu KB refused (%lu KB in use)", kTagNames[tag], size / 1024,
+                 (unsigned long)(inUse / 1024));
+        return NULL;
+    }
+
+    buffer->refs = 1;
+    buffer->tag = tag;
+    s_stats.inUse += buffer->size;
+    s_stats.tagInUse[tag] += buffer->size;
+    updatePeaks();
+    mutexUnlock(&s_mutex);
+    return buffer;
+}
+
+void bufferRetain(PoolBuffer* buffer) {
+    if (buffer) __atomic_add_fetch(&buffer->refs, 1, __ATOMIC_RELAXED);
+}
+
+void bufferRelease(PoolBuffer* buffer) {
+    if (!buffer) return;
+    if (__atomic_sub_fetch(&buffer->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    mutexLock(&s_mutex);
+    s_stats.inUse -= buffer->size;
+    s_stats.tagInUse[buffer->tag] -= buffer->size;
+    if (s_stats.cached + buffer->size <= BUFFER_POOL_IDLE_MAX) {
+        buffer->next = s_idle;
+        s_idle = buffer;
+        s_stats.cached += buffer->size;
+        buffer = NULL;
+    }
+    mutexUnlock(&s_mutex);
+
+    if (buffer) freeBuffer(buffer);
+}
+
+void bufferPoolTrim(void) {
+    mutexLock(&s_mutex);
+    while (dropLargestIdle()) {}
+    mutexUnlock(&s_mutex);
+}
+
+void bufferPoolGetStats(BufferPoolStats* out) {
+    mutexLock(&s_mutex);
+    *out = s_stats;
+    mutexUnlock(&s_mutex);
+}
+
+const char* bufferTagName(BufferTag tag) {
+    return (unsigned)tag < BUFFER_TAG_COUNT ? kTagNames[tag] : "?";
+}
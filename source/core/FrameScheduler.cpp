@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/FrameScheduler.h"
+
+namespace Javelin {
+
+FrameScheduler::FrameScheduler() {
+    mutexInit(&mutex_);
+    condvarInit(&cond_);
+}
+
+void FrameScheduler::wake() {
+    mutexLock(&mutex_);
+    condvarWakeOne(&cond_);
+    mutexUnlock(&mutex_);
+}
+
+void FrameScheduler::noteInput() {
+    lastInputTick_ = armGetSystemTick();
+}
+
+void FrameScheduler::requestFullRate() {
+    fullRate_ = true;
+}
+
+bool FrameScheduler::shouldRender() {
+    if (fullRate_) return true;
+
+    u64 now = armGetSystemTick();
+    if (lastInputTick_ && now - lastInputTick_ < armNsToTicks(FRAME_ACTIVE_GRACE_NS)) return true;
+
+    u64 sinceRender = now - lastRenderTick_;
+    if (dirty_.load(std::memory_order_acquire) && sinceRender >= armNsToTicks(FRAME_DIRTY_INTERVAL_NS))
+        return true;
+    return sinceRender >= armNsToTicks(FRAME_IDLE_INTERVAL_NS);
+}
+
+void FrameScheduler::beginFrame() {
+    // Marks made while this frame is built are kept for the next one
+    dirty_.store(false, std::memory_order_relaxed);
+    lastRenderTick_ = armGetSystemTick();
+    fullRate_ = false;
+}
+
+void FrameScheduler::waitForWork() {
+    // Already dirty: a frame is due within FRAME_DIRTY_INTERVAL_NS, keep polling input
+    if (dirty_.load(std::memory_order_acquire)) {
+        svcSleepThread(FRAME_POLL_INTERVAL_NS);
+        return;
+    }
+
+    mutexLock(&mutex_);
+    if (!dirty_.load(std::memory_order_acquire))
+        condvarWaitTimeout(&cond_, &mutex_, FRAME_POLL_INTERVAL_NS);
+    mutexUnlock(&mutex_);
+}
+
+} // namespace Javelin
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 //
 #include "GuiManager.h"
+#include "FrameScheduler.h"
 #include "i18n/Localization.h"
 #include "install/stream_install.h"
 #include "imgui.h"
@@ -10,6 +11,15 @@
 
 namespace Javelin {
 
+static float transferPercent(const TransferSlot* slot) {
+    if (!slot) return 0.0f;
+    uint64_t total = slot->totalBytes.load(std::memory_order_relaxed);
+    uint64_t done = slot->bytesDone.load(std::memory_order_relaxed);
+    if (total == 0) return slot->finished.load(std::memory_order_relaxed) ? 100.0f : 0.0f;
+    float percent = (float)done / (float)total * 100.0f;
+    return percent > 100.0f ? 100.0f : percent;
+}
+
 void GuiManager::initialize() {
     eventSubscriptions.push_back(
         EventBus::getInstance().subscribe<ScreenChangeEvent>(
@@ -29,12 +39,6 @@ void GuiManager::initialize() {
         )
     );
 
-    eventSubscriptions.push_back(
-        EventBus::getInstance().subscribe<TransferProgressEvent>(
-            [this](TransferProgressEvent& e) { onTransferProgress(e); }
-        )
-    );
-
     eventSubscriptions.push_back(
         EventBus::getInstance().subscribe<TransferCompleteEvent>(
             [this](TransferCompleteEvent& e) { onTransferComplete(e); }
@@ -47,12 +51,6 @@ void GuiManager::initialize() {
         )
     );
 
-    eventSubscriptions.push_back(
-        EventBus::getInstance().subscribe<InstallProgressEvent>(
-            [this](InstallProgressEvent& e) { onInstallProgress(e); }
-        )
-    );
-
     eventSubscriptions.push_back(
         EventBus::getInstance().subscribe<InstallCompleteEvent>(
             [this](InstallCompleteEvent& e) { onInstallComplete(e); }
@@ -81,6 +79,10 @@ void GuiManager::updateNotifications(float deltaTime) {
             }),
         notifications.end()
     );
+
+    // Keep drawing while a notification is up so it leaves on time instead of
+    // on the next idle heartbeat
+    if (!notifications.empty()) FrameScheduler::getInstance().requestFullRate();
 }
 
 void GuiManager::renderNotifications() {
@@ -121,48 +123,78 @@ void GuiManager::renderNotifications() {
 }
 
 void GuiManager::renderModals() {
-    // Ticket prompt has highest priority - block all other modals when active
+    // Ticket prompt has highest priority - block all other modals when active.
+    // The install waits on the answer, so keep the prompt responsive.
     if (ticketPrompt.active) {
+        FrameScheduler::getInstance().requestFullRate();
         renderPersonalizedTicketModal();
         return;
     }
 
-    std::vector<std::string> transfersToRemove;
+    std::vector<TransferId> transfersToRemove;
+    std::vector<TransferId> installsToRemove;
 
     for (auto& pair : activeTransfers) {
-        bool shouldRemove = renderTransferModal(pair.second);
-        if (shouldRemove) {
+        if (renderTransferModal(pair.second)) {
             transfersToRemove.push_back(pair.first);
         }
     }
 
-    for (const auto& key : transfersToRemove) {
-        activeTransfers.erase(key);
+    for (auto& pair : activeInstalls) {
+        if (renderInstallModal(pair.second)) {
+            installsToRemove.push_back(pair.first);
+        }
     }
 
-    for (auto& pair : activeInstalls) {
-        renderInstallModal(pair.second);
+    for (TransferId id : transfersToRemove) {
+        activeTransfers.erase(id);
+    }
+    for (TransferId id : installsToRemove) {
+        activeInstalls.erase(id);
     }
 }
 
+// Hand the table slot back once nothing running reads it. Finished modals keep
+// their own copy of the final state, so slots never wait for a dismissal.
+void GuiManager::releaseTransfer(TransferId id) {
+    auto transfer = activeTransfers.find(id);
+    if (transfer != activeTransfers.end() && !transfer->second.isComplete) return;
+    auto install = activeInstalls.find(id);
+    if (install != activeInstalls.end() && !install->second.isComplete) return;
+    TransferTable::getInstance().release(id);
+}
+
+// The operation still runs, only without a progress modal
+void GuiManager::warnNoTransferSlot(const std::string& name) {
+    char message[TRANSFER_NAME_MAX + 128];
+    snprintf(message, sizeof(message), TR("modal.no_transfer_slot"), name.c_str());
+    onNotification(NotificationEvent(message, NotificationEvent::Type::Warning, 5000));
+}
+
 bool GuiManager::isModalActive() const {
     return ticketPrompt.active || !activeTransfers.empty() || !activeInstalls.empty();
 }
 
 void GuiManager::renderStatusBar() {
     // Find the most relevant active operation to show
+    TransferTable& table = TransferTable::getInstance();
+
     const TransferProgress* activeTransfer = nullptr;
+    const TransferSlot* transferSlot = nullptr;
     for (const auto& pair : activeTransfers) {
         if (!pair.second.isComplete) {
             activeTransfer = &pair.second;
+            transferSlot = table.get(pair.first);
             break;
         }
     }
 
     const InstallProgress* activeInstall = nullptr;
+    const TransferSlot* installSlot = nullptr;
     for (const auto& pair : activeInstalls) {
         if (!pair.second.isComplete) {
             activeInstall = &pair.second;
+            installSlot = table.get(pair.first);
             break;
         }
     }
@@ -200,9 +232,10 @@ void GuiManager::renderStatusBar() {
         x += ImGui::CalcTextSize(truncName).x + 12.0f;
 
         // Percentage and speed
+        float percent = transferPercent(transferSlot);
+        float speed = transferSlot ? transferSlot->speedMBps.load(std::memory_order_relaxed) : 0.0f;
         char stats[64];
-        snprintf(stats, sizeof(stats), "%.1f%%  %.1f MB/s",
-                 activeTransfer->progressPercent, activeTransfer->speedMBps);
+        snprintf(stats, sizeof(stats), "%.1f%%  %.1f MB/s", percent, speed);
         drawList->AddText(ImVec2(x, textY), IM_COL32(180, 200, 220, 255), stats);
         x += ImGui::CalcTextSize(stats).x + 12.0f;
 
@@ -211,7 +244,7 @@ void GuiManager::renderStatusBar() {
         float barX = 1280.0f - barW - 10.0f;
         float barY0 = 8.0f;
         float barY1 = barHeight - 8.0f;
-        float fill = activeTransfer->progressPercent / 100.0f;
+        float fill = percent / 100.0f;
         if (fill > 1.0f) fill = 1.0f;
         drawList->AddRectFilled(ImVec2(barX, barY0), ImVec2(barX + barW, barY1),
                                 IM_COL32(30, 30, 45, 255), 3.0f);
@@ -229,15 +262,16 @@ void GuiManager::renderStatusBar() {
         drawList->AddText(ImVec2(x, textY), IM_COL32(220, 220, 230, 255), truncName);
         x += ImGui::CalcTextSize(truncName).x + 12.0f;
 
+        float percent = transferPercent(installSlot);
         char stats[64];
-        snprintf(stats, sizeof(stats), "%.1f%%", activeInstall->progressPercent);
+        snprintf(stats, sizeof(stats), "%.1f%%", percent);
         drawList->AddText(ImVec2(x, textY), IM_COL32(180, 200, 220, 255), stats);
 
         float barW = 200.0f;
         float barX = 1280.0f - barW - 10.0f;
         float barY0 = 8.0f;
         float barY1 = barHeight - 8.0f;
-        float fill = activeInstall->progressPercent / 100.0f;
+        float fill = percent / 100.0f;
         if (fill > 1.0f) fill = 1.0f;
         drawList->AddRectFilled(ImVec2(barX, barY0), ImVec2(barX + barW, barY1),
                                 IM_COL32(30, 30, 45, 255), 3.0f);
@@ -268,72 +302,61 @@ void GuiManager::onNotification(const NotificationEvent& event) {
 }
 
 void GuiManager::onTransferStart(const TransferStartEvent& event) {
+    // Without a table slot there is nothing live to show
+    if (event.transferId == InvalidTransferId) {
+        warnNoTransferSlot(event.filePath);
+        return;
+    }
+
     TransferProgress progress;
+    progress.id = event.transferId;
     progress.filePath = event.filePath;
-    progress.bytesTransferred = 0;
     progress.totalBytes = event.totalBytes;
-    progress.progressPercent = 0.0f;
-    progress.speedMBps = 0.0f;
+    progress.bytesTransferred = 0;
     progress.isComplete = false;
     progress.success = false;
-    progress.cancelledPtr = event.cancelledPtr;
-
-    activeTransfers[event.filePath] = progress;
-}
 
-void GuiManager::onTransferProgress(const TransferProgressEvent& event) {
-    auto it = activeTransfers.find(event.filePath);
-    if (it != activeTransfers.end()) {
-        it->second.bytesTransferred = event.bytesTransferred;
-        it->second.progressPercent = event.progressPercent;
-        it->second.speedMBps = event.speedMBps;
-    }
+    activeTransfers[event.transferId] = progress;
 }
 
 void GuiManager::onTransferComplete(const TransferCompleteEvent& event) {
-    auto it = activeTransfers.find(event.filePath);
+    auto it = activeTransfers.find(event.transferId);
     if (it != activeTransfers.end()) {
         it->second.isComplete = true;
         it->second.success = event.success;
         it->second.errorMessage = event.errorMessage;
         it->second.bytesTransferred = event.totalBytes;
-        it->second.progressPercent = 100.0f;
     }
+    releaseTransfer(event.transferId);
 }
 
 void GuiManager::onInstallStart(const InstallStartEvent& event) {
+    if (event.transferId == InvalidTransferId) {
+        warnNoTransferSlot(event.titleName);
+        return;
+    }
+
     InstallProgress progress;
+    progress.id = event.transferId;
     progress.titleName = event.titleName;
     progress.filePath = event.filePath;
-    progress.progressPercent = 0.0f;
     progress.bytesWritten = 0;
-    progress.totalBytes = 0;
     progress.isComplete = false;
     progress.success = false;
-    progress.cancelledPtr = nullptr;
-
-    activeInstalls[event.titleName] = progress;
-}
 
-void GuiManager::onInstallProgress(const InstallProgressEvent& event) {
-    auto it = activeInstalls.find(event.titleName);
-    if (it != activeInstalls.end()) {
-        it->second.progressPercent = event.progressPercent;
-        it->second.currentFile = event.currentFile;
-        it->second.bytesWritten = event.bytesWritten;
-        it->second.totalBytes = event.totalBytes;
-        it->second.stage = event.stage;
-    }
+    activeInstalls[event.transferId] = progress;
 }
 
 void GuiManager::onInstallComplete(const InstallCompleteEvent& event) {
-    auto it = activeInstalls.find(event.titleName);
+    auto it = activeInstalls.find(event.transferId);
     if (it != activeInstalls.end()) {
+        const TransferSlot* slot = TransferTable::getInstance().get(event.transferId);
+        it->second.bytesWritten = slot ? slot->bytesDone.load(std::memory_order_relaxed) : 0;
         it->second.isComplete = true;
         it->second.success = event.success;
         it->second.errorMessage = event.errorMessage;
-        it->second.progressPercent = event.success ? 100.0f : 0.0f;
     }
+    releaseTransfer(event.transferId);
 }
 
 void GuiManager::onPersonalizedTicket(const PersonalizedTicketEvent& event) {
@@ -413,22 +436,26 @@ bool GuiManager::renderTransferModal(const TransferProgress& transfer) {
             ImGui::Text("%s %s", TR("modal.file"), transfer.filePath.c_str());
             ImGui::Spacing();
 
+            const TransferSlot* slot = TransferTable::getInstance().get(transfer.id);
+            float percent = transferPercent(slot);
+            uint64_t done = slot ? slot->bytesDone.load(std::memory_order_relaxed) : 0;
+            uint64_t total = slot ? slot->totalBytes.load(std::memory_order_relaxed) : transfer.totalBytes;
+            float speed = slot ? slot->speedMBps.load(std::memory_order_relaxed) : 0.0f;
+
             char progressText[256];
             snprintf(progressText, sizeof(progressText),
                     "%.1f%% (%.2f MB / %.2f MB) - %.2f MB/s",
-                    transfer.progressPercent,
-                    transfer.bytesTransferred / (1024.0f * 1024.0f),
-                    transfer.totalBytes / (1024.0f * 1024.0f),
-                    transfer.speedMBps);
+                    percent,
+                    done / (1024.0f * 1024.0f),
+                    total / (1024.0f * 1024.0f),
+                    speed);
 
-            ImGui::ProgressBar(transfer.progressPercent / 100.0f, ImVec2(480, 0), progressText);
+            ImGui::ProgressBar(percent / 100.0f, ImVec2(480, 0), progressText);
 
             ImGui::Spacing();
 
             if (ImGui::Button(TR("modal.cancel"), ImVec2(200, 40)) || ImGui::IsKeyPressed(ImGuiKey_GamepadFaceDown)) {
-                if (transfer.cancelledPtr) {
-                    __atomic_store_n(transfer.cancelledPtr, true, __ATOMIC_RELEASE);
-                }
+                TransferTable::getInstance().cancel(transfer.id);
             }
 
             ImGui::Spacing();
@@ -441,7 +468,9 @@ bool GuiManager::renderTransferModal(const TransferProgress& transfer) {
     return shouldRemove;
 }
 
-void GuiManager::renderInstallModal(const InstallProgress& install) {
+bool GuiManager::renderInstallModal(const InstallProgress& install) {
+    bool shouldRemove = false;
+
     if (install.isComplete) {
         ImGui::SetNextWindowPos(ImVec2(640, 360), ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
         ImGui::SetNextWindowSize(ImVec2(500, 0), ImGuiCond_Appearing);
@@ -466,7 +495,7 @@ void GuiManager::renderInstallModal(const InstallProgress& install) {
 
             ImGui::Spacing();
             if (ImGui::Button(TR("modal.ok"), ImVec2(200, 40)) || ImGui::IsKeyPressed(ImGuiKey_GamepadFaceRight)) {
-                activeInstalls.erase(install.titleName);
+                shouldRemove = true;
             }
         }
         ImGui::End();
@@ -483,35 +512,33 @@ void GuiManager::renderInstallModal(const InstallProgress& install) {
             ImGui::Text("%s", titleText);
             ImGui::Spacing();
 
-            if (!install.currentFile.empty()) {
-                char fileText[512];
-                snprintf(fileText, sizeof(fileText), TR("modal.installing_file"), install.currentFile.c_str());
-                ImGui::Text("%s", fileText);
-            }
-
-            if (!install.stage.empty()) {
+            const TransferSlot* slot = TransferTable::getInstance().get(install.id);
+            const char* stage = slot ? slot->stage.load(std::memory_order_relaxed) : nullptr;
+            if (stage) {
                 char stageText[256];
-                snprintf(stageText, sizeof(stageText), TR("modal.stage"), install.stage.c_str());
+                snprintf(stageText, sizeof(stageText), TR("modal.stage"), stage);
                 ImGui::Text("%s", stageText);
             }
 
             ImGui::Spacing();
 
+            float percent = transferPercent(slot);
+            uint64_t written = slot ? slot->bytesDone.load(std::memory_order_relaxed) : 0;
+            uint64_t total = slot ? slot->totalBytes.load(std::memory_order_relaxed) : 0;
+
             char progressText[256];
             snprintf(progressText, sizeof(progressText),
                     "%.1f%% (%.2f MB / %.2f MB)",
-                    install.progressPercent,
-                    install.bytesWritten / (1024.0f * 1024.0f),
-                    install.totalBytes / (1024.0f * 1024.0f));
+                    percent,
+                    written / (1024.0f * 1024.0f),
+                    total / (1024.0f * 1024.0f));
 
-            ImGui::ProgressBar(install.progressPercent / 100.0f, ImVec2(480, 0), progressText);
+            ImGui::ProgressBar(percent / 100.0f, ImVec2(480, 0), progressText);
 
             ImGui::Spacing();
 
             if (ImGui::Button(TR("modal.cancel"), ImVec2(200, 40)) || ImGui::IsKeyPressed(ImGuiKey_GamepadFaceDown)) {
-                if (install.cancelledPtr) {
-                    __atomic_store_n(install.cancelledPtr, true, __ATOMIC_RELEASE);
-                }
+                TransferTable::getInstance().cancel(install.id);
             }
 
             ImGui::Spacing();
@@ -520,6 +547,8 @@ void GuiManager::renderInstallModal(const InstallProgress& install) {
         }
         ImGui::End();
     }
+
+    return shouldRemove;
 }
 
 void GuiManager::renderPersonalizedTicketModal() {
@@ -549,16 +578,16 @@ void GuiManager::renderPersonalizedTicketModal() {
         ImGui::Spacing();
 
         // Ticket details
-        ImGui::Text(TR("ticket.detail_device_id"));
+        ImGui::Text(TR("tickets.detail_device_id"));
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "0x%016lX", ticketPrompt.deviceId);
 
-        ImGui::Text(TR("ticket.detail_account_id"));
+        ImGui::Text(TR("tickets.detail_account_id"));
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "0x%08X", ticketPrompt.accountId);
 
         // Rights ID
-        ImGui::Text(TR("ticket.detail_rights_id"));
+        ImGui::Text(TR("tickets.detail_rights_id"));
         ImGui::SameLine();
         char rightsIdStr[33];
         for (int i = 0; i < 16; i++) {
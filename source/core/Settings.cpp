@@ -10,6 +10,8 @@
 static Settings g_settings = {
     .language = "en",
     .mtp_buffer_size = MTP_BUFFER_DEFAULT,
+    .log_to_file = true,
+    .thread_layout = THREAD_LAYOUT_PINNED,
 };
 
 // Simple JSON parser for our config format
@@ -27,6 +29,11 @@ static char* findJsonString(const char* json, const char* key, char* buffer, siz
     while (*valueStart == ' ' || *valueStart == '\t' || *valueStart == '\n') valueStart++;
 
     if (*valueStart != '"') {
+        // Booleans come back as "true"/"false"
+        if (strncmp(valueStart, "true", 4) == 0 || strncmp(valueStart, "false", 5) == 0) {
+            snprintf(buffer, bufferSize, "%s", *valueStart == 't' ? "true" : "false");
+            return buffer;
+        }
         // Not a string, try to parse as number
         if (*valueStart == '-' || (*valueStart >= '0' && *valueStart <= '9')) {
             const char* numEnd = valueStart;
@@ -78,6 +85,15 @@ void settingsSetMtpBufferSize(u32 size) {
     g_settings.mtp_buffer_size = size;
 }
 
+void settingsSetLogToFile(bool enabled) {
+    g_settings.log_to_file = enabled;
+}
+
+void settingsSetThreadLayout(ThreadLayout layout) {
+    if ((unsigned)layout >= THREAD_LAYOUT_COUNT) layout = THREAD_LAYOUT_PINNED;
+    g_settings.thread_layout = layout;
+}
+
 bool settingsSave(void) {
     FILE* f = fopen(SETTINGS_PATH, "w");
     if (!f) {
@@ -86,7 +102,9 @@ bool settingsSave(void) {
 
     fprintf(f, "{\n");
     fprintf(f, "  \"language\": \"%s\",\n", g_settings.language);
-    fprintf(f, "  \"mtp_buffer_size\": %u\n", g_settings.mtp_buffer_size);
+    fprintf(f, "  \"mtp_buffer_size\": %u,\n", g_settings.mtp_buffer_size);
+    fprintf(f, "  \"log_to_file\": %s,\n", g_settings.log_to_file ? "true" : "false");
+    fprintf(f, "  \"thread_layout\": \"%s\"\n", threadLayoutName(g_settings.thread_layout));
     fprintf(f, "}\n");
 
     fclose(f);
@@ -134,6 +152,16 @@ bool settingsLoad(void) {
         settingsSetMtpBufferSize(size);
     }
 
+    // Parse log file toggle
+    if (findJsonString(buffer, "log_to_file", valueBuffer, sizeof(valueBuffer))) {
+        settingsSetLogToFile(strcmp(valueBuffer, "true") == 0);
+    }
+
+    // Parse thread layout
+    if (findJsonString(buffer, "thread_layout", valueBuffer, sizeof(valueBuffer))) {
+        settingsSetThreadLayout(threadLayoutFromName(valueBuffer));
+    }
+
     free(buffer);
     return true;
 }
@@ -0,0 +1,360 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/TaskPool.h"
+#include "core/ThreadRoles.h"
+#include "core/Trace.h"
+#include "mtp/mtp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct Task {
+    u32 refs;                   // Atomic; the pool holds one until the task finishes
+    u32 state;                  // Atomic TaskState
+    TaskDesc desc;
+    Task* continuations;        // Waiting on this task (guarded by g_mutex)
+    Task* nextContinuation;
+};
+
+// Growable ring. The owner pushes and pops at the back, thieves take the front.
+typedef struct {
+    Task** items;
+    u32 head;
+    u32 count;
+    u32 capacity;
+} TaskDeque;
+
+typedef struct {
+    Thread thread;
+    u32 index;
+    Mutex lock;                 // Guards queues
+    TaskDeque queues[TASK_PRIORITY_COUNT];
+} TaskWorker;
+
+static TaskWorker g_workers[TASK_POOL_MAX_WORKERS];
+static u32 g_worker_count = 0;
+static u32 g_next_worker = 0;   // Round robin for submits from outside the pool
+static u32 g_queued = 0;        // Tasks sitting in any deque
+static bool g_stopping = false;
+
+static Mutex g_mutex;           // Sleeping, completion and continuation lists
+static CondVar g_work_cond;
+static CondVar g_done_cond;
+
+static thread_local TaskWorker* t_worker = nullptr;
+
+static const char* const kWorkerNames[TASK_POOL_MAX_WORKERS] = { "pool 0", "pool 1", "pool 2" };
+
+// ---------------------------------------------------------------------------
+// Deques
+// ---------------------------------------------------------------------------
+
+static bool dequePushBack(TaskDeque* d, Task* task) {
+    if (d->count == d->capacity) {
+        u32 cap = d->capacity ? d->capacity * 2 : 64;
+        Task** items = (Task**)malloc(sizeof(Task*) * cap);
+        if (!items) return false;
+        for (u32 i = 0; i < d->count; i++) items[i] = d->items[(d->head + i) % d->capacity];
+        free(d->items);
+        d->items = items;
+        d->head = 0;
+        d->capacity = cap;
+    }
+    d->items[(d->head + d->count) % d->capacity] = task;
+    d->count++;
+    return true;
+}
+
+static Task* dequePopBack(TaskDeque* d) {
+    if (d->count == 0) return NULL;
+    d->count--;
+    return d->items[(d->head + d->count) % d->capacity];
+}
+
+static Task* dequePopFront(TaskDeque* d) {
+    if (d->count == 0) return NULL;
+    Task* task = d->items[d->head];
+    d->head = (d->head + 1) % d->capacity;
+    d->count--;
+    return task;
+}
+
+// ---------------------------------------------------------------------------
+// Scheduling
+// ---------------------------------------------------------------------------
+
+static void runTask(Task* task);
+
+static void taskUnref(Task* task) {
+    if (__atomic_sub_fetch(&task->refs, 1, __ATOMIC_ACQ_REL) == 0) free(task);
+}
+
+static void enqueue(Task* task) {
+    if (g_worker_count == 0) {
+        runTask(task);
+        return;
+    }
+
+    // A worker keeps what it spawns; stealing spreads it out
+    TaskWorker* w = t_worker;
+    if (!w) w = &g_workers[__atomic_fetch_add(&g_next_worker, 1, __ATOMIC_RELAXED) % g_worker_count];
+
+    // Counted before it is visible so a thief never takes g_queued below zero
+    __atomic_add_fetch(&g_queued, 1, __ATOMIC_RELEASE);
+    mutexLock(&w->lock);
+    bool queued = dequePushBack(&w->queues[task->desc.priority], task);
+    mutexUnlock(&w->lock);
+    if (!queued) {
+        __atomic_sub_fetch(&g_queued, 1, __ATOMIC_RELEASE);
+        runTask(task);
+        return;
+    }
+
+    mutexLock(&g_mutex);
+    condvarWakeOne(&g_work_cond);
+    mutexUnlock(&g_mutex);
+}
+
+// Highest priority first; within a priority the own deque before stealing
+static Task* findTask(TaskWorker* self) {
+    if (__atomic_load_n(&g_queued, __ATOMIC_ACQUIRE) == 0) return NULL;
+
+    for (int p = 0; p < TASK_PRIORITY_COUNT; p++) {
+        if (self) {
+            mutexLock(&self->lock);
+            Task* task = dequePopBack(&self->queues[p]);
+            mutexUnlock(&self->lock);
+            if (task) {
+                __atomic_sub_fetch(&g_queued, 1, __ATOMIC_ACQ_REL);
+                return task;
+            }
+        }
+        u32 start = self ? self->index + 1 : 0;
+        for (u32 i = 0; i < g_worker_count; i++) {
+            TaskWorker* victim = &g_workers[(start + i) % g_worker_count];
+            if (victim == self) continue;
+            mutexLock(&victim->lock);
+            Task* task = dequePopFront(&victim->queues[p]);
+            mutexUnlock(&victim->lock);
+            if (task) {
+                __atomic_sub_fetch(&g_queued, 1, __ATOMIC_ACQ_REL);
+                return task;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void finishTask(Task* task, TaskState state) {
+    if (task->desc.release) task->desc.release(task->desc.arg);
+
+    mutexLock(&g_mutex);
+    __atomic_store_n(&task->state, state, __ATOMIC_RELEASE);
+    Task* cont = task->continuations;
+    task->continuations = NULL;
+    condvarWakeAll(&g_done_cond);
+    mutexUnlock(&g_mutex);
+
+    while (cont) {
+        Task* next = cont->nextContinuation;
+        if (state == TASK_STATE_CANCELLED) finishTask(cont, TASK_STATE_CANCELLED);
+        else enqueue(cont);
+        cont = next;
+    }
+    taskUnref(task);
+}
+
+static void runTask(Task* task) {
+    if (taskCancelled(task->desc.cancel)) {
+        finishTask(task, TASK_STATE_CANCELLED);
+        return;
+    }
+    __atomic_store_n(&task->state, TASK_STATE_RUNNING, __ATOMIC_RELAXED);
+    task->desc.run(task->desc.arg);
+    finishTask(task, TASK_STATE_DONE);
+}
+
+static void workerMain(void* arg) {
+    TaskWorker* self = (TaskWorker*)arg;
+    t_worker = self;
+    TRACE_THREAD_NAME(kWorkerNames[self->index]);
+
+    while (true) {
+        Task* task = findTask(self);
+        if (task) {
+            TRACE_SCOPE("task");
+            runTask(task);
+            continue;
+        }
+
+        // g_queued is raised before the wake-up is sent under g_mutex, so
+        // checking it under the same lock cannot miss a submit
+        mutexLock(&g_mutex);
+        bool stop = g_stopping && __atomic_load_n(&g_queued, __ATOMIC_ACQUIRE) == 0;
+        if (!stop && __atomic_load_n(&g_queued, __ATOMIC_ACQUIRE) == 0) condvarWait(&g_work_cond, &g_mutex);
+        mutexUnlock(&g_mutex);
+        if (stop) break;
+    }
+    t_worker = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+void taskPoolInit(void) {
+    if (g_worker_count > 0) return;
+
+    mutexInit(&g_mutex);
+    condvarInit(&g_work_cond);
+    condvarInit(&g_done_cond);
+    g_stopping = false;
+
+    // One worker per core the background role may run on. Without a mask
+    // (shared layout) they all stay unpinned on the default core, where they
+    // still overlap service calls that block.
+    const ThreadRoleConfig* cfg = threadRoleGet(THREAD_ROLE_BACKGROUND);
+    u32 mask = cfg->coreMask;
+
+    u32 created = 0;
+    for (s32 slot = 0; slot < TASK_POOL_MAX_WORKERS; slot++) {
+        if (mask && !(mask & (1u << slot))) continue;
+        s32 core = mask ? slot : cfg->core;
+        TaskWorker* w = &g_workers[created];
+        memset(w, 0, sizeof(*w));
+        w->index = created;
+        mutexInit(&w->lock);
+
+        Result rc = threadCreate(&w->thread, workerMain, w, NULL, TASK_POOL_STACK_SIZE, cfg->priority, core);
+        if (R_FAILED(rc)) {
+            LOG_ERROR("TaskPool: worker on core %d failed: 0x%08X", core, rc);
+            continue;
+        }
+        // Start on its own core but let the scheduler migrate it within the mask
+        if (mask && mask != (1u << core)) svcSetThreadCoreMask(w->thread.handle, core, mask);
+        created++;
+    }
+
+    // Published before the first worker runs; a worker that fails to start
+    // still has its deque drained by the others
+    __atomic_store_n(&g_worker_count, created, __ATOMIC_RELEASE);
+    u32 started = 0;
+    for (u32 i = 0; i < created; i++) {
+        if (R_SUCCEEDED(threadStart(&g_workers[i].thread))) started++;
+    }
+    if (started == 0) {
+        g_worker_count = 0;
+        for (u32 i = 0; i < created; i++) threadClose(&g_workers[i].thread);
+    }
+    if (mask) LOG_INFO("TaskPool: %u workers, core mask 0x%X", started, mask);
+    else LOG_INFO("TaskPool: %u workers on the default core", started);
+}
+
+void taskPoolExit(void) {
+    u32 count = g_worker_count;
+    if (count == 0) return;
+
+    mutexLock(&g_mutex);
+    g_stopping = true;
+    condvarWakeAll(&g_work_cond);
+    mutexUnlock(&g_mutex);
+
+    for (u32 i = 0; i < count; i++) {
+        threadWaitForExit(&g_workers[i].thread);
+        threadClose(&g_workers[i].thread);
+    }
+    g_worker_count = 0;
+
+    for (u32 i = 0; i < count; i++) {
+        for (int p = 0; p < TASK_PRIORITY_COUNT; p++) {
+            free(g_workers[i].queues[p].items);
+            g_workers[i].queues[p] = TaskDeque{};
+        }
+    }
+}
+
+u32 taskPoolWorkerCount(void) {
+    return __atomic_load_n(&g_worker_count, __ATOMIC_ACQUIRE);
+}
+
+Task* taskSubmitDesc(const TaskDesc* desc) {
+    Task* task = (Task*)calloc(1, sizeof(Task));
+    if (!task) {
+        taskWait(desc->after);
+        bool dropped = desc->after && taskGetState(desc->after) == TASK_STATE_CANCELLED;
+        if (!dropped && !taskCancelled(desc->cancel)) desc->run(desc->arg);
+        if (desc->release) desc->release(desc->arg);
+        return NULL;
+    }
+    task->refs = 2;             // Caller and pool
+    task->state = TASK_STATE_QUEUED;
+    task->desc = *desc;
+    if ((unsigned)task->desc.priority >= TASK_PRIORITY_COUNT) task->desc.priority = TASK_PRIORITY_NORMAL;
+    task->desc.after = NULL;
+
+    Task* parent = desc->after;
+    if (parent) {
+        mutexLock(&g_mutex);
+        u32 parentState = __atomic_load_n(&parent->state, __ATOMIC_ACQUIRE);
+        bool waiting = parentState < TASK_STATE_DONE;
+        if (waiting) {
+            task->nextContinuation = parent->continuations;
+            parent->continuations = task;
+        }
+        mutexUnlock(&g_mutex);
+        if (waiting) return task;
+        if (parentState == TASK_STATE_CANCELLED) {
+            finishTask(task, TASK_STATE_CANCELLED);
+            return task;
+        }
+    }
+
+    enqueue(task);
+    return task;
+}
+
+Task* taskSubmit(TaskFunc run, void* arg, TaskPriority priority, const TaskCancelToken* cancel) {
+    TaskDesc desc = { run, arg, NULL, priority, cancel, NULL };
+    return taskSubmitDesc(&desc);
+}
+
+Task* taskThen(Task* parent, TaskFunc run, void* arg, TaskPriority priority, const TaskCancelToken* cancel) {
+    TaskDesc desc = { run, arg, NULL, priority, cancel, parent };
+    return taskSubmitDesc(&desc);
+}
+
+void taskWait(Task* task) {
+    if (!task) return;
+
+    while (!taskIsFinished(task)) {
+        // Workers help instead of blocking, so nested waits cannot starve the pool
+        if (t_worker) {
+            Task* other = findTask(t_worker);
+            if (other) {
+                runTask(other);
+                continue;
+            }
+        }
+
+        mutexLock(&g_mutex);
+        if (!taskIsFinished(task)) {
+            // A worker wakes up now and then in case new work arrived meanwhile
+            if (t_worker) condvarWaitTimeout(&g_done_cond, &g_mutex, 1000000ULL);
+            else condvarWait(&g_done_cond, &g_mutex);
+        }
+        mutexUnlock(&g_mutex);
+    }
+}
+
+TaskState taskGetState(const Task* task) {
+    if (!task) return TASK_STATE_DONE;
+    return (TaskState)__atomic_load_n(&task->state, __ATOMIC_ACQUIRE);
+}
+
+bool taskIsFinished(const Task* task) {
+    return taskGetState(task) >= TASK_STATE_DONE;
+}
+
+void taskRelease(Task* task) {
+    if (task) taskUnref(task);
+}
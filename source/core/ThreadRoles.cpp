@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/ThreadRoles.h"
+#include "mtp/mtp_log.h"
+#include <string.h>
+
+#define DEFAULT_PRIORITY 0x2C
+
+// Applications get cores 0-2; core 0 also takes most system work, so the
+// latency-sensitive USB pump and the bulk I/O workers each get their own core
+static const ThreadRoleConfig kLayouts[THREAD_LAYOUT_COUNT][THREAD_ROLE_COUNT] = {
+    // THREAD_LAYOUT_PINNED
+    {
+        { 0, 1u << 0, 0x2D },                   // UI
+        { 1, 1u << 1, 0x26 },                   // USB
+        { 2, 1u << 2, 0x2A },                   // IO
+        { 0, (1u << 0) | (1u << 2), 0x30 },     // Background, borrows idle time on 0 and 2
+    },
+    // THREAD_LAYOUT_SHARED
+    {
+        { -2, 0, DEFAULT_PRIORITY },
+        { -2, 0, DEFAULT_PRIORITY },
+        { -2, 0, DEFAULT_PRIORITY },
+        { -2, 0, DEFAULT_PRIORITY },
+    },
+};
+
+static const char* const kLayoutNames[THREAD_LAYOUT_COUNT] = { "pinned", "shared" };
+
+static ThreadLayout g_layout = THREAD_LAYOUT_PINNED;
+
+void threadRolesSetLayout(ThreadLayout layout) {
+    if ((unsigned)layout >= THREAD_LAYOUT_COUNT) layout = THREAD_LAYOUT_PINNED;
+    g_layout = layout;
+
+    const ThreadRoleConfig* ui = threadRoleGet(THREAD_ROLE_UI);
+    Handle self = threadGetCurHandle();
+    svcSetThreadPriority(self, ui->priority);
+    if (ui->coreMask) {
+        Result rc = svcSetThreadCoreMask(self, ui->core, ui->coreMask);
+        if (R_FAILED(rc)) LOG_WARN("Threads: UI core mask failed: 0x%08X", rc);
+    }
+    LOG_INFO("Threads: %s layout", kLayoutNames[layout]);
+}
+
+ThreadLayout threadRolesGetLayout(void) {
+    return g_layout;
+}
+
+const ThreadRoleConfig* threadRoleGet(ThreadRole role) {
+    if ((unsigned)role >= THREAD_ROLE_COUNT) role = THREAD_ROLE_BACKGROUND;
+    return &kLayouts[g_layout][role];
+}
+
+const char* threadLayoutName(ThreadLayout layout) {
+    return (unsigned)layout < THREAD_LAYOUT_COUNT ? kLayoutNames[layout] : kLayoutNames[0];
+}
+
+ThreadLayout threadLayoutFromName(const char* name) {
+    for (int i = 0; i < THREAD_LAYOUT_COUNT; i++) {
+        if (name && strcmp(name, kLayoutNames[i]) == 0) return (ThreadLayout)i;
+    }
+    return THREAD_LAYOUT_PINNED;
+}
+
+Result threadCreateForRole(Thread* t, ThreadFunc entry, void* arg, size_t stack_sz, ThreadRole role) {
+    const ThreadRoleConfig* cfg = threadRoleGet(role);
+    Result rc = threadCreate(t, entry, arg, NULL, stack_sz, cfg->priority, cfg->core);
+    if (R_FAILED(rc)) return rc;
+
+    // A wider mask lets the scheduler move the thread off its preferred core
+    if (cfg->coreMask && cfg->coreMask != (1u << cfg->core)) {
+        Result maskRc = svcSetThreadCoreMask(t->handle, cfg->core, cfg->coreMask);
+        if (R_FAILED(maskRc)) LOG_WARN("Threads: core mask 0x%X failed: 0x%08X", cfg->coreMask, maskRc);
+    }
+    return rc;
+}
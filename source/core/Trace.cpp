@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/Trace.h"
+
+#if JAVELIN_TRACE
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace Javelin {
+
+// Ring of finished spans. Only the owning thread writes events and head.
+struct TraceBuffer {
+    char threadName[TRACE_THREAD_NAME_MAX];
+    uint32_t tid;
+    std::atomic<uint64_t> head;
+    TraceEvent events[TRACE_EVENTS_PER_THREAD];
+};
+
+static std::mutex g_trace_mutex;        // Registration and dumping
+static TraceBuffer* g_buffers[TRACE_MAX_THREADS];
+static uint32_t g_buffer_count = 0;
+static std::atomic<bool> g_enabled{true};
+
+static thread_local TraceBuffer* t_buffer = nullptr;
+static thread_local bool t_registration_failed = false;
+
+// Caller holds g_trace_mutex
+static TraceBuffer* registerBuffer(const char* name) {
+    if (name) {
+        for (uint32_t i = 0; i < g_buffer_count; i++) {
+            if (strcmp(g_buffers[i]->threadName, name) == 0) return g_buffers[i];
+        }
+    }
+    if (g_buffer_count >= TRACE_MAX_THREADS) return nullptr;
+
+    TraceBuffer* buffer = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+    if (!buffer) return nullptr;
+    buffer->tid = g_buffer_count + 1;
+    if (name) snprintf(buffer->threadName, sizeof(buffer->threadName), "%s", name);
+    else snprintf(buffer->threadName, sizeof(buffer->threadName), "thread %u", buffer->tid);
+    g_buffers[g_buffer_count++] = buffer;
+    return buffer;
+}
+
+void traceSetThreadName(const char* name) {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    t_buffer = registerBuffer(name);
+    t_registration_failed = t_buffer == nullptr;
+}
+
+void traceRecord(const char* name, uint64_t start, uint64_t end, uint64_t arg) {
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+
+    TraceBuffer* buffer = t_buffer;
+    if (!buffer) {
+        if (t_registration_failed) return;
+        std::lock_guard<std::mutex> lock(g_trace_mutex);
+        buffer = t_buffer = registerBuffer(nullptr);
+        t_registration_failed = buffer == nullptr;
+        if (!buffer) return;
+    }
+
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer->events[head % TRACE_EVENTS_PER_THREAD];
+    event.start = start;
+    event.end = end;
+    event.name = name;
+    event.arg = arg;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void traceSetEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool traceIsEnabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void traceClear() {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    for (uint32_t i = 0; i < g_buffer_count; i++)
+        g_buffers[i]->head.store(0, std::memory_order_relaxed);
+}
+
+static double ticksToMicros(uint64_t ticks) {
+#ifdef __SWITCH__
+    return (double)armTicksToNs(ticks) / 1000.0;
+#else
+    return (double)ticks / 1000.0;
+#endif
+}
+
+static void writeJsonString(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+bool traceDump(const char* path) {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    static char s_file_buf[64 * 1024];
+    setvbuf(f, s_file_buf, _IOFBF, sizeof(s_file_buf));
+
+    // Spans that end while the file is written are lost, not torn
+    bool wasEnabled = g_enabled.exchange(false);
+
+    // Timestamps are relative to the oldest recorded span
+    uint64_t origin = UINT64_MAX;
+    for (uint32_t i = 0; i < g_buffer_count; i++) {
+        TraceBuffer* b = g_buffers[i];
+        uint64_t head = b->head.load(std::memory_order_acquire);
+        uint64_t count = head < TRACE_EVENTS_PER_THREAD ? head : TRACE_EVENTS_PER_THREAD;
+        for (uint64_t n = head - count; n < head; n++) {
+            uint64_t start = b->events[n % TRACE_EVENTS_PER_THREAD].start;
+            if (start < origin) origin = start;
+        }
+    }
+    if (origin == UINT64_MAX) origin = 0;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (uint32_t i = 0; i < g_buffer_count; i++) {
+        TraceBuffer* b = g_buffers[i];
+
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                first ? "" : ",\n", b->tid);
+        writeJsonString(f, b->threadName);
+        fprintf(f, "}}");
+        first = false;
+
+        uint64_t head = b->head.load(std::memory_order_acquire);
+        uint64_t count = head < TRACE_EVENTS_PER_THREAD ? head : TRACE_EVENTS_PER_THREAD;
+        for (uint64_t n = head - count; n < head; n++) {
+            const TraceEvent& e = b->events[n % TRACE_EVENTS_PER_THREAD];
+            fprintf(f, ",\n{\"name\":");
+            writeJsonString(f, e.name ? e.name : "?");
+            fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%llu}}",
+                    b->tid, ticksToMicros(e.start - origin), ticksToMicros(e.end - e.start),
+                    (unsigned long long)e.arg);
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    bool ok = ferror(f) == 0;
+    if (fclose(f) != 0) ok = false;
+
+    g_enabled.store(wasEnabled);
+    return ok;
+}
+
+} // namespace Javelin
+
+#endif // JAVELIN_TRACE
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "core/TransferTable.h"
+#include "mtp/mtp_log.h"
+#include <cstdio>
+
+namespace Javelin {
+
+TransferId TransferTable::begin(const char* name, uint64_t totalBytes) {
+    for (uint32_t i = 0; i < TRANSFER_TABLE_SIZE; i++) {
+        TransferSlot& slot = slots_[i];
+        if (slot.claimed.exchange(true, std::memory_order_acquire)) continue;
+
+        snprintf(slot.name, sizeof(slot.name), "%s", name ? name : "");
+        slot.bytesDone.store(0, std::memory_order_relaxed);
+        slot.totalBytes.store(totalBytes, std::memory_order_relaxed);
+        slot.speedMBps.store(0.0f, std::memory_order_relaxed);
+        slot.stage.store(nullptr, std::memory_order_relaxed);
+        slot.cancelRequested.store(false, std::memory_order_relaxed);
+        slot.finished.store(false, std::memory_order_relaxed);
+
+        // The serial keeps ids unique across slot reuse; the low part is the slot
+        uint32_t serial = nextSerial_.fetch_add(1, std::memory_order_relaxed);
+        TransferId id = serial * TRANSFER_TABLE_SIZE + i;
+        if (id == InvalidTransferId) {
+            serial = nextSerial_.fetch_add(1, std::memory_order_relaxed);
+            id = serial * TRANSFER_TABLE_SIZE + i;
+        }
+        slot.id.store(id, std::memory_order_release);
+        return id;
+    }
+    LOG_WARN("TransferTable: all %d slots busy, '%s' runs without progress", TRANSFER_TABLE_SIZE,
+             name ? name : "");
+    return InvalidTransferId;
+}
+
+void TransferTable::release(TransferId id) {
+    TransferSlot* slot = find(id);
+    if (!slot) return;
+    slot->id.store(InvalidTransferId, std::memory_order_release);
+    slot->claimed.store(false, std::memory_order_release);
+}
+
+} // namespace Javelin
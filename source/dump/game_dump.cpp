@@ -4,6 +4,7 @@
 #include "dump/game_dump.h"
 #include "mtp/mtp_log.h"
 #include "core/Debug.h"
+#include "core/Trace.h"
 
 extern "C" {
 #include "ipcext/es.h"
@@ -11,6 +12,8 @@ extern "C" {
 }
 
 #include "install/cnmt.h"
+#include "service/title_cache.h"
+#include "service/services.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -61,6 +64,7 @@ static u64 get_nca_size(const NcmContentInfo* info)
 
 static s64 read_nca_data(DumpContext* ctx, const DumpNspFileEntry* entry, u64 offset, void* buffer, u64 size)
 {
+    TRACE_SCOPE_ARG("read_nca_data", size);
     NcmContentStorage* storage = NULL;
     if (entry->storage_id == NcmStorageId_SdCard)
     {
@@ -69,7 +73,7 @@ static s64 read_nca_data(DumpContext* ctx, const DumpNspFileEntry* entry, u64 of
             LOG_ERROR("[Dump] SD storage not open");
             return -1;
         }
-        storage = &ctx->sd_storage;
+        storage = ctx->sd_storage;
     }
     else
     {
@@ -78,7 +82,7 @@ static s64 read_nca_data(DumpContext* ctx, const DumpNspFileEntry* entry, u64 of
             LOG_ERROR("[Dump] NAND storage not open");
             return -1;
         }
-        storage = &ctx->nand_storage;
+        storage = ctx->nand_storage;
     }
 
     u64 bytes_read_total = 0;
@@ -113,7 +117,7 @@ static bool ensure_es_service(DumpContext* ctx)
 {
     if (ctx->es_initialized) return true;
 
-    Result rc = esInitialize();
+    Result rc = servicesAcquire(SERVICE_ES);
     if (R_SUCCEEDED(rc))
     {
         ctx->es_initialized = true;
@@ -163,10 +167,9 @@ static void extract_ticket_cert(DumpContext* ctx, DumpNspLayout* layout, const u
                         LOG_INFO("[Dump] Found matching common ticket for rights ID");
 
                         // Extract the ticket data
-                        u8* tik_buf = (u8*)malloc(0x400);
+                        u8* tik_buf = (u8*)arenaCalloc(&layout->arena, 0x400);
                         if (tik_buf)
                         {
-                            memset(tik_buf, 0, 0x400);
                             u64 out_size = 0;
                             rc = esGetCommonTicketData(&out_size, &rights_ids[i], tik_buf, 0x400);
                             if (R_SUCCEEDED(rc) && out_size > 0)
@@ -178,7 +181,6 @@ static void extract_ticket_cert(DumpContext* ctx, DumpNspLayout* layout, const u
                             else
                             {
                                 LOG_ERROR("[Dump] Failed to get common ticket data: 0x%08X", rc);
-                                free(tik_buf);
                             }
                         }
                         break;
@@ -208,10 +210,9 @@ static void extract_ticket_cert(DumpContext* ctx, DumpNspLayout* layout, const u
                         {
                             LOG_INFO("[Dump] Found matching personalized ticket - extracting via common path");
                             // Personalized tickets can sometimes be read via the common API
-                            u8* tik_buf = (u8*)malloc(0x400);
+                            u8* tik_buf = (u8*)arenaCalloc(&layout->arena, 0x400);
                             if (tik_buf)
                             {
-                                memset(tik_buf, 0, 0x400);
                                 u64 out_size = 0;
                                 rc = esGetCommonTicketData(&out_size, &rights_ids[i], tik_buf, 0x400);
                                 if (R_SUCCEEDED(rc) && out_size > 0)
@@ -223,7 +224,6 @@ static void extract_ticket_cert(DumpContext* ctx, DumpNspLayout* layout, const u
                                 else
                                 {
                                     LOG_WARN("[Dump] Could not extract personalized ticket: 0x%08X", rc);
-                                    free(tik_buf);
                                 }
                             }
                             break;
@@ -312,28 +312,10 @@ static void parse_version_string(u32 version_key, char* out_version, size_t out_
 
 static void get_game_name_from_ns(u64 app_id, char* out_name, size_t out_size)
 {
-    NsApplicationControlData* ctrl = (NsApplicationControlData*)malloc(sizeof(NsApplicationControlData));
-    if (ctrl)
+    if (!titleCacheGetName(app_id, out_name, out_size))
     {
-        u64 actual = 0;
-        Result rc = nsGetApplicationControlData(NsApplicationControlSource_Storage, app_id, ctrl, sizeof(*ctrl),
-                                                &actual);
-        if (R_SUCCEEDED(rc) && actual >= sizeof(ctrl->nacp))
-        {
-            for (int k = 0; k < 16; k++)
-            {
-                if (ctrl->nacp.lang[k].name[0])
-                {
-                    strncpy(out_name, ctrl->nacp.lang[k].name, out_size - 1);
-                    out_name[out_size - 1] = '\0';
-                    free(ctrl);
-                    return;
-                }
-            }
-        }
-        free(ctrl);
+        snprintf(out_name, out_size, "%016lX", app_id);
     }
-    snprintf(out_name, out_size, "%016lX", app_id);
 }
 
 static bool get_display_version_from_ns(u64 app_id, char* out_version, size_t out_size)
@@ -434,7 +416,7 @@ static void open_ncm_handles(DumpContext* ctx)
 
     if (!ctx->sd_storage_open)
     {
-        Result rc = ncmOpenContentStorage(&ctx->sd_storage, NcmStorageId_SdCard);
+        Result rc = servicesGetContentStorage(NcmStorageId_SdCard, &ctx->sd_storage);
         if (R_SUCCEEDED(rc))
         {
             ctx->sd_storage_open = true;
@@ -443,7 +425,7 @@ static void open_ncm_handles(DumpContext* ctx)
 
     if (!ctx->sd_meta_db_open)
     {
-        Result rc = ncmOpenContentMetaDatabase(&ctx->sd_meta_db, NcmStorageId_SdCard);
+        Result rc = servicesGetContentMetaDatabase(NcmStorageId_SdCard, &ctx->sd_meta_db);
         if (R_SUCCEEDED(rc))
         {
             ctx->sd_meta_db_open = true;
@@ -452,7 +434,7 @@ static void open_ncm_handles(DumpContext* ctx)
 
     if (!ctx->nand_storage_open)
     {
-        Result rc = ncmOpenContentStorage(&ctx->nand_storage, NcmStorageId_BuiltInUser);
+        Result rc = servicesGetContentStorage(NcmStorageId_BuiltInUser, &ctx->nand_storage);
         if (R_SUCCEEDED(rc))
         {
             ctx->nand_storage_open = true;
@@ -461,7 +443,7 @@ static void open_ncm_handles(DumpContext* ctx)
 
     if (!ctx->nand_meta_db_open)
     {
-        Result rc = ncmOpenContentMetaDatabase(&ctx->nand_meta_db, NcmStorageId_BuiltInUser);
+        Result rc = servicesGetContentMetaDatabase(NcmStorageId_BuiltInUser, &ctx->nand_meta_db);
         if (R_SUCCEEDED(rc))
         {
             ctx->nand_meta_db_open = true;
@@ -484,7 +466,7 @@ static void build_pfs0_header(DumpNspLayout* layout)
         (sizeof(Pfs0FileEntry) * layout->file_count) +
         padded_string_table_size;
 
-    layout->pfs0_header = (u8*)calloc(1, header_size);
+    layout->pfs0_header = (u8*)arenaCalloc(&layout->arena, header_size);
     if (!layout->pfs0_header) return;
     layout->pfs0_header_size = header_size;
 
@@ -526,6 +508,8 @@ static void compute_nsp_layout(DumpContext* ctx, DumpNspLayout* layout,
 {
     if (layout->computed) return;
 
+    arenaReset(&layout->arena);
+    arenaInit(&layout->arena, ARENA_KIND_LAYOUT, ARENA_LAYOUT_BLOCK);
     memset(layout->files, 0, sizeof(layout->files));
     layout->file_count = 0;
     layout->ticket_data = NULL;
@@ -571,11 +555,11 @@ static void compute_nsp_layout(DumpContext* ctx, DumpNspLayout* layout,
 
     if (storage_id == NcmStorageId_SdCard)
     {
-        meta_db = &ctx->sd_meta_db;
+        meta_db = ctx->sd_meta_db;
     }
     else
     {
-        meta_db = &ctx->nand_meta_db;
+        meta_db = ctx->nand_meta_db;
     }
 
     (void)primary_storage;
@@ -687,21 +671,10 @@ static void compute_nsp_layout(DumpContext* ctx, DumpNspLayout* layout,
 
 static void free_layout(DumpNspLayout* layout)
 {
-    if (layout->pfs0_header)
-    {
-        free(layout->pfs0_header);
-        layout->pfs0_header = NULL;
-    }
-    if (layout->ticket_data)
-    {
-        free(layout->ticket_data);
-        layout->ticket_data = NULL;
-    }
-    if (layout->cert_data)
-    {
-        free(layout->cert_data);
-        layout->cert_data = NULL;
-    }
+    arenaReset(&layout->arena);
+    layout->pfs0_header = NULL;
+    layout->ticket_data = NULL;
+    layout->cert_data = NULL;
     layout->computed = false;
     layout->file_count = 0;
     layout->total_nsp_size = 0;
@@ -717,7 +690,7 @@ static bool ensure_dump_services(DumpContext* ctx)
 
     if (!ctx->ncm_initialized)
     {
-        Result rc = ncmInitialize();
+        Result rc = servicesAcquire(SERVICE_NCM);
         if (R_SUCCEEDED(rc))
         {
             ctx->ncm_initialized = true;
@@ -726,7 +699,7 @@ static bool ensure_dump_services(DumpContext* ctx)
 
     if (!ctx->ns_initialized)
     {
-        Result rc = nsInitialize();
+        Result rc = servicesAcquire(SERVICE_NS);
         if (R_SUCCEEDED(rc))
         {
             ctx->ns_initialized = true;
@@ -780,7 +753,7 @@ void dumpEnumerateGames(DumpContext* ctx)
     s32 sd_total = 0;
     if (ctx->sd_meta_db_open)
     {
-        Result rc = ncmContentMetaDatabaseListApplication(&ctx->sd_meta_db, &sd_total, &sd_count,
+        Result rc = ncmContentMetaDatabaseListApplication(ctx->sd_meta_db, &sd_total, &sd_count,
                                                           sd_app_keys, 512, NcmContentMetaType_Application);
         if (R_FAILED(rc))
         {
@@ -792,7 +765,7 @@ void dumpEnumerateGames(DumpContext* ctx)
     s32 nand_total = 0;
     if (ctx->nand_meta_db_open)
     {
-        Result rc = ncmContentMetaDatabaseListApplication(&ctx->nand_meta_db, &nand_total, &nand_count,
+        Result rc = ncmContentMetaDatabaseListApplication(ctx->nand_meta_db, &nand_total, &nand_count,
                                                           nand_app_keys, 512, NcmContentMetaType_Application);
         if (R_FAILED(rc))
         {
@@ -800,6 +773,15 @@ void dumpEnumerateGames(DumpContext* ctx)
         }
     }
 
+    // Resolve all names in one concurrent batch before building the entries
+    {
+        u64 name_ids[1024];
+        u32 name_count = 0;
+        for (s32 i = 0; i < sd_count; i++) name_ids[name_count++] = sd_app_keys[i].application_id;
+        for (s32 i = 0; i < nand_count; i++) name_ids[name_count++] = nand_app_keys[i].application_id;
+        titleCacheFetch(name_ids, name_count);
+    }
+
     for (s32 i = 0; i < sd_count && ctx->game_count < ctx->max_games; i++)
     {
         u64 app_id = sd_app_keys[i].application_id;
@@ -814,7 +796,7 @@ void dumpEnumerateGames(DumpContext* ctx)
 
         get_game_name_from_ns(app_id, game->game_name, sizeof(game->game_name));
 
-        NcmContentMetaDatabase* meta_db = &ctx->sd_meta_db;
+        NcmContentMetaDatabase* meta_db = ctx->sd_meta_db;
         u8 meta_buffer[0x4000];
 
         DumpContentMetaEntry* cme = &game->content_metas[game->content_meta_count];
@@ -969,7 +951,7 @@ void dumpEnumerateGames(DumpContext* ctx)
 
         get_game_name_from_ns(app_id, game->game_name, sizeof(game->game_name));
 
-        NcmContentMetaDatabase* meta_db = &ctx->nand_meta_db;
+        NcmContentMetaDatabase* meta_db = ctx->nand_meta_db;
         u8 meta_buffer[0x4000];
 
         DumpContentMetaEntry* cme = &game->content_metas[game->content_meta_count];
@@ -1184,42 +1166,27 @@ void dumpExit(DumpContext* ctx)
     free(ctx->games);
     ctx->games = NULL;
 
-    if (ctx->sd_storage_open)
-    {
-        ncmContentStorageClose(&ctx->sd_storage);
-        ctx->sd_storage_open = false;
-    }
-    if (ctx->nand_storage_open)
-    {
-        ncmContentStorageClose(&ctx->nand_storage);
-        ctx->nand_storage_open = false;
-    }
-    if (ctx->sd_meta_db_open)
-    {
-        ncmContentMetaDatabaseClose(&ctx->sd_meta_db);
-        ctx->sd_meta_db_open = false;
-    }
-    if (ctx->nand_meta_db_open)
-    {
-        ncmContentMetaDatabaseClose(&ctx->nand_meta_db);
-        ctx->nand_meta_db_open = false;
-    }
+    // Shared handles stay open for the next user
+    ctx->sd_storage_open = false;
+    ctx->nand_storage_open = false;
+    ctx->sd_meta_db_open = false;
+    ctx->nand_meta_db_open = false;
 
     if (ctx->ncm_initialized)
     {
-        ncmExit();
+        servicesRelease(SERVICE_NCM);
         ctx->ncm_initialized = false;
     }
 
     if (ctx->ns_initialized)
     {
-        nsExit();
+        servicesRelease(SERVICE_NS);
         ctx->ns_initialized = false;
     }
 
     if (ctx->es_initialized)
     {
-        esExit();
+        servicesRelease(SERVICE_ES);
         ctx->es_initialized = false;
     }
 
@@ -1243,7 +1210,7 @@ void dumpPreInitServices(DumpContext* ctx)
 
     if (!ctx->ns_initialized)
     {
-        Result rc = nsInitialize();
+        Result rc = servicesAcquire(SERVICE_NS);
         if (R_SUCCEEDED(rc))
         {
             ctx->ns_initialized = true;
@@ -1252,7 +1219,7 @@ void dumpPreInitServices(DumpContext* ctx)
 
     if (!ctx->ncm_initialized)
     {
-        Result rc = ncmInitialize();
+        Result rc = servicesAcquire(SERVICE_NCM);
         if (R_SUCCEEDED(rc))
         {
             ctx->ncm_initialized = true;
@@ -5,6 +5,7 @@
 #include "mtp/mtp_log.h"
 #include "core/GuiEvents.h"
 #include "core/Event.h"
+#include "core/Trace.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -161,7 +162,7 @@ static void ensure_keys_checked(GcContext* ctx) {
             NotificationEvent::Type::Warning,
             6000
         );
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
         LOG_WARN("[GC] prod.keys not found - dump will lack key info");
     }
     if (!ctx->title_keys.loaded) {
@@ -651,11 +652,11 @@ bool gcRefreshCardState(GcContext* ctx) {
         if (inserted) {
             NotificationEvent evt("Gamecard inserted.",
                                   NotificationEvent::Type::Info, 3000);
-            EventBus::getInstance().post(evt);
+            EventBus::getInstance().postAsync(evt);
         } else {
             NotificationEvent evt("Gamecard removed.",
                                   NotificationEvent::Type::Warning, 3000);
-            EventBus::getInstance().post(evt);
+            EventBus::getInstance().postAsync(evt);
         }
     }
     return changed;
@@ -715,7 +716,7 @@ void gcRefreshIfNeeded(GcContext* ctx) {
             NotificationEvent evt(
                 std::string("Gamecard ready: ") + ctx->game_name,
                 NotificationEvent::Type::Success, 4000);
-            EventBus::getInstance().post(evt);
+            EventBus::getInstance().postAsync(evt);
         } else {
             LOG_ERROR("[GC] Failed to build XCI layout");
         }
@@ -723,6 +724,7 @@ void gcRefreshIfNeeded(GcContext* ctx) {
 }
 
 s64 gcReadObject(GcContext* ctx, u32 handle, u64 offset, void* buffer, u64 size) {
+    TRACE_SCOPE_ARG("gcReadObject", size);
     if (!ctx->initialized) return -1;
     if (handle != MTP_HANDLE_GC_XCI_FILE && handle != MTP_HANDLE_GC_NSP_FILE) return -1;
 
@@ -7,138 +7,218 @@
 #include "core/Debug.h"
 #include <cstdio>
 #include <cstring>
-#include <unordered_map>
 
 namespace Javelin {
 
 void Localization::initialize() {
     currentLanguage = "en";
+    strings = kEmbeddedLanguages[0].strings;
 
-    const auto& embeddedLangs = getEmbeddedLanguages();
-    for (const auto& lang : embeddedLangs) {
-        if (lang.code && lang.keys && lang.values) {
-            std::unordered_map<std::string, std::string> langStrings;
-            for (size_t i = 0; lang.keys[i] != nullptr && lang.values[i] != nullptr; i++) {
-                langStrings[lang.keys[i]] = lang.values[i];
-            }
-            allStrings[lang.code] = langStrings;
-        }
-    }
+    DBG_PRINT("Loaded %zu embedded languages, %zu strings each", kEmbeddedLanguageCount, kStringCount);
 
-    DBG_PRINT("Loaded %zu embedded languages", allStrings.size());
-
-    const char* langCodes[] = {
-        "af", "ar", "ca", "cs", "da", "de", "el", "en", "es", "fi", "fr",
-        "he", "hu", "it", "ja", "ko", "nl", "no", "pl", "pt", "ro", "ru",
-        "sr", "sv", "tr", "uk", "vi", "zh"
-    };
+    // Other languages are read from RomFS when first selected
+    loadFromRomfs("en");
+    strings = findTable("en");
+}
 
-    for (size_t i = 0; i < sizeof(langCodes) / sizeof(langCodes[0]); i++) {
-        loadFromRomfs(langCodes[i]);
+bool Localization::hasRomfsTable(const char* langCode) const {
+    for (const auto& table : romfsTables) {
+        if (table->code == langCode) return true;
     }
+    return false;
+}
 
-    auto it = allStrings.find("en");
-    if (it != allStrings.end()) {
-        strings = it->second;
+const char* const* Localization::findTable(const char* langCode) const {
+    for (const auto& table : romfsTables) {
+        if (table->code == langCode) return table->strings;
     }
-
-    DBG_PRINT("Initialized with %zu languages (including RomFS overrides)", allStrings.size());
+    for (size_t i = 0; i < kEmbeddedLanguageCount; i++) {
+        if (strcmp(kEmbeddedLanguages[i].code, langCode) == 0) return kEmbeddedLanguages[i].strings;
+    }
+    return nullptr;
 }
 
 void Localization::loadLanguage(const char* langCode) {
     if (loadFromRomfs(langCode)) {
-        currentLanguage = langCode;
+        setLanguage(langCode);
     }
 }
 
 void Localization::setLanguage(const char* langCode) {
-    std::string codeStr(langCode);
-    auto it = allStrings.find(codeStr);
-    if (it != allStrings.end()) {
-        currentLanguage = codeStr;
-        strings = it->second;
-        DBG_PRINT("Language changed to: %s (loaded %zu strings)", langCode, strings.size());
+    if (!hasRomfsTable(langCode)) loadFromRomfs(langCode);
+
+    const char* const* table = findTable(langCode);
+    if (table) {
+        currentLanguage = langCode;
+        strings = table;
+        DBG_PRINT("Language changed to: %s", langCode);
     } else {
-        DBG_PRINT("Language not found: %s (available: %zu)", langCode, allStrings.size());
+        DBG_PRINT("Language not found: %s", langCode);
     }
 }
 
 const char* Localization::getLanguageName(const char* code) const {
-    const auto& embeddedLangs = getEmbeddedLanguages();
-    for (const auto& lang : embeddedLangs) {
-        if (lang.code && strcmp(lang.code, code) == 0) {
-            return lang.name;
+    for (size_t i = 0; i < kEmbeddedLanguageCount; i++) {
+        if (strcmp(kEmbeddedLanguages[i].code, code) == 0) {
+            return kEmbeddedLanguages[i].name;
         }
     }
     return "English";
 }
 
 const char* Localization::tr(const char* key) const {
-    auto it = strings.find(key);
-    if (it != strings.end()) {
-        return it->second.c_str();
-    }
-
-    auto enTranslations = getEmbeddedTranslations("en");
-    auto enIt = enTranslations.find(key);
-    if (enIt != enTranslations.end()) {
-        return enIt->second.c_str();
-    }
-
-    return key;
+    int id = findStringId(key);
+    return id >= 0 ? strings[id] : key;
 }
 
 const char* Localization::tr(const char* key, const char* fallback) const {
-    auto it = strings.find(key);
-    if (it != strings.end()) {
-        return it->second.c_str();
-    }
-    return fallback;
+    int id = findStringId(key);
+    return id >= 0 ? strings[id] : fallback;
 }
 
 std::vector<Language> Localization::getAvailableLanguages() const {
     std::vector<Language> languages;
-
-    const auto& embeddedLangs = getEmbeddedLanguages();
-    for (const auto& lang : embeddedLangs) {
-        if (lang.code && lang.name) {
-            languages.push_back({lang.code, lang.name});
-        }
+    languages.reserve(kEmbeddedLanguageCount);
+    for (size_t i = 0; i < kEmbeddedLanguageCount; i++) {
+        languages.push_back({kEmbeddedLanguages[i].code, kEmbeddedLanguages[i].name});
     }
-
     return languages;
 }
 
 bool Localization::hasLanguage(const char* langCode) const {
-    return allStrings.find(langCode) != allStrings.end();
+    return findTable(langCode) != nullptr;
 }
 
-static char* findJsonValue(const char* json, const char* key, char* buffer, size_t bufferSize) {
-    char searchKey[256];
-    snprintf(searchKey, sizeof(searchKey), "\"%s\"", key);
-
-    const char* keyPos = strstr(json, searchKey);
-    if (!keyPos) return nullptr;
+// ----------------------------------------------------------------------------
+// RomFS overrides
+// Translation files are flat {"key": "value"} objects. The file is read into
+// one buffer, walked once, and each value is unescaped in place; the buffer
+// then backs the language's string table.
+// ----------------------------------------------------------------------------
 
-    const char* colon = strchr(keyPos, ':');
-    if (!colon) return nullptr;
+static const char* skipWhitespace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    return p;
+}
 
-    const char* valueStart = colon + 1;
-    while (*valueStart == ' ' || *valueStart == '\t' || *valueStart == '\n') valueStart++;
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-    if (*valueStart != '"') return nullptr;
-    valueStart++;
+static bool readHex4(const char* p, const char* end, u32* out) {
+    if (end - p < 4) return false;
+    u32 v = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hexValue(p[i]);
+        if (h < 0) return false;
+        v = (v << 4) | (u32)h;
+    }
+    *out = v;
+    return true;
+}
 
-    const char* valueEnd = strchr(valueStart, '"');
-    if (!valueEnd) return nullptr;
+static char* putUtf8(char* out, u32 cp) {
+    if (cp < 0x80) {
+        *out++ = (char)cp;
+    } else if (cp < 0x800) {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
 
-    size_t length = valueEnd - valueStart;
-    if (length >= bufferSize) length = bufferSize - 1;
+// Unescape the string starting just past its opening quote into a
+// NUL-terminated string at the same address. Decoded text is never longer
+// than its source, so writes stay behind reads. Returns the position after
+// the closing quote, or nullptr if the string is malformed.
+static char* readJsonString(char* p, const char* end) {
+    char* out = p;
+    while (p < end && *p != '"') {
+        if (*p != '\\') {
+            *out++ = *p++;
+            continue;
+        }
+        if (++p >= end) return nullptr;
+        char c = *p++;
+        switch (c) {
+            case '"': case '\\': case '/': *out++ = c; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                u32 cp;
+                if (!readHex4(p, end, &cp)) return nullptr;
+                p += 4;
+                // Surrogate pair
+                u32 low;
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    readHex4(p + 2, end, &low) && low >= 0xDC00 && low < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                out = putUtf8(out, cp);
+                break;
+            }
+            default:
+                return nullptr;
+        }
+    }
+    if (p >= end) return nullptr;
+    *out = '\0';
+    return p + 1;
+}
 
-    memcpy(buffer, valueStart, length);
-    buffer[length] = '\0';
+// Walk the object once, pointing table entries at values in the buffer.
+// Unknown keys are skipped. Returns the number of strings overridden.
+static int parseTranslations(char* json, size_t size, const char** strings) {
+    const char* end = json + size;
+    char* p = (char*)skipWhitespace(json, end);
+    if (p >= end || *p != '{') return 0;
+    p++;
+
+    int count = 0;
+    for (;;) {
+        p = (char*)skipWhitespace(p, end);
+        if (p < end && *p == '}') break;
+        if (p >= end || *p != '"') return count;
+
+        char* key = p + 1;
+        p = readJsonString(key, end);
+        if (!p) return count;
+
+        p = (char*)skipWhitespace(p, end);
+        if (p >= end || *p != ':') return count;
+        p = (char*)skipWhitespace(p + 1, end);
+        if (p >= end || *p != '"') return count;
+
+        char* value = p + 1;
+        p = readJsonString(value, end);
+        if (!p) return count;
+
+        int id = findStringId(key);
+        if (id >= 0 && value[0] != '\0') {
+            strings[id] = value;
+            count++;
+        }
 
-    return buffer;
+        p = (char*)skipWhitespace(p, end);
+        if (p < end && *p == ',') p++;
+    }
+    return count;
 }
 
 bool Localization::loadFromRomfs(const char* langCode) {
@@ -156,40 +236,41 @@ bool Localization::loadFromRomfs(const char* langCode) {
     }
 
     fseek(f, 0, SEEK_END);
-    size_t size = ftell(f);
+    long size = ftell(f);
     fseek(f, 0, SEEK_SET);
-
-    char* buffer = (char*)malloc(size + 1);
-    if (!buffer) {
+    if (size <= 0) {
         fclose(f);
         return false;
     }
 
-    fread(buffer, 1, size, f);
-    buffer[size] = '\0';
+    std::unique_ptr<LanguageTable> table(new LanguageTable());
+    table->arena.reset(new char[size]);
+    size_t got = fread(table->arena.get(), 1, size, f);
     fclose(f);
 
-    std::unordered_map<std::string, std::string> langStrings;
-    auto embeddedFallback = getEmbeddedTranslations(langCode);
-    if (embeddedFallback.empty()) {
-        embeddedFallback = getEmbeddedTranslations("en");
+    // Start from the embedded table (English fills its gaps)
+    table->code = langCode;
+    const char* const* base = nullptr;
+    for (size_t i = 0; i < kEmbeddedLanguageCount && !base; i++) {
+        if (strcmp(kEmbeddedLanguages[i].code, langCode) == 0) base = kEmbeddedLanguages[i].strings;
     }
-    langStrings = embeddedFallback;
-
-    char valueBuffer[512];
-    int translatedCount = 0;
-
-    auto enTranslations = getEmbeddedTranslations("en");
-    for (const auto& entry : enTranslations) {
-        char* value = findJsonValue(buffer, entry.first.c_str(), valueBuffer, sizeof(valueBuffer));
-        if (value && strlen(value) > 0) {
-            langStrings[entry.first] = value;
-            translatedCount++;
+    if (!base) base = kEmbeddedLanguages[0].strings;
+    memcpy(table->strings, base, sizeof(table->strings));
+
+    int translatedCount = parseTranslations(table->arena.get(), got, table->strings);
+
+    // Reloading a language replaces its table; keep the active pointer valid
+    const char* const* newStrings = table->strings;
+    bool replaced = false;
+    for (auto& existing : romfsTables) {
+        if (existing->code == langCode) {
+            if (strings == existing->strings) strings = newStrings;
+            existing = std::move(table);
+            replaced = true;
+            break;
         }
     }
-
-    free(buffer);
-    allStrings[langCode] = langStrings;
+    if (!replaced) romfsTables.push_back(std::move(table));
 
     if (translatedCount > 0) {
         DBG_PRINT("Loaded %s from RomFS: %d translations", langCode, translatedCount);
@@ -199,4 +280,3 @@ bool Localization::loadFromRomfs(const char* langCode) {
 }
 
 }
-
@@ -3,6 +3,7 @@
 //
 #include "install/cnmt.h"
 #include "mtp_log.h"
+#include "service/services.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -54,16 +55,15 @@ bool cnmtReadFromInstalledNca(const NcmContentId* cnmt_id, NcmStorageId storage_
                                CnmtContext* out_ctx) {
     if (!cnmt_id || !out_ctx) return false;
 
-    NcmContentStorage storage;
-    Result rc = ncmOpenContentStorage(&storage, storage_id);
+    NcmContentStorage* storage;
+    Result rc = servicesGetContentStorage(storage_id, &storage);
     if (R_FAILED(rc)) {
         LOG_ERROR("CNMT: Failed to open content storage: 0x%08X", rc);
         return false;
     }
 
     char nca_path[FS_MAX_PATH];
-    rc = ncmContentStorageGetPath(&storage, nca_path, sizeof(nca_path), cnmt_id);
-    ncmContentStorageClose(&storage);
+    rc = ncmContentStorageGetPath(storage, nca_path, sizeof(nca_path), cnmt_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("CNMT: Failed to get NCA path: 0x%08X", rc);
         return false;
@@ -269,9 +269,10 @@ NcmContentMetaKey cnmtGetContentMetaKey(const CnmtContext* ctx) {
 Result cnmtBuildInstallContentMeta(const CnmtContext* ctx,
                                    const NcmContentInfo* cnmt_content_info,
                                    bool ignore_req_firmware,
+                                   Arena* arena,
                                    u8** out_buffer,
                                    size_t* out_size) {
-    if (!ctx || !cnmt_content_info || !out_buffer || !out_size) {
+    if (!ctx || !cnmt_content_info || !arena || !out_buffer || !out_size) {
         return MAKERESULT(Module_Libnx, LibnxError_BadInput);
     }
 
@@ -280,7 +281,7 @@ Result cnmtBuildInstallContentMeta(const CnmtContext* ctx,
                        ((ctx->content_count + 1) * sizeof(NcmContentInfo)) +
                        ctx->extended_data_size;
 
-    u8* buffer = (u8*)malloc(total_size);
+    u8* buffer = (u8*)arenaAlloc(arena, total_size);
     if (!buffer) {
         LOG_ERROR("CNMT: Failed to allocate install buffer (%zu bytes)", total_size);
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
@@ -358,16 +359,15 @@ bool nacpGetDisplayVersionFromControlNca(NcmContentMetaDatabase* meta_db,
         return false;
     }
 
-    NcmContentStorage storage;
-    rc = ncmOpenContentStorage(&storage, storage_id);
+    NcmContentStorage* storage;
+    rc = servicesGetContentStorage(storage_id, &storage);
     if (R_FAILED(rc)) {
         LOG_ERROR("NACP: Failed to open content storage: 0x%08X", rc);
         return false;
     }
 
     char nca_path[FS_MAX_PATH];
-    rc = ncmContentStorageGetPath(&storage, nca_path, sizeof(nca_path), &control_id);
-    ncmContentStorageClose(&storage);
+    rc = ncmContentStorageGetPath(storage, nca_path, sizeof(nca_path), &control_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("NACP: Failed to get Control NCA path: 0x%08X", rc);
         return false;
@@ -431,16 +431,15 @@ bool nacpGetDlcName(NcmContentMetaDatabase* meta_db,
         return false;
     }
 
-    NcmContentStorage storage;
-    rc = ncmOpenContentStorage(&storage, storage_id);
+    NcmContentStorage* storage;
+    rc = servicesGetContentStorage(storage_id, &storage);
     if (R_FAILED(rc)) {
         LOG_ERROR("NACP: Failed to open content storage: 0x%08X", rc);
         return false;
     }
 
     char nca_path[FS_MAX_PATH];
-    rc = ncmContentStorageGetPath(&storage, nca_path, sizeof(nca_path), &control_id);
-    ncmContentStorageClose(&storage);
+    rc = ncmContentStorageGetPath(storage, nca_path, sizeof(nca_path), &control_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("NACP: Failed to get DLC Control NCA path: 0x%08X", rc);
         return false;
@@ -9,17 +9,36 @@
 #include "core/Event.h"
 #include "mtp_log.h"
 #include "install/cnmt.h"
+#include "service/services.h"
 #include <string.h>
 #include <strings.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/stat.h>
 
+#define NCA_TRANSFER_SIZE (1024 * 1024)
+
+// Drop what the previous install left in the arena
+static void beginInstall(NcaInstallContext* ctx) {
+    arenaReset(&ctx->arena);
+    ctx->transfer_buffer = NULL;
+}
+
+// One copy buffer shared by every NCA of an install
+static u8* transferBuffer(NcaInstallContext* ctx) {
+    if (!ctx->transfer_buffer) {
+        ctx->transfer_buffer = (u8*)arenaAlloc(&ctx->arena, NCA_TRANSFER_SIZE);
+        if (!ctx->transfer_buffer) LOG_ERROR("NCA Install: Failed to allocate transfer buffer");
+    }
+    return ctx->transfer_buffer;
+}
+
 Result ncaInstallInit(NcaInstallContext* ctx, InstallTarget target) {
     if (!ctx) return MAKERESULT(Module_Libnx, LibnxError_BadInput);
 
     memset(ctx, 0, sizeof(NcaInstallContext));
     ctx->target = target;
+    arenaInit(&ctx->arena, ARENA_KIND_INSTALL, ARENA_INSTALL_BLOCK);
 
     if (target == INSTALL_TARGET_SD) {
         ctx->storage_id = NcmStorageId_SdCard;
@@ -27,14 +46,14 @@ Result ncaInstallInit(NcaInstallContext* ctx, InstallTarget target) {
         ctx->storage_id = NcmStorageId_BuiltInUser;
     }
 
-    Result rc = ncmInitialize();
+    Result rc = servicesAcquire(SERVICE_NCM);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to initialize NCM: 0x%08X", rc);
         return rc;
     }
     ctx->ncm_initialized = true;
 
-    rc = ncmOpenContentStorage(&ctx->content_storage, ctx->storage_id);
+    rc = servicesGetContentStorage(ctx->storage_id, &ctx->content_storage);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to open content storage: 0x%08X", rc);
         ncaInstallExit(ctx);
@@ -42,7 +61,7 @@ Result ncaInstallInit(NcaInstallContext* ctx, InstallTarget target) {
     }
     ctx->storage_open = true;
 
-    rc = ncmOpenContentMetaDatabase(&ctx->meta_db, ctx->storage_id);
+    rc = servicesGetContentMetaDatabase(ctx->storage_id, &ctx->meta_db);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to open metadata database: 0x%08X", rc);
         ncaInstallExit(ctx);
@@ -56,21 +75,20 @@ Result ncaInstallInit(NcaInstallContext* ctx, InstallTarget target) {
 void ncaInstallExit(NcaInstallContext* ctx) {
     if (!ctx) return;
 
-    if (ctx->meta_db_open) {
-        ncmContentMetaDatabaseClose(&ctx->meta_db);
-        ctx->meta_db_open = false;
-    }
-
-    if (ctx->storage_open) {
-        ncmContentStorageClose(&ctx->content_storage);
-        ctx->storage_open = false;
-    }
+    // The storage and meta database handles are shared; they stay open
+    ctx->meta_db_open = false;
+    ctx->storage_open = false;
 
     if (ctx->ncm_initialized) {
-        ncmExit();
+        servicesRelease(SERVICE_NCM);
         ctx->ncm_initialized = false;
     }
 
+    if (ctx->arena.held) {
+        LOG_INFO("NCA Install: Metadata arena peaked at %lu KB (%lu KB used)",
+                 (unsigned long)(ctx->arena.held / 1024), (unsigned long)(ctx->arena.used / 1024));
+    }
+    arenaReset(&ctx->arena);
     memset(ctx, 0, sizeof(NcaInstallContext));
 }
 
@@ -80,6 +98,8 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
         return MAKERESULT(Module_Libnx, LibnxError_BadInput);
     }
 
+    beginInstall(ctx);
+
     FILE* nca_fp = fopen(nca_path, "rb");
     if (!nca_fp) {
         LOG_ERROR("NCA Install: Failed to open NCA file: %s", nca_path);
@@ -91,7 +111,7 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
     fseek(nca_fp, 0, SEEK_SET);
 
     NcmPlaceHolderId placeholder_id;
-    Result rc = ncmContentStorageGeneratePlaceHolderId(&ctx->content_storage, &placeholder_id);
+    Result rc = ncmContentStorageGeneratePlaceHolderId(ctx->content_storage, &placeholder_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to generate placeholder ID: 0x%08X", rc);
         fclose(nca_fp);
@@ -108,7 +128,7 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
         content_id.c[i] = (u8)strtoul(hex_byte, NULL, 16);
     }
 
-    rc = ncmContentStorageCreatePlaceHolder(&ctx->content_storage, &content_id,
+    rc = ncmContentStorageCreatePlaceHolder(ctx->content_storage, &content_id,
                                             &placeholder_id, nca_size);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to create placeholder: 0x%08X", rc);
@@ -116,10 +136,9 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
         return rc;
     }
 
-    u8* buffer = (u8*)malloc(1024 * 1024);
+    u8* buffer = transferBuffer(ctx);
     if (!buffer) {
-        LOG_ERROR("NCA Install: Failed to allocate transfer buffer");
-        ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
         fclose(nca_fp);
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
     }
@@ -128,7 +147,7 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
     bool write_success = true;
 
     while (offset < nca_size) {
-        u64 chunk_size = (nca_size - offset > 1024 * 1024) ? 1024 * 1024 : (nca_size - offset);
+        u64 chunk_size = (nca_size - offset > NCA_TRANSFER_SIZE) ? NCA_TRANSFER_SIZE : (nca_size - offset);
 
         size_t read_bytes = fread(buffer, 1, chunk_size, nca_fp);
         if (read_bytes != chunk_size) {
@@ -137,7 +156,7 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
             break;
         }
 
-        rc = ncmContentStorageWritePlaceHolder(&ctx->content_storage, &placeholder_id,
+        rc = ncmContentStorageWritePlaceHolder(ctx->content_storage, &placeholder_id,
                                                offset, buffer, read_bytes);
         if (R_FAILED(rc)) {
             LOG_ERROR("NCA Install: Write error at offset 0x%lX: 0x%08X", offset, rc);
@@ -148,22 +167,21 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
         offset += read_bytes;
     }
 
-    free(buffer);
     fclose(nca_fp);
 
     if (!write_success) {
-        ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
         return MAKERESULT(Module_Libnx, LibnxError_IoError);
     }
 
-    rc = ncmContentStorageRegister(&ctx->content_storage, &content_id, &placeholder_id);
+    rc = ncmContentStorageRegister(ctx->content_storage, &content_id, &placeholder_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to register content: 0x%08X", rc);
-        ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
         return rc;
     }
 
-    ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+    ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
 
     if (out_content_id) {
         memcpy(out_content_id, &content_id, sizeof(NcmContentId));
@@ -175,7 +193,7 @@ Result ncaInstallFile(NcaInstallContext* ctx, const char* nca_path,
 static Result readCnmtFromNca(NcaInstallContext* ctx, const NcmContentId* cnmt_id,
                               CnmtContext* out_cnmt) {
     char cnmt_path[FS_MAX_PATH];
-    Result rc = ncmContentStorageGetPath(&ctx->content_storage, cnmt_path, sizeof(cnmt_path), cnmt_id);
+    Result rc = ncmContentStorageGetPath(ctx->content_storage, cnmt_path, sizeof(cnmt_path), cnmt_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to get CNMT NCA path: 0x%08X", rc);
         return rc;
@@ -227,7 +245,7 @@ static Result readCnmtFromNca(NcaInstallContext* ctx, const NcmContentId* cnmt_i
     s64 cnmt_size;
     fsFileGetSize(&cnmt_file, &cnmt_size);
 
-    u8* cnmt_data = (u8*)malloc(cnmt_size);
+    u8* cnmt_data = (u8*)arenaAlloc(&ctx->arena, cnmt_size);
     if (!cnmt_data) {
         fsFileClose(&cnmt_file);
         fsFsClose(&cnmt_fs);
@@ -240,16 +258,13 @@ static Result readCnmtFromNca(NcaInstallContext* ctx, const NcmContentId* cnmt_i
     fsFsClose(&cnmt_fs);
 
     if (R_FAILED(rc) || bytes_read != (u64)cnmt_size) {
-        free(cnmt_data);
         return rc;
     }
 
     if (!cnmtParse(out_cnmt, cnmt_data, cnmt_size)) {
-        free(cnmt_data);
         return MAKERESULT(Module_Libnx, LibnxError_IoError);
     }
 
-    free(cnmt_data);
     return 0;
 }
 
@@ -259,6 +274,7 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
     }
 
     LOG_INFO("NCA Install: Installing NSP: %s", nsp_path);
+    beginInstall(ctx);
 
     NspContext nsp;
     if (!nspOpen(&nsp, nsp_path)) {
@@ -283,11 +299,10 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
             if (cert_idx < 0) continue;
 
             u64 tik_size = nspGetFileSize(&nsp, i);
-            u8* tik_data = (u8*)malloc(tik_size);
+            u8* tik_data = (u8*)arenaAlloc(&ctx->arena, tik_size);
             if (!tik_data) continue;
 
             if (nspReadFile(&nsp, i, 0, tik_data, tik_size) != (s64)tik_size) {
-                free(tik_data);
                 continue;
             }
 
@@ -307,15 +322,10 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
             }
 
             u64 cert_size = nspGetFileSize(&nsp, cert_idx);
-            u8* cert_data = (u8*)malloc(cert_size);
-            if (!cert_data) {
-                free(tik_data);
-                continue;
-            }
+            u8* cert_data = (u8*)arenaAlloc(&ctx->arena, cert_size);
+            if (!cert_data) continue;
 
             if (nspReadFile(&nsp, cert_idx, 0, cert_data, cert_size) != (s64)cert_size) {
-                free(cert_data);
-                free(tik_data);
                 continue;
             }
 
@@ -340,9 +350,6 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
                     LOG_DEBUG("NCA Install: Imported ticket successfully");
                 }
             }
-
-            free(cert_data);
-            free(tik_data);
         }
     }
 
@@ -364,19 +371,19 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
             }
 
             NcmPlaceHolderId placeholder_id;
-            ncmContentStorageGeneratePlaceHolderId(&ctx->content_storage, &placeholder_id);
+            ncmContentStorageGeneratePlaceHolderId(ctx->content_storage, &placeholder_id);
 
             u64 nca_size = nspGetFileSize(&nsp, i);
 
             // Remove existing content if already registered (e.g. from a previous attempt)
             bool already_exists = false;
-            ncmContentStorageHas(&ctx->content_storage, &already_exists, &cnmt_content_id);
+            ncmContentStorageHas(ctx->content_storage, &already_exists, &cnmt_content_id);
             if (already_exists) {
-                ncmContentStorageDelete(&ctx->content_storage, &cnmt_content_id);
+                ncmContentStorageDelete(ctx->content_storage, &cnmt_content_id);
                 LOG_INFO("NCA Install: Removed existing CNMT NCA before reinstall");
             }
 
-            Result rc = ncmContentStorageCreatePlaceHolder(&ctx->content_storage,
+            Result rc = ncmContentStorageCreatePlaceHolder(ctx->content_storage,
                                                            &cnmt_content_id,
                                                            &placeholder_id, nca_size);
             if (R_FAILED(rc)) {
@@ -384,12 +391,17 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
                 continue;
             }
 
-            u8* buffer = (u8*)malloc(1024 * 1024);
+            u8* buffer = transferBuffer(ctx);
+            if (!buffer) {
+                ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
+                break;
+            }
+
             u64 offset = 0;
             bool write_ok = true;
             while (offset < nca_size) {
-                u64 to_read = (nca_size - offset > 1024 * 1024) ?
-                             1024 * 1024 : (nca_size - offset);
+                u64 to_read = (nca_size - offset > NCA_TRANSFER_SIZE) ?
+                             NCA_TRANSFER_SIZE : (nca_size - offset);
 
                 s64 read = nspReadFile(&nsp, i, offset, buffer, to_read);
                 if (read <= 0) {
@@ -398,7 +410,7 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
                     break;
                 }
 
-                Result wrc = ncmContentStorageWritePlaceHolder(&ctx->content_storage, &placeholder_id,
+                Result wrc = ncmContentStorageWritePlaceHolder(ctx->content_storage, &placeholder_id,
                                                   offset, buffer, read);
                 if (R_FAILED(wrc)) {
                     LOG_ERROR("NCA Install: CNMT placeholder write failed: 0x%08X at offset 0x%lX", wrc, offset);
@@ -407,27 +419,26 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
                 }
                 offset += read;
             }
-            free(buffer);
 
             if (!write_ok || offset != nca_size) {
                 LOG_ERROR("NCA Install: CNMT NCA incomplete: wrote %lu of %lu bytes", (unsigned long)offset, (unsigned long)nca_size);
-                ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+                ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
                 continue;
             }
 
-            rc = ncmContentStorageRegister(&ctx->content_storage, &cnmt_content_id, &placeholder_id);
+            rc = ncmContentStorageRegister(ctx->content_storage, &cnmt_content_id, &placeholder_id);
             if (R_FAILED(rc)) {
                 LOG_ERROR("NCA Install: Failed to register CNMT NCA: 0x%08X", rc);
-                ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+                ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
                 continue;
             }
-            ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+            ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
 
             LOG_INFO("NCA Install: CNMT NCA registered successfully (%lu bytes)", (unsigned long)nca_size);
 
             // Verify it's actually registered
             bool has_content = false;
-            ncmContentStorageHas(&ctx->content_storage, &has_content, &cnmt_content_id);
+            ncmContentStorageHas(ctx->content_storage, &has_content, &cnmt_content_id);
             LOG_INFO("NCA Install: CNMT NCA present in storage: %s", has_content ? "yes" : "no");
 
             rc = readCnmtFromNca(ctx, &cnmt_content_id, &cnmt_ctx);
@@ -491,29 +502,36 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
 
         // Remove existing content if already registered
         bool already_exists = false;
-        ncmContentStorageHas(&ctx->content_storage, &already_exists, content_id);
+        ncmContentStorageHas(ctx->content_storage, &already_exists, content_id);
         if (already_exists) {
-            ncmContentStorageDelete(&ctx->content_storage, content_id);
+            ncmContentStorageDelete(ctx->content_storage, content_id);
             LOG_INFO("NCA Install: Removed existing NCA before reinstall");
         }
 
         NcmPlaceHolderId placeholder_id;
-        ncmContentStorageGeneratePlaceHolderId(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageGeneratePlaceHolderId(ctx->content_storage, &placeholder_id);
 
         u64 nca_size = nspGetFileSize(&nsp, nca_idx);
-        Result prc = ncmContentStorageCreatePlaceHolder(&ctx->content_storage, content_id,
+        Result prc = ncmContentStorageCreatePlaceHolder(ctx->content_storage, content_id,
                                           &placeholder_id, nca_size);
         if (R_FAILED(prc)) {
             LOG_ERROR("NCA Install: Failed to create placeholder: 0x%08X", prc);
             continue;
         }
 
-        u8* buffer = (u8*)malloc(1024 * 1024);
+        u8* buffer = transferBuffer(ctx);
+        if (!buffer) {
+            ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
+            cnmtFree(&cnmt_ctx);
+            nspClose(&nsp);
+            return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        }
+
         u64 offset = 0;
         bool write_ok = true;
         while (offset < nca_size) {
-            u64 to_read = (nca_size - offset > 1024 * 1024) ?
-                         1024 * 1024 : (nca_size - offset);
+            u64 to_read = (nca_size - offset > NCA_TRANSFER_SIZE) ?
+                         NCA_TRANSFER_SIZE : (nca_size - offset);
 
             s64 read = nspReadFile(&nsp, nca_idx, offset, buffer, to_read);
             if (read <= 0) {
@@ -522,7 +540,7 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
                 break;
             }
 
-            Result wrc = ncmContentStorageWritePlaceHolder(&ctx->content_storage, &placeholder_id,
+            Result wrc = ncmContentStorageWritePlaceHolder(ctx->content_storage, &placeholder_id,
                                               offset, buffer, read);
             if (R_FAILED(wrc)) {
                 LOG_ERROR("NCA Install: Write failed: 0x%08X at offset 0x%lX", wrc, offset);
@@ -536,19 +554,18 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
                 ctx->progress_cb(total_bytes_written, total_install_size, ctx->progress_user_data);
             }
         }
-        free(buffer);
 
         if (!write_ok || offset != nca_size) {
             LOG_ERROR("NCA Install: NCA incomplete: %lu of %lu bytes", (unsigned long)offset, (unsigned long)nca_size);
-            ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+            ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
             continue;
         }
 
-        prc = ncmContentStorageRegister(&ctx->content_storage, content_id, &placeholder_id);
+        prc = ncmContentStorageRegister(ctx->content_storage, content_id, &placeholder_id);
         if (R_FAILED(prc)) {
             LOG_ERROR("NCA Install: Failed to register NCA: 0x%08X", prc);
         }
-        ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
     }
 
     LOG_INFO("NCA Install: Step 4/4 - Registering with system");
@@ -570,7 +587,7 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
 
     u8* install_meta_buffer;
     size_t install_meta_size;
-    Result rc = cnmtBuildInstallContentMeta(&cnmt_ctx, &cnmt_info, false,
+    Result rc = cnmtBuildInstallContentMeta(&cnmt_ctx, &cnmt_info, false, &ctx->arena,
                                            &install_meta_buffer, &install_meta_size);
     if (R_FAILED(rc)) {
         cnmtFree(&cnmt_ctx);
@@ -579,22 +596,19 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
     }
 
     NcmContentMetaKey meta_key = cnmtGetContentMetaKey(&cnmt_ctx);
-    rc = ncmContentMetaDatabaseSet(&ctx->meta_db, &meta_key,
+    rc = ncmContentMetaDatabaseSet(ctx->meta_db, &meta_key,
                                    (NcmContentMetaHeader*)install_meta_buffer,
                                    install_meta_size);
     if (R_SUCCEEDED(rc)) {
-        ncmContentMetaDatabaseCommit(&ctx->meta_db);
+        ncmContentMetaDatabaseCommit(ctx->meta_db);
         LOG_DEBUG("NCA Install: Content metadata registered");
     } else {
         LOG_ERROR("NCA Install: Failed to register content metadata: 0x%08X", rc);
-        free(install_meta_buffer);
         cnmtFree(&cnmt_ctx);
         nspClose(&nsp);
         return rc;
     }
 
-    free(install_meta_buffer);
-
     u64 title_id = cnmt_ctx.header.title_id;
 
     u64 base_title_id;
@@ -626,7 +640,7 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
     storage_record.meta_record = meta_key;
     storage_record.storage_id = ctx->storage_id;
 
-    nsInitialize();
+    bool ns_held = R_SUCCEEDED(servicesAcquire(SERVICE_NS));
 
     Service ns_app_man_srv;
     bool got_ns_service = false;
@@ -672,7 +686,7 @@ Result ncaInstallNsp(NcaInstallContext* ctx, const char* nsp_path, u64* out_titl
         LOG_INFO("NCA Install: Content is installed, reboot may be required");
     }
 
-    nsExit();
+    if (ns_held) servicesRelease(SERVICE_NS);
 
     if (out_title_id) {
         *out_title_id = title_id;
@@ -692,24 +706,24 @@ static Result installNcaFromXci(NcaInstallContext* ctx, XciContext* xci, u32 fil
     u64 nca_size = xciGetFileSize(xci, file_idx);
 
     NcmPlaceHolderId placeholder_id;
-    Result rc = ncmContentStorageGeneratePlaceHolderId(&ctx->content_storage, &placeholder_id);
+    Result rc = ncmContentStorageGeneratePlaceHolderId(ctx->content_storage, &placeholder_id);
     if (R_FAILED(rc)) return rc;
 
-    ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
-    rc = ncmContentStorageCreatePlaceHolder(&ctx->content_storage, content_id,
+    ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
+    rc = ncmContentStorageCreatePlaceHolder(ctx->content_storage, content_id,
                                             &placeholder_id, nca_size);
     if (R_FAILED(rc)) return rc;
 
-    u8* buffer = (u8*)malloc(1024 * 1024);
+    u8* buffer = transferBuffer(ctx);
     if (!buffer) {
-        ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
     }
 
     u64 offset = 0;
     bool success = true;
     while (offset < nca_size) {
-        u64 to_read = (nca_size - offset > 1024 * 1024) ? 1024 * 1024 : (nca_size - offset);
+        u64 to_read = (nca_size - offset > NCA_TRANSFER_SIZE) ? NCA_TRANSFER_SIZE : (nca_size - offset);
 
         s64 read = xciReadFile(xci, file_idx, offset, buffer, to_read);
         if (read <= 0) {
@@ -717,7 +731,7 @@ static Result installNcaFromXci(NcaInstallContext* ctx, XciContext* xci, u32 fil
             break;
         }
 
-        rc = ncmContentStorageWritePlaceHolder(&ctx->content_storage, &placeholder_id,
+        rc = ncmContentStorageWritePlaceHolder(ctx->content_storage, &placeholder_id,
                                                offset, buffer, read);
         if (R_FAILED(rc)) {
             success = false;
@@ -725,15 +739,14 @@ static Result installNcaFromXci(NcaInstallContext* ctx, XciContext* xci, u32 fil
         }
         offset += read;
     }
-    free(buffer);
 
     if (!success) {
-        ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
         return MAKERESULT(Module_Libnx, LibnxError_IoError);
     }
 
-    rc = ncmContentStorageRegister(&ctx->content_storage, content_id, &placeholder_id);
-    ncmContentStorageDeletePlaceHolder(&ctx->content_storage, &placeholder_id);
+    rc = ncmContentStorageRegister(ctx->content_storage, content_id, &placeholder_id);
+    ncmContentStorageDeletePlaceHolder(ctx->content_storage, &placeholder_id);
     return rc;
 }
 
@@ -743,6 +756,7 @@ Result ncaInstallXci(NcaInstallContext* ctx, const char* xci_path, u64* out_titl
     }
 
     LOG_INFO("NCA Install: Installing XCI: %s", xci_path);
+    beginInstall(ctx);
 
     XciContext xci;
     if (!xciOpen(&xci, xci_path)) {
@@ -839,7 +853,7 @@ Result ncaInstallXci(NcaInstallContext* ctx, const char* xci_path, u64* out_titl
 
     u8* install_meta_buffer;
     size_t install_meta_size;
-    rc = cnmtBuildInstallContentMeta(&cnmt_ctx, &cnmt_info, false,
+    rc = cnmtBuildInstallContentMeta(&cnmt_ctx, &cnmt_info, false, &ctx->arena,
                                      &install_meta_buffer, &install_meta_size);
     if (R_FAILED(rc)) {
         LOG_ERROR("NCA Install: Failed to build install content meta: 0x%08X", rc);
@@ -849,22 +863,19 @@ Result ncaInstallXci(NcaInstallContext* ctx, const char* xci_path, u64* out_titl
     }
 
     NcmContentMetaKey meta_key = cnmtGetContentMetaKey(&cnmt_ctx);
-    rc = ncmContentMetaDatabaseSet(&ctx->meta_db, &meta_key,
+    rc = ncmContentMetaDatabaseSet(ctx->meta_db, &meta_key,
                                    (NcmContentMetaHeader*)install_meta_buffer,
                                    install_meta_size);
     if (R_SUCCEEDED(rc)) {
-        ncmContentMetaDatabaseCommit(&ctx->meta_db);
+        ncmContentMetaDatabaseCommit(ctx->meta_db);
         LOG_DEBUG("NCA Install: Content metadata registered");
     } else {
         LOG_ERROR("NCA Install: Failed to register content metadata: 0x%08X", rc);
-        free(install_meta_buffer);
         cnmtFree(&cnmt_ctx);
         xciClose(&xci);
         return rc;
     }
 
-    free(install_meta_buffer);
-
     u64 title_id = cnmt_ctx.header.title_id;
 
     u64 base_title_id;
@@ -894,7 +905,7 @@ Result ncaInstallXci(NcaInstallContext* ctx, const char* xci_path, u64* out_titl
     storage_record.meta_record = meta_key;
     storage_record.storage_id = ctx->storage_id;
 
-    nsInitialize();
+    bool ns_held = R_SUCCEEDED(servicesAcquire(SERVICE_NS));
 
     Service ns_app_man_srv;
     bool got_ns_service = false;
@@ -940,7 +951,7 @@ Result ncaInstallXci(NcaInstallContext* ctx, const char* xci_path, u64* out_titl
         LOG_INFO("NCA Install: Content is installed, reboot may be required");
     }
 
-    nsExit();
+    if (ns_held) servicesRelease(SERVICE_NS);
 
     if (out_title_id) {
         *out_title_id = title_id;
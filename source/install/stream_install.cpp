@@ -6,6 +6,8 @@
 #include "install/cnmt.h"
 #include "install/ticket_utils.h"
 #include "mtp_log.h"
+#include "core/Trace.h"
+#include "service/services.h"
 #include <switch.h>
 #include <string.h>
 #include <strings.h>
@@ -40,32 +42,34 @@ Result streamInstallInit(StreamInstallContext* ctx, InstallTarget target) {
     ctx->state = STREAM_STATE_IDLE;
     ctx->cnmt_scanned = false;
 
-    ctx->buffer = (u8*)malloc(STREAM_BUFFER_SIZE);
-    if (!ctx->buffer) {
+    ctx->buffer_block = bufferPoolAcquire(STREAM_BUFFER_SIZE, BUFFER_TAG_INSTALL);
+    if (!ctx->buffer_block) {
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
     }
+    ctx->buffer = ctx->buffer_block->data;
     ctx->buffer_size = STREAM_BUFFER_SIZE;
 
     // Pre-allocate write buffer for NCA installation to avoid per-call malloc/free
-    ctx->write_buffer_size = 1024 * 1024;
-    ctx->write_buffer = (u8*)malloc(ctx->write_buffer_size);
-    if (!ctx->write_buffer) {
-        free(ctx->buffer);
+    ctx->write_block = bufferPoolAcquire(1024 * 1024, BUFFER_TAG_INSTALL);
+    if (!ctx->write_block) {
+        bufferRelease(ctx->buffer_block);
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
     }
+    ctx->write_buffer = ctx->write_block->data;
+    ctx->write_buffer_size = 1024 * 1024;
 
     ctx->nca_ctx = (NcaInstallContext*)malloc(sizeof(NcaInstallContext));
     if (!ctx->nca_ctx) {
-        free(ctx->write_buffer);
-        free(ctx->buffer);
+        bufferRelease(ctx->write_block);
+        bufferRelease(ctx->buffer_block);
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
     }
 
     Result rc = ncaInstallInit(ctx->nca_ctx, target);
     if (R_FAILED(rc)) {
         free(ctx->nca_ctx);
-        free(ctx->write_buffer);
-        free(ctx->buffer);
+        bufferRelease(ctx->write_block);
+        bufferRelease(ctx->buffer_block);
         return rc;
     }
 
@@ -85,41 +89,20 @@ void streamInstallExit(StreamInstallContext* ctx) {
         ctx->nca_ctx = NULL;
     }
 
-    if (ctx->buffer) {
-        free(ctx->buffer);
-        ctx->buffer = NULL;
-    }
+    bufferRelease(ctx->buffer_block);
+    ctx->buffer_block = NULL;
+    ctx->buffer = NULL;
 
-    if (ctx->write_buffer) {
-        free(ctx->write_buffer);
-        ctx->write_buffer = NULL;
-    }
-
-    if (ctx->pfs0.file_entries) {
-        free(ctx->pfs0.file_entries);
-        ctx->pfs0.file_entries = NULL;
-    }
-
-    if (ctx->pfs0.string_table) {
-        free(ctx->pfs0.string_table);
-        ctx->pfs0.string_table = NULL;
-    }
+    bufferRelease(ctx->write_block);
+    ctx->write_block = NULL;
+    ctx->write_buffer = NULL;
 
+    // PFS0 tables, ticket and cert went with the install arena in ncaInstallExit
     if (ctx->cnmt_found) {
         cnmtFree(&ctx->cnmt_ctx);
         ctx->cnmt_found = false;
     }
 
-    if (ctx->ticket_data) {
-        free(ctx->ticket_data);
-        ctx->ticket_data = NULL;
-    }
-
-    if (ctx->cert_data) {
-        free(ctx->cert_data);
-        ctx->cert_data = NULL;
-    }
-
     memset(ctx, 0, sizeof(StreamInstallContext));
 }
 
@@ -138,32 +121,18 @@ void streamInstallReset(StreamInstallContext* ctx) {
     ctx->file_type = STREAM_TYPE_UNKNOWN;
     ctx->stream_file_offset = 0;
 
-    // Free and reset PFS0 header caches
-    if (ctx->pfs0.file_entries) {
-        free(ctx->pfs0.file_entries);
-        ctx->pfs0.file_entries = NULL;
-    }
-    if (ctx->pfs0.string_table) {
-        free(ctx->pfs0.string_table);
-        ctx->pfs0.string_table = NULL;
-    }
+    // PFS0 header, ticket and cert caches all live in the install arena
+    if (ctx->nca_ctx) arenaReset(&ctx->nca_ctx->arena);
+    ctx->pfs0.file_entries = NULL;
+    ctx->pfs0.string_table = NULL;
     ctx->pfs0.header_cached = false;
     ctx->pfs0.header_parsed = false;
 
-    // Free and reset ticket/cert caches
-    if (ctx->ticket_data) {
-        free(ctx->ticket_data);
-        ctx->ticket_data = NULL;
-    }
-    if (ctx->cert_data) {
-        free(ctx->cert_data);
-        ctx->cert_data = NULL;
-    }
+    ctx->ticket_data = NULL;
+    ctx->cert_data = NULL;
     ctx->ticket_size = 0;
     ctx->cert_size = 0;
     ctx->ticket_imported = false;
-
-    (void)ctx->nca_ctx;
 }
 
 Result streamInstallStart(StreamInstallContext* ctx, const char* filename, u64 file_size) {
@@ -271,30 +240,27 @@ static bool parsePfs0Header(StreamInstallContext* ctx) {
     ctx->pfs0.file_entries_size = file_entries_size;
 
     // Allocate and read file entries
-    ctx->pfs0.file_entries = (u8*)malloc(file_entries_size);
+    Arena* arena = &ctx->nca_ctx->arena;
+    ctx->pfs0.file_entries = (u8*)arenaAlloc(arena, file_entries_size);
     if (!ctx->pfs0.file_entries) {
         LOG_ERROR("Stream Install: Failed to allocate file entries cache");
         return false;
     }
     if (streamRead(ctx, ctx->pfs0.file_entries, file_entries_size) != file_entries_size) {
-        free(ctx->pfs0.file_entries);
         ctx->pfs0.file_entries = NULL;
         return false;
     }
 
     // Allocate and read string table
     ctx->pfs0.string_table_alloc = header.string_table_size;
-    ctx->pfs0.string_table = (char*)malloc(header.string_table_size);
+    ctx->pfs0.string_table = (char*)arenaAlloc(arena, header.string_table_size);
     if (!ctx->pfs0.string_table) {
         LOG_ERROR("Stream Install: Failed to allocate string table cache");
-        free(ctx->pfs0.file_entries);
         ctx->pfs0.file_entries = NULL;
         return false;
     }
     if (streamRead(ctx, ctx->pfs0.string_table, header.string_table_size) != header.string_table_size) {
-        free(ctx->pfs0.string_table);
         ctx->pfs0.string_table = NULL;
-        free(ctx->pfs0.file_entries);
         ctx->pfs0.file_entries = NULL;
         return false;
     }
@@ -352,9 +318,12 @@ static Result installCurrentNca(StreamInstallContext* ctx) {
         // Track our position in the file stream
         ctx->stream_file_offset += read;
 
-        rc = ncmContentStorageWritePlaceHolder(&ctx->nca_ctx->content_storage,
-                                               &ctx->placeholder_id,
-                                               ctx->nca_offset, buffer, read);
+        {
+            TRACE_SCOPE_ARG("ncm write", read);
+            rc = ncmContentStorageWritePlaceHolder(ctx->nca_ctx->content_storage,
+                                                   &ctx->placeholder_id,
+                                                   ctx->nca_offset, buffer, read);
+        }
         if (R_FAILED(rc)) {
             LOG_ERROR("Stream Install: Write failed at offset 0x%lX: 0x%08X", ctx->nca_offset, rc);
             break;
@@ -372,9 +341,9 @@ static Result installCurrentNca(StreamInstallContext* ctx) {
     }
 
     if (ctx->nca_offset >= ctx->nca_size) {
-        rc = ncmContentStorageRegister(&ctx->nca_ctx->content_storage,
+        rc = ncmContentStorageRegister(ctx->nca_ctx->content_storage,
                                        &ctx->nca_id, &ctx->placeholder_id);
-        ncmContentStorageDeletePlaceHolder(&ctx->nca_ctx->content_storage, &ctx->placeholder_id);
+        ncmContentStorageDeletePlaceHolder(ctx->nca_ctx->content_storage, &ctx->placeholder_id);
 
         if (R_FAILED(rc)) {
             // 0x00000805 = content already exists, treat as success
@@ -500,7 +469,7 @@ static Result startNextFile(StreamInstallContext* ctx) {
                     filename, entry.size, streamAvailable(ctx), ctx->ticket_data);
 
             if (streamAvailable(ctx) >= entry.size && !ctx->ticket_data) {
-                ctx->ticket_data = (u8*)malloc(entry.size);
+                ctx->ticket_data = (u8*)arenaAlloc(&ctx->nca_ctx->arena, entry.size);
                 if (ctx->ticket_data) {
                     u64 read = streamRead(ctx, ctx->ticket_data, entry.size);
                     if (read == entry.size) {
@@ -525,7 +494,6 @@ static Result startNextFile(StreamInstallContext* ctx) {
                         }
                     } else {
                         LOG_ERROR("Stream Install: Failed to read ticket - expected %lu, got %lu", entry.size, read);
-                        free(ctx->ticket_data);
                         ctx->ticket_data = NULL;
                     }
                 } else {
@@ -548,7 +516,7 @@ static Result startNextFile(StreamInstallContext* ctx) {
                     filename, entry.size, streamAvailable(ctx), ctx->cert_data);
 
             if (streamAvailable(ctx) >= entry.size && !ctx->cert_data) {
-                ctx->cert_data = (u8*)malloc(entry.size);
+                ctx->cert_data = (u8*)arenaAlloc(&ctx->nca_ctx->arena, entry.size);
                 if (ctx->cert_data) {
                     u64 read = streamRead(ctx, ctx->cert_data, entry.size);
                     if (read == entry.size) {
@@ -557,7 +525,6 @@ static Result startNextFile(StreamInstallContext* ctx) {
                         LOG_INFO("Stream Install: ✓ Cached cert: %s (%u bytes)", filename, ctx->cert_size);
                     } else {
                         LOG_ERROR("Stream Install: Failed to read cert - expected %lu, got %lu", entry.size, read);
-                        free(ctx->cert_data);
                         ctx->cert_data = NULL;
                     }
                 } else {
@@ -589,13 +556,13 @@ static Result startNextFile(StreamInstallContext* ctx) {
             ctx->nca_offset = 0;
 
             // Delete any existing content with the same ID (from previous failed installs)
-            ncmContentStorageDelete(&ctx->nca_ctx->content_storage, &nca_id);
+            ncmContentStorageDelete(ctx->nca_ctx->content_storage, &nca_id);
 
             // Create placeholder
-            ncmContentStorageGeneratePlaceHolderId(&ctx->nca_ctx->content_storage, &ctx->placeholder_id);
-            ncmContentStorageDeletePlaceHolder(&ctx->nca_ctx->content_storage, &ctx->placeholder_id);
+            ncmContentStorageGeneratePlaceHolderId(ctx->nca_ctx->content_storage, &ctx->placeholder_id);
+            ncmContentStorageDeletePlaceHolder(ctx->nca_ctx->content_storage, &ctx->placeholder_id);
 
-            Result rc = ncmContentStorageCreatePlaceHolder(&ctx->nca_ctx->content_storage,
+            Result rc = ncmContentStorageCreatePlaceHolder(ctx->nca_ctx->content_storage,
                                                            &nca_id,
                                                            &ctx->placeholder_id,
                                                            entry.size);
@@ -652,8 +619,7 @@ static Result importCachedTicket(StreamInstallContext* ctx) {
 
     LOG_INFO("Stream Install: Attempting to import ticket (%u bytes)...", ctx->ticket_size);
 
-    // Initialize ES service if needed
-    Result rc = esInitialize();
+    Result rc = servicesAcquire(SERVICE_ES);
     if (R_FAILED(rc)) {
         LOG_ERROR("Stream Install: Failed to initialize ES service: 0x%08X", rc);
         return rc;
@@ -668,7 +634,7 @@ static Result importCachedTicket(StreamInstallContext* ctx) {
         rc = esImportTicket(ctx->ticket_data, ctx->ticket_size, NULL, 0);
     }
 
-    esExit();
+    servicesRelease(SERVICE_ES);
 
     if (R_FAILED(rc)) {
         // Error 0x1A05 means ticket already exists, which is fine
@@ -692,7 +658,7 @@ static Result readCnmtFromInstalledNca(StreamInstallContext* ctx) {
     // not encrypted, so we can read them without the ticket.
 
     char cnmt_path[FS_MAX_PATH];
-    Result rc = ncmContentStorageGetPath(&ctx->nca_ctx->content_storage, cnmt_path,
+    Result rc = ncmContentStorageGetPath(ctx->nca_ctx->content_storage, cnmt_path,
                                          sizeof(cnmt_path), &ctx->cnmt_id);
     if (R_FAILED(rc)) {
         LOG_ERROR("Stream Install: Failed to get CNMT path: 0x%08X", rc);
@@ -742,7 +708,7 @@ static Result readCnmtFromInstalledNca(StreamInstallContext* ctx) {
     s64 cnmt_size;
     fsFileGetSize(&cnmt_file, &cnmt_size);
 
-    u8* cnmt_data = (u8*)malloc(cnmt_size);
+    u8* cnmt_data = (u8*)arenaAlloc(&ctx->nca_ctx->arena, cnmt_size);
     if (!cnmt_data) {
         fsFileClose(&cnmt_file);
         fsFsClose(&cnmt_fs);
@@ -755,16 +721,13 @@ static Result readCnmtFromInstalledNca(StreamInstallContext* ctx) {
     fsFsClose(&cnmt_fs);
 
     if (R_FAILED(rc) || bytes_read != (u64)cnmt_size) {
-        free(cnmt_data);
         return rc;
     }
 
     if (!cnmtParse(&ctx->cnmt_ctx, cnmt_data, cnmt_size)) {
-        free(cnmt_data);
         return MAKERESULT(Module_Libnx, LibnxError_IoError);
     }
 
-    free(cnmt_data);
     ctx->cnmt_found = true;
 
     LOG_INFO("Stream Install: CNMT parsed - Title ID: 0x%016lX, %u contents",
@@ -774,6 +737,7 @@ static Result readCnmtFromInstalledNca(StreamInstallContext* ctx) {
 }
 
 s64 streamInstallProcessData(StreamInstallContext* ctx, const void* data, u64 size) {
+    TRACE_SCOPE_ARG("streamInstallProcessData", size);
     if (!ctx || !data || size == 0) return -1;
     if (ctx->state == STREAM_STATE_ERROR) return -1;
 
@@ -944,7 +908,7 @@ Result streamInstallFinalize(StreamInstallContext* ctx) {
 
     u8* install_meta_buffer;
     size_t install_meta_size;
-    rc = cnmtBuildInstallContentMeta(&ctx->cnmt_ctx, &cnmt_info, false,
+    rc = cnmtBuildInstallContentMeta(&ctx->cnmt_ctx, &cnmt_info, false, &ctx->nca_ctx->arena,
                                      &install_meta_buffer, &install_meta_size);
     if (R_FAILED(rc)) {
         LOG_ERROR("Stream Install: Failed to build meta: 0x%08X", rc);
@@ -952,14 +916,13 @@ Result streamInstallFinalize(StreamInstallContext* ctx) {
     }
 
     NcmContentMetaKey meta_key = cnmtGetContentMetaKey(&ctx->cnmt_ctx);
-    rc = ncmContentMetaDatabaseSet(&ctx->nca_ctx->meta_db, &meta_key,
+    rc = ncmContentMetaDatabaseSet(ctx->nca_ctx->meta_db, &meta_key,
                                    (NcmContentMetaHeader*)install_meta_buffer,
                                    install_meta_size);
     if (R_SUCCEEDED(rc)) {
-        ncmContentMetaDatabaseCommit(&ctx->nca_ctx->meta_db);
+        ncmContentMetaDatabaseCommit(ctx->nca_ctx->meta_db);
         LOG_DEBUG("Stream Install: Content metadata registered");
     }
-    free(install_meta_buffer);
 
     if (R_FAILED(rc)) {
         return rc;
@@ -993,8 +956,11 @@ Result streamInstallFinalize(StreamInstallContext* ctx) {
 
     Service ns_app_man_srv;
     bool got_ns_service = false;
+    bool ns_held = R_SUCCEEDED(servicesAcquire(SERVICE_NS));
 
-    if (hosversionBefore(3, 0, 0)) {
+    if (!ns_held) {
+        LOG_WARN("Stream Install: NS unavailable, record not pushed");
+    } else if (hosversionBefore(3, 0, 0)) {
         Service* srv = nsGetServiceSession_ApplicationManagerInterface();
         if (srv) {
             memcpy(&ns_app_man_srv, srv, sizeof(Service));
@@ -1030,6 +996,7 @@ Result streamInstallFinalize(StreamInstallContext* ctx) {
             LOG_WARN("Stream Install: Failed to push record: 0x%08X", rc);
         }
     }
+    if (ns_held) servicesRelease(SERVICE_NS);
 
     ctx->state = STREAM_STATE_COMPLETE;
     LOG_INFO("Stream Install: ✓✓✓ COMPLETE! TitleID=0x%016lX, file=%s", title_id, ctx->filename);
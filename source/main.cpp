@@ -11,6 +11,7 @@
 #include "mtp/usb_mtp.h"
 #include "mtp/mtp_protocol.h"
 #include "mtp/mtp_log.h"
+#include "mtp/mtp_stats.h"
 #include "dump/game_dump.h"
 #include "dump/gamecard_dump.h"
 #include "core/GuiManager.h"
@@ -18,13 +19,22 @@
 #include "tickets/ticket_browser.h"
 #include "i18n/Localization.h"
 #include "core/Settings.h"
+#include "core/ThreadRoles.h"
+#include "core/TaskPool.h"
+#include "core/BufferPool.h"
+#include "core/Arena.h"
+#include "service/title_cache.h"
+#include "service/services.h"
 #include "core/Debug.h"
+#include "core/Trace.h"
+#include "core/FrameScheduler.h"
 #include <cmath>
 #include <dirent.h>
 #include <cstdio>
 #include <cstring>
 #include <strings.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <sys/statvfs.h>
 
 using namespace Javelin;
@@ -144,7 +154,7 @@ static void scanBackupsFolder() {
 }
 
 struct InstallProgressCtx {
-    std::string filepath;
+    TransferId transfer_id;
     u64 last_update_tick;
 };
 
@@ -158,22 +168,25 @@ static void installProgressCb(u64 bytes_written, u64 total_bytes, void* user_dat
     }
     pctx->last_update_tick = now;
 
-    float percent = (total_bytes > 0) ? ((float)bytes_written / (float)total_bytes) * 100.0f : 0.0f;
-    float speed = 0.0f;
     // Speed not easily computed here, leave at 0
-    TransferProgressEvent evt(pctx->filepath, bytes_written, total_bytes, percent, speed);
-    EventBus::getInstance().post(evt);
+    TransferTable& transfers = TransferTable::getInstance();
+    transfers.setTotal(pctx->transfer_id, total_bytes);
+    transfers.update(pctx->transfer_id, bytes_written, 0.0f);
 }
 
 static void installThreadFunc(void* arg) {
     (void)arg;
+    TRACE_THREAD_NAME("install");
     InstallTaskInfo task = g_install_task;
 
+    TransferTable& transfers = TransferTable::getInstance();
+    TransferId transfer_id = transfers.begin(task.filepath, 0);
     {
         TransferStartEvent evt;
+        evt.transferId = transfer_id;
         evt.filePath = task.filepath;
         evt.totalBytes = 0;
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
     }
 
     NcaInstallContext nca_ctx;
@@ -183,17 +196,19 @@ static void installThreadFunc(void* arg) {
         snprintf(err_msg, sizeof(err_msg), "Failed to initialize install context: 0x%08X", rc);
         LOG_ERROR("NCA Install: %s", err_msg);
         showError(err_msg);
+        transfers.finish(transfer_id);
         TransferCompleteEvent evt;
+        evt.transferId = transfer_id;
         evt.filePath = task.filepath;
         evt.success = false;
         evt.errorMessage = err_msg;
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
         g_install_thread_running = false;
         return;
     }
 
     InstallProgressCtx progress_ctx;
-    progress_ctx.filepath = task.filepath;
+    progress_ctx.transfer_id = transfer_id;
     progress_ctx.last_update_tick = 0;
     nca_ctx.progress_cb = installProgressCb;
     nca_ctx.progress_user_data = &progress_ctx;
@@ -206,9 +221,11 @@ static void installThreadFunc(void* arg) {
     }
 
     ncaInstallExit(&nca_ctx);
+    transfers.finish(transfer_id);
 
     {
         TransferCompleteEvent evt;
+        evt.transferId = transfer_id;
         evt.filePath = task.filepath;
         evt.success = R_SUCCEEDED(rc);
         if (R_FAILED(rc)) {
@@ -217,7 +234,7 @@ static void installThreadFunc(void* arg) {
             evt.errorMessage = err_msg;
             LOG_ERROR("NCA Install: %s (path=%s)", err_msg, task.filepath);
         }
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
     }
 
     if (R_SUCCEEDED(rc)) {
@@ -244,7 +261,7 @@ static void startInstallThread(InstallTaskInfo task) {
     g_install_thread_running = true;
     g_install_thread_needs_join = true;
 
-    Result rc = threadCreate(&g_install_thread, installThreadFunc, NULL, NULL, 0x20000, 0x2C, -2);
+    Result rc = threadCreateForRole(&g_install_thread, installThreadFunc, NULL, 0x20000, THREAD_ROLE_IO);
     if (R_SUCCEEDED(rc)) {
         threadStart(&g_install_thread);
     } else {
@@ -495,6 +512,127 @@ void renderMainMenu(bool& mtp_running) {
     ImGui::TextColored(ImVec4(0.35f, 0.38f, 0.45f, 1.0f), "v1.0.0");
 }
 
+// Latency in us, switching to ms once it stops fitting a narrow column
+static void statsLatencyCell(u64 us) {
+    ImGui::TableNextColumn();
+    if (us < 10000) ImGui::Text("%lu us", (unsigned long)us);
+    else ImGui::Text("%.1f ms", (double)us / 1000.0);
+}
+
+static void renderMTPStats() {
+    if (!ImGui::CollapsingHeader(TR("mtp.stats"))) return;
+
+    // Large (histograms), so not on the stack
+    static MtpStatsSnapshot s;
+    mtpStatsSnapshot(&s);
+
+    if (ImGui::BeginTable("MtpOps", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn(TR("mtp.stats_op"), ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn(TR("mtp.stats_count"), ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn(TR("mtp.stats_bytes"), ImGuiTableColumnFlags_WidthFixed, 110.0f);
+        ImGui::TableSetupColumn("p50", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableSetupColumn("p90", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableSetupColumn("p99", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableSetupColumn("max", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < MTP_STATS_OP_COUNT; i++) {
+            const MtpOpStats* op = &s.ops[i];
+            if (op->count == 0) continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(mtpStatsOpName(i));
+            ImGui::TableNextColumn();
+            ImGui::Text("%lu", (unsigned long)op->count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f MB", (double)op->bytes / (1024.0 * 1024.0));
+            statsLatencyCell(mtpStatsPercentileUs(op, 50.0));
+            statsLatencyCell(mtpStatsPercentileUs(op, 90.0));
+            statsLatencyCell(mtpStatsPercentileUs(op, 99.0));
+            statsLatencyCell(op->maxUs);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Text("%s", TR("mtp.stats_storage"));
+    for (int i = 0; i < MTP_BACKEND_COUNT; i++) {
+        const MtpBackendStats* b = &s.backends[i];
+        if (b->reads == 0 && b->writes == 0) continue;
+        double readMBps = b->readNs ? ((double)b->readBytes / (1024.0 * 1024.0)) / ((double)b->readNs / 1e9) : 0.0;
+        double writeMBps = b->writeNs ? ((double)b->writeBytes / (1024.0 * 1024.0)) / ((double)b->writeNs / 1e9) : 0.0;
+        ImGui::Text("  %-9s R %.1f MB/s (%.1f MB)  W %.1f MB/s (%.1f MB)",
+            mtpStatsBackendName((MtpBackend)i),
+            readMBps, (double)b->readBytes / (1024.0 * 1024.0),
+            writeMBps, (double)b->writeBytes / (1024.0 * 1024.0));
+    }
+
+    const MtpUsbStats* u = &s.usb;
+    ImGui::Text("%s", TR("mtp.stats_usb"));
+    ImGui::Text("  In %.1f MB / %lu URBs (%lu short)  Out %.1f MB / %lu URBs (%lu short)",
+        (double)u->bytesIn / (1024.0 * 1024.0), (unsigned long)u->transfersIn, (unsigned long)u->shortIn,
+        (double)u->bytesOut / (1024.0 * 1024.0), (unsigned long)u->transfersOut, (unsigned long)u->shortOut);
+    ImVec4 usbColor = (u->retryFailures || u->timeouts) ? ImVec4(1.0f, 0.8f, 0.0f, 1.0f) : ImVec4(1, 1, 1, 1);
+    ImGui::TextColored(usbColor, "  Retries %lu (%lu exhausted)  Timeouts %lu",
+        (unsigned long)u->retries, (unsigned long)u->retryFailures, (unsigned long)u->timeouts);
+
+    ImGui::Text("%s", TR("mtp.stats_queues"));
+    for (int i = 0; i < MTP_GAUGE_COUNT; i++) {
+        ImGui::Text("  %-15s %lu (max %lu)", mtpStatsGaugeName((MtpGauge)i),
+            (unsigned long)s.gauges[i].current, (unsigned long)s.gauges[i].max);
+    }
+
+    BufferPoolStats pool;
+    bufferPoolGetStats(&pool);
+    ImGui::Text("%s", TR("mtp.stats_buffers"));
+    ImGui::Text("  In use %.1f MB (peak %.1f)  Cached %.1f MB  Held peak %.1f / %.0f MB",
+        (double)pool.inUse / (1024.0 * 1024.0), (double)pool.peakInUse / (1024.0 * 1024.0),
+        (double)pool.cached / (1024.0 * 1024.0), (double)pool.peakHeld / (1024.0 * 1024.0),
+        (double)pool.budget / (1024.0 * 1024.0));
+    for (int i = 0; i < BUFFER_TAG_COUNT; i++) {
+        if (pool.tagInUse[i]) ImGui::Text("  %-15s %.1f MB", bufferTagName((BufferTag)i), (double)pool.tagInUse[i] / (1024.0 * 1024.0));
+    }
+    ImVec4 poolColor = pool.failures ? ImVec4(1.0f, 0.8f, 0.0f, 1.0f) : ImVec4(1, 1, 1, 1);
+    ImGui::TextColored(poolColor, "  Acquires %lu (%lu from heap, %lu refused)",
+        (unsigned long)pool.acquires, (unsigned long)pool.heapAllocs, (unsigned long)pool.failures);
+
+    ImGui::Text("%s", TR("mtp.stats_arenas"));
+    for (int i = 0; i < ARENA_KIND_COUNT; i++) {
+        ArenaStats arena;
+        arenaGetStats((ArenaKind)i, &arena);
+        ImVec4 arenaColor = arena.failures ? ImVec4(1.0f, 0.8f, 0.0f, 1.0f) : ImVec4(1, 1, 1, 1);
+        ImGui::TextColored(arenaColor, "  %-8s %lu KB live  last %lu KB  max %lu KB  (%lu ops, %lu refused)",
+            arenaKindName((ArenaKind)i), (unsigned long)(arena.live / 1024),
+            (unsigned long)(arena.lastPeak / 1024), (unsigned long)(arena.maxPeak / 1024),
+            (unsigned long)arena.operations, (unsigned long)arena.failures);
+    }
+
+    if (ImGui::Button(TR("mtp.stats_export"), ImVec2(140, 30))) {
+        mkdir("sdmc:/switch", 0777);
+        mkdir("sdmc:/switch/Javelin", 0777);
+        mkdir(MTP_STATS_DIR, 0777);
+
+        char path[128];
+        time_t now = time(nullptr);
+        struct tm* tm = localtime(&now);
+        char stamp[32] = "0";
+        if (tm) strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", tm);
+        snprintf(path, sizeof(path), MTP_STATS_DIR "/mtp-stats-%s.json", stamp);
+
+        if (mtpStatsExportJson(path)) {
+            LOG_INFO("Stats written to %s", path);
+            showSuccess(TR("mtp.stats_exported"));
+        } else {
+            LOG_ERROR("Failed to write stats to %s", path);
+            showError(TR("mtp.stats_export_failed"));
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(TR("mtp.stats_reset"), ImVec2(140, 30))) {
+        mtpStatsReset();
+    }
+    ImGui::Spacing();
+}
+
 void renderMTPScreen(MtpProtocolContext& mtp_ctx, bool& usb_initialized, bool& mtp_running, char* status_msg) {
     const char* mtpTitle = TR("mtp.title");
     centerText(mtpTitle);
@@ -564,7 +702,7 @@ void renderMTPScreen(MtpProtocolContext& mtp_ctx, bool& usb_initialized, bool& m
         if (ImGui::Button(TR("mtp.stop"), ImVec2(200, 50))) {
             mtp_running = false;
             snprintf(status_msg, 256, "%s", TR("mtp.status_stopping"));
-            showInfo(TR("mtp.stopping"));
+            showInfo(TR("mtp.status_stopping"));
         }
         ImGui::SameLine();
         if (ImGui::Button(TR("mtp.refresh"), ImVec2(100, 50))) {
@@ -589,8 +727,11 @@ void renderMTPScreen(MtpProtocolContext& mtp_ctx, bool& usb_initialized, bool& m
     ImGui::Spacing();
     ImGui::Separator();
 
+    renderMTPStats();
+
     ImGui::Text("%s", TR("mtp.log"));
     ImGui::BeginChild("LogScroll", ImVec2(0, 200), true);
+    mtpLogLockView();
     int log_count = mtpLogGetCount();
     for (int i = 0; i < log_count; i++) {
         const char* entry = mtpLogGetEntry(i);
@@ -602,6 +743,7 @@ void renderMTPScreen(MtpProtocolContext& mtp_ctx, bool& usb_initialized, bool& m
         ImGui::TextUnformatted(entry);
         ImGui::PopStyleColor();
     }
+    mtpLogUnlockView();
     if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
         ImGui::SetScrollHereY(1.0f);
     ImGui::EndChild();
@@ -609,6 +751,30 @@ void renderMTPScreen(MtpProtocolContext& mtp_ctx, bool& usb_initialized, bool& m
     if (ImGui::Button(TR("mtp.clear_log"), ImVec2(100, 30))) {
         mtpLogClear();
     }
+
+#if JAVELIN_TRACE
+    // Debug builds only; not translated
+    ImGui::SameLine();
+    if (ImGui::Button("Dump trace", ImVec2(140, 30))) {
+        mkdir("sdmc:/switch", 0777);
+        mkdir("sdmc:/switch/Javelin", 0777);
+        mkdir(TRACE_DIR, 0777);
+
+        char path[128];
+        time_t now = time(nullptr);
+        struct tm* tm = localtime(&now);
+        char stamp[32] = "0";
+        if (tm) strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", tm);
+        snprintf(path, sizeof(path), TRACE_DIR "/trace-%s.json", stamp);
+
+        if (traceDump(path)) LOG_INFO("Trace written to %s", path);
+        else LOG_ERROR("Failed to write trace to %s", path);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear trace", ImVec2(140, 30))) {
+        traceClear();
+    }
+#endif
 }
 
 static void sanitizeFilename(char* name) {
@@ -628,6 +794,8 @@ static void sanitizeFilename(char* name) {
 
 static void dumpThreadFunc(void* arg) {
     (void)arg;
+    TRACE_THREAD_NAME("dump");
+    TRACE_SCOPE("dumpThreadFunc");
     DumpTaskInfo task = g_dump_task;
     g_dump_should_cancel = false;
 
@@ -694,12 +862,14 @@ static void dumpThreadFunc(void* arg) {
         return;
     }
 
+    TransferTable& transfers = TransferTable::getInstance();
+    TransferId transfer_id = transfers.begin(filepath, total_size);
     {
         TransferStartEvent evt;
+        evt.transferId = transfer_id;
         evt.filePath = filepath;
         evt.totalBytes = total_size;
-        evt.cancelledPtr = &g_dump_should_cancel;
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
     }
 
     // FAT32 split: if >4GB, create a directory and write numbered parts
@@ -724,19 +894,29 @@ static void dumpThreadFunc(void* arg) {
 
     if (!fp) {
         showError(TR("dump.dump_failed"));
+        transfers.finish(transfer_id);
         TransferCompleteEvent evt;
+        evt.transferId = transfer_id;
         evt.filePath = filepath;
         evt.success = false;
         evt.errorMessage = TR("dump.error_create_file");
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
         g_dump_thread_running = false;
         return;
     }
 
     const u64 CHUNK_SIZE = 0x400000; // 4MB
-    u8* buf = (u8*)malloc(CHUNK_SIZE);
+    PoolBuffer* block = bufferPoolAcquire(CHUNK_SIZE, BUFFER_TAG_DUMP);
+    u8* buf = block ? block->data : NULL;
     if (!buf) {
         fclose(fp);
+        transfers.finish(transfer_id);
+        TransferCompleteEvent evt;
+        evt.transferId = transfer_id;
+        evt.filePath = filepath;
+        evt.success = false;
+        evt.errorMessage = TR("dump.dump_failed");
+        EventBus::getInstance().postAsync(evt);
         g_dump_thread_running = false;
         return;
     }
@@ -747,8 +927,14 @@ static void dumpThreadFunc(void* arg) {
     u64 dump_start_tick = armGetSystemTick();
 
     while (offset < total_size && !g_dump_should_cancel) {
+        if (transfers.isCancelled(transfer_id)) {
+            g_dump_should_cancel = true;
+            break;
+        }
+
         u64 remaining = total_size - offset;
         u64 chunk = (remaining < CHUNK_SIZE) ? remaining : CHUNK_SIZE;
+        TRACE_SCOPE_ARG("dump chunk", chunk);
 
         // If splitting, don't exceed the FAT32 limit for this part
         if (needs_split && (split_written + chunk > FAT32_MAX)) {
@@ -792,7 +978,11 @@ static void dumpThreadFunc(void* arg) {
             break;
         }
 
-        size_t written = fwrite(buf, 1, (size_t)rd, fp);
+        size_t written;
+        {
+            TRACE_SCOPE_ARG("sd write", rd);
+            written = fwrite(buf, 1, (size_t)rd, fp);
+        }
         if (written != (size_t)rd) {
             success = false;
             break;
@@ -803,23 +993,16 @@ static void dumpThreadFunc(void* arg) {
 
         u64 now = armGetSystemTick();
         if (now - last_progress_tick > armNsToTicks(100000000ULL)) {
-            float pct = (float)offset / (float)total_size * 100.0f;
             u64 elapsed_ns = armTicksToNs(now - dump_start_tick);
             float elapsed_sec = elapsed_ns / 1000000000.0f;
             float speed = (elapsed_sec > 0.1f) ? (offset / (1024.0f * 1024.0f)) / elapsed_sec : 0.0f;
-            TransferProgressEvent evt;
-            evt.filePath = filepath;
-            evt.bytesTransferred = offset;
-            evt.totalBytes = total_size;
-            evt.progressPercent = pct;
-            evt.speedMBps = speed;
-            EventBus::getInstance().post(evt);
+            transfers.update(transfer_id, offset, speed);
             last_progress_tick = now;
         }
     }
 
     fclose(fp);
-    free(buf);
+    bufferRelease(block);
 
     if (g_dump_should_cancel) {
         if (needs_split) {
@@ -836,15 +1019,17 @@ static void dumpThreadFunc(void* arg) {
         success = false;
     }
 
+    transfers.finish(transfer_id);
     {
         TransferCompleteEvent evt;
+        evt.transferId = transfer_id;
         evt.filePath = filepath;
         evt.success = success;
         evt.totalBytes = offset;
         if (!success && !g_dump_should_cancel) {
             evt.errorMessage = TR("dump.error_write");
         }
-        EventBus::getInstance().post(evt);
+        EventBus::getInstance().postAsync(evt);
     }
 
     if (success) {
@@ -871,7 +1056,7 @@ static void startDumpThread(DumpTaskInfo task) {
     g_dump_thread_running = true;
     g_dump_thread_needs_join = true;
 
-    Result rc = threadCreate(&g_dump_thread, dumpThreadFunc, NULL, NULL, 0x20000, 0x2C, -2);
+    Result rc = threadCreateForRole(&g_dump_thread, dumpThreadFunc, NULL, 0x20000, THREAD_ROLE_IO);
     if (R_SUCCEEDED(rc)) {
         threadStart(&g_dump_thread);
     } else {
@@ -1381,6 +1566,42 @@ void renderSettingsScreen() {
     ImGui::Separator();
     ImGui::Spacing();
 
+    // Log File Section
+    bool logToFile = settingsGet()->log_to_file;
+    if (ImGui::Checkbox(TR("settings.log_to_file"), &logToFile)) {
+        settingsSetLogToFile(logToFile);
+        settingsSave();
+        if (logToFile) mtpLogFileStart();
+        else mtpLogFileStop();
+    }
+    ImGui::TextDisabled("(%s)", TR("settings.log_to_file_desc"));
+
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // Thread Layout Section
+    ImGui::Text("%s", TR("settings.thread_layout"));
+    ImGui::Spacing();
+
+    const char* layoutLabels[THREAD_LAYOUT_COUNT] = {
+        TR("settings.thread_layout_pinned"),
+        TR("settings.thread_layout_shared"),
+    };
+    int layoutIndex = (int)settingsGet()->thread_layout;
+    ImGui::PushItemWidth(listWidth);
+    if (ImGui::Combo("##thread_layout", &layoutIndex, layoutLabels, THREAD_LAYOUT_COUNT)) {
+        settingsSetThreadLayout((ThreadLayout)layoutIndex);
+        settingsSave();
+        threadRolesSetLayout((ThreadLayout)layoutIndex);
+    }
+    ImGui::PopItemWidth();
+    ImGui::TextDisabled("(%s)", TR("settings.thread_layout_desc"));
+
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
     if (ImGui::Button(TR("settings.back"), ImVec2(100, 40)) || ImGui::IsKeyPressed(ImGuiKey_GamepadFaceRight)) {
         // Reset first frame flag for next time we enter settings
         s_first_frame = true;
@@ -1392,6 +1613,7 @@ void renderSettingsScreen() {
 static bool* g_mtp_thread_should_stop = nullptr;
 static void mtpThreadFunc(void* arg) {
     MtpProtocolContext* ctx = (MtpProtocolContext*)arg;
+    TRACE_THREAD_NAME("MTP");
 
     while (!*g_mtp_thread_should_stop) {
         mtpProtocolProcess(ctx);
@@ -1431,10 +1653,15 @@ int main(int argc, char* argv[]) {
     GuiManager::getInstance().initialize();
 
     settingsInit();
+    threadRolesSetLayout(settingsGet()->thread_layout);
+    taskPoolInit();
+    titleCacheInit();
     Localization::getInstance().initialize();
 
     const Settings* settings = settingsGet();
     Localization::getInstance().setLanguage(settings->language);
+    if (settings->log_to_file)
+        mtpLogFileStart();
 
     bool usb_initialized = false;
     bool mtp_running = false;
@@ -1459,11 +1686,11 @@ int main(int argc, char* argv[]) {
     padConfigureInput(1, HidNpadStyleSet_NpadStandard);
     padInitializeDefault(&pad);
 
-    while (appletMainLoop()) {
-        u64 currentTime = armGetSystemTick();
-        float deltaTime = (currentTime - lastTime) / 1000000.0f;
-        lastTime = currentTime;
+    TRACE_THREAD_NAME("UI");
+    FrameScheduler& scheduler = FrameScheduler::getInstance();
+    EventBus::getInstance().setWakeHook([] { FrameScheduler::getInstance().markDirty(); });
 
+    while (appletMainLoop()) {
         padUpdate(&pad);
         u64 kDown = padGetButtonsDown(&pad);
         u64 kHeld = padGetButtons(&pad);
@@ -1588,10 +1815,77 @@ int main(int argc, char* argv[]) {
         io.AddKeyEvent(ImGuiKey_GamepadL1, (kHeld & HidNpadButton_L) != 0);
         io.AddKeyEvent(ImGuiKey_GamepadR1, (kHeld & HidNpadButton_R) != 0);
 
+        // Housekeeping runs every iteration, rendered or not: a host listing a
+        // folder waits on these refreshes, and MTP starts or stops right after
+        // the frame that toggled it
+        if (mtp_running) {
+            savesRefreshIfNeeded(&mtp_ctx.saves);
+            dumpRefreshIfNeeded(&mtp_ctx.dump);
+            gcRefreshIfNeeded(&mtp_ctx.gamecard);
+        }
+
+        // Prevent auto-sleep when MTP, dump, or install is active
+        {
+            bool need_wake = mtp_running || g_dump_thread_running || g_install_thread_running;
+            if (need_wake && !sleep_locked) {
+                appletSetMediaPlaybackState(true);
+                sleep_locked = true;
+            } else if (!need_wake && sleep_locked) {
+                appletSetMediaPlaybackState(false);
+                sleep_locked = false;
+            }
+        }
+
+        if (mtp_running && !mtp_thread_running) {
+            savesPreInitServices(&mtp_ctx.saves);
+            dumpPreInitServices(&mtp_ctx.dump);
+            gcPreInitServices(&mtp_ctx.gamecard);
+
+            g_mtp_thread_should_stop = &mtp_thread_should_stop;
+            mtp_thread_should_stop = false;
+            Result rc = threadCreateForRole(&mtp_thread, mtpThreadFunc, &mtp_ctx, 0x20000, THREAD_ROLE_USB);
+            if (R_SUCCEEDED(rc)) {
+                threadStart(&mtp_thread);
+                mtp_thread_running = true;
+            }
+        } else if (!mtp_running && mtp_thread_running) {
+            mtp_thread_should_stop = true;
+            threadWaitForExit(&mtp_thread);
+            threadClose(&mtp_thread);
+            mtp_thread_running = false;
+
+            mtpProtocolExit(&mtp_ctx);
+            usbMtpExit();
+            usb_initialized = false;
+            snprintf(status_msg, 256, "%s", TR("mtp.status_stopped"));
+            showInfo(TR("mtp.status_stopped"));
+        }
+
+        // Skip rendering while nobody is touching the console and nothing changed;
+        // input queued above is picked up by the next rendered frame
+        if (kDown || kHeld || touchActive || leftStickActive || rightStickActive)
+            scheduler.noteInput();
+        if (!scheduler.shouldRender()) {
+            scheduler.waitForWork();
+            continue;
+        }
+        scheduler.beginFrame();
+
+        TRACE_SCOPE("frame");
+        u64 currentTime = armGetSystemTick();
+        float deltaTime = (currentTime - lastTime) / 1000000.0f;
+        lastTime = currentTime;
+
         ImGui_ImplSwitch_NewFrame();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui::NewFrame();
 
+        // Apply what worker threads queued since the last frame
+        {
+            TRACE_SCOPE("dispatchQueued");
+            mtpStatsSetGauge(MTP_GAUGE_EVENT_QUEUE, EventBus::getInstance().dispatchQueued());
+        }
+        mtpLogPump();
         GuiManager::getInstance().updateNotifications(deltaTime);
 
         int currentScreen = GuiManager::getInstance().getCurrentScreen();
@@ -1641,49 +1935,6 @@ int main(int argc, char* argv[]) {
 
         GuiManager::getInstance().renderModals();
 
-        if (mtp_running) {
-            savesRefreshIfNeeded(&mtp_ctx.saves);
-            dumpRefreshIfNeeded(&mtp_ctx.dump);
-            gcRefreshIfNeeded(&mtp_ctx.gamecard);
-        }
-
-        // Prevent auto-sleep when MTP, dump, or install is active
-        {
-            bool need_wake = mtp_running || g_dump_thread_running || g_install_thread_running;
-            if (need_wake && !sleep_locked) {
-                appletSetMediaPlaybackState(true);
-                sleep_locked = true;
-            } else if (!need_wake && sleep_locked) {
-                appletSetMediaPlaybackState(false);
-                sleep_locked = false;
-            }
-        }
-
-        if (mtp_running && !mtp_thread_running) {
-            savesPreInitServices(&mtp_ctx.saves);
-            dumpPreInitServices(&mtp_ctx.dump);
-            gcPreInitServices(&mtp_ctx.gamecard);
-
-            g_mtp_thread_should_stop = &mtp_thread_should_stop;
-            mtp_thread_should_stop = false;
-            Result rc = threadCreate(&mtp_thread, mtpThreadFunc, &mtp_ctx, NULL, 0x20000, 0x2C, -2);
-            if (R_SUCCEEDED(rc)) {
-                threadStart(&mtp_thread);
-                mtp_thread_running = true;
-            }
-        } else if (!mtp_running && mtp_thread_running) {
-            mtp_thread_should_stop = true;
-            threadWaitForExit(&mtp_thread);
-            threadClose(&mtp_thread);
-            mtp_thread_running = false;
-
-            mtpProtocolExit(&mtp_ctx);
-            usbMtpExit();
-            usb_initialized = false;
-            snprintf(status_msg, 256, "%s", TR("mtp.status_stopped"));
-            showInfo(TR("mtp.stopped"));
-        }
-
         if (virtualMouseActive || leftStickWasActive) {
             ImDrawList* drawList = ImGui::GetForegroundDrawList();
             ImVec2 cursorPos(virtualMouseX, virtualMouseY);
@@ -1767,6 +2018,11 @@ int main(int argc, char* argv[]) {
         usb_initialized = false;
     }
 
+    taskPoolExit();
+    titleCacheExit();
+    servicesExit();
+    mtpLogFileStop();
+
     svcSleepThread(100000000ULL);
     glFinish();
     ImGui_ImplOpenGL3_Shutdown();
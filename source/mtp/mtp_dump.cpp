@@ -284,7 +284,7 @@ bool dumpGetObjectInfo(DumpContext* ctx, u32 handle, MtpObject* out) {
                 }
             }
 
-            NcmContentMetaDatabase* meta_db = game->is_on_sd ? &ctx->sd_meta_db : &ctx->nand_meta_db;
+            NcmContentMetaDatabase* meta_db = game->is_on_sd ? ctx->sd_meta_db : ctx->nand_meta_db;
             NcmStorageId storage = game->is_on_sd ? NcmStorageId_SdCard : NcmStorageId_BuiltInUser;
 
             if (update_count > 0) {
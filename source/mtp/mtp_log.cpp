@@ -2,9 +2,14 @@
 // SPDX-License-Identifier: MIT
 //
 #include "mtp/mtp_log.h"
+#include "mtp/mtp_stats.h"
 #include "core/Debug.h"
+#include "core/ThreadRoles.h"
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #define MAX_LOG_ENTRIES 100
 #define MAX_LOG_LENGTH 512
@@ -14,21 +19,43 @@ typedef struct {
     char message[MAX_LOG_LENGTH];
 } LogEntry;
 
+// Formatted history shown by the log view. Only mtpLogPump writes it.
 static LogEntry g_log_entries[MAX_LOG_ENTRIES];
+static int g_log_head = 0;              // Oldest entry
 static int g_log_count = 0;
+static Mutex g_log_mutex;
+
+// Pending records. Producers claim slots with a CAS on the enqueue position;
+// a slot's seq equals its position while free and position + 1 once filled.
+static MtpLogRecord g_ring[MTP_LOG_RING_SIZE];
+static u32 g_enqueue_pos = 0;
+static u32 g_dequeue_pos = 0;           // Consumer only, under g_log_mutex
+static u32 g_dropped = 0;
+static bool g_wake_pending = false;     // Producers already nudged the file writer
 static bool g_log_initialized = false;
+static u64 g_log_start_tick = 0;          // File timestamps are relative to this
 
 void mtpLogInit(void) {
-    if (g_log_initialized) return;
+    if (__atomic_load_n(&g_log_initialized, __ATOMIC_ACQUIRE)) return;
 
+    mutexInit(&g_log_mutex);
     memset(g_log_entries, 0, sizeof(g_log_entries));
+    g_log_head = 0;
     g_log_count = 0;
-    g_log_initialized = true;
+    for (u32 i = 0; i < MTP_LOG_RING_SIZE; i++)
+        g_ring[i].seq = i;
+    g_enqueue_pos = 0;
+    g_dequeue_pos = 0;
+    g_log_start_tick = armGetSystemTick();
+    __atomic_store_n(&g_log_initialized, true, __ATOMIC_RELEASE);
 }
 
 void mtpLogClear(void) {
+    mutexLock(&g_log_mutex);
+    g_log_head = 0;
     g_log_count = 0;
     memset(g_log_entries, 0, sizeof(g_log_entries));
+    mutexUnlock(&g_log_mutex);
 }
 
 int mtpLogGetCount(void) {
@@ -37,122 +64,530 @@ int mtpLogGetCount(void) {
 
 const char* mtpLogGetEntry(int index) {
     if (index < 0 || index >= g_log_count) return "";
-    return g_log_entries[index].message;
+    return g_log_entries[(g_log_head + index) % MAX_LOG_ENTRIES].message;
 }
 
 MtpLogLevel mtpLogGetLevel(int index) {
     if (index < 0 || index >= g_log_count) return MTP_LOG_INFO;
-    return g_log_entries[index].level;
+    return g_log_entries[(g_log_head + index) % MAX_LOG_ENTRIES].level;
+}
+
+// ----------------------------------------------------------------------------
+// Producer side (any thread)
+// ----------------------------------------------------------------------------
+
+static void mtpLogWakeWriter(void);
+
+MtpLogRecord* mtpLogBeginRecord(MtpLogLevel level, const char* fmt) {
+    if (!__atomic_load_n(&g_log_initialized, __ATOMIC_ACQUIRE)) return nullptr;
+
+    u32 pos = __atomic_load_n(&g_enqueue_pos, __ATOMIC_RELAXED);
+    MtpLogRecord* r;
+    for (;;) {
+        r = &g_ring[pos & (MTP_LOG_RING_SIZE - 1)];
+        s32 diff = (s32)(__atomic_load_n(&r->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&g_enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            // Ring full: drop rather than stall a transfer thread
+            __atomic_fetch_add(&g_dropped, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        } else {
+            pos = __atomic_load_n(&g_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    // Past half full, wake the file writer early instead of waiting for its tick
+    if (pos - __atomic_load_n(&g_dequeue_pos, __ATOMIC_RELAXED) >= MTP_LOG_RING_SIZE / 2 &&
+        !__atomic_exchange_n(&g_wake_pending, true, __ATOMIC_RELAXED))
+        mtpLogWakeWriter();
+
+    r->level = (u8)level;
+    r->argc = 0;
+    r->strUsed = 0;
+    r->overflow = false;
+    r->thread = threadGetCurHandle();
+    r->tick = armGetSystemTick();
+    r->fmt = fmt;
+    return r;
+}
+
+void mtpLogCommitRecord(MtpLogRecord* record) {
+    u32 pos = __atomic_load_n(&record->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->seq, pos + 1, __ATOMIC_RELEASE);
 }
 
 void mtpLogAdd(MtpLogLevel level, const char* message) {
-    if (!g_log_initialized) return;
-
-    // Filter debug logs based on component debug flags
-    if (level == MTP_LOG_DEBUG) {
-        // Check if this debug message should be shown based on component flags
-        // For now, only show debug if DEBUG_INSTALL is enabled and message contains install-related keywords
-        #if DEBUG_INSTALL
-            // Allow install-related debug logs
-            if (strstr(message, "Install") ||
-                strstr(message, "install") ||
-                strstr(message, "Ticket") ||
-                strstr(message, "ticket") ||
-                strstr(message, "NCA") ||
-                strstr(message, "CNMT") ||
-                strstr(message, "Stream")) {
-                // Show this debug message
-            } else {
-                // Hide other debug messages
-                return;
-            }
-        #else
-            // Hide all debug logs if DEBUG_INSTALL is not enabled
-            return;
-        #endif
+    MtpLogRecord* r = mtpLogBeginRecord(level, nullptr);
+    if (!r) return;
+    snprintf(r->strings, sizeof(r->strings), "%s", message);
+    mtpLogCommitRecord(r);
+}
+
+// ----------------------------------------------------------------------------
+// Formatting (consumer side)
+// ----------------------------------------------------------------------------
+
+// Print one argument through the conversion spec it was logged with. The
+// stored value is narrowed to the type the length modifier names, so the
+// output matches what snprintf would have produced at the call site.
+static int formatArg(char* out, size_t size, const char* spec, char conv,
+                     const char* length, const MtpLogRecord* r, u8 i) {
+    u64 v = r->args[i];
+    u8 kind = r->kinds[i];
+
+    switch (conv) {
+        case 's':
+            if (kind != MTP_LOG_ARG_STR) return snprintf(out, size, "(?)");
+            return snprintf(out, size, spec, r->strings + v);
+        case 'p':
+            return snprintf(out, size, spec, (void*)(uintptr_t)v);
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double d;
+            if (kind == MTP_LOG_ARG_DOUBLE) memcpy(&d, &v, sizeof(d));
+            else d = (double)(s64)v;
+            return snprintf(out, size, spec, d);
+        }
+        case 'c':
+            return snprintf(out, size, spec, (int)v);
+        case 'd': case 'i':
+            if (!strcmp(length, "hh")) return snprintf(out, size, spec, (signed char)v);
+            if (!strcmp(length, "h"))  return snprintf(out, size, spec, (short)v);
+            if (!strcmp(length, "l"))  return snprintf(out, size, spec, (long)v);
+            if (!strcmp(length, "ll")) return snprintf(out, size, spec, (long long)v);
+            if (!strcmp(length, "z") || !strcmp(length, "t")) return snprintf(out, size, spec, (ssize_t)v);
+            if (!strcmp(length, "j"))  return snprintf(out, size, spec, (intmax_t)v);
+            return snprintf(out, size, spec, (int)v);
+        case 'u': case 'x': case 'X': case 'o':
+            if (!strcmp(length, "hh")) return snprintf(out, size, spec, (unsigned char)v);
+            if (!strcmp(length, "h"))  return snprintf(out, size, spec, (unsigned short)v);
+            if (!strcmp(length, "l"))  return snprintf(out, size, spec, (unsigned long)v);
+            if (!strcmp(length, "ll")) return snprintf(out, size, spec, (unsigned long long)v);
+            if (!strcmp(length, "z") || !strcmp(length, "t")) return snprintf(out, size, spec, (size_t)v);
+            if (!strcmp(length, "j"))  return snprintf(out, size, spec, (uintmax_t)v);
+            return snprintf(out, size, spec, (unsigned int)v);
     }
+    return 0;
+}
 
-    if (g_log_count < MAX_LOG_ENTRIES) {
-        g_log_entries[g_log_count].level = level;
-        strncpy(g_log_entries[g_log_count].message, message, MAX_LOG_LENGTH - 1);
-        g_log_entries[g_log_count].message[MAX_LOG_LENGTH - 1] = '\0';
-        g_log_count++;
-    } else {
-        for (int i = 0; i < MAX_LOG_ENTRIES - 1; i++) {
-            g_log_entries[i] = g_log_entries[i + 1];
+// Expand a record into its message text
+static void formatRecord(const MtpLogRecord* r, char* out, size_t size) {
+    if (!r->fmt) {
+        snprintf(out, size, "%s", r->strings);
+        return;
+    }
+
+    size_t used = 0;
+    u8 arg = 0;
+    const char* p = r->fmt;
+    while (*p && used + 1 < size) {
+        if (*p != '%') {
+            out[used++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion; a "*" width or
+        // precision takes the next argument and is written into the spec
+        const char* start = p++;
+        int stars[2];
+        u8 starCount = 0;
+        bool missing = false;
+        bool noPrecision = false;   // Negative "*" precision: as if none was given
+        while (*p && strchr("-+ #0", *p)) p++;
+        if (*p == '*') {
+            p++;
+            if (arg < r->argc) stars[starCount++] = (int)(s64)r->args[arg++];
+            else missing = true;
         }
-        g_log_entries[MAX_LOG_ENTRIES - 1].level = level;
-        strncpy(g_log_entries[MAX_LOG_ENTRIES - 1].message, message, MAX_LOG_LENGTH - 1);
-        g_log_entries[MAX_LOG_ENTRIES - 1].message[MAX_LOG_LENGTH - 1] = '\0';
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                p++;
+                if (arg < r->argc) {
+                    stars[starCount] = (int)(s64)r->args[arg++];
+                    noPrecision = stars[starCount++] < 0;
+                } else {
+                    missing = true;
+                }
+            }
+            while (*p >= '0' && *p <= '9') p++;
+        }
+        const char* lenStart = p;
+        while (*p && strchr("hlzjtL", *p)) p++;
+        char length[3] = {0};
+        size_t lenChars = (size_t)(p - lenStart);
+        if (lenChars < sizeof(length)) memcpy(length, lenStart, lenChars);
+        char conv = *p;
+        if (!conv) break;
+        p++;
+
+        char spec[48];
+        size_t specLen = (size_t)(p - start);
+        if (specLen >= 24 || missing || arg >= r->argc) {
+            // Malformed or missing argument: show the spec as written
+            int n = snprintf(out + used, size - used, "%.*s", (int)specLen, start);
+            if (n > 0) used += (size_t)n;
+            continue;
+        }
+        size_t o = 0;
+        u8 star = 0;
+        for (const char* c = start; c < p; c++) {
+            if (*c == '.' && noPrecision) { c++; star++; }  // Drop ".*" and its value
+            else if (*c == '*') o += (size_t)snprintf(spec + o, sizeof(spec) - o, "%d", stars[star++]);
+            else spec[o++] = *c;
+        }
+        spec[o] = '\0';
+
+        int n = formatArg(out + used, size - used, spec, conv, length, r, arg++);
+        if (n > 0) used += (size_t)n;
     }
+    if (used >= size) used = size - 1;
+    out[used] = '\0';
+}
+
+// ----------------------------------------------------------------------------
+// Debug filtering, applied to formatted text off the logging thread
+// ----------------------------------------------------------------------------
+
+[[maybe_unused]] static bool matchesAny(const char* message, const char* const* keywords) {
+    for (; *keywords; keywords++)
+        if (strstr(message, *keywords)) return true;
+    return false;
+}
+
+[[maybe_unused]] static const char* const kInstallKeywords[] = { "Install", "install", "Ticket", "ticket", "NCA", "CNMT", "Stream", nullptr };
+
+// Only install-related debug messages reach the log view
+static bool debugVisibleInView(const char* message) {
+#if DEBUG_INSTALL
+    return matchesAny(message, kInstallKeywords);
+#else
+    (void)message;
+    return false;
+#endif
+}
 
-    // Only print to nxlink if this message should be shown based on debug flags
 #if NXLINK_ENABLED
-    // For debug messages, only show if they match enabled component flags
+// Debug messages are printed when they match an enabled component flag
+static bool debugVisibleOnNxlink(const char* message) {
     bool should_print = false;
-    if (level != MTP_LOG_DEBUG) {
-        // Always print INFO and ERROR messages
-        should_print = true;
+#if DEBUG_INSTALL
+    if (matchesAny(message, kInstallKeywords)) should_print = true;
+#endif
+#if DEBUG_MTP_PROTO
+    static const char* const kProto[] = { "MTP Command", "MTP:", "Response", "Data ", "GetStorage", nullptr };
+    if (matchesAny(message, kProto)) should_print = true;
+#endif
+#if DEBUG_MTP_STORAGE
+    static const char* const kStorage[] = { "Storage", "storage", nullptr };
+    if (matchesAny(message, kStorage)) should_print = true;
+#endif
+#if DEBUG_USB
+    static const char* const kUsb[] = { "USB", "Read:", "Write:", nullptr };
+    if (matchesAny(message, kUsb)) should_print = true;
+#endif
+#if DEBUG_SAVES
+    static const char* const kSaves[] = { "Save", "save", nullptr };
+    if (matchesAny(message, kSaves)) should_print = true;
+#endif
+#if DEBUG_GUI
+    static const char* const kGui[] = { "GUI", "Render", nullptr };
+    if (matchesAny(message, kGui)) should_print = true;
+#endif
+#if DEBUG_MEMORY
+    static const char* const kMemory[] = { "Alloc", "Free", nullptr };
+    if (matchesAny(message, kMemory)) should_print = true;
+#endif
+    (void)message;
+    return should_print;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Consumer
+// ----------------------------------------------------------------------------
+
+// File sink batches. Pumps append formatted lines to the active buffer under
+// g_log_mutex; the writer swaps buffers and writes the full one unlocked.
+#define LOG_SINK_BUFFER_SIZE    (64 * 1024)
+#define LOG_SINK_INTERVAL_NS    250000000ULL    // Writer wakeup
+#define LOG_SINK_SYNC_NS        2000000000ULL   // fsync at least this often
+
+typedef struct {
+    Thread thread;
+    bool stop;                  // Guarded by g_log_mutex
+    CondVar wake;
+    char buffers[2][LOG_SINK_BUFFER_SIZE];
+    u32 active;
+    u32 used;                   // Bytes in buffers[active]
+    u32 dropped;                // Lines that did not fit before the writer caught up
+    bool urgent;                // An error was logged; write and sync now
+} LogFileSink;
+
+// Static so producers can signal it without racing mtpLogFileStop
+static LogFileSink g_sink_storage;
+static LogFileSink* g_sink = nullptr;       // Set while the writer runs
+static void sinkAppend(MtpLogLevel level, u64 tick, u32 thread, const char* message) {
+    static const char kLevels[] = { 'D', 'I', 'W', 'E' };
+    LogFileSink* sink = g_sink;
+
+    char line[MAX_LOG_LENGTH + 48];
+    u64 ms = armTicksToNs(tick - g_log_start_tick) / 1000000ULL;
+    int n = snprintf(line, sizeof(line), "%6lu.%03lu %c %08X %s\n",
+                     (unsigned long)(ms / 1000), (unsigned long)(ms % 1000),
+                     kLevels[level & 3], thread, message);
+    if (n <= 0) return;
+    if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+
+    if (sink->used + (u32)n > LOG_SINK_BUFFER_SIZE) {
+        sink->dropped++;
+        return;
+    }
+    memcpy(sink->buffers[sink->active] + sink->used, line, n);
+    sink->used += n;
+
+    if (level == MTP_LOG_ERROR || sink->used > LOG_SINK_BUFFER_SIZE / 2) {
+        sink->urgent = level == MTP_LOG_ERROR || sink->urgent;
+        condvarWakeOne(&sink->wake);
+    }
+}
+
+static void appendEntry(MtpLogLevel level, const char* message) {
+    int slot;
+    if (g_log_count < MAX_LOG_ENTRIES) {
+        slot = (g_log_head + g_log_count) % MAX_LOG_ENTRIES;
+        g_log_count++;
     } else {
-        // Debug messages - check component flags
-        // Only show debug logs if at least one debug flag is enabled
-        #if DEBUG_INSTALL || DEBUG_MTP_PROTO || DEBUG_MTP_STORAGE || DEBUG_USB || DEBUG_SAVES || DEBUG_GUI || DEBUG_MEMORY
-            #if DEBUG_INSTALL
-                if (strstr(message, "Install") ||
-                    strstr(message, "install") ||
-                    strstr(message, "Ticket") ||
-                    strstr(message, "ticket") ||
-                    strstr(message, "NCA") ||
-                    strstr(message, "CNMT") ||
-                    strstr(message, "Stream")) {
-                    should_print = true;
-                }
-            #endif
-            #if DEBUG_MTP_PROTO
-                if (strstr(message, "MTP Command") ||
-                    strstr(message, "MTP:") ||
-                    strstr(message, "Response") ||
-                    strstr(message, "Data ") ||
-                    strstr(message, "GetStorage")) {
-                    should_print = true;
-                }
-            #endif
-            #if DEBUG_MTP_STORAGE
-                if (strstr(message, "Storage") ||
-                    strstr(message, "storage")) {
-                    should_print = true;
-                }
-            #endif
-            #if DEBUG_USB
-                if (strstr(message, "USB") ||
-                    strstr(message, "Read:") ||
-                    strstr(message, "Write:")) {
-                    should_print = true;
-                }
-            #endif
-            #if DEBUG_SAVES
-                if (strstr(message, "Save") ||
-                    strstr(message, "save")) {
-                    should_print = true;
-                }
-            #endif
-            #if DEBUG_GUI
-                if (strstr(message, "GUI") ||
-                    strstr(message, "Render")) {
-                    should_print = true;
-                }
-            #endif
-            #if DEBUG_MEMORY
-                if (strstr(message, "Alloc") ||
-                    strstr(message, "Free")) {
-                    should_print = true;
-                }
-            #endif
-        #endif
+        slot = g_log_head;
+        g_log_head = (g_log_head + 1) % MAX_LOG_ENTRIES;
     }
+    g_log_entries[slot].level = level;
+    snprintf(g_log_entries[slot].message, MAX_LOG_LENGTH, "%s", message);
+}
+
+static void emitMessage(MtpLogLevel level, u64 tick, u32 thread, const char* message) {
+    bool visible = level != MTP_LOG_DEBUG || debugVisibleInView(message);
+    if (visible)
+        appendEntry(level, message);
 
-    if (should_print) {
+    // The file gets what the view gets
+    if (visible && g_sink)
+        sinkAppend(level, tick, thread, message);
+
+#if NXLINK_ENABLED
+    if (level != MTP_LOG_DEBUG || debugVisibleOnNxlink(message))
         printf("[MTP] %s\n", message);
-    }
 #endif
 }
+
+// Drain the ring. Caller holds g_log_mutex.
+static void pumpLocked(void) {
+    char message[MAX_LOG_LENGTH];
+
+    mtpStatsSetGauge(MTP_GAUGE_LOG_RING, __atomic_load_n(&g_enqueue_pos, __ATOMIC_RELAXED) - g_dequeue_pos);
+
+    for (;;) {
+        MtpLogRecord* r = &g_ring[g_dequeue_pos & (MTP_LOG_RING_SIZE - 1)];
+        if (__atomic_load_n(&r->seq, __ATOMIC_ACQUIRE) != g_dequeue_pos + 1) break;
+
+        formatRecord(r, message, sizeof(message));
+        MtpLogLevel level = (MtpLogLevel)r->level;
+        u64 tick = r->tick;
+        u32 thread = r->thread;
+
+        // Hand the slot back before the (slower) sinks run
+        __atomic_store_n(&r->seq, g_dequeue_pos + MTP_LOG_RING_SIZE, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_dequeue_pos, g_dequeue_pos + 1, __ATOMIC_RELAXED);
+
+        emitMessage(level, tick, thread, message);
+    }
+
+    u32 dropped = __atomic_exchange_n(&g_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped) {
+        snprintf(message, sizeof(message), "Log overflow: %u messages dropped", dropped);
+        emitMessage(MTP_LOG_WARNING, armGetSystemTick(), threadGetCurHandle(), message);
+    }
+}
+
+void mtpLogPump(void) {
+    if (!__atomic_load_n(&g_log_initialized, __ATOMIC_ACQUIRE)) return;
+
+    mutexLock(&g_log_mutex);
+    pumpLocked();
+    mutexUnlock(&g_log_mutex);
+}
+
+void mtpLogLockView(void) {
+    mutexLock(&g_log_mutex);
+}
+
+void mtpLogUnlockView(void) {
+    mutexUnlock(&g_log_mutex);
+}
+
+// ----------------------------------------------------------------------------
+// SD file sink
+// ----------------------------------------------------------------------------
+
+static void logFilePath(char* out, size_t size, int index) {
+    if (index == 0) snprintf(out, size, MTP_LOG_FILE_DIR "/javelin.log");
+    else snprintf(out, size, MTP_LOG_FILE_DIR "/javelin.%d.log", index);
+}
+
+static FILE* openLogFile(long* size) {
+    char path[64];
+    logFilePath(path, sizeof(path), 0);
+    FILE* f = fopen(path, "a");
+    if (!f) return nullptr;
+    // Batches are already large; skip stdio's own buffering
+    setvbuf(f, nullptr, _IONBF, 0);
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    return f;
+}
+
+// javelin.log -> javelin.1.log -> ... ; the oldest file is deleted
+static FILE* rotateLogFile(FILE* f, long* size) {
+    fclose(f);
+
+    char from[64], to[64];
+    logFilePath(to, sizeof(to), MTP_LOG_FILE_KEEP - 1);
+    remove(to);
+    for (int i = MTP_LOG_FILE_KEEP - 2; i >= 0; i--) {
+        logFilePath(from, sizeof(from), i);
+        logFilePath(to, sizeof(to), i + 1);
+        rename(from, to);
+    }
+    return openLogFile(size);
+}
+
+static void syncLogFile(FILE* f) {
+    fflush(f);
+    fsync(fileno(f));
+}
+
+static void logWriterThread(void* arg) {
+    LogFileSink* sink = (LogFileSink*)arg;
+
+    mkdir("sdmc:/switch", 0777);
+    mkdir("sdmc:/switch/Javelin", 0777);
+    mkdir(MTP_LOG_FILE_DIR, 0777);
+
+    long size = 0;
+    FILE* f = openLogFile(&size);
+    if (f) {
+        time_t now = time(nullptr);
+        struct tm* tm = localtime(&now);
+        char stamp[32] = "";
+        if (tm) strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", tm);
+        fprintf(f, "==== Javelin session started %s ====\n", stamp);
+    }
+
+    u64 lastSync = armGetSystemTick();
+    mutexLock(&g_log_mutex);
+    for (;;) {
+        // A nudge that arrived while we were writing is still pending
+        bool stopping = sink->stop;
+        if (!stopping && !sink->urgent && !__atomic_load_n(&g_wake_pending, __ATOMIC_RELAXED))
+            condvarWaitTimeout(&sink->wake, &g_log_mutex, LOG_SINK_INTERVAL_NS);
+        stopping = sink->stop;
+
+        __atomic_store_n(&g_wake_pending, false, __ATOMIC_RELAXED);
+        pumpLocked();
+
+        char* batch = sink->buffers[sink->active];
+        u32 batchSize = sink->used;
+        u32 dropped = sink->dropped;
+        bool urgent = sink->urgent;
+        sink->active ^= 1;
+        sink->used = 0;
+        sink->dropped = 0;
+        sink->urgent = false;
+        mutexUnlock(&g_log_mutex);
+
+        if (f && batchSize) {
+            if (size + (long)batchSize > MTP_LOG_FILE_MAX_SIZE)
+                f = rotateLogFile(f, &size);
+            if (f) {
+                size += (long)fwrite(batch, 1, batchSize, f);
+                if (dropped)
+                    size += fprintf(f, "(%u log lines dropped, SD writes fell behind)\n", dropped);
+            }
+        }
+
+        u64 nowTick = armGetSystemTick();
+        if (f && (urgent || stopping || armTicksToNs(nowTick - lastSync) >= LOG_SINK_SYNC_NS)) {
+            syncLogFile(f);
+            lastSync = nowTick;
+        }
+
+        mutexLock(&g_log_mutex);
+        if (stopping) break;
+    }
+    mutexUnlock(&g_log_mutex);
+
+    if (f) fclose(f);
+}
+
+void mtpLogFileStart(void) {
+    if (!__atomic_load_n(&g_log_initialized, __ATOMIC_ACQUIRE) || g_sink) return;
+
+    LogFileSink* sink = &g_sink_storage;
+    sink->stop = false;
+    sink->active = 0;
+    sink->used = 0;
+    sink->dropped = 0;
+    sink->urgent = false;
+    condvarInit(&sink->wake);
+
+    Result rc = threadCreateForRole(&sink->thread, logWriterThread, sink, 0x8000, THREAD_ROLE_BACKGROUND);
+    if (R_FAILED(rc)) return;
+
+    // Publish before starting so the first pump already feeds the file
+    mutexLock(&g_log_mutex);
+    __atomic_store_n(&g_sink, sink, __ATOMIC_RELEASE);
+    mutexUnlock(&g_log_mutex);
+
+    rc = threadStart(&sink->thread);
+    if (R_FAILED(rc)) {
+        mutexLock(&g_log_mutex);
+        __atomic_store_n(&g_sink, (LogFileSink*)nullptr, __ATOMIC_RELEASE);
+        mutexUnlock(&g_log_mutex);
+        threadClose(&sink->thread);
+    }
+}
+
+void mtpLogFileStop(void) {
+    LogFileSink* sink = g_sink;
+    if (!sink) return;
+
+    mutexLock(&g_log_mutex);
+    sink->stop = true;
+    condvarWakeOne(&sink->wake);
+    mutexUnlock(&g_log_mutex);
+
+    // The writer drains and syncs once more before it exits
+    threadWaitForExit(&sink->thread);
+    threadClose(&sink->thread);
+
+    mutexLock(&g_log_mutex);
+    __atomic_store_n(&g_sink, (LogFileSink*)nullptr, __ATOMIC_RELEASE);
+    mutexUnlock(&g_log_mutex);
+}
+
+static void mtpLogWakeWriter(void) {
+    LogFileSink* sink = __atomic_load_n(&g_sink, __ATOMIC_ACQUIRE);
+    if (sink) condvarWakeOne(&sink->wake);
+}
+
+bool mtpLogFileRunning(void) {
+    return g_sink != nullptr;
+}
@@ -8,12 +8,14 @@
 #include "mtp/mtp_dump.h"
 #include "mtp/mtp_gamecard.h"
 #include "mtp/mtp_log.h"
+#include "mtp/mtp_stats.h"
 #include "mtp/usb_mtp.h"
 #include "install/stream_install.h"
 #include "core/TransferEvents.h"
 #include "core/Event.h"
 #include "core/Settings.h"
 #include "core/Debug.h"
+#include "core/Trace.h"
 #include <string.h>
 #include <malloc.h>
 #include <stdio.h>
@@ -22,28 +24,27 @@
 using namespace Javelin;
 
 #define MTP_TIMEOUT_NS 5000000000ULL
+#define SAVES_COMMIT_IDLE_NS 1000000000ULL  // Host idle time before pending save writes commit
 
-static std::unordered_map<std::string, bool> g_transfer_cancelled;
-static Mutex g_transfer_mutex = {0};
-
-static inline void transfer_cancel_set(const std::string& path, bool value) {
-    mutexLock(&g_transfer_mutex);
-    g_transfer_cancelled[path] = value;
-    mutexUnlock(&g_transfer_mutex);
+// Storage read/write timing for the stats panel; failed calls are not counted
+static inline void record_storage(MtpBackend backend, bool write, s64 bytes, u64 start_tick) {
+    if (bytes > 0) mtpStatsRecordStorage(backend, write, (u64)bytes, armGetSystemTick() - start_tick);
 }
 
-static inline bool transfer_cancel_check(const std::string& path) {
-    mutexLock(&g_transfer_mutex);
-    auto it = g_transfer_cancelled.find(path);
-    bool cancelled = (it != g_transfer_cancelled.end() && it->second);
-    mutexUnlock(&g_transfer_mutex);
-    return cancelled;
+// Second buffer for double-buffered transfers, held for one operation only.
+// Released buffers stay cached in the pool, so this rarely reaches the heap.
+static u8* acquire_alt_buffer(MtpProtocolContext* ctx) {
+    if (!ctx->alt_block) {
+        ctx->alt_block = bufferPoolAcquire(ctx->tx_block->size, BUFFER_TAG_MTP);
+        ctx->alt_buffer = ctx->alt_block ? ctx->alt_block->data : NULL;
+    }
+    return ctx->alt_buffer;
 }
 
-static inline void transfer_cancel_erase(const std::string& path) {
-    mutexLock(&g_transfer_mutex);
-    g_transfer_cancelled.erase(path);
-    mutexUnlock(&g_transfer_mutex);
+static void release_alt_buffer(MtpProtocolContext* ctx) {
+    bufferRelease(ctx->alt_block);
+    ctx->alt_block = NULL;
+    ctx->alt_buffer = NULL;
 }
 
 static void send_response(MtpProtocolContext* ctx, u16 response_code, u32 transaction_id, u32* params, u32 param_count) {
@@ -256,6 +257,7 @@ static void handle_get_device_info(MtpProtocolContext* ctx, u32 transaction_id)
         MTP_OP_DELETE_OBJECT,
         MTP_OP_SEND_OBJECT_INFO,
         MTP_OP_SEND_OBJECT,
+        MTP_OP_SET_OBJECT_PROP_VALUE,
     };
     u32 op_count = sizeof(operations) / sizeof(u16);
     *(u32*)ptr = op_count;
@@ -312,6 +314,9 @@ static void handle_close_session(MtpProtocolContext* ctx, u32 transaction_id) {
         return;
     }
 
+    // Host is done with the device; land any save writes still in a transaction
+    savesCommitPending(&ctx->saves);
+
     ctx->session_open = false;
     ctx->session_id = 0;
     send_response(ctx, MTP_RESP_OK, transaction_id, NULL, 0);
@@ -646,6 +651,12 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
                   handle, obj.filename, (unsigned long)obj.size);
 #endif
 
+        SavesFileHandle* save_file = savesOpenRead(&ctx->saves, handle);
+        if (!save_file) {
+            send_response(ctx, MTP_RESP_GENERAL_ERROR, transaction_id, NULL, 0);
+            return;
+        }
+
         MtpContainerHeader* hdr = (MtpContainerHeader*)ctx->tx_buffer;
         hdr->length = sizeof(MtpContainerHeader) + obj.size;
         hdr->type = MTP_CONTAINER_TYPE_DATA;
@@ -654,23 +665,22 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
         usbMtpWrite(ctx->tx_buffer, sizeof(MtpContainerHeader), MTP_TIMEOUT_NS);
 
-        u64 offset = 0;
         u64 remaining = obj.size;
 
         while (remaining > 0) {
             u32 chunk_size = (remaining > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining;
 
-            s64 read = savesReadObject(&ctx->saves, handle, offset, ctx->tx_buffer, chunk_size);
+            s64 read = savesReadFile(save_file, ctx->tx_buffer, chunk_size);
             if (read <= 0) {
                 break;
             }
 
             usbMtpWriteDirect(ctx->tx_buffer, read, MTP_TIMEOUT_NS);
 
-            offset += read;
             remaining -= read;
         }
 
+        savesCloseFile(save_file);
         send_response(ctx, MTP_RESP_OK, transaction_id, NULL, 0);
         return;
     }
@@ -704,13 +714,15 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
         usbMtpWrite(ctx->tx_buffer, sizeof(MtpContainerHeader), MTP_TIMEOUT_NS);
 
+        TransferTable& transfers = TransferTable::getInstance();
+        TransferId transfer_id = transfers.begin(obj.filename, obj.size);
         TransferStartEvent startEvt(
+            transfer_id,
             std::string(obj.filename),
             obj.size,
             TransferStartEvent::Direction::Download
         );
-        startEvt.cancelledPtr = nullptr;
-        EventBus::getInstance().post(startEvt);
+        EventBus::getInstance().postAsync(startEvt);
 
         u64 transfer_start_time = armGetSystemTick();
         u64 offset = 0;
@@ -721,12 +733,16 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
         u64 last_progress_bytes = 0;
 
         u8* dump_read_buf = ctx->tx_buffer;
-        u8* dump_write_buf = ctx->alt_buffer;
+        u8* dump_write_buf = acquire_alt_buffer(ctx);
         s64 dump_pending_write = 0;
 
-        {
+        if (!dump_write_buf) {
+            transfer_failed = true;
+        } else {
             u32 chunk_size = (remaining > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining;
+            u64 read_start = armGetSystemTick();
             s64 rd = dumpReadObject(&ctx->dump, handle, offset, dump_read_buf, chunk_size);
+            record_storage(MTP_BACKEND_DUMP, false, rd, read_start);
             if (rd <= 0) {
                 transfer_failed = true;
             } else {
@@ -749,10 +765,17 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
             if (remaining_after > 0) {
                 u32 next_chunk = (remaining_after > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining_after;
+                TRACE_SCOPE_ARG("dump read", next_chunk);
+                u64 read_start = armGetSystemTick();
                 next_read_size = dumpReadObject(&ctx->dump, handle, after_write, dump_read_buf, next_chunk);
+                record_storage(MTP_BACKEND_DUMP, false, next_read_size, read_start);
             }
 
-            size_t usb_written = usbMtpWriteDirectFinish(MTP_TIMEOUT_NS);
+            size_t usb_written;
+            {
+                TRACE_SCOPE("usb write wait");
+                usb_written = usbMtpWriteDirectFinish(MTP_TIMEOUT_NS);
+            }
             if (usb_written == 0) {
                 transfer_failed = true;
                 break;
@@ -762,9 +785,6 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
             u64 now_ticks = armGetSystemTick();
             if ((now_ticks - last_progress_tick) >= progress_tick_interval) {
-                float percent = (obj.size > 0)
-                                ? ((float)offset / (float)obj.size) * 100.0f
-                                : 100.0f;
                 u64 recent_ticks = now_ticks - last_progress_tick;
                 float recent_sec = (float)((double)recent_ticks / armGetSystemTickFreq());
                 u64 recent_bytes = offset - last_progress_bytes;
@@ -772,9 +792,7 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
                               ? ((float)recent_bytes / (1024.0f * 1024.0f)) / recent_sec
                               : 0.0f;
 
-                TransferProgressEvent progressEvt(
-                    std::string(obj.filename), offset, obj.size, percent, speed);
-                EventBus::getInstance().post(progressEvt);
+                transfers.update(transfer_id, offset, speed);
                 last_progress_tick = now_ticks;
                 last_progress_bytes = offset;
             }
@@ -797,19 +815,19 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
             float elapsed_sec = (float)((double)elapsed_ticks / armGetSystemTickFreq());
             float speed = (elapsed_sec > 0.0f)
                           ? ((float)offset / (1024.0f * 1024.0f)) / elapsed_sec : 0.0f;
-            TransferProgressEvent finalEvt(
-                std::string(obj.filename), offset, obj.size, 100.0f, speed);
-            EventBus::getInstance().post(finalEvt);
+            transfers.update(transfer_id, offset, speed);
         }
+        transfers.finish(transfer_id);
 
         send_response(ctx, MTP_RESP_OK, transaction_id, NULL, 0);
 
         TransferCompleteEvent completeEvt(
+            transfer_id,
             std::string(obj.filename),
             offset,
             !transfer_failed,
             transfer_failed ? "Dump read failed" : "");
-        EventBus::getInstance().post(completeEvt);
+        EventBus::getInstance().postAsync(completeEvt);
 
         return;
     }
@@ -840,13 +858,15 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
         usbMtpWrite(ctx->tx_buffer, sizeof(MtpContainerHeader), MTP_TIMEOUT_NS);
 
+        TransferTable& transfers = TransferTable::getInstance();
+        TransferId transfer_id = transfers.begin(obj.filename, obj.size);
         TransferStartEvent startEvt(
+            transfer_id,
             std::string(obj.filename),
             obj.size,
             TransferStartEvent::Direction::Download
         );
-        startEvt.cancelledPtr = nullptr;
-        EventBus::getInstance().post(startEvt);
+        EventBus::getInstance().postAsync(startEvt);
 
         u64 transfer_start_time = armGetSystemTick();
         u64 offset = 0;
@@ -859,12 +879,16 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
         // Double-buffered gamecard download: read next chunk from gamecard while
         // USB DMA for the current chunk is in-flight.
         u8* gc_read_buf = ctx->tx_buffer;
-        u8* gc_write_buf = ctx->alt_buffer;
+        u8* gc_write_buf = acquire_alt_buffer(ctx);
         s64 gc_pending_write = 0;
 
-        {
+        if (!gc_write_buf) {
+            transfer_failed = true;
+        } else {
             u32 chunk_size = (remaining > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining;
+            u64 read_start = armGetSystemTick();
             s64 read = gcReadObject(&ctx->gamecard, handle, offset, gc_read_buf, chunk_size);
+            record_storage(MTP_BACKEND_GAMECARD, false, read, read_start);
             if (read <= 0) {
                 LOG_ERROR("GetObject (gamecard): gcReadObject returned %lld at offset %llu",
                           (long long)read, (unsigned long long)offset);
@@ -889,10 +913,16 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
             if (remaining_after > 0) {
                 u32 next_chunk = (remaining_after > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining_after;
+                u64 read_start = armGetSystemTick();
                 next_read_size = gcReadObject(&ctx->gamecard, handle, after_write, gc_read_buf, next_chunk);
+                record_storage(MTP_BACKEND_GAMECARD, false, next_read_size, read_start);
             }
 
-            size_t usb_written = usbMtpWriteDirectFinish(MTP_TIMEOUT_NS);
+            size_t usb_written;
+            {
+                TRACE_SCOPE("usb write wait");
+                usb_written = usbMtpWriteDirectFinish(MTP_TIMEOUT_NS);
+            }
             if (usb_written == 0) {
                 transfer_failed = true;
                 break;
@@ -902,9 +932,6 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
             u64 now_ticks = armGetSystemTick();
             if ((now_ticks - last_progress_tick) >= progress_tick_interval) {
-                float percent = (obj.size > 0)
-                                ? ((float)offset / (float)obj.size) * 100.0f
-                                : 100.0f;
                 u64 recent_ticks = now_ticks - last_progress_tick;
                 float recent_sec = (float)((double)recent_ticks / armGetSystemTickFreq());
                 u64 recent_bytes = offset - last_progress_bytes;
@@ -912,9 +939,7 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
                               ? ((float)recent_bytes / (1024.0f * 1024.0f)) / recent_sec
                               : 0.0f;
 
-                TransferProgressEvent progressEvt(
-                    std::string(obj.filename), offset, obj.size, percent, speed);
-                EventBus::getInstance().post(progressEvt);
+                transfers.update(transfer_id, offset, speed);
                 last_progress_tick = now_ticks;
                 last_progress_bytes = offset;
             }
@@ -939,19 +964,19 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
             float elapsed_sec = (float)((double)elapsed_ticks / armGetSystemTickFreq());
             float speed = (elapsed_sec > 0.0f)
                           ? ((float)offset / (1024.0f * 1024.0f)) / elapsed_sec : 0.0f;
-            TransferProgressEvent finalEvt(
-                std::string(obj.filename), offset, obj.size, 100.0f, speed);
-            EventBus::getInstance().post(finalEvt);
+            transfers.update(transfer_id, offset, speed);
         }
+        transfers.finish(transfer_id);
 
         send_response(ctx, MTP_RESP_OK, transaction_id, NULL, 0);
 
         TransferCompleteEvent completeEvt(
+            transfer_id,
             std::string(obj.filename),
             offset,
             !transfer_failed,
             transfer_failed ? "Gamecard read failed" : "");
-        EventBus::getInstance().post(completeEvt);
+        EventBus::getInstance().postAsync(completeEvt);
 
         return;
     }
@@ -972,20 +997,15 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
               handle, obj.filename, (unsigned long)obj.size);
 #endif
 
-    transfer_cancel_set(obj.full_path, false);
-
-    mutexLock(&g_transfer_mutex);
-    bool* cancel_ptr = &g_transfer_cancelled[obj.full_path];
-    mutexUnlock(&g_transfer_mutex);
-
+    TransferTable& transfers = TransferTable::getInstance();
+    TransferId transfer_id = transfers.begin(obj.full_path, obj.size);
     TransferStartEvent startEvent(
+        transfer_id,
         obj.full_path,
         obj.size,
         TransferStartEvent::Direction::Download
     );
-    startEvent.cancelled = false;
-    startEvent.cancelledPtr = cancel_ptr;
-    EventBus::getInstance().post(startEvent);
+    EventBus::getInstance().postAsync(startEvent);
 
     MtpContainerHeader* hdr = (MtpContainerHeader*)ctx->tx_buffer;
     hdr->length = sizeof(MtpContainerHeader) + obj.size;
@@ -1013,14 +1033,19 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
         // Double-buffered download: overlaps SD card reads with USB DMA writes.
         // Uses usbMtpWriteDirect (zero-copy) to avoid an extra memcpy per chunk.
         u8* read_buf = ctx->tx_buffer;
-        u8* write_buf = ctx->alt_buffer;
+        u8* write_buf = acquire_alt_buffer(ctx);
         s64 pending_write_size = 0;
         u64 progress_tick_interval = armGetSystemTickFreq() / 10;
+        MtpBackend read_backend = mtpStatsBackendForStorage(obj.storage_id);
         u64 last_progress_tick = transfer_start_time;
 
-        {
+        if (!write_buf) {
+            transfer_failed = true;
+        } else {
             u32 chunk_size = (remaining > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining;
+            u64 read_start = armGetSystemTick();
             s64 read = mtpStorageReadFile(file_handle, read_buf, chunk_size);
+            record_storage(read_backend, false, read, read_start);
             if (read <= 0) {
                 transfer_failed = true;
             } else {
@@ -1033,7 +1058,7 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
         while (!transfer_failed && pending_write_size > 0) {
             if (++chunks_since_cancel_check > 5) {
-                if (__atomic_load_n(cancel_ptr, __ATOMIC_ACQUIRE)) {
+                if (transfers.isCancelled(transfer_id)) {
                     transfer_failed = true;
                     break;
                 }
@@ -1051,10 +1076,17 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
             if (remaining_after > 0) {
                 u32 next_chunk = (remaining_after > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining_after;
+                TRACE_SCOPE_ARG("storage read", next_chunk);
+                u64 read_start = armGetSystemTick();
                 next_read_size = mtpStorageReadFile(file_handle, read_buf, next_chunk);
+                record_storage(read_backend, false, next_read_size, read_start);
             }
 
-            size_t usb_written = usbMtpWriteDirectFinish(MTP_TIMEOUT_NS);
+            size_t usb_written;
+            {
+                TRACE_SCOPE("usb write wait");
+                usb_written = usbMtpWriteDirectFinish(MTP_TIMEOUT_NS);
+            }
             if (usb_written == 0) {
                 transfer_failed = true;
                 break;
@@ -1064,14 +1096,12 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
 
             u64 now_ticks = armGetSystemTick();
             if ((now_ticks - last_progress_tick) >= progress_tick_interval) {
-                float percent = ((float)offset / obj.size) * 100.0f;
                 u64 recent_ticks = now_ticks - last_progress_ticks;
                 float recent_sec = (float)((double)recent_ticks / armGetSystemTickFreq());
                 u64 recent_bytes = offset - last_progress_bytes;
                 float speed = (recent_sec > 0.01f) ? (recent_bytes / (1024.0f * 1024.0f)) / recent_sec : 0.0f;
 
-                TransferProgressEvent progressEvent(obj.full_path, offset, obj.size, percent, speed);
-                EventBus::getInstance().post(progressEvent);
+                transfers.update(transfer_id, offset, speed);
                 last_progress_ticks = now_ticks;
                 last_progress_bytes = offset;
                 last_progress_tick = now_ticks;
@@ -1097,22 +1127,21 @@ static void handle_get_object(MtpProtocolContext* ctx, u32 transaction_id, u32 h
         u64 elapsed_ticks = armGetSystemTick() - transfer_start_time;
         float elapsed_sec = (float)((double)elapsed_ticks / armGetSystemTickFreq());
         float speed = (elapsed_sec > 0) ? (offset / (1024.0f * 1024.0f)) / elapsed_sec : 0.0f;
-        TransferProgressEvent finalProgressEvent(obj.full_path, offset, obj.size, 100.0f, speed);
-        EventBus::getInstance().post(finalProgressEvent);
+        transfers.update(transfer_id, offset, speed);
     }
 
     send_response(ctx, MTP_RESP_OK, transaction_id, NULL, 0);
 
-    bool was_cancelled = __atomic_load_n(cancel_ptr, __ATOMIC_ACQUIRE);
+    bool was_cancelled = transfers.isCancelled(transfer_id);
+    transfers.finish(transfer_id);
     TransferCompleteEvent completeEvent(
+        transfer_id,
         obj.full_path,
         offset,
         !transfer_failed,
         transfer_failed ? (was_cancelled ? "Transfer cancelled" : "Transfer failed") : ""
     );
-    EventBus::getInstance().post(completeEvent);
-
-    transfer_cancel_erase(obj.full_path);
+    EventBus::getInstance().postAsync(completeEvent);
 }
 
 static u32 g_pending_storage_id = 0;
@@ -1214,18 +1243,28 @@ static void handle_send_object_info(MtpProtocolContext* ctx, u32 transaction_id,
     send_response(ctx, MTP_RESP_OK, transaction_id, params, 3);
 }
 
-static inline s64 write_chunk(MtpProtocolContext* ctx, bool is_install, bool is_saves,
+static inline s64 write_chunk(MtpProtocolContext* ctx, bool is_install, SavesFileHandle* save_file,
                                MtpFileHandle* file_handle, u32 handle, u64 offset,
                                const void* buffer, size_t size) {
+    TRACE_SCOPE_ARG("storage write", size);
+    u64 write_start = armGetSystemTick();
+    s64 written;
+    MtpBackend backend;
     if (is_install) {
-        return installWriteObject(&ctx->install, handle, offset, buffer, size);
-    } else if (is_saves) {
-        return savesWriteObject(&ctx->saves, handle, offset, buffer, size);
+        written = installWriteObject(&ctx->install, handle, offset, buffer, size);
+        backend = MTP_BACKEND_INSTALL;
+    } else if (save_file) {
+        written = savesWriteFile(save_file, buffer, size);
+        backend = MTP_BACKEND_SAVES;
     } else if (file_handle) {
-        return mtpStorageWriteFile(file_handle, buffer, size);
+        written = mtpStorageWriteFile(file_handle, buffer, size);
+        backend = mtpStatsBackendForStorage(g_pending_storage_id);
     } else {
-        return mtpStorageWriteObject(&ctx->storage, handle, offset, buffer, size);
+        written = mtpStorageWriteObject(&ctx->storage, handle, offset, buffer, size);
+        backend = mtpStatsBackendForStorage(g_pending_storage_id);
     }
+    record_storage(backend, true, written, write_start);
+    return written;
 }
 
 static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
@@ -1258,40 +1297,30 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
         obj_filename[sizeof(obj_filename) - 1] = '\0';
     }
 
-    static std::unordered_map<u32, TransferStartEvent*> upload_events;
-    static std::unordered_map<u32, u64> upload_start_times;
-
-    transfer_cancel_set(std::string(obj_filename), false);
-
-    mutexLock(&g_transfer_mutex);
-    bool* cancel_ptr = &g_transfer_cancelled[std::string(obj_filename)];
-    mutexUnlock(&g_transfer_mutex);
+    // One table slot covers the upload and, for installs, the install it feeds
+    TransferTable& transfers = TransferTable::getInstance();
+    TransferId transfer_id = transfers.begin(obj_filename, g_pending_object_size);
+    u64 upload_start_time = armGetSystemTick();
 
     // Post different events for install vs transfer
     if (is_install) {
-        InstallStartEvent installStartEvt(obj_filename, obj_filename);
-        EventBus::getInstance().post(installStartEvt);
+        InstallStartEvent installStartEvt(transfer_id, obj_filename, obj_filename);
+        EventBus::getInstance().postAsync(installStartEvt);
     }
 
-    TransferStartEvent* startEvent = new TransferStartEvent(obj_filename, g_pending_object_size,
-                                                            TransferStartEvent::Direction::Upload);
-    startEvent->cancelledPtr = cancel_ptr;
-    upload_events[g_pending_object_handle] = startEvent;
-    upload_start_times[g_pending_object_handle] = armGetSystemTick();
-    EventBus::getInstance().post(*startEvent);
+    TransferStartEvent startEvent(transfer_id, obj_filename, g_pending_object_size,
+                                  TransferStartEvent::Direction::Upload);
+    EventBus::getInstance().postAsync(startEvent);
 
     size_t read_bytes = usbMtpRead(ctx->rx_buffer, ctx->buffer_size, MTP_TIMEOUT_NS);
     if (read_bytes < sizeof(MtpContainerHeader)) {
         send_response(ctx, MTP_RESP_GENERAL_ERROR, transaction_id, NULL, 0);
 
-        TransferCompleteEvent failEvent(obj_filename, 0, false, "Failed to read data header");
-        EventBus::getInstance().post(failEvent);
+        transfers.finish(transfer_id);
+        TransferCompleteEvent failEvent(transfer_id, obj_filename, 0, false, "Failed to read data header");
+        EventBus::getInstance().postAsync(failEvent);
 
-        u32 saved_handle = g_pending_object_handle;
         g_pending_object_handle = 0;
-        delete upload_events[saved_handle];
-        upload_events.erase(saved_handle);
-        transfer_cancel_erase(std::string(obj_filename));
         return;
     }
 
@@ -1299,26 +1328,27 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
     if (data_hdr->type != MTP_CONTAINER_TYPE_DATA) {
         send_response(ctx, MTP_RESP_GENERAL_ERROR, transaction_id, NULL, 0);
 
-        TransferCompleteEvent failEvent(obj_filename, 0, false, "Invalid data container type");
-        EventBus::getInstance().post(failEvent);
+        transfers.finish(transfer_id);
+        TransferCompleteEvent failEvent(transfer_id, obj_filename, 0, false, "Invalid data container type");
+        EventBus::getInstance().postAsync(failEvent);
 
-        u32 saved_handle = g_pending_object_handle;
         g_pending_object_handle = 0;
-        delete upload_events[saved_handle];
-        upload_events.erase(saved_handle);
-        transfer_cancel_erase(std::string(obj_filename));
         return;
     }
 
     u64 data_size = data_hdr->length - sizeof(MtpContainerHeader);
+    transfers.setTotal(transfer_id, data_size);
     u64 offset = 0;
     u64 total_written = 0;
-    u64 last_progress_ticks = upload_start_times[g_pending_object_handle];
+    u64 last_progress_ticks = upload_start_time;
     u64 last_progress_bytes = 0;
     u64 progress_tick_interval = armGetSystemTickFreq() / 10;
 
     MtpFileHandle* file_handle = nullptr;
-    if (!is_install && !is_saves) {
+    SavesFileHandle* save_file = nullptr;
+    if (is_saves) {
+        save_file = savesOpenWrite(&ctx->saves, g_pending_object_handle);
+    } else if (!is_install) {
         file_handle = mtpStorageOpenWrite(&ctx->storage, g_pending_object_handle);
     }
 
@@ -1326,7 +1356,7 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
         size_t first_chunk = read_bytes - sizeof(MtpContainerHeader);
         if (first_chunk > data_size) first_chunk = data_size;
 
-        s64 written = write_chunk(ctx, is_install, is_saves, file_handle,
+        s64 written = write_chunk(ctx, is_install, save_file, file_handle,
                                   g_pending_object_handle, 0,
                                   ctx->rx_buffer + sizeof(MtpContainerHeader), first_chunk);
         if (written > 0) {
@@ -1338,7 +1368,7 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
     // Double-buffered upload: overlaps storage writes with USB DMA reads.
     // While chunk N is written to storage, USB DMA for chunk N+1 is already in-flight.
     u8* read_buffer = ctx->rx_buffer;
-    u8* write_buffer = ctx->alt_buffer;
+    u8* write_buffer = acquire_alt_buffer(ctx);
     size_t pending_write_size = 0;
     u64 pending_write_offset = 0;
 
@@ -1346,7 +1376,7 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
     u64 chunks_since_cancel_check = 0;
 
     bool read_posted = false;
-    if (offset < data_size) {
+    if (offset < data_size && write_buffer) {
         u64 remaining = data_size - offset;
         u32 chunk_size = (remaining > USB_BUFFER_SIZE) ? USB_BUFFER_SIZE : (u32)remaining;
         read_posted = usbMtpReadDirectStart(read_buffer, chunk_size);
@@ -1354,7 +1384,7 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
 
     while (offset < data_size && read_posted) {
         if (++chunks_since_cancel_check > 5) {
-            if (__atomic_load_n(cancel_ptr, __ATOMIC_ACQUIRE)) {
+            if (transfers.isCancelled(transfer_id)) {
                 cancel_requested = true;
                 // Drain the in-flight DMA before aborting to avoid leaving the
                 // USB endpoint in a wedged state.
@@ -1365,7 +1395,7 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
         }
 
         if (pending_write_size > 0) {
-            s64 written = write_chunk(ctx, is_install, is_saves, file_handle,
+            s64 written = write_chunk(ctx, is_install, save_file, file_handle,
                                       g_pending_object_handle, pending_write_offset,
                                       write_buffer, pending_write_size);
             if (written > 0) {
@@ -1373,14 +1403,17 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
 
                 u64 now_ticks = armGetSystemTick();
                 if ((now_ticks - last_progress_ticks) > progress_tick_interval) {
-                    float percent = (float)total_written / data_size * 100.0f;
                     u64 recent_ticks = now_ticks - last_progress_ticks;
                     float recent_sec = (float)((double)recent_ticks / armGetSystemTickFreq());
                     u64 recent_bytes = total_written - last_progress_bytes;
                     float speed = (recent_sec > 0.01f) ? (recent_bytes / (1024.0f * 1024.0f)) / recent_sec : 0.0f;
 
-                    // Post install-specific events with stage information
+                    transfers.update(transfer_id, total_written, speed);
+
                     if (is_install && ctx->install.stream_ctx) {
+                        StreamInstallContext* sctx = ctx->install.stream_ctx;
+                        mtpStatsSetGauge(MTP_GAUGE_INSTALL_BUFFER, sctx->buffer_pos - sctx->read_pos);
+
                         // Check if we need to prompt user about personalized ticket (only once)
                         if (streamInstallShouldPostTicketEvent(ctx->install.stream_ctx)) {
                             u8 rights_id[16];
@@ -1394,32 +1427,25 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
                                 PersonalizedTicketEvent ticketEvt(display_name, display_name,
                                                                  rights_id, device_id, account_id,
                                                                  ctx->install.stream_ctx);
-                                EventBus::getInstance().post(ticketEvt);
+                                EventBus::getInstance().postAsync(ticketEvt);
                                 LOG_INFO("MTP: Posted PersonalizedTicketEvent for %s", display_name);
                             }
                         }
 
-                        const char* stage = streamInstallGetStageString(ctx->install.stream_ctx);
-
-                        // Use filename from stream context instead of MTP object name
-                        const char* display_name = ctx->install.stream_ctx->filename;
-                        if (display_name[0] == '\0') {
-                            display_name = obj_filename;  // Fallback to MTP object name
-                        }
-
-                        InstallProgressEvent installProgressEvt(display_name, "", percent, total_written, data_size, stage);
-                        EventBus::getInstance().post(installProgressEvt);
+                        transfers.setStage(transfer_id, streamInstallGetStageString(ctx->install.stream_ctx));
                     }
 
-                    TransferProgressEvent progressEvent(obj_filename, total_written, data_size, percent, speed);
-                    EventBus::getInstance().post(progressEvent);
                     last_progress_ticks = now_ticks;
                     last_progress_bytes = total_written;
                 }
             }
         }
 
-        size_t chunk_read = usbMtpReadDirectFinish(MTP_TIMEOUT_NS);
+        size_t chunk_read;
+        {
+            TRACE_SCOPE("usb read wait");
+            chunk_read = usbMtpReadDirectFinish(MTP_TIMEOUT_NS);
+        }
         if (chunk_read == 0) {
             break;
         }
@@ -1441,7 +1467,7 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
     }
 
     if (!cancel_requested && pending_write_size > 0) {
-        s64 written = write_chunk(ctx, is_install, is_saves, file_handle,
+        s64 written = write_chunk(ctx, is_install, save_file, file_handle,
                                   g_pending_object_handle, pending_write_offset,
                                   write_buffer, pending_write_size);
         if (written > 0) {
@@ -1455,21 +1481,20 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
         file_handle = nullptr;
     }
 
+    if (save_file) {
+        savesCloseFile(save_file);
+        save_file = nullptr;
+    }
+
     {
-        float percent = (data_size > 0) ? (float)total_written / data_size * 100.0f : 100.0f;
-        u64 elapsed_ticks = armGetSystemTick() - upload_start_times[g_pending_object_handle];
+        u64 elapsed_ticks = armGetSystemTick() - upload_start_time;
         float elapsed_sec = (float)((double)elapsed_ticks / armGetSystemTickFreq());
         float speed = (elapsed_sec > 0) ? (total_written / (1024.0f * 1024.0f)) / elapsed_sec : 0.0f;
 
-        // Post install-specific final progress event with stage
+        transfers.update(transfer_id, total_written, speed);
         if (is_install && ctx->install.stream_ctx) {
-            const char* stage = streamInstallGetStageString(ctx->install.stream_ctx);
-            InstallProgressEvent installProgressEvt(obj_filename, "", percent, total_written, data_size, stage);
-            EventBus::getInstance().post(installProgressEvt);
+            transfers.setStage(transfer_id, streamInstallGetStageString(ctx->install.stream_ctx));
         }
-
-        TransferProgressEvent progressEvent(obj_filename, total_written, data_size, percent, speed);
-        EventBus::getInstance().post(progressEvent);
     }
 
     u32 saved_handle = g_pending_object_handle;
@@ -1493,7 +1518,10 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
         }
     } else if (was_saves) {
         if (total_written > 0 && !was_cancelled) {
-            savesCommitObject(&ctx->saves, saved_handle);
+            // Archive restores only commit if the whole stream extracted cleanly
+            if (!savesCommitObject(&ctx->saves, saved_handle)) {
+                transfer_success = false;
+            }
         } else {
             savesDeleteObject(&ctx->saves, saved_handle);
             transfer_success = false;
@@ -1507,21 +1535,18 @@ static void handle_send_object(MtpProtocolContext* ctx, u32 transaction_id) {
         }
     }
 
+    transfers.finish(transfer_id);
+
     // Post install-specific complete event
     if (was_install) {
-        InstallCompleteEvent installCompleteEvt(obj_filename, transfer_success,
+        InstallCompleteEvent installCompleteEvt(transfer_id, obj_filename, transfer_success,
                                                transfer_success ? "" : (was_cancelled ? "Installation cancelled" : "Installation failed"));
-        EventBus::getInstance().post(installCompleteEvt);
+        EventBus::getInstance().postAsync(installCompleteEvt);
     }
 
-    TransferCompleteEvent completeEvent(obj_filename, total_written, transfer_success,
+    TransferCompleteEvent completeEvent(transfer_id, obj_filename, total_written, transfer_success,
                                        transfer_success ? "" : (was_cancelled ? "Transfer cancelled" : "Transfer failed"));
-    EventBus::getInstance().post(completeEvent);
-
-    delete upload_events[saved_handle];
-    upload_events.erase(saved_handle);
-    upload_start_times.erase(saved_handle);
-    transfer_cancel_erase(std::string(obj_filename));
+    EventBus::getInstance().postAsync(completeEvent);
 
     if (was_cancelled) {
         send_response(ctx, MTP_RESP_TRANSACTION_CANCELLED, transaction_id, NULL, 0);
@@ -1558,6 +1583,65 @@ static void handle_delete_object(MtpProtocolContext* ctx, u32 transaction_id, u3
     }
 }
 
+// Only renames are supported, and only where a name means something: folders in
+// the saves Snapshots tree, which start a snapshot or restore when renamed
+static void handle_set_object_prop_value(MtpProtocolContext* ctx, u32 transaction_id,
+                                          u32 handle, u32 prop_code) {
+    if (!ctx->session_open) {
+        send_response(ctx, MTP_RESP_SESSION_NOT_OPEN, transaction_id, NULL, 0);
+        return;
+    }
+
+    // The data phase comes first whatever the answer
+    size_t read_bytes = usbMtpRead(ctx->rx_buffer, ctx->buffer_size, MTP_TIMEOUT_NS);
+    if (read_bytes < sizeof(MtpContainerHeader)) {
+        send_response(ctx, MTP_RESP_GENERAL_ERROR, transaction_id, NULL, 0);
+        return;
+    }
+
+    MtpContainerHeader* data_hdr = (MtpContainerHeader*)ctx->rx_buffer;
+    if (data_hdr->type != MTP_CONTAINER_TYPE_DATA) {
+        send_response(ctx, MTP_RESP_GENERAL_ERROR, transaction_id, NULL, 0);
+        return;
+    }
+
+    if (prop_code != MTP_PROP_OBJECT_FILE_NAME) {
+        send_response(ctx, MTP_RESP_INVALID_OBJECT_PROP_CODE, transaction_id, NULL, 0);
+        return;
+    }
+    if (!savesIsVirtualHandle(handle)) {
+        send_response(ctx, MTP_RESP_OPERATION_NOT_SUPPORTED, transaction_id, NULL, 0);
+        return;
+    }
+
+    u8* str_ptr = ctx->rx_buffer + sizeof(MtpContainerHeader);
+    size_t str_avail = read_bytes - sizeof(MtpContainerHeader);
+
+    char filename[MTP_MAX_FILENAME];
+    memset(filename, 0, sizeof(filename));
+
+    u8 str_len = str_avail > 0 ? str_ptr[0] : 0;
+    if (str_len > 0 && str_len < 128 && 1 + (size_t)str_len * 2 <= str_avail) {
+        utf16le_to_utf8(str_ptr + 1, str_len - 1, filename, sizeof(filename));
+    }
+    sanitize_filename_fat32(filename);
+
+    if (filename[0] == '\0') {
+        send_response(ctx, MTP_RESP_INVALID_PARAMETER, transaction_id, NULL, 0);
+        return;
+    }
+
+#if DEBUG_MTP_PROTO
+    LOG_DEBUG("SetObjectPropValue: handle=0x%08X, name='%s'", handle, filename);
+#endif
+
+    if (savesRenameObject(&ctx->saves, handle, filename)) {
+        send_response(ctx, MTP_RESP_OK, transaction_id, NULL, 0);
+    } else {
+        send_response(ctx, MTP_RESP_OBJECT_WRITE_PROTECTED, transaction_id, NULL, 0);
+    }
+}
+
 Result mtpProtocolInit(MtpProtocolContext* ctx) {
     memset(ctx, 0, sizeof(MtpProtocolContext));
 
@@ -1568,16 +1652,18 @@ Result mtpProtocolInit(MtpProtocolContext* ctx) {
     if (buffer_size > MTP_BUFFER_MAX) buffer_size = MTP_BUFFER_MAX;
     LOG_INFO("MTP: Initializing with buffer size: %zu KB", buffer_size / 1024);
 
-    ctx->rx_buffer = (u8*)memalign(0x1000, buffer_size);
-    ctx->tx_buffer = (u8*)memalign(0x1000, buffer_size);
-    ctx->alt_buffer = (u8*)memalign(0x1000, buffer_size);
+    // Data phases move up to USB_BUFFER_SIZE per chunk whatever the setting,
+    // so no buffer may be smaller than that. alt_buffer is taken per operation.
+    ctx->buffer_size = buffer_size;
+    ctx->rx_block = bufferPoolAcquire(buffer_size > USB_BUFFER_SIZE ? buffer_size : USB_BUFFER_SIZE, BUFFER_TAG_MTP);
+    ctx->tx_block = bufferPoolAcquire(buffer_size > USB_BUFFER_SIZE ? buffer_size : USB_BUFFER_SIZE, BUFFER_TAG_MTP);
 
-    if (!ctx->rx_buffer || !ctx->tx_buffer || !ctx->alt_buffer) {
+    if (!ctx->rx_block || !ctx->tx_block) {
         mtpProtocolExit(ctx);
         return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
     }
-
-    ctx->buffer_size = buffer_size;
+    ctx->rx_buffer = ctx->rx_block->data;
+    ctx->tx_buffer = ctx->tx_block->data;
 
     Result rc = mtpStorageInit(&ctx->storage);
     if (R_FAILED(rc)) {
@@ -1600,24 +1686,21 @@ void mtpProtocolExit(MtpProtocolContext* ctx) {
     installExit(&ctx->install);
     mtpStorageExit(&ctx->storage);
 
-    if (ctx->rx_buffer) {
-        free(ctx->rx_buffer);
-        ctx->rx_buffer = NULL;
-    }
-    if (ctx->tx_buffer) {
-        free(ctx->tx_buffer);
-        ctx->tx_buffer = NULL;
-    }
-    if (ctx->alt_buffer) {
-        free(ctx->alt_buffer);
-        ctx->alt_buffer = NULL;
-    }
+    release_alt_buffer(ctx);
+    bufferRelease(ctx->rx_block);
+    bufferRelease(ctx->tx_block);
+
+    BufferPoolStats pool;
+    bufferPoolGetStats(&pool);
+    LOG_INFO("MTP: Buffer pool peak %lu KB in use, %lu KB held",
+             (unsigned long)(pool.peakInUse / 1024), (unsigned long)(pool.peakHeld / 1024));
 
     memset(ctx, 0, sizeof(MtpProtocolContext));
 }
 
 static bool s_logged_usb_ready = false;
 static u64 s_usb_check_count = 0;
+static u64 s_last_command_tick = 0;
 
 bool mtpProtocolProcess(MtpProtocolContext* ctx) {
     if (!usbMtpIsReady()) {
@@ -1628,6 +1711,8 @@ bool mtpProtocolProcess(MtpProtocolContext* ctx) {
 #endif
         }
         s_logged_usb_ready = false;
+        // Cable pulled mid-batch: don't leave save writes uncommitted
+        savesCommitPending(&ctx->saves);
         return true;
     }
 
@@ -1640,9 +1725,17 @@ bool mtpProtocolProcess(MtpProtocolContext* ctx) {
     size_t read_bytes = usbMtpRead(ctx->rx_buffer, ctx->buffer_size, 10000000ULL);
 
     if (read_bytes == 0) {
+        // Commit save writes once the host has gone quiet, so a multi-file copy
+        // into a save lands as one transaction instead of one commit per file.
+        if (savesHasPendingCommits(&ctx->saves) &&
+            armTicksToNs(armGetSystemTick() - s_last_command_tick) > SAVES_COMMIT_IDLE_NS) {
+            savesCommitPending(&ctx->saves);
+        }
         return true;
     }
 
+    s_last_command_tick = armGetSystemTick();
+
     if (read_bytes < sizeof(MtpContainerHeader)) {
         return true;
     }
@@ -1668,6 +1761,13 @@ bool mtpProtocolProcess(MtpProtocolContext* ctx) {
         LOG_DEBUG("MTP Command: 0x%04X, txn=%u, payload=%u bytes",
                  hdr->code, hdr->transaction_id, payload_size);
 
+        TRACE_SCOPE_ARG(mtpOperationName(hdr->code), hdr->transaction_id);
+
+        // The data phase may reuse rx_buffer, so keep the opcode
+        u16 op_code = hdr->code;
+        u64 op_start = armGetSystemTick();
+        u64 op_usb_start = mtpStatsUsbBytes();
+
         switch (hdr->code) {
             case MTP_OP_GET_DEVICE_INFO:
                 handle_get_device_info(ctx, hdr->transaction_id);
@@ -1728,10 +1828,21 @@ bool mtpProtocolProcess(MtpProtocolContext* ctx) {
                 handle_delete_object(ctx, hdr->transaction_id, payload_size >= 4 ? params[0] : 0);
                 break;
 
+            case MTP_OP_SET_OBJECT_PROP_VALUE:
+                handle_set_object_prop_value(ctx, hdr->transaction_id,
+                                             payload_size >= 4 ? params[0] : 0,
+                                             payload_size >= 8 ? params[1] : 0);
+                break;
+
             default:
                 send_response(ctx, MTP_RESP_OPERATION_NOT_SUPPORTED, hdr->transaction_id, NULL, 0);
                 break;
         }
+
+        mtpStatsRecordOp(op_code, armGetSystemTick() - op_start, mtpStatsUsbBytes() - op_usb_start);
+
+        // Back to the pool, where install and dump can use it between transfers
+        release_alt_buffer(ctx);
     }
 
     return true;
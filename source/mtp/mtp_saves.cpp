@@ -3,15 +3,20 @@
 //
 #include "mtp/mtp_saves.h"
 #include "mtp/mtp_log.h"
+#include "mtp/mtp_tar.h"
+#include "mtp/mtp_saves_snapshot.h"
+#include "service/title_cache.h"
+#include "service/services.h"
+#include "core/ThreadRoles.h"
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <dirent.h>
-#include <sys/stat.h>
 #include <sys/statvfs.h>
-
-#define SAVES_MOUNT_PREFIX "sv"
+#include <sys/stat.h>
+#include <time.h>
 
 typedef struct {
     u64 application_id;
@@ -21,95 +26,293 @@ typedef struct {
     u16 save_data_index;
 } SaveInfoEntry;
 
-#define MAX_SAVE_INFO_ENTRIES 4096
-static SaveInfoEntry s_save_info[MAX_SAVE_INFO_ENTRIES];
+static SaveInfoEntry* s_save_info = NULL;
 static u32 s_save_info_count = 0;
+static u32 s_save_info_capacity = 0;
 
 static void start_background_refresh(SavesContext* ctx);
 static void stop_background_refresh(void);
 static void do_refresh_internal(SavesContext* ctx);
+static bool commit_save_type(SavesContext* ctx, SaveTypeEntry* type);
+static void archive_release_type(u32 type_handle);
+static bool archive_pins_type(u32 type_handle);
+static void snapshot_close_archive(void);
+static bool snapshot_job_busy(void);
+static void snapshot_job_stop(void);
+
+#define SLOT_NONE 0xFFFFFFFF
+
+// Handle with the generation bits stripped
+static u32 handle_base(u32 handle) {
+    return handle & ((1u << MTP_HANDLE_SAVES_GEN_SHIFT) - 1);
+}
 
 static bool is_game_handle(u32 handle) {
-    return handle >= MTP_HANDLE_SAVES_GAME_START && handle <= MTP_HANDLE_SAVES_GAME_END;
+    u32 h = handle_base(handle);
+    return h >= MTP_HANDLE_SAVES_GAME_START && h <= MTP_HANDLE_SAVES_GAME_END;
 }
 
 static bool is_user_handle(u32 handle) {
-    return handle >= MTP_HANDLE_SAVES_USER_START && handle <= MTP_HANDLE_SAVES_USER_END;
+    u32 h = handle_base(handle);
+    return h >= MTP_HANDLE_SAVES_USER_START && h <= MTP_HANDLE_SAVES_USER_END;
 }
 
 static bool is_type_handle(u32 handle) {
-    return handle >= MTP_HANDLE_SAVES_TYPE_START && handle <= MTP_HANDLE_SAVES_TYPE_END;
+    u32 h = handle_base(handle);
+    return h >= MTP_HANDLE_SAVES_TYPE_START && h <= MTP_HANDLE_SAVES_TYPE_END;
 }
 
 static bool is_file_handle(u32 handle) {
-    return handle >= MTP_HANDLE_SAVES_FILE_START;
+    u32 h = handle_base(handle);
+    return h >= MTP_HANDLE_SAVES_FILE_START && h <= MTP_HANDLE_SAVES_FILE_END;
 }
 
-static u32 get_game_index(u32 handle) {
-    if (!is_game_handle(handle)) return 0xFFFFFFFF;
-    return handle - MTP_HANDLE_SAVES_GAME_START;
+static bool is_snapshot_handle(u32 handle) {
+    u32 h = handle_base(handle);
+    return h >= MTP_HANDLE_SAVES_SNAPSHOT_START && h <= MTP_HANDLE_SAVES_SNAPSHOT_END;
 }
 
-static u32 make_game_handle(u32 index) {
-    return MTP_HANDLE_SAVES_GAME_START + index;
+static u32 make_handle(u32 range_start, u32 slot, u8 generation) {
+    return ((u32)(generation & 0xF) << MTP_HANDLE_SAVES_GEN_SHIFT) | (range_start + slot);
 }
 
-typedef struct {
-    u64 app_id;
-    char name[256];
-    bool is_installed;
-    bool fetched;
-} NameCacheEntry;
-
-#define NAME_CACHE_SIZE 256
-static NameCacheEntry s_name_cache[NAME_CACHE_SIZE];
-static u32 s_name_cache_count = 0;
-static Mutex s_name_cache_mutex = {0};  // Zero-initialized is valid for libnx Mutex
-
-static NameCacheEntry* get_name_cache_entry(u64 app_id) {
-    mutexLock(&s_name_cache_mutex);
-
-    for (u32 i = 0; i < s_name_cache_count; i++) {
-        if (s_name_cache[i].app_id == app_id) {
-            mutexUnlock(&s_name_cache_mutex);
-            return &s_name_cache[i];
-        }
+// ---------------------------------------------------------------------------
+// Pools and names
+//
+// Entries are allocated on demand in chunks, so memory follows the number of
+// saves actually present and browsed. Slots are capped only by their handle
+// range, and freed slots are reused with a bumped generation.
+// ---------------------------------------------------------------------------
+
+#define POOL_CHUNK_ENTRIES  128
+#define NAME_BLOCK_SIZE     8192
+
+struct SavesNameBlock {
+    SavesNameBlock* next;
+    u32 used;
+    u32 size;
+    // Followed by size bytes of string data
+};
+
+static void pool_init(SavesPool* p, u32 entry_size) {
+    memset(p, 0, sizeof(SavesPool));
+    p->entry_size = entry_size;
+}
+
+static void pool_clear(SavesPool* p) {
+    for (u32 i = 0; i < p->chunk_count; i++) free(p->chunks[i]);
+    free(p->chunks);
+    free(p->free_slots);
+    pool_init(p, p->entry_size);
+}
+
+static void* pool_at(const SavesPool* p, u32 slot) {
+    if (slot >= p->count) return NULL;
+    return (u8*)p->chunks[slot / POOL_CHUNK_ENTRIES] + (size_t)(slot % POOL_CHUNK_ENTRIES) * p->entry_size;
+}
+
+// Returns a slot (contents left as the previous user left them), or SLOT_NONE
+static u32 pool_alloc(SavesPool* p, u32 max_slots) {
+    if (p->free_count > 0) {
+        p->live++;
+        return p->free_slots[--p->free_count];
+    }
+    if (p->count >= max_slots) return SLOT_NONE;
+
+    if (p->count == p->chunk_count * POOL_CHUNK_ENTRIES) {
+        void** chunks = (void**)realloc(p->chunks, sizeof(void*) * (p->chunk_count + 1));
+        if (!chunks) return SLOT_NONE;
+        p->chunks = chunks;
+
+        void* chunk = calloc(POOL_CHUNK_ENTRIES, p->entry_size);
+        if (!chunk) return SLOT_NONE;
+        p->chunks[p->chunk_count++] = chunk;
     }
+    p->live++;
+    return p->count++;
+}
 
-    if (s_name_cache_count < NAME_CACHE_SIZE) {
-        NameCacheEntry* entry = &s_name_cache[s_name_cache_count++];
-        entry->app_id = app_id;
-        entry->fetched = false;
-        entry->is_installed = false;
-        snprintf(entry->name, sizeof(entry->name), "%016lX", app_id);
-        mutexUnlock(&s_name_cache_mutex);
-        return entry;
+static void pool_release(SavesPool* p, u32 slot) {
+    if (p->free_count >= p->free_capacity) {
+        u32 cap = p->free_capacity ? p->free_capacity * 2 : 64;
+        u32* slots = (u32*)realloc(p->free_slots, sizeof(u32) * cap);
+        if (!slots) return;  // Slot leaks until the next refresh
+        p->free_slots = slots;
+        p->free_capacity = cap;
     }
+    p->free_slots[p->free_count++] = slot;
+    p->live--;
+}
 
-    mutexUnlock(&s_name_cache_mutex);
-    return NULL;
+static u32 name_hash(const char* s) {
+    u32 h = 2166136261u;
+    while (*s) h = (h ^ (u8)*s++) * 16777619u;
+    return h;
+}
+
+static void names_clear(SavesNames* n) {
+    for (SavesNameBlock* b = n->blocks; b; ) {
+        SavesNameBlock* next = b->next;
+        free(b);
+        b = next;
+    }
+    free(n->table);
+    memset(n, 0, sizeof(SavesNames));
+}
+
+static bool names_grow_table(SavesNames* n) {
+    u32 size = n->table_size ? n->table_size * 2 : 1024;
+    const char** table = (const char**)calloc(size, sizeof(const char*));
+    if (!table) return false;
+
+    for (u32 i = 0; i < n->table_size; i++) {
+        const char* s = n->table[i];
+        if (!s) continue;
+        u32 j = name_hash(s) & (size - 1);
+        while (table[j]) j = (j + 1) & (size - 1);
+        table[j] = s;
+    }
+    free(n->table);
+    n->table = table;
+    n->table_size = size;
+    return true;
 }
 
-static void fetch_name_for_entry(NameCacheEntry* entry) {
-    if (!entry || entry->fetched) return;
+// Returns the interned copy of s; the pointer stays valid until names_clear()
+static const char* names_intern(SavesNames* n, const char* s) {
+    if ((n->count + 1) * 4 > n->table_size * 3 && !names_grow_table(n)) return NULL;
 
-    NsApplicationControlData ctrl;
-    u64 actual = 0;
-    Result rc = nsGetApplicationControlData(NsApplicationControlSource_Storage, entry->app_id, &ctrl, sizeof(ctrl), &actual);
+    u32 mask = n->table_size - 1;
+    u32 i = name_hash(s) & mask;
+    for (; n->table[i]; i = (i + 1) & mask) {
+        if (strcmp(n->table[i], s) == 0) return n->table[i];
+    }
 
-    if (R_SUCCEEDED(rc) && actual >= sizeof(ctrl.nacp)) {
-        entry->is_installed = true;
-        for (int i = 0; i < 16; i++) {
-            if (ctrl.nacp.lang[i].name[0]) {
-                mutexLock(&s_name_cache_mutex);
-                strncpy(entry->name, ctrl.nacp.lang[i].name, sizeof(entry->name) - 1);
-                entry->name[sizeof(entry->name) - 1] = '\0';
-                mutexUnlock(&s_name_cache_mutex);
-                break;
-            }
-        }
+    u32 len = (u32)strlen(s) + 1;
+    SavesNameBlock* b = n->blocks;
+    if (!b || b->size - b->used < len) {
+        u32 size = len > NAME_BLOCK_SIZE ? len : NAME_BLOCK_SIZE;
+        b = (SavesNameBlock*)malloc(sizeof(SavesNameBlock) + size);
+        if (!b) return NULL;
+        b->next = n->blocks;
+        b->used = 0;
+        b->size = size;
+        n->blocks = b;
+        n->bytes += size;
     }
-    entry->fetched = true;
+
+    char* out = (char*)(b + 1) + b->used;
+    memcpy(out, s, len);
+    b->used += len;
+
+    n->table[i] = out;
+    n->count++;
+    return out;
+}
+
+// Interned name, or an empty string if the arena is out of memory
+static const char* intern_name(SavesContext* ctx, const char* s) {
+    const char* out = names_intern(&ctx->names, s);
+    return out ? out : "";
+}
+
+static GameSaveEntry* game_at(SavesContext* ctx, u32 index) {
+    return (GameSaveEntry*)pool_at(&ctx->games, index);
+}
+
+static SaveTypeEntry* type_at(SavesContext* ctx, u32 slot) {
+    SaveTypeEntry* t = (SaveTypeEntry*)pool_at(&ctx->types, slot);
+    return (t && t->handle) ? t : NULL;
+}
+
+static u32 get_type_index(SaveTypeEntry* type) {
+    return handle_base(type->handle) - MTP_HANDLE_SAVES_TYPE_START;
+}
+
+static UserFolderEntry* alloc_user_folder(SavesContext* ctx) {
+    u32 slot = pool_alloc(&ctx->user_folders, MTP_HANDLE_SAVES_USER_END - MTP_HANDLE_SAVES_USER_START + 1);
+    if (slot == SLOT_NONE) return NULL;
+    UserFolderEntry* uf = (UserFolderEntry*)pool_at(&ctx->user_folders, slot);
+    u8 gen = uf->generation;
+    memset(uf, 0, sizeof(UserFolderEntry));
+    uf->generation = gen;
+    uf->handle = make_handle(MTP_HANDLE_SAVES_USER_START, slot, gen);
+    return uf;
+}
+
+static SaveTypeEntry* alloc_type(SavesContext* ctx) {
+    u32 slot = pool_alloc(&ctx->types, MTP_HANDLE_SAVES_TYPE_END - MTP_HANDLE_SAVES_TYPE_START + 1);
+    if (slot == SLOT_NONE) return NULL;
+    SaveTypeEntry* t = (SaveTypeEntry*)pool_at(&ctx->types, slot);
+    u8 gen = t->generation;
+    memset(t, 0, sizeof(SaveTypeEntry));
+    t->generation = gen;
+    t->handle = make_handle(MTP_HANDLE_SAVES_TYPE_START, slot, gen);
+    return t;
+}
+
+static SaveFileEntry* alloc_file(SavesContext* ctx) {
+    u32 slot = pool_alloc(&ctx->files, MTP_HANDLE_SAVES_FILE_END - MTP_HANDLE_SAVES_FILE_START + 1);
+    if (slot == SLOT_NONE) return NULL;
+    SaveFileEntry* f = (SaveFileEntry*)pool_at(&ctx->files, slot);
+    u8 gen = f->generation;
+    memset(f, 0, sizeof(SaveFileEntry));
+    f->generation = gen;
+    f->handle = make_handle(MTP_HANDLE_SAVES_FILE_START, slot, gen);
+    return f;
+}
+
+// Release a slot; the bumped generation invalidates handles the host still holds
+static void free_user_folder(SavesContext* ctx, UserFolderEntry* uf) {
+    u32 slot = handle_base(uf->handle) - MTP_HANDLE_SAVES_USER_START;
+    uf->handle = 0;
+    uf->generation++;
+    pool_release(&ctx->user_folders, slot);
+}
+
+static void free_type(SavesContext* ctx, SaveTypeEntry* t) {
+    u32 slot = get_type_index(t);
+    t->handle = 0;
+    t->generation++;
+    pool_release(&ctx->types, slot);
+}
+
+static void free_file(SavesContext* ctx, SaveFileEntry* f) {
+    u32 slot = handle_base(f->handle) - MTP_HANDLE_SAVES_FILE_START;
+    f->handle = 0;
+    f->generation++;
+    pool_release(&ctx->files, slot);
+}
+
+static SnapshotNode* alloc_snapshot_node(SavesContext* ctx) {
+    u32 slot = pool_alloc(&ctx->snapshot_nodes, MTP_HANDLE_SAVES_SNAPSHOT_END - MTP_HANDLE_SAVES_SNAPSHOT_START + 1);
+    if (slot == SLOT_NONE) return NULL;
+    SnapshotNode* n = (SnapshotNode*)pool_at(&ctx->snapshot_nodes, slot);
+    u8 gen = n->generation;
+    memset(n, 0, sizeof(SnapshotNode));
+    n->generation = gen;
+    n->handle = make_handle(MTP_HANDLE_SAVES_SNAPSHOT_START, slot, gen);
+    return n;
+}
+
+static void free_snapshot_node(SavesContext* ctx, SnapshotNode* n) {
+    u32 slot = handle_base(n->handle) - MTP_HANDLE_SAVES_SNAPSHOT_START;
+    n->handle = 0;
+    n->generation++;
+    pool_release(&ctx->snapshot_nodes, slot);
+}
+
+static void clear_model(SavesContext* ctx) {
+    pool_clear(&ctx->snapshot_nodes);
+    memset(&ctx->snapshot_root, 0, sizeof(ctx->snapshot_root));
+    ctx->snapshots_scanned = false;
+    pool_clear(&ctx->files);
+    pool_clear(&ctx->types);
+    pool_clear(&ctx->user_folders);
+    pool_clear(&ctx->games);
+    names_clear(&ctx->names);
+    ctx->built_game_count = 0;
+    ctx->browse_clock = 0;
 }
 
 static u64 get_base_title_id(u64 app_id) {
@@ -131,45 +334,31 @@ static const char* get_title_type_string(u64 app_id) {
     }
 }
 
+// Display name from the title cache. DLC and updates are named after their base
+// game. Returns false if the title itself has no known name (not installed).
 static bool check_installation_status(u64 app_id, char* name_out, size_t name_size) {
-    NameCacheEntry* entry = get_name_cache_entry(app_id);
-    if (!entry) {
-        snprintf(name_out, name_size, "%016lX", app_id);
-        return false;
-    }
-
-    if (!entry->fetched) {
-        fetch_name_for_entry(entry);
-    }
-
     u64 type = (app_id >> 48) & 0xFFFF;
     if (type == 0x0101 || type == 0x0102) {
-        u64 base_id = get_base_title_id(app_id);
-
-        NameCacheEntry* base_entry = get_name_cache_entry(base_id);
-        if (base_entry && !base_entry->fetched) {
-            fetch_name_for_entry(base_entry);
-        }
-
-        if (base_entry && base_entry->fetched && base_entry->name[0]) {
+        char base_name[256];
+        if (titleCacheLookup(get_base_title_id(app_id), base_name, sizeof(base_name))) {
             if (type == 0x0101) {
                 u32 dlc_num = app_id & 0xFFF;
                 if (dlc_num > 0) {
-                    snprintf(name_out, name_size, "%s [DLC %u]", base_entry->name, dlc_num);
+                    snprintf(name_out, name_size, "%s [DLC %u]", base_name, dlc_num);
                 } else {
-                    snprintf(name_out, name_size, "%s [DLC]", base_entry->name);
+                    snprintf(name_out, name_size, "%s [DLC]", base_name);
                 }
             } else {
-                snprintf(name_out, name_size, "%s [Update]", base_entry->name);
+                snprintf(name_out, name_size, "%s [Update]", base_name);
             }
             name_out[name_size - 1] = '\0';
             return true;
         }
     }
 
-    strncpy(name_out, entry->name, name_size - 1);
-    name_out[name_size - 1] = '\0';
-    return entry->is_installed;
+    if (titleCacheLookup(app_id, name_out, name_size)) return true;
+    snprintf(name_out, name_size, "%016lX", app_id);
+    return false;
 }
 
 static bool enumerate_all_users(SavesContext* ctx) {
@@ -244,60 +433,218 @@ static bool has_save_info(u64 app_id, AccountUid uid, u8 save_type, u8 space_id,
 }
 
 static GameSaveEntry* find_or_create_game_fast(SavesContext* ctx, u64 app_id) {
-    for (u32 i = 0; i < ctx->game_count; i++) {
-        if (ctx->games[i].application_id == app_id) {
-            return &ctx->games[i];
+    for (u32 i = 0; i < ctx->games.count; i++) {
+        GameSaveEntry* g = game_at(ctx, i);
+        if (g->application_id == app_id) {
+            return g;
         }
     }
 
-    if (ctx->game_count >= ctx->max_games) return NULL;
+    u32 idx = pool_alloc(&ctx->games, MTP_HANDLE_SAVES_GAME_END - MTP_HANDLE_SAVES_GAME_START + 1);
+    if (idx == SLOT_NONE) return NULL;
 
-    GameSaveEntry* g = &ctx->games[ctx->game_count];
+    GameSaveEntry* g = game_at(ctx, idx);
     memset(g, 0, sizeof(GameSaveEntry));
 
+    char name[256];
     g->application_id = app_id;
-    g->game_index = ctx->game_count;
-    g->folder_handle = make_game_handle(ctx->game_count);
-    g->is_installed = check_installation_status(app_id, g->game_name, sizeof(g->game_name));
-
-    ctx->game_count++;
+    g->game_index = idx;
+    g->folder_handle = make_handle(MTP_HANDLE_SAVES_GAME_START, idx, 0);
+    g->is_installed = check_installation_status(app_id, name, sizeof(name));
+    g->game_name = intern_name(ctx, name);
     return g;
 }
 
+static GameSaveEntry* find_game_by_handle(SavesContext* ctx, u32 handle) {
+    if (!is_game_handle(handle)) return NULL;
+    GameSaveEntry* g = game_at(ctx, handle_base(handle) - MTP_HANDLE_SAVES_GAME_START);
+    return (g && g->folder_handle == handle) ? g : NULL;
+}
+
 static SaveTypeEntry* find_type_by_handle(SavesContext* ctx, u32 handle) {
-    for (u32 i = 0; i < ctx->type_count; i++) {
-        if (ctx->types[i].handle == handle) return &ctx->types[i];
-    }
-    return NULL;
+    if (!is_type_handle(handle)) return NULL;
+    SaveTypeEntry* t = type_at(ctx, handle_base(handle) - MTP_HANDLE_SAVES_TYPE_START);
+    return (t && t->handle == handle) ? t : NULL;
 }
 
 static UserFolderEntry* find_user_folder_by_handle(SavesContext* ctx, u32 handle) {
-    for (u32 i = 0; i < ctx->user_folder_count; i++) {
-        if (ctx->user_folders[i].handle == handle) return &ctx->user_folders[i];
-    }
-    return NULL;
+    if (!is_user_handle(handle)) return NULL;
+    UserFolderEntry* uf = (UserFolderEntry*)pool_at(&ctx->user_folders,
+                                                    handle_base(handle) - MTP_HANDLE_SAVES_USER_START);
+    return (uf && uf->handle == handle) ? uf : NULL;
 }
 
 static SaveFileEntry* find_file_by_handle(SavesContext* ctx, u32 handle) {
-    for (u32 i = 0; i < ctx->file_count; i++) {
-        if (ctx->files[i].handle == handle) return &ctx->files[i];
+    if (!is_file_handle(handle)) return NULL;
+    SaveFileEntry* f = (SaveFileEntry*)pool_at(&ctx->files, handle_base(handle) - MTP_HANDLE_SAVES_FILE_START);
+    return (f && f->handle == handle) ? f : NULL;
+}
+
+static SnapshotNode* find_snapshot_node(SavesContext* ctx, u32 handle) {
+    if (!is_snapshot_handle(handle)) return NULL;
+    SnapshotNode* n = (SnapshotNode*)pool_at(&ctx->snapshot_nodes,
+                                             handle_base(handle) - MTP_HANDLE_SAVES_SNAPSHOT_START);
+    return (n && n->handle == handle) ? n : NULL;
+}
+
+static SaveNodeLinks* get_links(SavesContext* ctx, u32 handle) {
+    if (handle == MTP_HANDLE_SAVES_SNAPSHOTS) {
+        return &ctx->snapshot_root;
     }
-    return NULL;
+    if (is_snapshot_handle(handle)) {
+        SnapshotNode* n = find_snapshot_node(ctx, handle);
+        return n ? &n->links : NULL;
+    }
+    if (is_game_handle(handle)) {
+        GameSaveEntry* g = find_game_by_handle(ctx, handle);
+        return g ? &g->links : NULL;
+    }
+    if (is_user_handle(handle)) {
+        UserFolderEntry* uf = find_user_folder_by_handle(ctx, handle);
+        return uf ? &uf->links : NULL;
+    }
+    if (is_type_handle(handle)) {
+        SaveTypeEntry* t = find_type_by_handle(ctx, handle);
+        return t ? &t->links : NULL;
+    }
+    SaveFileEntry* f = find_file_by_handle(ctx, handle);
+    return f ? &f->links : NULL;
 }
 
-static bool mount_save_type(SavesContext* ctx, SaveTypeEntry* type) {
-    if (type->mounted) {
-        LOG_DEBUG("[SAVES_MOUNT] Type 0x%08X already mounted", type->handle);
-        return true;
+// Append child to the end of parent's child list (keeps enumeration in creation order)
+static void link_child(SavesContext* ctx, u32 parent, u32 child) {
+    SaveNodeLinks* p = get_links(ctx, parent);
+    SaveNodeLinks* c = get_links(ctx, child);
+    if (!p || !c) return;
+
+    c->next_sibling = 0;
+    if (p->last_child) {
+        SaveNodeLinks* last = get_links(ctx, p->last_child);
+        if (last) last->next_sibling = child;
+    } else {
+        p->first_child = child;
+    }
+    p->last_child = child;
+    p->child_count++;
+}
+
+static void unlink_child(SavesContext* ctx, u32 parent, u32 child) {
+    SaveNodeLinks* p = get_links(ctx, parent);
+    if (!p) return;
+
+    u32 prev = 0;
+    for (u32 h = p->first_child; h; ) {
+        SaveNodeLinks* l = get_links(ctx, h);
+        if (!l) break;
+        if (h == child) {
+            if (prev) get_links(ctx, prev)->next_sibling = l->next_sibling;
+            else p->first_child = l->next_sibling;
+            if (p->last_child == child) p->last_child = prev;
+            p->child_count--;
+            return;
+        }
+        prev = h;
+        h = l->next_sibling;
+    }
+}
+
+// Free a file entry and everything below it
+static void remove_file_subtree(SavesContext* ctx, SaveFileEntry* f) {
+    for (u32 h = f->links.first_child; h; ) {
+        SaveFileEntry* child = find_file_by_handle(ctx, h);
+        if (!child) break;
+        h = child->links.next_sibling;
+        remove_file_subtree(ctx, child);
+    }
+    free_file(ctx, f);
+}
+
+// Save-relative path of a file entry ("/dir/file"), rebuilt from its parent chain
+#define SAVES_MAX_DEPTH 64
+
+static bool build_file_path(SavesContext* ctx, const SaveFileEntry* f, char* out, size_t out_size) {
+    const char* parts[SAVES_MAX_DEPTH];
+    u32 depth = 0;
+    for (const SaveFileEntry* e = f; e; e = find_file_by_handle(ctx, e->parent_handle)) {
+        if (depth >= SAVES_MAX_DEPTH) return false;
+        parts[depth++] = e->filename;
+    }
+
+    size_t o = 0;
+    out[0] = '\0';
+    while (depth > 0) {
+        int n = snprintf(out + o, out_size - o, "/%s", parts[--depth]);
+        if (n < 0 || o + n >= out_size) return false;
+        o += n;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Mount manager
+//
+// Save filesystems are opened natively (no fsdev devoptab) and at most
+// MTP_SAVES_MAX_MOUNTS stay open. Mounting another save closes the least
+// recently used one, committing its pending writes first. Saves with open
+// file handles or an archive restore in progress are pinned.
+// ---------------------------------------------------------------------------
+
+static void remove_from_mounted(SavesContext* ctx, u32 type_idx) {
+    for (u32 i = 0; i < ctx->mounted_count; i++) {
+        if (ctx->mounted_types[i] == type_idx) {
+            ctx->mounted_types[i] = ctx->mounted_types[--ctx->mounted_count];
+            return;
+        }
+    }
+}
+
+// Unmounting discards anything not yet committed
+static void unmount_save_type(SavesContext* ctx, SaveTypeEntry* type) {
+    if (!type->mounted) return;
+    if (type->pending_commit) {
+        LOG_INFO("[SAVES_UNMOUNT] Dropping uncommitted writes of type 0x%08X", type->handle);
+        type->pending_commit = false;
+        ctx->pending_commit_count--;
+    }
+    LOG_DEBUG("[SAVES_UNMOUNT] Unmounting type 0x%08X", type->handle);
+    archive_release_type(type->handle);
+    fsFsClose(&type->save_fs);
+    type->mounted = false;
+    remove_from_mounted(ctx, get_type_index(type));
+}
+
+// Close the least recently used unpinned save to make room for another mount
+static bool evict_one_mount(SavesContext* ctx) {
+    SaveTypeEntry* victim = NULL;
+    for (u32 i = 0; i < ctx->mounted_count; i++) {
+        SaveTypeEntry* t = type_at(ctx, ctx->mounted_types[i]);
+        if (t->open_files > 0 || archive_pins_type(t->handle)) continue;
+        if (!victim || t->last_used < victim->last_used) victim = t;
     }
+    if (!victim) return false;
+
+    if (!commit_save_type(ctx, victim)) return false;
+    LOG_DEBUG("[SAVES_MOUNT] Evicting type 0x%08X", victim->handle);
+    unmount_save_type(ctx, victim);
+    return true;
+}
+
+// Mount a save (or refresh its LRU stamp); every save_fs access goes through here
+static bool mount_save_type(SavesContext* ctx, SaveTypeEntry* type) {
+    type->last_used = ++ctx->mount_clock;
+    if (type->mounted) return true;
 
     LOG_DEBUG("[SAVES_MOUNT] Mounting type 0x%08X (game_idx=%u, save_type=%u)",
               type->handle, type->game_index, type->save_type);
 
+    if (ctx->mounted_count >= MTP_SAVES_MAX_MOUNTS && !evict_one_mount(ctx)) {
+        LOG_ERROR("[SAVES_MOUNT] All %u mounts are pinned, cannot mount 0x%08X",
+                  ctx->mounted_count, type->handle);
+        return false;
+    }
 
-    GameSaveEntry* game = &ctx->games[type->game_index];
+    GameSaveEntry* game = game_at(ctx, type->game_index);
 
-    FsFileSystem fs;
     FsSaveDataAttribute attr = {0};
     attr.application_id = game->application_id;
 
@@ -311,101 +658,183 @@ static bool mount_save_type(SavesContext* ctx, SaveTypeEntry* type) {
     }
 
     FsSaveDataSpaceId space_id = (FsSaveDataSpaceId)type->space_id;
-    Result rc = fsOpenSaveDataFileSystem(&fs, space_id, &attr);
+    Result rc = fsOpenSaveDataFileSystem(&type->save_fs, space_id, &attr);
     if (R_FAILED(rc)) {
         LOG_DEBUG("[SAVES_MOUNT] Failed to open save data filesystem: 0x%08X", rc);
+        type->mount_failed = true;
         return false;
     }
 
-    char mount[32];
-    snprintf(mount, sizeof(mount), "%s%u", SAVES_MOUNT_PREFIX, type->handle & 0xFFFF);
-
-    if (fsdevMountDevice(mount, fs) < 0) {
-        LOG_DEBUG("[SAVES_MOUNT] fsdevMountDevice failed for '%s'", mount);
-        fsFsClose(&fs);
-        return false;
-    }
-
-    type->save_fs = fs;
     type->mounted = true;
-    strncpy(type->mount_name, mount, sizeof(type->mount_name) - 1);
-    LOG_DEBUG("[SAVES_MOUNT] Successfully mounted type 0x%08X as '%s'", type->handle, mount);
+    type->mount_failed = false;
+    ctx->mounted_types[ctx->mounted_count++] = get_type_index(type);
+    LOG_DEBUG("[SAVES_MOUNT] Mounted type 0x%08X (%u/%u open)",
+              type->handle, ctx->mounted_count, MTP_SAVES_MAX_MOUNTS);
     return true;
 }
 
-static void unmount_save_type(SaveTypeEntry* type) {
-    if (!type->mounted) return;
-    LOG_DEBUG("[SAVES_UNMOUNT] Unmounting type 0x%08X ('%s')", type->handle, type->mount_name);
-    fsdevUnmountDevice(type->mount_name);
-    type->mounted = false;
-}
-
 static void scan_directory(SavesContext* ctx, u32 type_idx, u32 parent_handle, const char* path) {
-    if (ctx->file_count >= ctx->max_files) {
-        LOG_DEBUG("[SAVES_SCAN] Max files reached (%u)", ctx->max_files);
-        return;
-    }
-
     LOG_DEBUG("[SAVES_SCAN] Scanning directory '%s' (parent=0x%08X, type_idx=%u)", path, parent_handle, type_idx);
 
-    DIR* dir = opendir(path);
-    if (!dir) {
+    SaveTypeEntry* type = type_at(ctx, type_idx);
+    FsDir dir;
+    if (!type || !mount_save_type(ctx, type) ||
+        R_FAILED(fsFsOpenDirectory(&type->save_fs, path, FsDirOpenMode_ReadDirs | FsDirOpenMode_ReadFiles, &dir))) {
         LOG_DEBUG("[SAVES_SCAN] Failed to open directory '%s'", path);
         return;
     }
 
-    u32 start_count = ctx->file_count;
-    struct dirent* ent;
-    while ((ent = readdir(dir)) && ctx->file_count < ctx->max_files) {
-        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+    u32 found = 0;
+    bool full = false;
+    FsDirectoryEntry entries[8];
+    s64 read = 0;
+    while (!full && R_SUCCEEDED(fsDirRead(&dir, &read, 8, entries)) && read > 0) {
+        for (s64 i = 0; i < read; i++) {
+            FsDirectoryEntry* ent = &entries[i];
+
+            SaveFileEntry* f = alloc_file(ctx);
+            if (!f) {
+                LOG_ERROR("[SAVES_SCAN] Out of file slots (%u live)", ctx->files.live);
+                full = true;
+                break;
+            }
 
-        SaveFileEntry* f = &ctx->files[ctx->file_count];
-        memset(f, 0, sizeof(SaveFileEntry));
+            f->filename = intern_name(ctx, ent->name);
+            f->parent_handle = parent_handle;
+            f->game_index = type->game_index;
+            f->type_index = type_idx;
+            f->is_directory = (ent->type == FsDirEntryType_Dir);
+            if (!f->is_directory) f->size = ent->file_size;
 
-        strncpy(f->filename, ent->d_name, sizeof(f->filename) - 1);
-        snprintf(f->full_path, sizeof(f->full_path), "%s/%s", path, ent->d_name);
+            link_child(ctx, parent_handle, f->handle);
+            found++;
+        }
+    }
+    fsDirClose(&dir);
+    LOG_DEBUG("[SAVES_SCAN] Found %u entries in '%s' (total now: %u)", found, path, ctx->files.live);
+}
 
-        char* ds = strstr(f->full_path, "//");
-        if (ds) memmove(ds, ds + 1, strlen(ds));
+static void add_save_type(SavesContext* ctx, GameSaveEntry* game, u32 parent_handle, s32 user_index,
+                          u8 save_type, u8 space_id, s16 cache_index, const char* name) {
+    SaveTypeEntry* t = alloc_type(ctx);
+    if (!t) {
+        LOG_ERROR("[SAVES_BUILD_STRUCT] Out of save type slots (%u live)", ctx->types.live);
+        return;
+    }
+    t->save_type = save_type;
+    t->space_id = space_id;
+    t->parent_handle = parent_handle;
+    t->game_index = game->game_index;
+    t->user_index = user_index;
+    t->cache_index = cache_index;
+    t->name = intern_name(ctx, name);
+    link_child(ctx, parent_handle, t->handle);
+    LOG_DEBUG("[SAVES_BUILD_STRUCT] Added %s save type", t->name);
+}
 
-        f->handle = ctx->next_file_handle++;
-        f->parent_handle = parent_handle;
-        f->game_index = ctx->types[type_idx].game_index;
-        f->type_index = type_idx;
+// Call fn on every save type of a game (directly under it or under its user folders).
+// Stops early and returns false as soon as fn does.
+typedef bool (*SaveTypeVisitor)(SavesContext* ctx, SaveTypeEntry* type);
 
-        struct stat st;
-        if (stat(f->full_path, &st) == 0) {
-            f->is_directory = S_ISDIR(st.st_mode);
-            if (!f->is_directory) f->size = st.st_size;
+static bool visit_game_types(SavesContext* ctx, GameSaveEntry* game, SaveTypeVisitor fn) {
+    for (u32 h = game->links.first_child; h; ) {
+        SaveNodeLinks* l = get_links(ctx, h);
+        if (!l) break;
+        u32 next = l->next_sibling;
+
+        if (is_type_handle(h)) {
+            if (!fn(ctx, find_type_by_handle(ctx, h))) return false;
         } else {
-            f->is_directory = (ent->d_type == DT_DIR);
+            for (u32 th = l->first_child; th; ) {
+                SaveTypeEntry* t = find_type_by_handle(ctx, th);
+                if (!t) break;
+                th = t->links.next_sibling;
+                if (!fn(ctx, t)) return false;
+            }
         }
+        h = next;
+    }
+    return true;
+}
+
+static void drop_type_files(SavesContext* ctx, u32 type_idx);
+
+// A save can be released once nothing holds it and its writes are committed
+static bool can_release_type(SavesContext* ctx, SaveTypeEntry* type) {
+    if (type->open_files > 0 || archive_pins_type(type->handle)) return false;
+    return commit_save_type(ctx, type);
+}
 
-        ctx->file_count++;
+static bool release_type(SavesContext* ctx, SaveTypeEntry* type) {
+    unmount_save_type(ctx, type);
+    drop_type_files(ctx, get_type_index(type));
+    free_type(ctx, type);
+    return true;
+}
+
+// Free everything below a game folder; it is rebuilt when browsed again
+static bool release_game_subtree(SavesContext* ctx, GameSaveEntry* game) {
+    if (!visit_game_types(ctx, game, can_release_type)) return false;
+    visit_game_types(ctx, game, release_type);
+
+    for (u32 h = game->links.first_child; h; ) {
+        UserFolderEntry* uf = find_user_folder_by_handle(ctx, h);
+        SaveNodeLinks* l = get_links(ctx, h);
+        h = l ? l->next_sibling : 0;
+        if (uf) free_user_folder(ctx, uf);
+    }
+
+    memset(&game->links, 0, sizeof(game->links));
+    game->users_scanned = false;
+    ctx->built_game_count--;
+    LOG_DEBUG("[SAVES_BUILD_STRUCT] Released subtree of game %u (%016lX)",
+              game->game_index, game->application_id);
+    return true;
+}
+
+// Keep the number of built games under the budget by dropping the least recently browsed
+static void trim_built_games(SavesContext* ctx, GameSaveEntry* keep) {
+    while (ctx->built_game_count >= MTP_SAVES_MAX_BUILT_GAMES) {
+        GameSaveEntry* victim = NULL;
+        for (u32 i = 0; i < ctx->games.count; i++) {
+            GameSaveEntry* g = game_at(ctx, i);
+            if (g == keep || !g->users_scanned) continue;
+            if (!victim || g->last_browsed < victim->last_browsed) victim = g;
+        }
+        if (!victim) break;
+        // Pinned games (open files, restores, failed commits) stay; the next build tries another
+        if (!release_game_subtree(ctx, victim)) {
+            victim->last_browsed = ++ctx->browse_clock;
+            break;
+        }
     }
-    closedir(dir);
-    LOG_DEBUG("[SAVES_SCAN] Found %u entries in '%s' (total now: %u)",
-              ctx->file_count - start_count, path, ctx->file_count);
+}
+
+static void touch_game(SavesContext* ctx, u32 game_idx) {
+    GameSaveEntry* g = game_at(ctx, game_idx);
+    if (g) g->last_browsed = ++ctx->browse_clock;
 }
 
 static void build_game_structure(SavesContext* ctx, u32 game_idx) {
-    if (game_idx >= ctx->game_count) {
-        LOG_DEBUG("[SAVES_BUILD_STRUCT] Invalid game_idx %u (count=%u)", game_idx, ctx->game_count);
+    GameSaveEntry* game = game_at(ctx, game_idx);
+    if (!game) {
+        LOG_DEBUG("[SAVES_BUILD_STRUCT] Invalid game_idx %u (count=%u)", game_idx, ctx->games.count);
         return;
     }
-    GameSaveEntry* game = &ctx->games[game_idx];
+    touch_game(ctx, game_idx);
     if (game->users_scanned) {
         LOG_DEBUG("[SAVES_BUILD_STRUCT] Game %u (%016lX) already scanned", game_idx, game->application_id);
         return;
     }
 
     LOG_DEBUG("[SAVES_BUILD_STRUCT] Building structure for game %u (%016lX)", game_idx, game->application_id);
+    trim_built_games(ctx, game);
 
     AccountUid empty_uid = {0};
-    u32 initial_user_folders = ctx->user_folder_count;
-    u32 initial_types = ctx->type_count;
+    u32 initial_user_folders = ctx->user_folders.live;
+    u32 initial_types = ctx->types.live;
 
-    for (s32 ui = 0; ui < ctx->user_count && ctx->user_folder_count < ctx->max_user_folders; ui++) {
+    for (s32 ui = 0; ui < ctx->user_count; ui++) {
         bool user_has_saves = false;
 
         for (u32 i = 0; i < s_save_info_count && !user_has_saves; i++) {
@@ -420,123 +849,56 @@ static void build_game_structure(SavesContext* ctx, u32 game_idx) {
 
         if (user_has_saves) {
             LOG_DEBUG("[SAVES_BUILD_STRUCT] User %d has saves for this game", ui);
-            UserFolderEntry* uf = &ctx->user_folders[ctx->user_folder_count];
-            memset(uf, 0, sizeof(UserFolderEntry));
+            UserFolderEntry* uf = alloc_user_folder(ctx);
+            if (!uf) {
+                LOG_ERROR("[SAVES_BUILD_STRUCT] Out of user folder slots (%u live)", ctx->user_folders.live);
+                break;
+            }
 
             uf->uid = ctx->user_uids[ui];
-            strncpy(uf->username, ctx->user_names[ui], sizeof(uf->username) - 1);
-            uf->handle = ctx->next_user_handle++;
             uf->parent_game_handle = game->folder_handle;
             uf->game_index = game_idx;
             uf->user_index = ui;
-
-            ctx->user_folder_count++;
+            link_child(ctx, game->folder_handle, uf->handle);
 
             if (has_save_info(game->application_id, ctx->user_uids[ui], FsSaveDataType_Account, FsSaveDataSpaceId_User, 0)) {
-                if (ctx->type_count < ctx->max_types) {
-                    SaveTypeEntry* t = &ctx->types[ctx->type_count];
-                    memset(t, 0, sizeof(SaveTypeEntry));
-                    t->save_type = FsSaveDataType_Account;
-                    t->space_id = FsSaveDataSpaceId_User;
-                    t->handle = ctx->next_type_handle++;
-                    t->parent_handle = uf->handle;
-                    t->game_index = game_idx;
-                    t->user_index = ui;
-                    t->cache_index = -1;
-                    strncpy(t->name, "Account", sizeof(t->name) - 1);
-                    ctx->type_count++;
-                    LOG_DEBUG("[SAVES_BUILD_STRUCT] Added Account save type");
-                }
+                add_save_type(ctx, game, uf->handle, ui, FsSaveDataType_Account, FsSaveDataSpaceId_User, -1, "Account");
             }
 
-            for (u16 idx = 0; idx < 16 && ctx->type_count < ctx->max_types; idx++) {
+            for (u16 idx = 0; idx < 16; idx++) {
                 if (has_save_info(game->application_id, ctx->user_uids[ui], FsSaveDataType_Cache, FsSaveDataSpaceId_User, idx)) {
-                    SaveTypeEntry* t = &ctx->types[ctx->type_count];
-                    memset(t, 0, sizeof(SaveTypeEntry));
-                    t->save_type = FsSaveDataType_Cache;
-                    t->space_id = FsSaveDataSpaceId_User;
-                    t->handle = ctx->next_type_handle++;
-                    t->parent_handle = uf->handle;
-                    t->game_index = game_idx;
-                    t->user_index = ui;
-                    t->cache_index = idx;
-                    snprintf(t->name, sizeof(t->name), "Cache.%04d", idx);
-                    ctx->type_count++;
+                    char name[32];
+                    snprintf(name, sizeof(name), "Cache.%04d", idx);
+                    add_save_type(ctx, game, uf->handle, ui, FsSaveDataType_Cache, FsSaveDataSpaceId_User, idx, name);
                 }
             }
         }
     }
 
     if (has_save_info(game->application_id, empty_uid, FsSaveDataType_Device, FsSaveDataSpaceId_User, 0)) {
-        if (ctx->type_count < ctx->max_types) {
-            SaveTypeEntry* t = &ctx->types[ctx->type_count];
-            memset(t, 0, sizeof(SaveTypeEntry));
-            t->save_type = FsSaveDataType_Device;
-            t->space_id = FsSaveDataSpaceId_User;
-            t->handle = ctx->next_type_handle++;
-            t->parent_handle = game->folder_handle;
-            t->game_index = game_idx;
-            t->user_index = -1;
-            t->cache_index = -1;
-            strncpy(t->name, "Device", sizeof(t->name) - 1);
-            ctx->type_count++;
-            LOG_DEBUG("[SAVES_BUILD_STRUCT] Added Device save type");
-        }
+        add_save_type(ctx, game, game->folder_handle, -1, FsSaveDataType_Device, FsSaveDataSpaceId_User, -1, "Device");
     }
 
     if (has_save_info(game->application_id, empty_uid, FsSaveDataType_Bcat, FsSaveDataSpaceId_User, 0)) {
-        if (ctx->type_count < ctx->max_types) {
-            SaveTypeEntry* t = &ctx->types[ctx->type_count];
-            memset(t, 0, sizeof(SaveTypeEntry));
-            t->save_type = FsSaveDataType_Bcat;
-            t->space_id = FsSaveDataSpaceId_User;
-            t->handle = ctx->next_type_handle++;
-            t->parent_handle = game->folder_handle;
-            t->game_index = game_idx;
-            t->user_index = -1;
-            t->cache_index = -1;
-            strncpy(t->name, "BCAT", sizeof(t->name) - 1);
-            ctx->type_count++;
-            LOG_DEBUG("[SAVES_BUILD_STRUCT] Added BCAT save type");
-        }
+        add_save_type(ctx, game, game->folder_handle, -1, FsSaveDataType_Bcat, FsSaveDataSpaceId_User, -1, "BCAT");
     }
 
     if (has_save_info(game->application_id, empty_uid, FsSaveDataType_Temporary, FsSaveDataSpaceId_User, 0)) {
-        if (ctx->type_count < ctx->max_types) {
-            SaveTypeEntry* t = &ctx->types[ctx->type_count];
-            memset(t, 0, sizeof(SaveTypeEntry));
-            t->save_type = FsSaveDataType_Temporary;
-            t->space_id = FsSaveDataSpaceId_User;
-            t->handle = ctx->next_type_handle++;
-            t->parent_handle = game->folder_handle;
-            t->game_index = game_idx;
-            t->user_index = -1;
-            t->cache_index = -1;
-            strncpy(t->name, "Temporary", sizeof(t->name) - 1);
-            ctx->type_count++;
-            LOG_DEBUG("[SAVES_BUILD_STRUCT] Added Temporary save type");
-        }
+        add_save_type(ctx, game, game->folder_handle, -1, FsSaveDataType_Temporary, FsSaveDataSpaceId_User, -1, "Temporary");
     }
 
-    for (u16 idx = 0; idx < 16 && ctx->type_count < ctx->max_types; idx++) {
+    for (u16 idx = 0; idx < 16; idx++) {
         if (has_save_info(game->application_id, empty_uid, FsSaveDataType_Cache, FsSaveDataSpaceId_SdUser, idx)) {
-            SaveTypeEntry* t = &ctx->types[ctx->type_count];
-            memset(t, 0, sizeof(SaveTypeEntry));
-            t->save_type = FsSaveDataType_Cache;
-            t->space_id = FsSaveDataSpaceId_SdUser;
-            t->handle = ctx->next_type_handle++;
-            t->parent_handle = game->folder_handle;
-            t->game_index = game_idx;
-            t->user_index = -1;
-            t->cache_index = idx;
-            snprintf(t->name, sizeof(t->name), "SD_Cache.%04d", idx);
-            ctx->type_count++;
+            char name[32];
+            snprintf(name, sizeof(name), "SD_Cache.%04d", idx);
+            add_save_type(ctx, game, game->folder_handle, -1, FsSaveDataType_Cache, FsSaveDataSpaceId_SdUser, idx, name);
         }
     }
 
     game->users_scanned = true;
+    ctx->built_game_count++;
     LOG_DEBUG("[SAVES_BUILD_STRUCT] Structure complete for game %u: %u user folders, %u types",
-              game_idx, ctx->user_folder_count - initial_user_folders, ctx->type_count - initial_types);
+              game_idx, ctx->user_folders.live - initial_user_folders, ctx->types.live - initial_types);
 }
 
 static void ensure_type_scanned(SavesContext* ctx, SaveTypeEntry* type) {
@@ -545,44 +907,1159 @@ static void ensure_type_scanned(SavesContext* ctx, SaveTypeEntry* type) {
         return;
     }
 
-    LOG_DEBUG("[SAVES_ENSURE_TYPE] Scanning type 0x%08X", type->handle);
-
-    if (!mount_save_type(ctx, type)) {
-        LOG_DEBUG("[SAVES_ENSURE_TYPE] Failed to mount type 0x%08X, marking as scanned", type->handle);
-        type->scanned = true;
-        return;
+    LOG_DEBUG("[SAVES_ENSURE_TYPE] Scanning type 0x%08X", type->handle);
+
+    if (!mount_save_type(ctx, type)) {
+        LOG_DEBUG("[SAVES_ENSURE_TYPE] Failed to mount type 0x%08X, marking as scanned", type->handle);
+        type->scanned = true;
+        return;
+    }
+
+    scan_directory(ctx, get_type_index(type), type->handle, "/");
+    type->scanned = true;
+    LOG_DEBUG("[SAVES_ENSURE_TYPE] Type 0x%08X scan complete", type->handle);
+}
+
+static void ensure_file_scanned(SavesContext* ctx, SaveFileEntry* file) {
+    if (!file->is_directory || file->scanned) return;
+
+    char path[FS_MAX_PATH];
+    if (!build_file_path(ctx, file, path, sizeof(path))) return;
+    scan_directory(ctx, file->type_index, file->handle, path);
+    file->scanned = true;
+}
+
+// ---------------------------------------------------------------------------
+// Whole-save archives
+//
+// Every save type folder exposes one virtual ustar archive. Reads are served
+// from a manifest built by walking the mounted save, so any offset can be
+// produced without materializing the archive. Uploading a .tar into the type
+// folder wipes the save, extracts the stream in a single pass and commits
+// once; an aborted upload unmounts without committing, which discards it.
+// ---------------------------------------------------------------------------
+
+#define ARCHIVE_HANDLE_OFFSET (MTP_HANDLE_SAVES_ARCHIVE_START - MTP_HANDLE_SAVES_TYPE_START)
+
+typedef struct {
+    u32 path_offset;            // Offset into ArchiveReader::paths (path relative to save root)
+    u32 header_size;
+    u64 header_offset;          // Archive offset of this entry's header blocks
+    u64 size;
+    bool is_directory;
+} ArchiveEntry;
+
+typedef struct {
+    u32 type_handle;            // Save type the manifest describes (0 = none)
+    ArchiveEntry* entries;
+    u32 entry_count;
+    u32 entry_capacity;
+    char* paths;
+    u32 paths_len;
+    u32 paths_capacity;
+    u64 data_end;               // Offset of the end-of-archive marker
+    u64 total_size;
+    u64 mtime;                  // Stamped into every header; fixed when the manifest is built
+    FsFile file;                // File of the entry currently being streamed
+    s32 file_entry;             // -1 when no file is open
+} ArchiveReader;
+
+typedef struct {
+    SavesContext* ctx;
+    u32 type_handle;            // Save type being restored (0 = idle)
+    TarParser parser;
+    u64 received;
+    FsFile out;
+    bool out_open;
+    u64 out_offset;
+    bool failed;
+} ArchiveWriter;
+
+static ArchiveReader s_archive_reader;
+static ArchiveWriter s_archive_writer;
+
+static bool is_archive_handle(u32 handle) {
+    u32 h = handle_base(handle);
+    return h >= MTP_HANDLE_SAVES_ARCHIVE_START && h <= MTP_HANDLE_SAVES_ARCHIVE_END;
+}
+
+static bool is_archive_name(const char* name) {
+    size_t len = strlen(name);
+    size_t ext = strlen(MTP_SAVES_ARCHIVE_EXT);
+    return len > ext && strcasecmp(name + len - ext, MTP_SAVES_ARCHIVE_EXT) == 0;
+}
+
+static SaveTypeEntry* find_type_by_archive_handle(SavesContext* ctx, u32 handle) {
+    if (!is_archive_handle(handle)) return NULL;
+    return find_type_by_handle(ctx, handle - ARCHIVE_HANDLE_OFFSET);
+}
+
+static void archive_reader_close_file(ArchiveReader* r) {
+    if (r->file_entry >= 0) {
+        fsFileClose(&r->file);
+    }
+    r->file_entry = -1;
+}
+
+static void archive_reader_reset(ArchiveReader* r) {
+    archive_reader_close_file(r);
+    free(r->entries);
+    free(r->paths);
+    memset(r, 0, sizeof(ArchiveReader));
+    r->file_entry = -1;
+}
+
+// Called before a save is unmounted: the reader may hold one of its files open
+static void archive_release_type(u32 type_handle) {
+    if (s_archive_reader.type_handle == type_handle) {
+        archive_reader_reset(&s_archive_reader);
+    }
+}
+
+// A restore in progress keeps its save mounted until commit/rollback
+static bool archive_pins_type(u32 type_handle) {
+    return s_archive_writer.type_handle == type_handle;
+}
+
+// Forget the cached archive of a save type after its contents changed
+static void invalidate_archive(SaveTypeEntry* type) {
+    type->archive_sized = false;
+    if (s_archive_reader.type_handle == type->handle) {
+        archive_reader_reset(&s_archive_reader);
+    }
+}
+
+// Drop the cached file entries of a save type so the next browse rescans it
+static void drop_type_files(SavesContext* ctx, u32 type_idx) {
+    SaveTypeEntry* t = type_at(ctx, type_idx);
+    if (!t) return;
+    for (u32 h = t->links.first_child; h; ) {
+        SaveFileEntry* f = find_file_by_handle(ctx, h);
+        if (!f) break;
+        h = f->links.next_sibling;
+        remove_file_subtree(ctx, f);
+    }
+    memset(&t->links, 0, sizeof(t->links));
+    t->scanned = false;
+}
+
+static bool archive_add_entry(ArchiveReader* r, const char* rel_path, u64 size, bool is_dir) {
+    if (r->entry_count >= r->entry_capacity) {
+        u32 cap = r->entry_capacity ? r->entry_capacity * 2 : 64;
+        ArchiveEntry* e = (ArchiveEntry*)realloc(r->entries, sizeof(ArchiveEntry) * cap);
+        if (!e) return false;
+        r->entries = e;
+        r->entry_capacity = cap;
+    }
+
+    u32 len = (u32)strlen(rel_path) + 1;
+    if (r->paths_len + len > r->paths_capacity) {
+        u32 cap = r->paths_capacity ? r->paths_capacity * 2 : 4096;
+        while (cap < r->paths_len + len) cap *= 2;
+        char* p = (char*)realloc(r->paths, cap);
+        if (!p) return false;
+        r->paths = p;
+        r->paths_capacity = cap;
+    }
+
+    ArchiveEntry* e = &r->entries[r->entry_count++];
+    e->path_offset = r->paths_len;
+    e->size = is_dir ? 0 : size;
+    e->is_directory = is_dir;
+    e->header_size = tarHeaderSize(rel_path, is_dir);
+    memcpy(r->paths + r->paths_len, rel_path, len);
+    r->paths_len += len;
+    return true;
+}
+
+// Append every entry of one directory to the manifest
+static bool archive_list_directory(ArchiveReader* r, FsFileSystem* fs, const char* rel) {
+    char dir_path[TAR_MAX_PATH + 2];
+    snprintf(dir_path, sizeof(dir_path), "/%s", rel);
+
+    FsDir dir;
+    if (R_FAILED(fsFsOpenDirectory(fs, dir_path, FsDirOpenMode_ReadDirs | FsDirOpenMode_ReadFiles, &dir))) {
+        LOG_ERROR("[SAVES_ARCHIVE] Failed to open directory '%s'", dir_path);
+        return false;
+    }
+
+    bool ok = true;
+    FsDirectoryEntry entries[8];
+    s64 read = 0;
+    while (ok && R_SUCCEEDED(fsDirRead(&dir, &read, 8, entries)) && read > 0) {
+        for (s64 i = 0; i < read && ok; i++) {
+            char child[TAR_MAX_PATH];
+            int n = snprintf(child, sizeof(child), "%s%s%s", rel, rel[0] ? "/" : "", entries[i].name);
+            if (n < 0 || n >= (int)sizeof(child)) {
+                LOG_ERROR("[SAVES_ARCHIVE] Path too long under '%s'", dir_path);
+                ok = false;
+                break;
+            }
+            bool is_dir = (entries[i].type == FsDirEntryType_Dir);
+            ok = archive_add_entry(r, child, is_dir ? 0 : entries[i].file_size, is_dir);
+        }
+    }
+    fsDirClose(&dir);
+    return ok;
+}
+
+// Lists a directory completely before descending into its subdirectories, so only
+// one directory handle is open at a time. Parents always precede their contents.
+static bool archive_walk(ArchiveReader* r, FsFileSystem* fs, const char* rel) {
+    u32 first = r->entry_count;
+    if (!archive_list_directory(r, fs, rel)) return false;
+
+    u32 last = r->entry_count;
+    for (u32 i = first; i < last; i++) {
+        if (!r->entries[i].is_directory) continue;
+        char child[TAR_MAX_PATH];
+        strncpy(child, r->paths + r->entries[i].path_offset, sizeof(child) - 1);
+        child[sizeof(child) - 1] = '\0';
+        if (!archive_walk(r, fs, child)) return false;
+    }
+    return true;
+}
+
+static bool archive_build_manifest(SavesContext* ctx, SaveTypeEntry* type) {
+    ArchiveReader* r = &s_archive_reader;
+    if (r->type_handle == type->handle) return true;
+
+    archive_reader_reset(r);
+    if (!mount_save_type(ctx, type)) return false;
+
+    if (!archive_walk(r, &type->save_fs, "")) {
+        archive_reader_reset(r);
+        return false;
+    }
+
+    u64 offset = 0;
+    for (u32 i = 0; i < r->entry_count; i++) {
+        ArchiveEntry* e = &r->entries[i];
+        e->header_offset = offset;
+        offset += e->header_size + tarPaddedSize(e->size);
+    }
+    r->data_end = offset;
+    r->total_size = offset + TAR_BLOCK_SIZE * 2;
+    r->mtime = (u64)time(NULL);
+    r->type_handle = type->handle;
+
+    type->archive_size = r->total_size;
+    type->archive_sized = true;
+
+    LOG_DEBUG("[SAVES_ARCHIVE] Manifest for type 0x%08X: %u entries, %llu bytes",
+              type->handle, r->entry_count, (unsigned long long)r->total_size);
+    return true;
+}
+
+// Index of the entry whose header/data/padding span contains offset
+static u32 archive_find_entry(ArchiveReader* r, u64 offset) {
+    u32 lo = 0, hi = r->entry_count;
+    while (hi - lo > 1) {
+        u32 mid = (lo + hi) / 2;
+        if (r->entries[mid].header_offset <= offset) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static s64 archive_read(SavesContext* ctx, SaveTypeEntry* type, u64 offset, u8* out, u64 size) {
+    ArchiveReader* r = &s_archive_reader;
+    if (!archive_build_manifest(ctx, type) || !mount_save_type(ctx, type)) return -1;
+    if (offset >= r->total_size) return 0;
+    if (size > r->total_size - offset) size = r->total_size - offset;
+
+    u8 header[TAR_BLOCK_SIZE * 2 + TAR_MAX_PATH + TAR_BLOCK_SIZE];
+    u64 done = 0;
+
+    while (done < size) {
+        u64 pos = offset + done;
+        u64 want = size - done;
+
+        if (pos >= r->data_end) {
+            memset(out + done, 0, want);
+            done += want;
+            break;
+        }
+
+        u32 idx = archive_find_entry(r, pos);
+        ArchiveEntry* e = &r->entries[idx];
+        const char* rel = r->paths + e->path_offset;
+        u64 data_start = e->header_offset + e->header_size;
+        u64 n;
+
+        if (pos < data_start) {
+            tarWriteHeader(header, rel, e->size, e->is_directory, r->mtime);
+            u64 in_header = pos - e->header_offset;
+            n = e->header_size - in_header;
+            if (n > want) n = want;
+            memcpy(out + done, header + in_header, n);
+        } else if (pos < data_start + e->size) {
+            u64 file_pos = pos - data_start;
+            n = e->size - file_pos;
+            if (n > want) n = want;
+
+            if (r->file_entry != (s32)idx) {
+                archive_reader_close_file(r);
+                char full[TAR_MAX_PATH + 2];
+                snprintf(full, sizeof(full), "/%s", rel);
+                if (R_SUCCEEDED(fsFsOpenFile(&type->save_fs, full, FsOpenMode_Read, &r->file))) {
+                    r->file_entry = (s32)idx;
+                }
+            }
+
+            u64 rd = 0;
+            if (r->file_entry == (s32)idx) {
+                fsFileRead(&r->file, file_pos, out + done, n, FsReadOption_None, &rd);
+            }
+            if (rd < n) {
+                // File shrank since the manifest was built; keep the archive well-formed
+                LOG_ERROR("[SAVES_ARCHIVE] Short read on '%s'", rel);
+                memset(out + done + rd, 0, n - rd);
+            }
+        } else {
+            n = data_start + tarPaddedSize(e->size) - pos;
+            if (n > want) n = want;
+            memset(out + done, 0, n);
+        }
+        done += n;
+    }
+
+    if (offset + size >= r->total_size) {
+        archive_reader_close_file(r);
+    }
+    return (s64)done;
+}
+
+static FsFileSystem* archive_writer_fs(ArchiveWriter* w) {
+    SaveTypeEntry* t = find_type_by_handle(w->ctx, w->type_handle);
+    return (t && t->mounted) ? &t->save_fs : NULL;
+}
+
+// Create every missing directory leading up to (and optionally including) path
+static bool make_directories(FsFileSystem* fs, const char* rel, bool include_last) {
+    char full[TAR_MAX_PATH + 2];
+    snprintf(full, sizeof(full), "/%s", rel);
+
+    for (char* p = full + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        fsFsCreateDirectory(fs, full);
+        *p = '/';
+    }
+    if (include_last && R_FAILED(fsFsCreateDirectory(fs, full))) {
+        FsDirEntryType type;
+        return R_SUCCEEDED(fsFsGetEntryType(fs, full, &type)) && type == FsDirEntryType_Dir;
+    }
+    return true;
+}
+
+static bool archive_on_directory(void* user, const char* path) {
+    ArchiveWriter* w = (ArchiveWriter*)user;
+    FsFileSystem* fs = archive_writer_fs(w);
+    if (!fs || !make_directories(fs, path, true)) {
+        LOG_ERROR("[SAVES_ARCHIVE] Failed to create directory '%s'", path);
+        return false;
+    }
+    return true;
+}
+
+static bool archive_on_file_begin(void* user, const char* path, u64 size) {
+    ArchiveWriter* w = (ArchiveWriter*)user;
+    FsFileSystem* fs = archive_writer_fs(w);
+    if (!fs) return false;
+
+    make_directories(fs, path, false);
+
+    char full[TAR_MAX_PATH + 2];
+    snprintf(full, sizeof(full), "/%s", path);
+
+    // The header carries the final size, so allocate it in one go
+    fsFsDeleteFile(fs, full);
+    Result rc = fsFsCreateFile(fs, full, size, 0);
+    if (R_SUCCEEDED(rc)) rc = fsFsOpenFile(fs, full, FsOpenMode_Write, &w->out);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SAVES_ARCHIVE] Failed to create '%s' (%llu bytes): 0x%08X",
+                  path, (unsigned long long)size, rc);
+        return false;
+    }
+    w->out_open = true;
+    w->out_offset = 0;
+    return true;
+}
+
+static bool archive_on_file_data(void* user, const void* data, u64 size) {
+    ArchiveWriter* w = (ArchiveWriter*)user;
+    if (!w->out_open) return false;
+    if (R_FAILED(fsFileWrite(&w->out, w->out_offset, data, size, FsWriteOption_None))) return false;
+    w->out_offset += size;
+    return true;
+}
+
+static bool archive_on_file_end(void* user) {
+    ArchiveWriter* w = (ArchiveWriter*)user;
+    if (!w->out_open) return false;
+    bool ok = R_SUCCEEDED(fsFileFlush(&w->out));
+    fsFileClose(&w->out);
+    w->out_open = false;
+    return ok;
+}
+
+// Finish a restore: commit it if the archive was complete, otherwise discard it
+static bool archive_writer_finish(SavesContext* ctx, bool commit) {
+    ArchiveWriter* w = &s_archive_writer;
+    if (!w->type_handle) return false;
+
+    if (w->out_open) {
+        fsFileClose(&w->out);
+        w->out_open = false;
+    }
+
+    SaveTypeEntry* type = find_type_by_handle(ctx, w->type_handle);
+    bool committed = false;
+
+    if (type && type->mounted) {
+        if (commit && !w->failed && tarParserComplete(&w->parser)) {
+            Result rc = fsFsCommit(&type->save_fs);
+            committed = R_SUCCEEDED(rc);
+            if (!committed) LOG_ERROR("[SAVES_ARCHIVE] Commit failed: 0x%08X", rc);
+        }
+        if (!committed) {
+            // Closing the save filesystem without a commit rolls back every change
+            LOG_INFO("[SAVES_ARCHIVE] Discarding restore of type 0x%08X", type->handle);
+            unmount_save_type(ctx, type);
+        }
+        invalidate_archive(type);
+        drop_type_files(ctx, get_type_index(type));
+    }
+
+    if (committed) {
+        LOG_INFO("[SAVES_ARCHIVE] Restored %u entries into type 0x%08X",
+                 w->parser.entry_count, w->type_handle);
+    }
+    memset(w, 0, sizeof(ArchiveWriter));
+    return committed;
+}
+
+static u32 archive_writer_begin(SavesContext* ctx, SaveTypeEntry* type) {
+    archive_writer_finish(ctx, false);
+
+    if (!mount_save_type(ctx, type)) return 0;
+    // Land earlier writes first so a failed restore only rolls back itself
+    if (!commit_save_type(ctx, type)) return 0;
+    invalidate_archive(type);
+
+    Result rc = fsFsCleanDirectoryRecursively(&type->save_fs, "/");
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SAVES_ARCHIVE] Failed to clear save 0x%08X: 0x%08X", type->handle, rc);
+        unmount_save_type(ctx, type);
+        drop_type_files(ctx, get_type_index(type));
+        return 0;
+    }
+
+    ArchiveWriter* w = &s_archive_writer;
+    memset(w, 0, sizeof(ArchiveWriter));
+    w->ctx = ctx;
+    w->type_handle = type->handle;
+
+    TarCallbacks cb = {
+        archive_on_directory, archive_on_file_begin, archive_on_file_data, archive_on_file_end, w
+    };
+    tarParserInit(&w->parser, &cb);
+
+    LOG_INFO("[SAVES_ARCHIVE] Restoring type 0x%08X from archive", type->handle);
+    return type->handle + ARCHIVE_HANDLE_OFFSET;
+}
+
+static s64 archive_write(u32 handle, u64 offset, const void* buf, u64 size) {
+    ArchiveWriter* w = &s_archive_writer;
+    if (!w->type_handle || handle != w->type_handle + ARCHIVE_HANDLE_OFFSET || w->failed) return -1;
+
+    // Extraction is a single forward pass over the stream
+    if (offset != w->received) {
+        LOG_ERROR("[SAVES_ARCHIVE] Non-sequential write at %llu (expected %llu)",
+                  (unsigned long long)offset, (unsigned long long)w->received);
+        w->failed = true;
+        return -1;
+    }
+
+    if (!tarParserFeed(&w->parser, buf, size)) {
+        w->failed = true;
+        return -1;
+    }
+    w->received += size;
+    return (s64)size;
+}
+
+static void archive_reset_all(SavesContext* ctx) {
+    archive_writer_finish(ctx, false);
+    archive_reader_reset(&s_archive_reader);
+}
+
+// Land pending writes and close every save filesystem (refresh/exit)
+static void close_all_types(SavesContext* ctx) {
+    archive_reset_all(ctx);
+    snapshot_close_archive();
+    if (!snapshot_job_busy()) snapshotStoreClose();  // A running job still writes to it
+    for (u32 i = 0; i < ctx->types.count; i++) {
+        SaveTypeEntry* t = type_at(ctx, i);
+        if (!t) continue;
+        commit_save_type(ctx, t);
+        unmount_save_type(ctx, t);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Snapshots
+//
+// The Snapshots folder mirrors SNAPSHOT_ROOT: a folder per title, a folder per
+// snapshot run and each manifest as a read-only .tar streamed from the chunk
+// store. MTP has no verb for "snapshot" or "restore", so those are requested by
+// creating or renaming a folder with a request name (see savesCreateObject);
+// that folder is a receipt whose name reports the progress and then the result
+// of the job.
+// Deleting a snapshot, a snapshot folder or a title folder removes it from the
+// SD card and compacts the chunk store.
+// ---------------------------------------------------------------------------
+
+static SnapshotArchive* s_snapshot_archive = NULL;
+static u32 s_snapshot_archive_handle = 0;
+
+static void snapshot_close_archive(void) {
+    snapshotArchiveClose(s_snapshot_archive);
+    s_snapshot_archive = NULL;
+    s_snapshot_archive_handle = 0;
+}
+
+// SD path of a node ("sdmc:/switch/Javelin/saves/<tid>/<stamp>/<label>.jsnap")
+static bool snapshot_node_path(SavesContext* ctx, const SnapshotNode* n, char* out, size_t out_size) {
+    const char* parts[3];
+    u32 depth = 0;
+    for (const SnapshotNode* e = n; e; e = find_snapshot_node(ctx, e->parent_handle)) {
+        if (depth >= 3 || !e->sd_name) return false;
+        parts[depth++] = e->sd_name;
+    }
+
+    size_t o = snprintf(out, out_size, "%s", SNAPSHOT_ROOT);
+    while (depth > 0) {
+        int len = snprintf(out + o, out_size - o, "/%s", parts[--depth]);
+        if (len < 0 || o + len >= out_size) return false;
+        o += len;
+    }
+    return true;
+}
+
+static SnapshotNode* add_snapshot_node(SavesContext* ctx, u32 parent, u8 kind, const char* sd_name,
+                                       const char* name, u64 application_id) {
+    SnapshotNode* n = alloc_snapshot_node(ctx);
+    if (!n) {
+        LOG_ERROR("[SAVES_SNAPSHOT] Out of snapshot node slots (%u live)", ctx->snapshot_nodes.live);
+        return NULL;
+    }
+    n->kind = kind;
+    n->parent_handle = parent;
+    n->sd_name = sd_name ? intern_name(ctx, sd_name) : NULL;
+    n->name = intern_name(ctx, name);
+    n->application_id = application_id;
+    n->scanned = (kind == SNAPSHOT_NODE_ARCHIVE || kind == SNAPSHOT_NODE_RECEIPT);
+    link_child(ctx, parent, n->handle);
+    return n;
+}
+
+static SnapshotNode* find_snapshot_child(SavesContext* ctx, u32 parent, const char* sd_name) {
+    SaveNodeLinks* p = get_links(ctx, parent);
+    for (u32 h = p ? p->first_child : 0; h; ) {
+        SnapshotNode* n = find_snapshot_node(ctx, h);
+        if (!n) break;
+        if (n->sd_name && strcmp(n->sd_name, sd_name) == 0) return n;
+        h = n->links.next_sibling;
+    }
+    return NULL;
+}
+
+static SnapshotNode* add_title_node(SavesContext* ctx, u64 application_id) {
+    char sd_name[17], title[256], name[MTP_MAX_FILENAME];
+    snprintf(sd_name, sizeof(sd_name), "%016lX", application_id);
+    if (titleCacheLookup(application_id, title, sizeof(title))) {
+        snprintf(name, sizeof(name), "%s [%s]", title, sd_name);
+    } else {
+        snprintf(name, sizeof(name), "%s", sd_name);
+    }
+    return add_snapshot_node(ctx, MTP_HANDLE_SAVES_SNAPSHOTS, SNAPSHOT_NODE_TITLE, sd_name, name, application_id);
+}
+
+// List the SD folder behind a node (parent NULL = the Snapshots root) into child nodes
+static void scan_snapshot_folder(SavesContext* ctx, u32 parent_handle, SnapshotNode* parent) {
+    char path[FS_MAX_PATH];
+    if (parent) {
+        if (!snapshot_node_path(ctx, parent, path, sizeof(path))) return;
+    } else {
+        snprintf(path, sizeof(path), "%s", SNAPSHOT_ROOT);
+    }
+
+    DIR* dir = opendir(path);
+    if (!dir) return;  // Nothing snapshotted yet
+
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char* name = ent->d_name;
+        if (name[0] == '.') continue;  // Also hides the chunk store
+
+        bool is_dir = (ent->d_type == DT_DIR);
+        if (ent->d_type == DT_UNKNOWN) {
+            char child[FS_MAX_PATH];
+            struct stat st;
+            snprintf(child, sizeof(child), "%s/%s", path, name);
+            is_dir = stat(child, &st) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (!parent) {
+            char* end = NULL;
+            u64 title_id = strtoull(name, &end, 16);
+            if (is_dir && strlen(name) == 16 && *end == '\0') add_title_node(ctx, title_id);
+        } else if (parent->kind == SNAPSHOT_NODE_TITLE) {
+            if (is_dir) add_snapshot_node(ctx, parent_handle, SNAPSHOT_NODE_DIR, name, name, parent->application_id);
+        } else if (parent->kind == SNAPSHOT_NODE_DIR) {
+            size_t len = strlen(name);
+            size_t ext = strlen(SNAPSHOT_EXT);
+            if (is_dir || len <= ext || strcmp(name + len - ext, SNAPSHOT_EXT) != 0) continue;
+
+            char label[MTP_MAX_FILENAME];
+            snprintf(label, sizeof(label), "%.*s%s", (int)(len - ext), name, MTP_SAVES_ARCHIVE_EXT);
+            add_snapshot_node(ctx, parent_handle, SNAPSHOT_NODE_ARCHIVE, name, label, parent->application_id);
+        }
+    }
+    closedir(dir);
+}
+
+static SaveNodeLinks* prepare_snapshot_children(SavesContext* ctx, u32 handle) {
+    if (handle == MTP_HANDLE_SAVES_SNAPSHOTS) {
+        if (!ctx->snapshots_scanned) {
+            scan_snapshot_folder(ctx, handle, NULL);
+            ctx->snapshots_scanned = true;
+        }
+        return &ctx->snapshot_root;
+    }
+
+    SnapshotNode* n = find_snapshot_node(ctx, handle);
+    if (!n || n->kind == SNAPSHOT_NODE_ARCHIVE) return NULL;
+    if (!n->scanned) {
+        scan_snapshot_folder(ctx, handle, n);
+        n->scanned = true;
+    }
+    return &n->links;
+}
+
+// The last opened snapshot archive stays cached for the reads that follow
+static SnapshotArchive* snapshot_archive_for(SavesContext* ctx, SnapshotNode* n) {
+    if (s_snapshot_archive && s_snapshot_archive_handle == n->handle) return s_snapshot_archive;
+    snapshot_close_archive();
+
+    char path[FS_MAX_PATH];
+    if (!snapshot_node_path(ctx, n, path, sizeof(path))) return NULL;
+    s_snapshot_archive = snapshotArchiveOpen(path);
+    if (!s_snapshot_archive) return NULL;
+
+    s_snapshot_archive_handle = n->handle;
+    n->size = snapshotArchiveSize(s_snapshot_archive);
+    n->sized = true;
+    return s_snapshot_archive;
+}
+
+// A save opened for a snapshot or restore job. The job gets a session of its
+// own, so a browsed save is committed and unmounted first (a save cannot be
+// opened twice) and is mounted again when the host next browses it.
+typedef struct {
+    u32 type_handle;            // Browsed save type that was unmounted, 0 if none
+    FsFileSystem fs;
+} SaveAccess;
+
+static bool snapshot_id_matches(SavesContext* ctx, SaveTypeEntry* t, const SnapshotSaveId* id) {
+    GameSaveEntry* g = game_at(ctx, t->game_index);
+    AccountUid uid = {0};
+    if (t->user_index >= 0 && t->user_index < ctx->user_count) uid = ctx->user_uids[t->user_index];
+    u16 cache_index = t->cache_index >= 0 ? (u16)t->cache_index : 0;
+    return g && g->application_id == id->application_id && t->save_type == id->save_type &&
+           t->space_id == id->space_id && cache_index == id->cache_index &&
+           memcmp(&uid, &id->uid, sizeof(uid)) == 0;
+}
+
+// Takes saves_mutex
+static bool save_access_open(SavesContext* ctx, const SnapshotSaveId* id, SaveAccess* a) {
+    memset(a, 0, sizeof(SaveAccess));
+    mutexLock(&ctx->saves_mutex);
+
+    for (u32 i = 0; i < ctx->types.count; i++) {
+        SaveTypeEntry* t = type_at(ctx, i);
+        if (!t || !snapshot_id_matches(ctx, t, id)) continue;
+
+        // Pending writes land first so a snapshot sees them and a restore replaces them
+        if (t->open_files > 0 || archive_pins_type(t->handle) || !commit_save_type(ctx, t)) {
+            mutexUnlock(&ctx->saves_mutex);
+            return false;
+        }
+        unmount_save_type(ctx, t);
+        a->type_handle = t->handle;
+        break;
+    }
+
+    FsSaveDataAttribute attr = {0};
+    attr.application_id = id->application_id;
+    attr.uid = id->uid;
+    attr.save_data_type = (FsSaveDataType)id->save_type;
+    attr.save_data_index = id->cache_index;
+    bool ok = R_SUCCEEDED(fsOpenSaveDataFileSystem(&a->fs, (FsSaveDataSpaceId)id->space_id, &attr));
+
+    mutexUnlock(&ctx->saves_mutex);
+    return ok;
+}
+
+// After a write the save is committed, or closed without a commit to drop it.
+// Takes saves_mutex to drop what the browser cached of a rewritten save.
+static bool save_access_close(SavesContext* ctx, SaveAccess* a, bool wrote, bool commit) {
+    bool ok = true;
+    if (wrote && commit) {
+        Result rc = fsFsCommit(&a->fs);
+        ok = R_SUCCEEDED(rc);
+        if (!ok) LOG_ERROR("[SAVES_SNAPSHOT] Commit failed: 0x%08X", rc);
+    }
+    fsFsClose(&a->fs);
+
+    if (wrote && a->type_handle) {
+        mutexLock(&ctx->saves_mutex);
+        SaveTypeEntry* t = find_type_by_handle(ctx, a->type_handle);
+        if (t) {
+            invalidate_archive(t);
+            drop_type_files(ctx, get_type_index(t));
+        }
+        mutexUnlock(&ctx->saves_mutex);
+    }
+    return ok;
+}
+
+// File name of a save's manifest, e.g. "Account - Nickname"
+static void snapshot_label(SavesContext* ctx, const SnapshotSaveId* id, char* out, size_t size) {
+    char type_name[32];
+    switch (id->save_type) {
+        case FsSaveDataType_Account: snprintf(type_name, sizeof(type_name), "Account"); break;
+        case FsSaveDataType_Device:  snprintf(type_name, sizeof(type_name), "Device"); break;
+        case FsSaveDataType_Bcat:    snprintf(type_name, sizeof(type_name), "BCAT"); break;
+        case FsSaveDataType_Cache:
+            snprintf(type_name, sizeof(type_name), "%s.%04d",
+                     id->space_id == FsSaveDataSpaceId_SdUser ? "SD_Cache" : "Cache", id->cache_index);
+            break;
+        default: snprintf(type_name, sizeof(type_name), "Type%u", id->save_type); break;
+    }
+
+    s32 ui = find_user_index(ctx, id->uid);
+    if (ui >= 0) {
+        snprintf(out, size, "%s - %s", type_name, ctx->user_names[ui]);
+    } else {
+        snprintf(out, size, "%s", type_name);
+    }
+
+    // Nicknames may contain characters FAT does not allow
+    for (char* p = out; *p; p++) {
+        if (strchr("\\/:*?\"<>|", *p)) *p = '_';
+    }
+}
+
+// Make a new snapshot folder visible in the tree; returns its node
+static SnapshotNode* note_snapshot_dir(SavesContext* ctx, u64 application_id, const char* stamp) {
+    prepare_snapshot_children(ctx, MTP_HANDLE_SAVES_SNAPSHOTS);
+
+    char sd_name[17];
+    snprintf(sd_name, sizeof(sd_name), "%016lX", application_id);
+    SnapshotNode* title = find_snapshot_child(ctx, MTP_HANDLE_SAVES_SNAPSHOTS, sd_name);
+    if (!title) title = add_title_node(ctx, application_id);
+    if (!title) return NULL;
+
+    // An unscanned title picks the folder up from the SD card
+    prepare_snapshot_children(ctx, title->handle);
+    SnapshotNode* dir = find_snapshot_child(ctx, title->handle, stamp);
+    return dir ? dir : add_snapshot_node(ctx, title->handle, SNAPSHOT_NODE_DIR, stamp, stamp, application_id);
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot jobs
+//
+// A request only adds its receipt and returns; the saves are snapshotted or
+// restored on a background thread, one job at a time. The job copies the save
+// list up front so a refresh cannot pull it away, takes saves_mutex only around
+// each save's open and close, and renames the receipt as it goes. Snapshot jobs
+// and deletions end by compacting the chunk store, on the same thread.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    SnapshotSaveId id;
+    char label[128];
+    char manifest[FS_MAX_PATH];  // Restores only
+} SnapshotJobItem;
+
+typedef struct {
+    SavesContext* ctx;
+    bool restore;
+    u32 receipt;                // Handle returned to the host
+    char stamp[SNAPSHOT_DIR_NAME_LEN];  // New snapshot folder, or the one restored
+    SnapshotJobItem* items;
+    u32 count;
+    u32 processed;              // Guarded by saves_mutex
+    u32 done;
+    bool compact;               // Reclaim unused chunks after the saves
+    u64 start;
+} SnapshotJob;
+
+static SnapshotJob s_job;
+static Thread s_job_thread;
+static bool s_job_running = false;  // Guarded by saves_mutex
+static bool s_job_joinable = false; // Thread created and not yet closed
+static bool s_job_stop = false;     // Set by savesExit while the job reads it, atomic
+static bool s_job_recompact = false; // Snapshots deleted while the job runs, guarded by saves_mutex
+
+// Receipt name: progress while running, then how many saves succeeded
+static void snapshot_job_text(const SnapshotJob* job, u32 processed, char* out, size_t size) {
+    if (processed < job->count) {
+        snprintf(out, size, "%s %s - running, %u of %u saves", job->restore ? "Restoring" : "Snapshot",
+                 job->stamp, processed, job->count);
+    } else {
+        snprintf(out, size, "%s %s - %u of %u saves", job->restore ? "Restored" : "Snapshot",
+                 job->stamp, job->done, job->count);
+    }
+}
+
+// Caller holds saves_mutex. The receipt is gone if a refresh rebuilt the tree.
+static void snapshot_job_report(SnapshotJob* job, u32 processed) {
+    SnapshotNode* n = find_snapshot_node(job->ctx, job->receipt);
+    if (!n || n->kind != SNAPSHOT_NODE_RECEIPT) return;
+
+    char text[MTP_MAX_FILENAME];
+    snapshot_job_text(job, processed, text, sizeof(text));
+    n->name = intern_name(job->ctx, text);
+}
+
+static bool snapshot_job_item(SnapshotJob* job, SnapshotJobItem* item) {
+    SavesContext* ctx = job->ctx;
+
+    if (job->restore && !snapshotReadSaveId(item->manifest, &item->id)) return false;
+
+    SaveAccess a;
+    if (!save_access_open(ctx, &item->id, &a)) {
+        LOG_ERROR("[SAVES_SNAPSHOT] Save %016lX '%s' is missing or in use", item->id.application_id, item->label);
+        return false;
+    }
+
+    if (job->restore) {
+        Result rc = snapshotRestore(&a.fs, item->manifest);
+        return save_access_close(ctx, &a, true, R_SUCCEEDED(rc)) && R_SUCCEEDED(rc);
+    }
+
+    char dir[FS_MAX_PATH];
+    snprintf(dir, sizeof(dir), SNAPSHOT_ROOT "/%016lX/%s", item->id.application_id, job->stamp);
+    Result rc = snapshotCreate(&a.fs, &item->id, dir, item->label, NULL);
+    save_access_close(ctx, &a, false, false);
+    if (R_FAILED(rc)) return false;
+
+    mutexLock(&ctx->saves_mutex);
+    note_snapshot_dir(ctx, item->id.application_id, job->stamp);
+    mutexUnlock(&ctx->saves_mutex);
+    return true;
+}
+
+static void snapshot_job_thread(void* arg) {
+    SnapshotJob* job = (SnapshotJob*)arg;
+    SavesContext* ctx = job->ctx;
+
+    u32 processed = 0;
+    for (; processed < job->count && !__atomic_load_n(&s_job_stop, __ATOMIC_RELAXED); processed++) {
+        if (snapshot_job_item(job, &job->items[processed])) job->done++;
+
+        mutexLock(&ctx->saves_mutex);
+        job->processed = processed + 1;
+        snapshot_job_report(job, processed + 1);
+        mutexUnlock(&ctx->saves_mutex);
+    }
+
+    if (job->count > 0) {
+        char text[MTP_MAX_FILENAME];
+        snapshot_job_text(job, job->count, text, sizeof(text));
+        LOG_INFO("[SAVES_SNAPSHOT] %s%s (%llu ms)", text, processed < job->count ? ", stopped" : "",
+                 (unsigned long long)(armTicksToNs(armGetSystemTick() - job->start) / 1000000ULL));
+    }
+    bool compact = job->compact && processed == job->count;
+    for (;;) {
+        if (compact) snapshotStoreCompact(&s_job_stop);
+
+        // Snapshots deleted in the meantime take another pass
+        mutexLock(&ctx->saves_mutex);
+        compact = s_job_recompact && !__atomic_load_n(&s_job_stop, __ATOMIC_RELAXED);
+        s_job_recompact = false;
+        if (!compact) break;
+        mutexUnlock(&ctx->saves_mutex);
+    }
+
+    free(job->items);
+    job->items = NULL;
+    s_job_running = false;
+    mutexUnlock(&ctx->saves_mutex);
+}
+
+// Caller holds saves_mutex
+static bool snapshot_job_busy(void) {
+    return s_job_running;
+}
+
+// Close the thread of a finished job
+static void snapshot_job_join(void) {
+    if (!s_job_joinable) return;
+    threadWaitForExit(&s_job_thread);
+    threadClose(&s_job_thread);
+    s_job_joinable = false;
+}
+
+// Stop after the save in progress and wait (exit); called without saves_mutex
+static void snapshot_job_stop(void) {
+    __atomic_store_n(&s_job_stop, true, __ATOMIC_RELAXED);
+    snapshot_job_join();
+    __atomic_store_n(&s_job_stop, false, __ATOMIC_RELAXED);
+}
+
+static bool job_add_item(SnapshotJob* job, u32* capacity) {
+    if (job->count < *capacity) return true;
+    u32 cap = *capacity ? *capacity * 2 : 16;
+    SnapshotJobItem* items = (SnapshotJobItem*)realloc(job->items, sizeof(SnapshotJobItem) * cap);
+    if (!items) return false;
+    job->items = items;
+    *capacity = cap;
+    return true;
+}
+
+// Every save of one title, or of all titles (application_id 0)
+static bool collect_snapshot_items(SavesContext* ctx, SnapshotJob* job, u64 application_id) {
+    u32 capacity = 0;
+    for (u32 i = 0; i < s_save_info_count; i++) {
+        const SaveInfoEntry* e = &s_save_info[i];
+        if (application_id && e->application_id != application_id) continue;
+        if (e->save_data_type == FsSaveDataType_Temporary) continue;  // Discarded by the system anyway
+        if (!job_add_item(job, &capacity)) return false;
+
+        SnapshotJobItem* item = &job->items[job->count++];
+        memset(item, 0, sizeof(SnapshotJobItem));
+        item->id.application_id = e->application_id;
+        item->id.uid = e->uid;
+        item->id.save_type = e->save_data_type;
+        item->id.space_id = e->space_id;
+        item->id.cache_index = e->save_data_index;
+        snapshot_label(ctx, &item->id, item->label, sizeof(item->label));
+    }
+    return true;
+}
+
+// Every manifest of a snapshot folder, restored into the save it was taken from
+static bool collect_restore_items(SavesContext* ctx, SnapshotJob* job, SnapshotNode* dir) {
+    SaveNodeLinks* links = prepare_snapshot_children(ctx, dir->handle);
+    if (!links) return false;
+
+    u32 capacity = 0;
+    for (u32 h = links->first_child; h; ) {
+        SnapshotNode* n = find_snapshot_node(ctx, h);
+        if (!n) break;
+        h = n->links.next_sibling;
+        if (n->kind != SNAPSHOT_NODE_ARCHIVE) continue;
+        if (!job_add_item(job, &capacity)) return false;
+
+        SnapshotJobItem* item = &job->items[job->count];
+        memset(item, 0, sizeof(SnapshotJobItem));
+        snprintf(item->label, sizeof(item->label), "%s", n->name);
+        if (snapshot_node_path(ctx, n, item->manifest, sizeof(item->manifest))) job->count++;
+    }
+    return true;
+}
+
+// Caller holds saves_mutex and has checked that no job is running
+static bool snapshot_job_start(SnapshotJob* job) {
+    Result rc = threadCreateForRole(&s_job_thread, snapshot_job_thread, job, 0x20000, THREAD_ROLE_BACKGROUND);
+    if (R_SUCCEEDED(rc)) {
+        s_job_running = true;   // Cleared by the job under saves_mutex
+        rc = threadStart(&s_job_thread);
+        if (R_FAILED(rc)) threadClose(&s_job_thread);
+    }
+    if (R_FAILED(rc)) {
+        s_job_running = false;
+        LOG_ERROR("[SAVES_SNAPSHOT] Failed to start snapshot job: 0x%08X", rc);
+        free(job->items);
+        job->items = NULL;
+        return false;
+    }
+    s_job_joinable = true;
+    return true;
+}
+
+// Requests are named explicitly, so a stray folder never snapshots every save
+// and only a deliberate name overwrites live saves. Hosts that create "New
+// folder" first get a plain folder and start the request by renaming it.
+#define SNAPSHOT_REQUEST_NAME   "Snapshot"
+#define RESTORE_REQUEST_NAME    "Restore"
+
+typedef enum {
+    SNAPSHOT_REQUEST_NONE = 0,
+    SNAPSHOT_REQUEST_CREATE,    // "Snapshot..." in Snapshots (every save) or in a title folder
+    SNAPSHOT_REQUEST_RESTORE,   // "Restore..." in a snapshot folder
+} SnapshotRequestKind;
+
+static SnapshotRequestKind snapshot_request_kind(SavesContext* ctx, u32 parent, const char* name) {
+    bool create = strncasecmp(name, SNAPSHOT_REQUEST_NAME, strlen(SNAPSHOT_REQUEST_NAME)) == 0;
+    bool restore = strncasecmp(name, RESTORE_REQUEST_NAME, strlen(RESTORE_REQUEST_NAME)) == 0;
+    if (parent == MTP_HANDLE_SAVES_SNAPSHOTS) return create ? SNAPSHOT_REQUEST_CREATE : SNAPSHOT_REQUEST_NONE;
+
+    SnapshotNode* n = find_snapshot_node(ctx, parent);
+    if (n && n->kind == SNAPSHOT_NODE_TITLE && create) return SNAPSHOT_REQUEST_CREATE;
+    if (n && n->kind == SNAPSHOT_NODE_DIR && restore) return SNAPSHOT_REQUEST_RESTORE;
+    return SNAPSHOT_REQUEST_NONE;
+}
+
+// Start the job a request folder asks for. The folder becomes the job's
+// receipt: its name tracks the job from now on.
+static bool snapshot_request(SavesContext* ctx, SnapshotNode* receipt, SnapshotRequestKind kind) {
+    if (snapshot_job_busy()) {
+        LOG_ERROR("[SAVES_SNAPSHOT] A snapshot job is still running");
+        return false;
+    }
+    snapshot_job_join();
+
+    SnapshotJob* job = &s_job;
+    memset(job, 0, sizeof(SnapshotJob));
+    job->ctx = ctx;
+    job->start = armGetSystemTick();
+
+    u32 parent = receipt->parent_handle;
+    SnapshotNode* p = find_snapshot_node(ctx, parent);
+    bool ok;
+    if (kind == SNAPSHOT_REQUEST_RESTORE) {
+        job->restore = true;
+        snprintf(job->stamp, sizeof(job->stamp), "%s", p->sd_name);
+        snapshot_close_archive();
+        ok = collect_restore_items(ctx, job, p);
+    } else {
+        snapshotMakeDirName(job->stamp, sizeof(job->stamp));
+        ok = collect_snapshot_items(ctx, job, p ? p->application_id : 0);
+    }
+    if (!ok) {
+        LOG_ERROR("[SAVES_SNAPSHOT] Out of memory for the save list");
+        free(job->items);
+        job->items = NULL;
+        return false;
+    }
+
+    char text[MTP_MAX_FILENAME];
+    snapshot_job_text(job, 0, text, sizeof(text));
+    receipt->name = intern_name(ctx, text);
+    if (job->count == 0) {
+        free(job->items);
+        job->items = NULL;
+        return true;
+    }
+    job->receipt = receipt->handle;
+    job->compact = !job->restore;
+
+    if (!snapshot_job_start(job)) return false;
+    LOG_INFO("[SAVES_SNAPSHOT] %s", text);
+    return true;
+}
+
+// Folder created in the Snapshots tree: a request if its name says so,
+// otherwise a plain folder that can still be renamed into one
+static u32 snapshot_folder_created(SavesContext* ctx, u32 parent, const char* name) {
+    SnapshotNode* p = find_snapshot_node(ctx, parent);
+    if (parent != MTP_HANDLE_SAVES_SNAPSHOTS &&
+        (!p || (p->kind != SNAPSHOT_NODE_TITLE && p->kind != SNAPSHOT_NODE_DIR))) {
+        return 0;
+    }
+
+    SnapshotNode* receipt = add_snapshot_node(ctx, parent, SNAPSHOT_NODE_RECEIPT, NULL, name, 0);
+    if (!receipt) return 0;
+
+    SnapshotRequestKind kind = snapshot_request_kind(ctx, parent, name);
+    if (kind != SNAPSHOT_REQUEST_NONE && !snapshot_request(ctx, receipt, kind)) {
+        unlink_child(ctx, parent, receipt->handle);
+        free_snapshot_node(ctx, receipt);
+        return 0;
+    }
+    return receipt->handle;
+}
+
+// rm -r of a snapshot or title folder on the SD card
+static bool remove_sd_folder(const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) return false;
+
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        char child[FS_MAX_PATH];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        struct stat st;
+        if (stat(child, &st) == 0 && S_ISDIR(st.st_mode)) remove_sd_folder(child);
+        else remove(child);
+    }
+    closedir(dir);
+    return rmdir(path) == 0;
+}
+
+static void remove_snapshot_subtree(SavesContext* ctx, SnapshotNode* n) {
+    for (u32 h = n->links.first_child; h; ) {
+        SnapshotNode* child = find_snapshot_node(ctx, h);
+        if (!child) break;
+        h = child->links.next_sibling;
+        remove_snapshot_subtree(ctx, child);
     }
+    if (s_snapshot_archive_handle == n->handle) snapshot_close_archive();
+    free_snapshot_node(ctx, n);
+}
 
-    char path[512];
-    snprintf(path, sizeof(path), "%s:/", type->mount_name);
+// Delete a snapshot, a snapshot folder or a title's snapshots, then compact the
+// chunk store in the background so their chunks free SD space. Hosts delete a
+// folder one object at a time, so deleting is only refused while a job is still
+// on its saves. Caller holds saves_mutex.
+static bool snapshot_delete(SavesContext* ctx, SnapshotNode* n) {
+    if (snapshot_job_busy() && s_job.processed < s_job.count) {
+        LOG_ERROR("[SAVES_SNAPSHOT] A snapshot job is still running");
+        return false;
+    }
 
-    u32 type_idx = 0;
-    for (u32 i = 0; i < ctx->type_count; i++) {
-        if (&ctx->types[i] == type) { type_idx = i; break; }
+    char path[FS_MAX_PATH];
+    if (!snapshot_node_path(ctx, n, path, sizeof(path))) return false;
+    bool ok = n->kind == SNAPSHOT_NODE_ARCHIVE ? remove(path) == 0 : remove_sd_folder(path);
+    if (!ok) {
+        LOG_ERROR("[SAVES_SNAPSHOT] Failed to delete %s", path);
+        return false;
     }
+    LOG_INFO("[SAVES_SNAPSHOT] Deleted %s", path);
 
-    scan_directory(ctx, type_idx, type->handle, path);
-    type->scanned = true;
-    LOG_DEBUG("[SAVES_ENSURE_TYPE] Type 0x%08X scan complete", type->handle);
-}
+    unlink_child(ctx, n->parent_handle, n->handle);
+    remove_snapshot_subtree(ctx, n);
 
-static void ensure_file_scanned(SavesContext* ctx, SaveFileEntry* file) {
-    if (!file->is_directory || file->scanned) return;
-    scan_directory(ctx, file->type_index, file->handle, file->full_path);
-    file->scanned = true;
+    if (snapshot_job_busy()) {
+        s_job_recompact = true;
+        return true;
+    }
+    snapshot_job_join();
+    SnapshotJob* job = &s_job;
+    memset(job, 0, sizeof(SnapshotJob));
+    job->ctx = ctx;
+    job->compact = true;
+    job->start = armGetSystemTick();
+    snapshot_job_start(job);  // On failure the next snapshot compacts instead
+    return true;
 }
 
 static bool ensure_services(SavesContext* ctx) {
     if (ctx->user_count > 0) return true;
 
     if (!ctx->acc_initialized) {
-        accountInitialize(AccountServiceType_System);
-        ctx->acc_initialized = true;
+        ctx->acc_initialized = R_SUCCEEDED(servicesAcquire(SERVICE_ACCOUNT));
     }
 
     if (!ctx->ns_initialized) {
-        nsInitialize();
-        ctx->ns_initialized = true;
+        ctx->ns_initialized = R_SUCCEEDED(servicesAcquire(SERVICE_NS));
     }
 
     return enumerate_all_users(ctx);
@@ -593,35 +2070,12 @@ Result savesInit(SavesContext* ctx) {
     memset(ctx, 0, sizeof(SavesContext));
     mutexInit(&ctx->saves_mutex);
 
-    ctx->max_games = MTP_SAVES_MAX_GAMES;
-    ctx->games = (GameSaveEntry*)malloc(sizeof(GameSaveEntry) * ctx->max_games);
-
-    ctx->max_user_folders = MTP_SAVES_MAX_USER_FOLDERS;
-    ctx->user_folders = (UserFolderEntry*)malloc(sizeof(UserFolderEntry) * ctx->max_user_folders);
-
-    ctx->max_types = MTP_SAVES_MAX_TYPES;
-    ctx->types = (SaveTypeEntry*)malloc(sizeof(SaveTypeEntry) * ctx->max_types);
+    pool_init(&ctx->games, sizeof(GameSaveEntry));
+    pool_init(&ctx->user_folders, sizeof(UserFolderEntry));
+    pool_init(&ctx->types, sizeof(SaveTypeEntry));
+    pool_init(&ctx->files, sizeof(SaveFileEntry));
+    pool_init(&ctx->snapshot_nodes, sizeof(SnapshotNode));
 
-    ctx->max_files = MTP_SAVES_MAX_FILES;
-    ctx->files = (SaveFileEntry*)malloc(sizeof(SaveFileEntry) * ctx->max_files);
-
-    if (!ctx->games || !ctx->user_folders || !ctx->types || !ctx->files) {
-        LOG_ERROR("Saves: Memory allocation failed");
-        free(ctx->games);
-        free(ctx->user_folders);
-        free(ctx->types);
-        free(ctx->files);
-        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
-    }
-
-    memset(ctx->games, 0, sizeof(GameSaveEntry) * ctx->max_games);
-    memset(ctx->user_folders, 0, sizeof(UserFolderEntry) * ctx->max_user_folders);
-    memset(ctx->types, 0, sizeof(SaveTypeEntry) * ctx->max_types);
-    memset(ctx->files, 0, sizeof(SaveFileEntry) * ctx->max_files);
-
-    ctx->next_user_handle = MTP_HANDLE_SAVES_USER_START;
-    ctx->next_type_handle = MTP_HANDLE_SAVES_TYPE_START;
-    ctx->next_file_handle = MTP_HANDLE_SAVES_FILE_START;
     ctx->initialized = true;
     ctx->needs_refresh = true;
     ctx->refresh_in_progress = false;
@@ -635,12 +2089,10 @@ void savesPreInitServices(SavesContext* ctx) {
     if (!ctx->initialized) return;
 
     if (!ctx->acc_initialized) {
-        accountInitialize(AccountServiceType_System);
-        ctx->acc_initialized = true;
+        ctx->acc_initialized = R_SUCCEEDED(servicesAcquire(SERVICE_ACCOUNT));
     }
     if (!ctx->ns_initialized) {
-        nsInitialize();
-        ctx->ns_initialized = true;
+        ctx->ns_initialized = R_SUCCEEDED(servicesAcquire(SERVICE_NS));
     }
 
     LOG_INFO("Saves: Services pre-initialized");
@@ -665,49 +2117,38 @@ void savesRefreshIfNeeded(SavesContext* ctx) {
     mutexLock(&ctx->saves_mutex);
     ctx->refresh_in_progress = false;
     mutexUnlock(&ctx->saves_mutex);
-    LOG_INFO("Saves: Refresh complete, %u games found", ctx->game_count);
+    LOG_INFO("Saves: Refresh complete, %u games found", ctx->games.count);
 }
 
 void savesExit(SavesContext* ctx) {
     if (!ctx->initialized) return;
 
     stop_background_refresh();
+    snapshot_job_stop();
 
     mutexLock(&ctx->saves_mutex);
 
-    for (u32 i = 0; i < ctx->type_count; i++) {
-        unmount_save_type(&ctx->types[i]);
-    }
-
-    free(ctx->files);
-    free(ctx->types);
-    free(ctx->user_folders);
-    free(ctx->games);
+    close_all_types(ctx);
+    clear_model(ctx);
 
-    ctx->files = NULL;
-    ctx->types = NULL;
-    ctx->user_folders = NULL;
-    ctx->games = NULL;
-    ctx->file_count = 0;
-    ctx->type_count = 0;
-    ctx->user_folder_count = 0;
-    ctx->game_count = 0;
+    free(s_save_info);
+    s_save_info = NULL;
+    s_save_info_count = 0;
+    s_save_info_capacity = 0;
 
     mutexUnlock(&ctx->saves_mutex);
 
     if (ctx->ns_initialized) {
-        nsExit();
+        servicesRelease(SERVICE_NS);
+        ctx->ns_initialized = false;
     }
     if (ctx->acc_initialized) {
-        accountExit();
+        servicesRelease(SERVICE_ACCOUNT);
+        ctx->acc_initialized = false;
     }
 
     ctx->initialized = false;
 
-    mutexLock(&s_name_cache_mutex);
-    s_name_cache_count = 0;
-    mutexUnlock(&s_name_cache_mutex);
-
     LOG_INFO("Saves: Cleanup complete");
 }
 
@@ -735,6 +2176,16 @@ bool savesGetStorageInfo(SavesContext* ctx, u32 storage_id, MtpStorageInfo* out)
     return true;
 }
 
+static bool reserve_save_info(void) {
+    if (s_save_info_count < s_save_info_capacity) return true;
+    u32 cap = s_save_info_capacity ? s_save_info_capacity * 2 : 256;
+    SaveInfoEntry* info = (SaveInfoEntry*)realloc(s_save_info, sizeof(SaveInfoEntry) * cap);
+    if (!info) return false;
+    s_save_info = info;
+    s_save_info_capacity = cap;
+    return true;
+}
+
 static Thread s_refresh_thread;
 static bool s_refresh_running = false;
 static bool s_refresh_stop = false;
@@ -744,12 +2195,10 @@ static void do_refresh_internal(SavesContext* ctx) {
     LOG_DEBUG("[SAVES_REFRESH] do_refresh_internal: START");
 
     if (!ctx->acc_initialized) {
-        accountInitialize(AccountServiceType_System);
-        ctx->acc_initialized = true;
+        ctx->acc_initialized = R_SUCCEEDED(servicesAcquire(SERVICE_ACCOUNT));
     }
     if (!ctx->ns_initialized) {
-        nsInitialize();
-        ctx->ns_initialized = true;
+        ctx->ns_initialized = R_SUCCEEDED(servicesAcquire(SERVICE_NS));
     }
 
     LOG_DEBUG("[SAVES_REFRESH] Enumerating users");
@@ -803,7 +2252,7 @@ static void do_refresh_internal(SavesContext* ctx) {
                 if (title_type != 0x0100 && title_type != 0x0101 && title_type != 0x0102) continue;
 
                 mutexLock(&ctx->saves_mutex);
-                if (s_save_info_count < MAX_SAVE_INFO_ENTRIES) {
+                if (reserve_save_info()) {
                     SaveInfoEntry* e = &s_save_info[s_save_info_count++];
                     e->application_id = app_id;
                     e->uid = info[i].uid;
@@ -818,24 +2267,34 @@ static void do_refresh_internal(SavesContext* ctx) {
         fsSaveDataInfoReaderClose(&reader);
     }
 
-    LOG_DEBUG("[SAVES_REFRESH] Fetching names for %u games", ctx->game_count);
-    for (u32 i = 0; i < ctx->game_count; i++) {
-        GameSaveEntry* g = &ctx->games[i];
-        NameCacheEntry* entry = get_name_cache_entry(g->application_id);
-        if (entry && !entry->fetched) {
-            fetch_name_for_entry(entry);
-            mutexLock(&ctx->saves_mutex);
-            strncpy(g->game_name, entry->name, sizeof(g->game_name) - 1);
-            g->is_installed = entry->is_installed;
-            mutexUnlock(&ctx->saves_mutex);
+    // Games are listed with cached names right away; resolve the rest in one batch
+    u32 game_count = ctx->games.count;
+    u64* ids = (u64*)malloc(sizeof(u64) * game_count * 2);
+    if (ids) {
+        u32 id_count = 0;
+        for (u32 i = 0; i < game_count; i++) {
+            u64 app_id = game_at(ctx, i)->application_id;
+            ids[id_count++] = app_id;
+            if (get_base_title_id(app_id) != app_id) ids[id_count++] = get_base_title_id(app_id);
         }
-        if ((i % 10) == 0) svcSleepThread(1000000ULL);
+        LOG_DEBUG("[SAVES_REFRESH] Resolving names for %u games", game_count);
+        titleCacheFetch(ids, id_count);
+        free(ids);
     }
 
+    mutexLock(&ctx->saves_mutex);
+    for (u32 i = 0; i < game_count; i++) {
+        GameSaveEntry* g = game_at(ctx, i);
+        char name[256];
+        g->is_installed = check_installation_status(g->application_id, name, sizeof(name));
+        if (strcmp(name, g->game_name) != 0) g->game_name = intern_name(ctx, name);
+    }
+    mutexUnlock(&ctx->saves_mutex);
+
     mutexLock(&ctx->saves_mutex);
     ctx->needs_refresh = false;
     mutexUnlock(&ctx->saves_mutex);
-    LOG_DEBUG("[SAVES_REFRESH] do_refresh_internal: END - found %u games", ctx->game_count);
+    LOG_DEBUG("[SAVES_REFRESH] do_refresh_internal: END - found %u games", ctx->games.count);
 }
 
 static void refresh_thread_func(void* arg) {
@@ -850,7 +2309,7 @@ static void refresh_thread_func(void* arg) {
     do_refresh_internal(ctx);
 
     s_refresh_running = false;
-    LOG_INFO("[SAVES_BG_THREAD] Background refresh complete (%u games)", ctx->game_count);
+    LOG_INFO("[SAVES_BG_THREAD] Background refresh complete (%u games)", ctx->games.count);
 }
 
 static void start_background_refresh(SavesContext* ctx) {
@@ -860,7 +2319,7 @@ static void start_background_refresh(SavesContext* ctx) {
     s_refresh_ctx = ctx;
     s_refresh_running = true;
 
-    Result rc = threadCreate(&s_refresh_thread, refresh_thread_func, ctx, NULL, 0x20000, 0x2C, -2);
+    Result rc = threadCreateForRole(&s_refresh_thread, refresh_thread_func, ctx, 0x20000, THREAD_ROLE_BACKGROUND);
     if (R_SUCCEEDED(rc)) {
         threadStart(&s_refresh_thread);
     } else {
@@ -891,16 +2350,8 @@ Result savesRefresh(SavesContext* ctx) {
     if (!ctx->initialized) return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
 
     mutexLock(&ctx->saves_mutex);
-    for (u32 i = 0; i < ctx->type_count; i++) {
-        unmount_save_type(&ctx->types[i]);
-    }
-    ctx->game_count = 0;
-    ctx->user_folder_count = 0;
-    ctx->type_count = 0;
-    ctx->file_count = 0;
-    ctx->next_user_handle = MTP_HANDLE_SAVES_USER_START;
-    ctx->next_type_handle = MTP_HANDLE_SAVES_TYPE_START;
-    ctx->next_file_handle = MTP_HANDLE_SAVES_FILE_START;
+    close_all_types(ctx);
+    clear_model(ctx);
     s_save_info_count = 0;
     ctx->needs_refresh = true;
     mutexUnlock(&ctx->saves_mutex);
@@ -908,6 +2359,44 @@ Result savesRefresh(SavesContext* ctx) {
     return 0;
 }
 
+// Make sure the children of a folder are known (lazy game build / save mount / dir scan).
+// Returns the folder's child list, or NULL if parent is not a browsable folder.
+static SaveNodeLinks* prepare_children(SavesContext* ctx, u32 parent_handle, bool* has_archive) {
+    *has_archive = false;
+
+    if (parent_handle == MTP_HANDLE_SAVES_SNAPSHOTS || is_snapshot_handle(parent_handle)) {
+        return prepare_snapshot_children(ctx, parent_handle);
+    }
+    if (is_game_handle(parent_handle)) {
+        GameSaveEntry* g = find_game_by_handle(ctx, parent_handle);
+        if (!g) return NULL;
+        build_game_structure(ctx, g->game_index);
+        return &g->links;
+    }
+    if (is_user_handle(parent_handle)) {
+        UserFolderEntry* uf = find_user_folder_by_handle(ctx, parent_handle);
+        if (!uf) return NULL;
+        touch_game(ctx, uf->game_index);
+        return &uf->links;
+    }
+    if (is_type_handle(parent_handle)) {
+        SaveTypeEntry* t = find_type_by_handle(ctx, parent_handle);
+        if (!t) return NULL;
+        touch_game(ctx, t->game_index);
+        ensure_type_scanned(ctx, t);
+        *has_archive = !t->mount_failed;
+        return &t->links;
+    }
+    if (is_file_handle(parent_handle)) {
+        SaveFileEntry* f = find_file_by_handle(ctx, parent_handle);
+        if (!f || !f->is_directory) return NULL;
+        touch_game(ctx, f->game_index);
+        ensure_file_scanned(ctx, f);
+        return &f->links;
+    }
+    return NULL;
+}
+
 u32 savesGetObjectCount(SavesContext* ctx, u32 storage_id, u32 parent_handle) {
     if (!ctx->initialized || storage_id != MTP_STORAGE_SAVES) {
         LOG_DEBUG("[SAVES_GET_COUNT] Invalid context or storage_id");
@@ -919,51 +2408,15 @@ u32 savesGetObjectCount(SavesContext* ctx, u32 storage_id, u32 parent_handle) {
     u32 count = 0;
 
     if (parent_handle == 0 || parent_handle == 0xFFFFFFFF) {
-        count = ctx->game_count;
-        LOG_DEBUG("[SAVES_GET_COUNT] Root level: %u games", count);
-    }
-    else if (is_game_handle(parent_handle)) {
-        u32 idx = get_game_index(parent_handle);
-        if (idx < ctx->game_count) {
-            LOG_DEBUG("[SAVES_GET_COUNT] Game handle 0x%08X (index %u)", parent_handle, idx);
-            build_game_structure(ctx, idx);
-
-            for (u32 i = 0; i < ctx->user_folder_count; i++) {
-                if (ctx->user_folders[i].parent_game_handle == parent_handle) count++;
-            }
-            for (u32 i = 0; i < ctx->type_count; i++) {
-                if (ctx->types[i].parent_handle == parent_handle) count++;
-            }
-            LOG_DEBUG("[SAVES_GET_COUNT] Game has %u children", count);
-        }
-    }
-    else if (is_user_handle(parent_handle)) {
-        for (u32 i = 0; i < ctx->type_count; i++) {
-            if (ctx->types[i].parent_handle == parent_handle) count++;
-        }
-        LOG_DEBUG("[SAVES_GET_COUNT] User handle 0x%08X: %u types", parent_handle, count);
-    }
-    else if (is_type_handle(parent_handle)) {
-        SaveTypeEntry* t = find_type_by_handle(ctx, parent_handle);
-        if (t) {
-            LOG_DEBUG("[SAVES_GET_COUNT] Type handle 0x%08X, scanning...", parent_handle);
-            ensure_type_scanned(ctx, t);
-            for (u32 i = 0; i < ctx->file_count; i++) {
-                if (ctx->files[i].parent_handle == parent_handle) count++;
-            }
-            LOG_DEBUG("[SAVES_GET_COUNT] Type has %u files", count);
-        }
-    }
-    else if (is_file_handle(parent_handle)) {
-        SaveFileEntry* f = find_file_by_handle(ctx, parent_handle);
-        if (f && f->is_directory) {
-            LOG_DEBUG("[SAVES_GET_COUNT] File handle 0x%08X (directory), scanning...", parent_handle);
-            ensure_file_scanned(ctx, f);
-            for (u32 i = 0; i < ctx->file_count; i++) {
-                if (ctx->files[i].parent_handle == parent_handle) count++;
-            }
-            LOG_DEBUG("[SAVES_GET_COUNT] Directory has %u children", count);
+        count = ctx->games.count + 1;  // Games and the Snapshots folder
+        LOG_DEBUG("[SAVES_GET_COUNT] Root level: %u games", ctx->games.count);
+    } else {
+        bool has_archive = false;
+        SaveNodeLinks* links = prepare_children(ctx, parent_handle, &has_archive);
+        if (links) {
+            count = links->child_count + (has_archive ? 1 : 0);
         }
+        LOG_DEBUG("[SAVES_GET_COUNT] Handle 0x%08X has %u children", parent_handle, count);
     }
 
     mutexUnlock(&ctx->saves_mutex);
@@ -986,63 +2439,25 @@ u32 savesEnumObjects(SavesContext* ctx, u32 storage_id, u32 parent_handle, u32*
     u32 count = 0;
 
     if (parent_handle == 0 || parent_handle == 0xFFFFFFFF) {
-        LOG_DEBUG("[SAVES_ENUM] Root level, %u games available", ctx->game_count);
-        for (u32 i = 0; i < ctx->game_count && count < max; i++) {
-            handles[count++] = ctx->games[i].folder_handle;
-        }
-    }
-    else if (is_game_handle(parent_handle)) {
-        u32 idx = get_game_index(parent_handle);
-        if (idx < ctx->game_count) {
-            LOG_DEBUG("[SAVES_ENUM] Game handle 0x%08X (index %u)", parent_handle, idx);
-            build_game_structure(ctx, idx);
-
-            for (u32 i = 0; i < ctx->user_folder_count && count < max; i++) {
-                if (ctx->user_folders[i].parent_game_handle == parent_handle) {
-                    handles[count++] = ctx->user_folders[i].handle;
-                }
-            }
-            for (u32 i = 0; i < ctx->type_count && count < max; i++) {
-                if (ctx->types[i].parent_handle == parent_handle) {
-                    handles[count++] = ctx->types[i].handle;
-                }
-            }
-            LOG_DEBUG("[SAVES_ENUM] Returning %u handles for game", count);
-        }
-    }
-    else if (is_user_handle(parent_handle)) {
-        for (u32 i = 0; i < ctx->type_count && count < max; i++) {
-            if (ctx->types[i].parent_handle == parent_handle) {
-                handles[count++] = ctx->types[i].handle;
-            }
+        LOG_DEBUG("[SAVES_ENUM] Root level, %u games available", ctx->games.count);
+        if (count < max) handles[count++] = MTP_HANDLE_SAVES_SNAPSHOTS;
+        for (u32 i = 0; i < ctx->games.count && count < max; i++) {
+            handles[count++] = game_at(ctx, i)->folder_handle;
         }
-        LOG_DEBUG("[SAVES_ENUM] Returning %u type handles for user", count);
-    }
-    else if (is_type_handle(parent_handle)) {
-        SaveTypeEntry* t = find_type_by_handle(ctx, parent_handle);
-        if (t) {
-            LOG_DEBUG("[SAVES_ENUM] Type handle 0x%08X, scanning files", parent_handle);
-            ensure_type_scanned(ctx, t);
-            for (u32 i = 0; i < ctx->file_count && count < max; i++) {
-                if (ctx->files[i].parent_handle == parent_handle) {
-                    handles[count++] = ctx->files[i].handle;
-                }
+    } else {
+        bool has_archive = false;
+        SaveNodeLinks* links = prepare_children(ctx, parent_handle, &has_archive);
+        if (links) {
+            if (has_archive && count < max) {
+                handles[count++] = parent_handle + ARCHIVE_HANDLE_OFFSET;
             }
-            LOG_DEBUG("[SAVES_ENUM] Returning %u file handles", count);
-        }
-    }
-    else if (is_file_handle(parent_handle)) {
-        SaveFileEntry* f = find_file_by_handle(ctx, parent_handle);
-        if (f && f->is_directory) {
-            LOG_DEBUG("[SAVES_ENUM] Directory file handle 0x%08X, scanning contents", parent_handle);
-            ensure_file_scanned(ctx, f);
-            for (u32 i = 0; i < ctx->file_count && count < max; i++) {
-                if (ctx->files[i].parent_handle == parent_handle) {
-                    handles[count++] = ctx->files[i].handle;
-                }
+            for (u32 h = links->first_child; h && count < max; ) {
+                handles[count++] = h;
+                SaveNodeLinks* l = get_links(ctx, h);
+                h = l ? l->next_sibling : 0;
             }
-            LOG_DEBUG("[SAVES_ENUM] Returning %u child handles", count);
         }
+        LOG_DEBUG("[SAVES_ENUM] Returning %u handles for 0x%08X", count, parent_handle);
     }
 
     mutexUnlock(&ctx->saves_mutex);
@@ -1057,9 +2472,8 @@ bool savesGetObjectInfo(SavesContext* ctx, u32 handle, MtpObject* out) {
     bool found = false;
 
     if (is_game_handle(handle)) {
-        u32 idx = get_game_index(handle);
-        if (idx < ctx->game_count) {
-            GameSaveEntry* g = &ctx->games[idx];
+        GameSaveEntry* g = find_game_by_handle(ctx, handle);
+        if (g) {
             out->handle = handle;
             out->parent_handle = 0xFFFFFFFF;
             out->storage_id = MTP_STORAGE_SAVES;
@@ -1079,7 +2493,7 @@ bool savesGetObjectInfo(SavesContext* ctx, u32 handle, MtpObject* out) {
             out->storage_id = MTP_STORAGE_SAVES;
             out->format = MTP_FORMAT_ASSOCIATION;
             out->object_type = MTP_OBJECT_TYPE_FOLDER;
-            snprintf(out->filename, MTP_MAX_FILENAME - 1, "User: %s", uf->username);
+            snprintf(out->filename, MTP_MAX_FILENAME - 1, "User: %s", ctx->user_names[uf->user_index]);
             found = true;
         }
     }
@@ -1095,6 +2509,42 @@ bool savesGetObjectInfo(SavesContext* ctx, u32 handle, MtpObject* out) {
             found = true;
         }
     }
+    else if (is_archive_handle(handle)) {
+        SaveTypeEntry* t = find_type_by_archive_handle(ctx, handle);
+        if (t && (t->archive_sized || archive_build_manifest(ctx, t))) {
+            out->handle = handle;
+            out->parent_handle = t->handle;
+            out->storage_id = MTP_STORAGE_SAVES;
+            out->format = MTP_FORMAT_UNDEFINED;
+            out->object_type = MTP_OBJECT_TYPE_FILE;
+            out->size = t->archive_size;
+            snprintf(out->filename, MTP_MAX_FILENAME - 1, "%s%s", t->name, MTP_SAVES_ARCHIVE_EXT);
+            found = true;
+        }
+    }
+    else if (handle == MTP_HANDLE_SAVES_SNAPSHOTS) {
+        out->handle = handle;
+        out->parent_handle = 0xFFFFFFFF;
+        out->storage_id = MTP_STORAGE_SAVES;
+        out->format = MTP_FORMAT_ASSOCIATION;
+        out->object_type = MTP_OBJECT_TYPE_FOLDER;
+        strncpy(out->filename, "Snapshots", MTP_MAX_FILENAME - 1);
+        found = true;
+    }
+    else if (is_snapshot_handle(handle)) {
+        SnapshotNode* n = find_snapshot_node(ctx, handle);
+        bool is_archive = n && n->kind == SNAPSHOT_NODE_ARCHIVE;
+        if (n && (!is_archive || n->sized || snapshot_archive_for(ctx, n))) {
+            out->handle = handle;
+            out->parent_handle = n->parent_handle;
+            out->storage_id = MTP_STORAGE_SAVES;
+            out->format = is_archive ? MTP_FORMAT_UNDEFINED : MTP_FORMAT_ASSOCIATION;
+            out->object_type = is_archive ? MTP_OBJECT_TYPE_FILE : MTP_OBJECT_TYPE_FOLDER;
+            out->size = is_archive ? n->size : 0;
+            strncpy(out->filename, n->name, MTP_MAX_FILENAME - 1);
+            found = true;
+        }
+    }
     else if (is_file_handle(handle)) {
         SaveFileEntry* f = find_file_by_handle(ctx, handle);
         if (f) {
@@ -1105,7 +2555,7 @@ bool savesGetObjectInfo(SavesContext* ctx, u32 handle, MtpObject* out) {
             out->size = f->size;
             out->object_type = f->is_directory ? MTP_OBJECT_TYPE_FOLDER : MTP_OBJECT_TYPE_FILE;
             strncpy(out->filename, f->filename, MTP_MAX_FILENAME - 1);
-            strncpy(out->full_path, f->full_path, MTP_MAX_PATH - 1);
+            build_file_path(ctx, f, out->full_path, MTP_MAX_PATH);
             found = true;
         }
     }
@@ -1116,60 +2566,270 @@ bool savesGetObjectInfo(SavesContext* ctx, u32 handle, MtpObject* out) {
 
 GameSaveEntry* savesGetGameForHandle(SavesContext* ctx, u32 handle) {
     if (is_game_handle(handle)) {
-        u32 idx = get_game_index(handle);
-        return (idx < ctx->game_count) ? &ctx->games[idx] : NULL;
+        return find_game_by_handle(ctx, handle);
     }
     if (is_user_handle(handle)) {
         UserFolderEntry* uf = find_user_folder_by_handle(ctx, handle);
-        return uf ? &ctx->games[uf->game_index] : NULL;
+        return uf ? game_at(ctx, uf->game_index) : NULL;
     }
     if (is_type_handle(handle)) {
         SaveTypeEntry* t = find_type_by_handle(ctx, handle);
-        return t ? &ctx->games[t->game_index] : NULL;
+        return t ? game_at(ctx, t->game_index) : NULL;
+    }
+    if (is_archive_handle(handle)) {
+        SaveTypeEntry* t = find_type_by_archive_handle(ctx, handle);
+        return t ? game_at(ctx, t->game_index) : NULL;
     }
     if (is_file_handle(handle)) {
         SaveFileEntry* f = find_file_by_handle(ctx, handle);
-        return f ? &ctx->games[f->game_index] : NULL;
+        return f ? game_at(ctx, f->game_index) : NULL;
     }
     return NULL;
 }
 
-s64 savesReadObject(SavesContext* ctx, u32 handle, u64 offset, void* buf, u64 size) {
-    if (!ctx->initialized || !is_file_handle(handle)) return -1;
+// ---------------------------------------------------------------------------
+// Streaming file handles
+// ---------------------------------------------------------------------------
+
+struct SavesFileHandle {
+    SavesContext* ctx;
+    u32 handle;
+    u32 type_index;
+    bool is_archive;            // Streams through the archive reader/extractor
+    bool is_snapshot;           // Read-only stream of a snapshot archive
+    bool writable;
+    FsFile file;
+    u64 offset;
+    u64 size;
+};
+
+static void mark_pending_commit(SavesContext* ctx, SaveTypeEntry* type) {
+    if (!type->pending_commit) {
+        type->pending_commit = true;
+        ctx->pending_commit_count++;
+    }
+}
 
-    // Copy path under lock, then release before file I/O to reduce lock contention
-    char path[512];
-    {
-        mutexLock(&ctx->saves_mutex);
+// Commit one save; callers hold saves_mutex. Open write handles block the commit.
+static bool commit_save_type(SavesContext* ctx, SaveTypeEntry* type) {
+    if (!type->pending_commit) return true;
+    if (type->open_files > 0 || !type->mounted) return false;
+
+    invalidate_archive(type);
+    Result rc = fsFsCommit(&type->save_fs);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SAVES_COMMIT] Commit of type 0x%08X failed: 0x%08X", type->handle, rc);
+        return false;
+    }
+
+    type->pending_commit = false;
+    ctx->pending_commit_count--;
+    LOG_DEBUG("[SAVES_COMMIT] Committed type 0x%08X", type->handle);
+    return true;
+}
+
+static SavesFileHandle* open_file_handle(SavesContext* ctx, u32 handle, bool write) {
+    if (!ctx->initialized) return NULL;
+
+    mutexLock(&ctx->saves_mutex);
+
+    SavesFileHandle* fh = NULL;
+
+    if (is_archive_handle(handle)) {
+        SaveTypeEntry* t = find_type_by_archive_handle(ctx, handle);
+        bool ok = t && (write ? s_archive_writer.type_handle == t->handle
+                              : archive_build_manifest(ctx, t));
+        if (ok) {
+            fh = (SavesFileHandle*)malloc(sizeof(SavesFileHandle));
+        }
+        if (fh) {
+            memset(fh, 0, sizeof(SavesFileHandle));
+            fh->type_index = get_type_index(t);
+            fh->is_archive = true;
+            fh->size = write ? 0 : t->archive_size;
+        }
+    } else if (is_file_handle(handle)) {
         SaveFileEntry* f = find_file_by_handle(ctx, handle);
-        if (!f || f->is_directory) {
-            mutexUnlock(&ctx->saves_mutex);
-            return -1;
+        SaveTypeEntry* t = (f && !f->is_directory) ? type_at(ctx, f->type_index) : NULL;
+
+        FsFile file;
+        char path[FS_MAX_PATH];
+        u32 mode = write ? (FsOpenMode_Write | FsOpenMode_Append) : FsOpenMode_Read;
+        if (t) touch_game(ctx, t->game_index);
+        if (t && build_file_path(ctx, f, path, sizeof(path)) && mount_save_type(ctx, t) &&
+            R_SUCCEEDED(fsFsOpenFile(&t->save_fs, path, mode, &file))) {
+            fh = (SavesFileHandle*)malloc(sizeof(SavesFileHandle));
+            if (!fh) {
+                fsFileClose(&file);
+            }
+        } else if (t) {
+            LOG_ERROR("[SAVES_FILE] Failed to open '%s'", f->filename);
+        }
+
+        if (fh) {
+            memset(fh, 0, sizeof(SavesFileHandle));
+            fh->file = file;
+            fh->type_index = f->type_index;
+
+            s64 size = 0;
+            fsFileGetSize(&file, &size);
+            fh->size = (u64)size;
+            t->open_files++;
+        }
+    } else if (is_snapshot_handle(handle) && !write) {
+        SnapshotNode* n = find_snapshot_node(ctx, handle);
+        if (n && n->kind == SNAPSHOT_NODE_ARCHIVE && snapshot_archive_for(ctx, n)) {
+            fh = (SavesFileHandle*)malloc(sizeof(SavesFileHandle));
+        }
+        if (fh) {
+            memset(fh, 0, sizeof(SavesFileHandle));
+            fh->is_snapshot = true;
+            fh->size = n->size;
         }
-        strncpy(path, f->full_path, sizeof(path) - 1);
-        path[sizeof(path) - 1] = '\0';
-        mutexUnlock(&ctx->saves_mutex);
     }
 
-    FILE* fp = fopen(path, "rb");
-    if (!fp) return -1;
+    if (fh) {
+        fh->ctx = ctx;
+        fh->handle = handle;
+        fh->writable = write;
+    }
+
+    mutexUnlock(&ctx->saves_mutex);
+    return fh;
+}
+
+SavesFileHandle* savesOpenRead(SavesContext* ctx, u32 handle) {
+    return open_file_handle(ctx, handle, false);
+}
+
+SavesFileHandle* savesOpenWrite(SavesContext* ctx, u32 handle) {
+    return open_file_handle(ctx, handle, true);
+}
+
+u64 savesGetFileSize(SavesFileHandle* fh) {
+    return fh ? fh->size : 0;
+}
+
+s64 savesReadFile(SavesFileHandle* fh, void* buffer, u64 size) {
+    if (!fh || fh->writable) return -1;
 
-    setvbuf(fp, NULL, _IOFBF, 256 * 1024);
+    if (fh->is_archive) {
+        SavesContext* ctx = fh->ctx;
+        mutexLock(&ctx->saves_mutex);
+        SaveTypeEntry* t = find_type_by_archive_handle(ctx, fh->handle);
+        s64 rd = t ? archive_read(ctx, t, fh->offset, (u8*)buffer, size) : -1;
+        mutexUnlock(&ctx->saves_mutex);
+        if (rd > 0) fh->offset += rd;
+        return rd;
+    }
 
-    fseek(fp, offset, SEEK_SET);
-    size_t rd = fread(buf, 1, size, fp);
-    fclose(fp);
+    if (fh->is_snapshot) {
+        SavesContext* ctx = fh->ctx;
+        mutexLock(&ctx->saves_mutex);
+        SnapshotNode* n = find_snapshot_node(ctx, fh->handle);
+        SnapshotArchive* a = n ? snapshot_archive_for(ctx, n) : NULL;
+        s64 rd = a ? snapshotArchiveRead(a, fh->offset, buffer, size) : -1;
+        mutexUnlock(&ctx->saves_mutex);
+        if (rd > 0) fh->offset += rd;
+        return rd;
+    }
 
+    u64 rd = 0;
+    Result rc = fsFileRead(&fh->file, fh->offset, buffer, size, FsReadOption_None, &rd);
+    if (R_FAILED(rc)) return -1;
+    fh->offset += rd;
     return (s64)rd;
 }
 
+s64 savesWriteFile(SavesFileHandle* fh, const void* buffer, u64 size) {
+    if (!fh || !fh->writable) return -1;
+
+    if (fh->is_archive) {
+        SavesContext* ctx = fh->ctx;
+        mutexLock(&ctx->saves_mutex);
+        s64 wr = archive_write(fh->handle, fh->offset, buffer, size);
+        mutexUnlock(&ctx->saves_mutex);
+        if (wr > 0) fh->offset += wr;
+        return wr;
+    }
+
+    Result rc = fsFileWrite(&fh->file, fh->offset, buffer, size, FsWriteOption_None);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SAVES_FILE] Write of %llu bytes at %llu failed: 0x%08X",
+                  (unsigned long long)size, (unsigned long long)fh->offset, rc);
+        return -1;
+    }
+    fh->offset += size;
+    if (fh->offset > fh->size) fh->size = fh->offset;
+    return (s64)size;
+}
+
+void savesCloseFile(SavesFileHandle* fh) {
+    if (!fh) return;
+
+    if (!fh->is_archive && !fh->is_snapshot) {
+        if (fh->writable) fsFileFlush(&fh->file);
+        fsFileClose(&fh->file);
+
+        SavesContext* ctx = fh->ctx;
+        mutexLock(&ctx->saves_mutex);
+        SaveTypeEntry* t = type_at(ctx, fh->type_index);
+        if (t) {
+            if (t->open_files > 0) t->open_files--;
+
+            if (fh->writable) {
+                SaveFileEntry* f = find_file_by_handle(ctx, fh->handle);
+                if (f) f->size = fh->size;
+                invalidate_archive(t);
+                mark_pending_commit(ctx, t);
+            }
+        }
+        mutexUnlock(&ctx->saves_mutex);
+    }
+
+    free(fh);
+}
+
+s64 savesReadObject(SavesContext* ctx, u32 handle, u64 offset, void* buf, u64 size) {
+    SavesFileHandle* fh = savesOpenRead(ctx, handle);
+    if (!fh) return -1;
+
+    fh->offset = offset;
+    s64 rd = savesReadFile(fh, buf, size);
+    savesCloseFile(fh);
+    return rd;
+}
+
+s64 savesWriteObject(SavesContext* ctx, u32 handle, u64 offset, const void* buf, u64 size) {
+    SavesFileHandle* fh = savesOpenWrite(ctx, handle);
+    if (!fh) return -1;
+
+    fh->offset = offset;
+    s64 wr = savesWriteFile(fh, buf, size);
+    savesCloseFile(fh);
+    return wr;
+}
+
 u32 savesCreateObject(SavesContext* ctx, u32 storage_id, u32 parent, const char* name, u16 fmt, u64 size) {
     if (!ctx->initialized || storage_id != MTP_STORAGE_SAVES) return 0;
-    if (ctx->file_count >= ctx->max_files) return 0;
 
     mutexLock(&ctx->saves_mutex);
 
-    char path[512];
+    if (parent == MTP_HANDLE_SAVES_SNAPSHOTS || is_snapshot_handle(parent)) {
+        u32 handle = (fmt == MTP_FORMAT_ASSOCIATION) ? snapshot_folder_created(ctx, parent, name) : 0;
+        mutexUnlock(&ctx->saves_mutex);
+        return handle;
+    }
+
+    // A .tar dropped into a save type folder is a whole-save restore
+    if (is_type_handle(parent) && fmt != MTP_FORMAT_ASSOCIATION && is_archive_name(name)) {
+        SaveTypeEntry* t = find_type_by_handle(ctx, parent);
+        u32 handle = t ? archive_writer_begin(ctx, t) : 0;
+        mutexUnlock(&ctx->saves_mutex);
+        return handle;
+    }
+
+    char path[FS_MAX_PATH];
     u32 game_idx = 0, type_idx = 0;
 
     if (is_type_handle(parent)) {
@@ -1178,18 +2838,17 @@ u32 savesCreateObject(SavesContext* ctx, u32 storage_id, u32 parent, const char*
             mutexUnlock(&ctx->saves_mutex);
             return 0;
         }
-        snprintf(path, sizeof(path), "%s:/", t->mount_name);
+        path[0] = '\0';
         game_idx = t->game_index;
-        for (u32 i = 0; i < ctx->type_count; i++) {
-            if (&ctx->types[i] == t) { type_idx = i; break; }
-        }
+        type_idx = get_type_index(t);
     } else if (is_file_handle(parent)) {
         SaveFileEntry* pf = find_file_by_handle(ctx, parent);
-        if (!pf || !pf->is_directory) {
+        SaveTypeEntry* pt = pf ? type_at(ctx, pf->type_index) : NULL;
+        if (!pf || !pf->is_directory || !pt || !mount_save_type(ctx, pt) ||
+            !build_file_path(ctx, pf, path, sizeof(path))) {
             mutexUnlock(&ctx->saves_mutex);
             return 0;
         }
-        strncpy(path, pf->full_path, sizeof(path) - 1);
         game_idx = pf->game_index;
         type_idx = pf->type_index;
     } else {
@@ -1197,111 +2856,127 @@ u32 savesCreateObject(SavesContext* ctx, u32 storage_id, u32 parent, const char*
         return 0;
     }
 
-    SaveFileEntry* f = &ctx->files[ctx->file_count];
-    memset(f, 0, sizeof(SaveFileEntry));
+    size_t len = strlen(path);
+    int n = snprintf(path + len, sizeof(path) - len, "/%s", name);
+    if (n < 0 || len + n >= sizeof(path)) {
+        mutexUnlock(&ctx->saves_mutex);
+        return 0;
+    }
+
+    SaveTypeEntry* type = type_at(ctx, type_idx);
+    bool is_directory = (fmt == MTP_FORMAT_ASSOCIATION);
+
+    Result rc;
+    if (is_directory) {
+        rc = fsFsCreateDirectory(&type->save_fs, path);
+    } else {
+        // Allocate the full size up front; the save journal then only sees data writes
+        fsFsDeleteFile(&type->save_fs, path);
+        rc = fsFsCreateFile(&type->save_fs, path, size, 0);
+    }
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SAVES_CREATE] Failed to create '%s': 0x%08X", path, rc);
+        mutexUnlock(&ctx->saves_mutex);
+        return 0;
+    }
 
-    strncpy(f->filename, name, sizeof(f->filename) - 1);
-    snprintf(f->full_path, sizeof(f->full_path), "%s/%s", path, name);
+    invalidate_archive(type);
+    mark_pending_commit(ctx, type);
 
-    char* ds = strstr(f->full_path, "//");
-    if (ds) memmove(ds, ds + 1, strlen(ds));
+    // The object exists now; without a slot it only shows up after a rescan
+    SaveFileEntry* f = alloc_file(ctx);
+    if (!f) {
+        LOG_ERROR("[SAVES_CREATE] Out of file slots (%u live)", ctx->files.live);
+        mutexUnlock(&ctx->saves_mutex);
+        return 0;
+    }
 
-    f->handle = ctx->next_file_handle++;
+    f->filename = intern_name(ctx, name);
     f->parent_handle = parent;
     f->game_index = game_idx;
     f->type_index = type_idx;
-    f->is_directory = (fmt == MTP_FORMAT_ASSOCIATION);
+    f->is_directory = is_directory;
+    f->scanned = is_directory;  // A fresh directory is empty
     f->size = size;
 
-    if (f->is_directory) {
-        if (mkdir(f->full_path, 0755) != 0) {
-            mutexUnlock(&ctx->saves_mutex);
-            return 0;
-        }
-    } else {
-        FILE* fp = fopen(f->full_path, "wb");
-        if (!fp) {
-            mutexUnlock(&ctx->saves_mutex);
-            return 0;
-        }
-        fclose(fp);
-    }
-
-    ctx->file_count++;
+    link_child(ctx, parent, f->handle);
+    u32 handle = f->handle;
     mutexUnlock(&ctx->saves_mutex);
-    return f->handle;
+    return handle;
 }
 
-s64 savesWriteObject(SavesContext* ctx, u32 handle, u64 offset, const void* buf, u64 size) {
-    if (!ctx->initialized || !is_file_handle(handle)) return -1;
+bool savesDeleteObject(SavesContext* ctx, u32 handle) {
+    if (!ctx->initialized) return false;
+    if (is_game_handle(handle) || is_user_handle(handle)) return false;
+    if (is_type_handle(handle)) return false;
+    if (handle == MTP_HANDLE_SAVES_SNAPSHOTS) return false;
 
-    // Copy path under lock, then release before file I/O to reduce lock contention
-    char path[512];
-    u32 file_index = 0;
-    {
+    if (is_snapshot_handle(handle)) {
         mutexLock(&ctx->saves_mutex);
-        SaveFileEntry* f = find_file_by_handle(ctx, handle);
-        if (!f || f->is_directory) {
-            mutexUnlock(&ctx->saves_mutex);
-            return -1;
-        }
-        strncpy(path, f->full_path, sizeof(path) - 1);
-        path[sizeof(path) - 1] = '\0';
-        // Find the index so we can update size after write
-        for (u32 i = 0; i < ctx->file_count; i++) {
-            if (ctx->files[i].handle == handle) { file_index = i; break; }
+        SnapshotNode* n = find_snapshot_node(ctx, handle);
+        bool ok = n != NULL;
+        if (n && n->kind == SNAPSHOT_NODE_RECEIPT) {
+            // Dismisses the receipt; a job still running carries on
+            unlink_child(ctx, n->parent_handle, handle);
+            free_snapshot_node(ctx, n);
+        } else if (n) {
+            ok = snapshot_delete(ctx, n);
         }
         mutexUnlock(&ctx->saves_mutex);
+        return ok;
     }
 
-    FILE* fp = fopen(path, "r+b");
-    if (!fp) fp = fopen(path, "wb");
-    if (!fp) return -1;
-
-    setvbuf(fp, NULL, _IOFBF, 256 * 1024);
-
-    fseek(fp, offset, SEEK_SET);
-    size_t wr = fwrite(buf, 1, size, fp);
-    fclose(fp);
-
-    // Update file size under lock
-    if (wr > 0) {
+    if (is_archive_handle(handle)) {
+        // Aborts a restore in progress; deleting the virtual archive itself is a no-op
+        // so "replace existing file" flows on the host can proceed to the upload.
         mutexLock(&ctx->saves_mutex);
-        if (file_index < ctx->file_count && ctx->files[file_index].handle == handle) {
-            if (offset + wr > ctx->files[file_index].size) {
-                ctx->files[file_index].size = offset + wr;
-            }
+        if (s_archive_writer.type_handle + ARCHIVE_HANDLE_OFFSET == handle) {
+            archive_writer_finish(ctx, false);
         }
         mutexUnlock(&ctx->saves_mutex);
+        return true;
     }
 
-    return (s64)wr;
-}
-
-bool savesDeleteObject(SavesContext* ctx, u32 handle) {
-    if (!ctx->initialized) return false;
-    if (is_game_handle(handle) || is_user_handle(handle)) return false;
-    if (is_type_handle(handle)) return false;
     if (!is_file_handle(handle)) return false;
 
-    // Copy path and type under lock, then release before filesystem I/O
-    char path[512];
-    bool is_dir = false;
-    {
-        mutexLock(&ctx->saves_mutex);
-        SaveFileEntry* f = find_file_by_handle(ctx, handle);
-        if (!f) {
-            mutexUnlock(&ctx->saves_mutex);
-            return false;
-        }
-        strncpy(path, f->full_path, sizeof(path) - 1);
-        path[sizeof(path) - 1] = '\0';
-        is_dir = f->is_directory;
+    mutexLock(&ctx->saves_mutex);
+    SaveFileEntry* f = find_file_by_handle(ctx, handle);
+    SaveTypeEntry* t = f ? type_at(ctx, f->type_index) : NULL;
+    char path[FS_MAX_PATH];
+    if (!t || !build_file_path(ctx, f, path, sizeof(path)) || !mount_save_type(ctx, t)) {
         mutexUnlock(&ctx->saves_mutex);
+        return false;
     }
 
-    int res = is_dir ? rmdir(path) : remove(path);
-    return res == 0;
+    Result rc = f->is_directory ? fsFsDeleteDirectoryRecursively(&t->save_fs, path)
+                                : fsFsDeleteFile(&t->save_fs, path);
+    if (R_SUCCEEDED(rc)) {
+        invalidate_archive(t);
+        mark_pending_commit(ctx, t);
+        unlink_child(ctx, f->parent_handle, handle);
+        remove_file_subtree(ctx, f);
+    }
+    mutexUnlock(&ctx->saves_mutex);
+    return R_SUCCEEDED(rc);
+}
+
+bool savesRenameObject(SavesContext* ctx, u32 handle, const char* name) {
+    if (!ctx->initialized || !is_snapshot_handle(handle)) return false;
+
+    mutexLock(&ctx->saves_mutex);
+    SnapshotNode* n = find_snapshot_node(ctx, handle);
+    bool ok = n && n->kind == SNAPSHOT_NODE_RECEIPT &&
+              !(snapshot_job_busy() && s_job.receipt == handle);  // Its name belongs to the job
+    if (ok) {
+        SnapshotRequestKind kind = snapshot_request_kind(ctx, n->parent_handle, name);
+        if (kind == SNAPSHOT_REQUEST_NONE) {
+            n->name = intern_name(ctx, name);
+        } else {
+            ok = snapshot_request(ctx, n, kind);
+        }
+    }
+    mutexUnlock(&ctx->saves_mutex);
+    return ok;
 }
 
 bool savesCommitObject(SavesContext* ctx, u32 handle) {
@@ -1309,22 +2984,52 @@ bool savesCommitObject(SavesContext* ctx, u32 handle) {
 
     mutexLock(&ctx->saves_mutex);
 
+    if (is_archive_handle(handle)) {
+        bool ok = s_archive_writer.type_handle + ARCHIVE_HANDLE_OFFSET == handle &&
+                  archive_writer_finish(ctx, true);
+        mutexUnlock(&ctx->saves_mutex);
+        return ok;
+    }
+
     SaveTypeEntry* t = NULL;
     if (is_type_handle(handle)) {
         t = find_type_by_handle(ctx, handle);
     } else if (is_file_handle(handle)) {
         SaveFileEntry* f = find_file_by_handle(ctx, handle);
-        if (f && f->type_index < ctx->type_count) {
-            t = &ctx->types[f->type_index];
+        if (f) {
+            t = type_at(ctx, f->type_index);
         }
     }
 
-    if (!t || !t->mounted) {
+    if (!t) {
         mutexUnlock(&ctx->saves_mutex);
         return false;
     }
 
-    Result rc = fsdevCommitDevice(t->mount_name);
+    // Joins the save's open transaction; savesCommitPending() commits the batch.
+    // An unmounted save was already committed when it was evicted.
+    if (t->mounted) mark_pending_commit(ctx, t);
     mutexUnlock(&ctx->saves_mutex);
-    return R_SUCCEEDED(rc);
+    return true;
+}
+
+bool savesHasPendingCommits(SavesContext* ctx) {
+    return ctx->initialized && ctx->pending_commit_count > 0;
+}
+
+bool savesCommitPending(SavesContext* ctx) {
+    if (!savesHasPendingCommits(ctx)) return true;
+
+    mutexLock(&ctx->saves_mutex);
+    bool ok = true;
+    for (u32 i = 0; i < ctx->types.count && ctx->pending_commit_count > 0; i++) {
+        SaveTypeEntry* t = type_at(ctx, i);
+        if (t && t->pending_commit && !commit_save_type(ctx, t)) {
+            ok = false;
+        }
+    }
+    mutexUnlock(&ctx->saves_mutex);
+
+    if (ok) LOG_DEBUG("[SAVES_COMMIT] All pending save writes committed");
+    return ok;
 }
@@ -0,0 +1,1161 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "mtp/mtp_saves_snapshot.h"
+#include "mtp/mtp_tar.h"
+#include "mtp/mtp_log.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define STORE_DIR           SNAPSHOT_ROOT "/.store"
+#define STORE_INDEX_PATH    STORE_DIR "/index.bin"
+#define STORE_INDEX_TMP     STORE_DIR "/index.tmp"
+#define STORE_PACK_LIMIT    (1ULL << 30)    // Stay well below the FAT32 file size limit
+
+// Content-defined chunking (gear hash). Boundaries depend only on the bytes
+// around them, so an edit only changes the chunks it touches.
+#define CHUNK_MIN           (2 * 1024)
+#define CHUNK_MAX           (64 * 1024)
+#define CHUNK_MASK          0x0000D93003530000ULL   // 13 bits spread over the hash: ~8 KB average
+#define READ_BUFFER_SIZE    (512 * 1024)
+
+#define MANIFEST_MAGIC      0x4D4E534A  // "JSNM"
+#define MANIFEST_VERSION    1
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    SnapshotSaveId id;
+    u64 created;
+    u32 entry_count;
+    u32 reserved;
+} ManifestHeader;
+
+// Followed by path_len path bytes and chunk_count ManifestChunks
+typedef struct {
+    u64 size;
+    u32 chunk_count;
+    u16 path_len;
+    u8 is_directory;
+    u8 reserved;
+} ManifestEntry;
+
+typedef struct {
+    u8 hash[32];
+    u32 length;
+} ManifestChunk;
+
+// ---------------------------------------------------------------------------
+// Chunk store
+//
+// Chunks are appended to pack files and located through index.bin, which is
+// only extended after the pack data it points to has been flushed. The whole
+// index is kept in memory behind a hash table while snapshots are in use.
+// Snapshot jobs add chunks on their own thread while MTP reads archives, so
+// every store access holds s_store_mutex.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    u8 hash[32];
+    u32 pack;
+    u32 length;
+    u64 offset;
+} ChunkLocation;
+
+typedef struct {
+    bool loaded;
+    ChunkLocation* chunks;
+    u32 count;
+    u32 capacity;
+    u32* table;                 // Chunk index + 1, 0 = empty
+    u32 table_size;
+    u32 committed;              // chunks[0..committed) are in index.bin
+    FILE* pack_out;
+    u32 pack_out_id;
+    u64 pack_out_size;
+    FILE* pack_in;
+    u32 pack_in_id;
+} ChunkStore;
+
+static ChunkStore s_store;
+static Mutex s_store_mutex = {0};  // Zero-initialized is valid for libnx Mutex
+static u64 s_gear[256];
+static bool s_gear_ready = false;
+
+static void init_gear(void) {
+    if (s_gear_ready) return;
+    u64 x = 0x4A6176656C696E00ULL;
+    for (int i = 0; i < 256; i++) {
+        // splitmix64
+        u64 z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        s_gear[i] = z ^ (z >> 31);
+    }
+    s_gear_ready = true;
+}
+
+static void pack_path(u32 id, char* out, size_t size) {
+    snprintf(out, size, STORE_DIR "/pack-%04u.bin", id);
+}
+
+static u32 hash_key(const u8* hash) {
+    u32 key;
+    memcpy(&key, hash, sizeof(key));
+    return key;
+}
+
+static bool store_rehash(u32 size) {
+    u32* table = (u32*)calloc(size, sizeof(u32));
+    if (!table) return false;
+
+    for (u32 i = 0; i < s_store.count; i++) {
+        u32 j = hash_key(s_store.chunks[i].hash) & (size - 1);
+        while (table[j]) j = (j + 1) & (size - 1);
+        table[j] = i + 1;
+    }
+    free(s_store.table);
+    s_store.table = table;
+    s_store.table_size = size;
+    return true;
+}
+
+static ChunkLocation* store_find(const u8* hash) {
+    if (!s_store.table_size) return NULL;
+    u32 mask = s_store.table_size - 1;
+    for (u32 j = hash_key(hash) & mask; s_store.table[j]; j = (j + 1) & mask) {
+        ChunkLocation* c = &s_store.chunks[s_store.table[j] - 1];
+        if (memcmp(c->hash, hash, sizeof(c->hash)) == 0) return c;
+    }
+    return NULL;
+}
+
+static bool store_append(const ChunkLocation* loc) {
+    if (s_store.count >= s_store.capacity) {
+        u32 cap = s_store.capacity ? s_store.capacity * 2 : 4096;
+        ChunkLocation* c = (ChunkLocation*)realloc(s_store.chunks, sizeof(ChunkLocation) * cap);
+        if (!c) return false;
+        s_store.chunks = c;
+        s_store.capacity = cap;
+    }
+    if ((s_store.count + 1) * 2 > s_store.table_size &&
+        !store_rehash(s_store.table_size ? s_store.table_size * 2 : 8192)) {
+        return false;
+    }
+
+    s_store.chunks[s_store.count] = *loc;
+    u32 mask = s_store.table_size - 1;
+    u32 j = hash_key(loc->hash) & mask;
+    while (s_store.table[j]) j = (j + 1) & mask;
+    s_store.table[j] = ++s_store.count;
+    return true;
+}
+
+static bool store_load(void) {
+    if (s_store.loaded) return true;
+
+    mkdir("sdmc:/switch", 0777);
+    mkdir("sdmc:/switch/Javelin", 0777);
+    mkdir(SNAPSHOT_ROOT, 0777);
+    mkdir(STORE_DIR, 0777);
+
+    // A compaction stopped between dropping the old index and renaming the new one
+    struct stat st;
+    if (stat(STORE_INDEX_PATH, &st) != 0 && stat(STORE_INDEX_TMP, &st) == 0) {
+        rename(STORE_INDEX_TMP, STORE_INDEX_PATH);
+    }
+
+    FILE* f = fopen(STORE_INDEX_PATH, "rb");
+    if (f) {
+        ChunkLocation loc;
+        while (fread(&loc, sizeof(loc), 1, f) == 1) {
+            if (!store_append(&loc)) break;
+            if (loc.pack > s_store.pack_out_id) s_store.pack_out_id = loc.pack;
+        }
+        fclose(f);
+    }
+
+    // Keep appending to the newest pack until it is full
+    char path[128];
+    pack_path(s_store.pack_out_id, path, sizeof(path));
+    s_store.pack_out_size = stat(path, &st) == 0 ? (u64)st.st_size : 0;
+    s_store.committed = s_store.count;
+    s_store.loaded = true;
+
+    LOG_INFO("[SNAPSHOT] Chunk store: %u chunks in %u packs", s_store.count, s_store.pack_out_id + 1);
+    return true;
+}
+
+static bool store_add(const u8* hash, const u8* data, u32 length) {
+    if (s_store.pack_out && s_store.pack_out_size + length > STORE_PACK_LIMIT) {
+        fclose(s_store.pack_out);
+        s_store.pack_out = NULL;
+        s_store.pack_out_id++;
+        s_store.pack_out_size = 0;
+    }
+    if (!s_store.pack_out) {
+        char path[128];
+        pack_path(s_store.pack_out_id, path, sizeof(path));
+        s_store.pack_out = fopen(path, "ab");
+        if (!s_store.pack_out) {
+            LOG_ERROR("[SNAPSHOT] Failed to open %s", path);
+            return false;
+        }
+        setvbuf(s_store.pack_out, NULL, _IOFBF, 256 * 1024);
+        fseek(s_store.pack_out, 0, SEEK_END);
+        s_store.pack_out_size = (u64)ftell(s_store.pack_out);
+    }
+
+    ChunkLocation loc;
+    memcpy(loc.hash, hash, sizeof(loc.hash));
+    loc.pack = s_store.pack_out_id;
+    loc.length = length;
+    loc.offset = s_store.pack_out_size;
+
+    if (fwrite(data, 1, length, s_store.pack_out) != length) return false;
+    s_store.pack_out_size += length;
+    return store_append(&loc);
+}
+
+// Make new chunks durable: pack data first, then the index records pointing at it
+static bool store_commit(void) {
+    if (s_store.committed == s_store.count) return true;
+    if (s_store.pack_out && fflush(s_store.pack_out) != 0) return false;
+
+    FILE* f = fopen(STORE_INDEX_PATH, "ab");
+    if (!f) return false;
+    u32 n = s_store.count - s_store.committed;
+    bool ok = fwrite(&s_store.chunks[s_store.committed], sizeof(ChunkLocation), n, f) == n;
+    ok = (fclose(f) == 0) && ok;
+    if (ok) s_store.committed = s_store.count;
+    return ok;
+}
+
+// Forget chunks added since the last commit (their pack bytes become dead space)
+static void store_rollback(void) {
+    if (s_store.committed == s_store.count) return;
+    s_store.count = s_store.committed;
+    store_rehash(s_store.table_size);
+}
+
+static bool store_read(const ChunkLocation* loc, u32 within, void* out, u32 size) {
+    if (s_store.pack_out && loc->pack == s_store.pack_out_id) {
+        fflush(s_store.pack_out);
+    }
+    if (!s_store.pack_in || s_store.pack_in_id != loc->pack) {
+        if (s_store.pack_in) fclose(s_store.pack_in);
+        char path[128];
+        pack_path(loc->pack, path, sizeof(path));
+        s_store.pack_in = fopen(path, "rb");
+        s_store.pack_in_id = loc->pack;
+        if (!s_store.pack_in) return false;
+    }
+    if (fseek(s_store.pack_in, (long)(loc->offset + within), SEEK_SET) != 0) return false;
+    return fread(out, 1, size, s_store.pack_in) == size;
+}
+
+// Drop the in-memory index; the next store_load() reads it back
+static void store_unload(void) {
+    if (s_store.pack_out) fclose(s_store.pack_out);
+    if (s_store.pack_in) fclose(s_store.pack_in);
+    free(s_store.chunks);
+    free(s_store.table);
+    memset(&s_store, 0, sizeof(s_store));
+}
+
+void snapshotStoreClose(void) {
+    mutexLock(&s_store_mutex);
+    store_commit();
+    store_unload();
+    mutexUnlock(&s_store_mutex);
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot creation
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    FsFileSystem* fs;
+    FILE* manifest;
+    u8* buffer;                 // READ_BUFFER_SIZE bytes
+    ManifestChunk* chunks;      // Chunk list of the file being processed
+    u32 chunk_count;
+    u32 chunk_capacity;
+    u32 entry_count;
+    SnapshotStats* stats;
+} SnapshotWriter;
+
+// Length of the next chunk of p[0..n); n is only a cut point at end of file
+static size_t cdc_cut(const u8* p, size_t n) {
+    if (n <= CHUNK_MIN) return n;
+    size_t end = n < CHUNK_MAX ? n : CHUNK_MAX;
+    u64 h = 0;
+    for (size_t i = CHUNK_MIN; i < end; i++) {
+        h = (h << 1) + s_gear[p[i]];
+        if (!(h & CHUNK_MASK)) return i + 1;
+    }
+    return end;
+}
+
+static bool writer_add_chunk(SnapshotWriter* w, const u8* data, u32 length) {
+    if (w->chunk_count >= w->chunk_capacity) {
+        u32 cap = w->chunk_capacity ? w->chunk_capacity * 2 : 256;
+        ManifestChunk* c = (ManifestChunk*)realloc(w->chunks, sizeof(ManifestChunk) * cap);
+        if (!c) return false;
+        w->chunks = c;
+        w->chunk_capacity = cap;
+    }
+
+    ManifestChunk* c = &w->chunks[w->chunk_count++];
+    sha256CalculateHash(c->hash, data, length);
+    c->length = length;
+
+    w->stats->chunks++;
+    mutexLock(&s_store_mutex);
+    bool ok = true;
+    if (!store_find(c->hash)) {
+        w->stats->new_chunks++;
+        w->stats->new_bytes += length;
+        ok = store_add(c->hash, data, length);
+    }
+    mutexUnlock(&s_store_mutex);
+    return ok;
+}
+
+static bool writer_put_entry(SnapshotWriter* w, const char* rel, u64 size, bool is_dir) {
+    ManifestEntry e;
+    memset(&e, 0, sizeof(e));
+    e.size = is_dir ? 0 : size;
+    e.chunk_count = is_dir ? 0 : w->chunk_count;
+    e.path_len = (u16)strlen(rel);
+    e.is_directory = is_dir ? 1 : 0;
+
+    bool ok = fwrite(&e, sizeof(e), 1, w->manifest) == 1 &&
+              fwrite(rel, 1, e.path_len, w->manifest) == e.path_len;
+    if (ok && e.chunk_count) {
+        ok = fwrite(w->chunks, sizeof(ManifestChunk), e.chunk_count, w->manifest) == e.chunk_count;
+    }
+    w->entry_count++;
+    return ok;
+}
+
+static bool snapshot_file(SnapshotWriter* w, const char* rel, u64 size) {
+    char path[FS_MAX_PATH];
+    snprintf(path, sizeof(path), "/%s", rel);
+
+    FsFile file;
+    Result rc = fsFsOpenFile(w->fs, path, FsOpenMode_Read, &file);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SNAPSHOT] Failed to open '%s': 0x%08X", path, rc);
+        return false;
+    }
+
+    w->chunk_count = 0;
+    u64 file_pos = 0;
+    size_t fill = 0, start = 0;
+    bool ok = true;
+
+    while (ok) {
+        // Keep at least one maximum-size chunk buffered until the end of the file
+        if (fill - start < CHUNK_MAX && file_pos < size) {
+            memmove(w->buffer, w->buffer + start, fill - start);
+            fill -= start;
+            start = 0;
+
+            u64 want = READ_BUFFER_SIZE - fill;
+            if (want > size - file_pos) want = size - file_pos;
+            u64 rd = 0;
+            rc = fsFileRead(&file, file_pos, w->buffer + fill, want, FsReadOption_None, &rd);
+            if (R_FAILED(rc) || rd == 0) {
+                LOG_ERROR("[SNAPSHOT] Read of '%s' failed at %llu", path, (unsigned long long)file_pos);
+                ok = false;
+                break;
+            }
+            fill += rd;
+            file_pos += rd;
+        }
+
+        size_t avail = fill - start;
+        if (avail == 0) break;
+
+        size_t len = cdc_cut(w->buffer + start, avail);
+        ok = writer_add_chunk(w, w->buffer + start, (u32)len);
+        start += len;
+    }
+    fsFileClose(&file);
+
+    if (ok) {
+        w->stats->files++;
+        w->stats->bytes += size;
+        ok = writer_put_entry(w, rel, file_pos, false);
+    }
+    return ok;
+}
+
+// List one directory completely (so only one handle is open), then descend
+static bool snapshot_walk(SnapshotWriter* w, const char* rel) {
+    char dir_path[FS_MAX_PATH];
+    snprintf(dir_path, sizeof(dir_path), "/%s", rel);
+
+    FsDir dir;
+    if (R_FAILED(fsFsOpenDirectory(w->fs, dir_path, FsDirOpenMode_ReadDirs | FsDirOpenMode_ReadFiles, &dir))) {
+        LOG_ERROR("[SNAPSHOT] Failed to open directory '%s'", dir_path);
+        return false;
+    }
+
+    FsDirectoryEntry* entries = NULL;
+    u32 count = 0, capacity = 0;
+    bool ok = true;
+    s64 read = 0;
+    while (ok) {
+        if (count + 8 > capacity) {
+            u32 cap = capacity ? capacity * 2 : 16;
+            FsDirectoryEntry* e = (FsDirectoryEntry*)realloc(entries, sizeof(FsDirectoryEntry) * cap);
+            if (!e) {
+                ok = false;
+                break;
+            }
+            entries = e;
+            capacity = cap;
+        }
+        if (R_FAILED(fsDirRead(&dir, &read, 8, entries + count)) || read <= 0) break;
+        count += (u32)read;
+    }
+    fsDirClose(&dir);
+
+    for (u32 i = 0; i < count && ok; i++) {
+        char child[FS_MAX_PATH];
+        int n = snprintf(child, sizeof(child), "%s%s%s", rel, rel[0] ? "/" : "", entries[i].name);
+        if (n < 0 || n >= TAR_MAX_PATH) {
+            LOG_ERROR("[SNAPSHOT] Path too long under '%s'", dir_path);
+            ok = false;
+            break;
+        }
+
+        if (entries[i].type == FsDirEntryType_Dir) {
+            ok = writer_put_entry(w, child, 0, true) && snapshot_walk(w, child);
+        } else {
+            ok = snapshot_file(w, child, (u64)entries[i].file_size);
+        }
+    }
+
+    free(entries);
+    return ok;
+}
+
+void snapshotMakeDirName(char* out, size_t size) {
+    time_t now = time(NULL);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    snprintf(out, size, "%04d%02d%02d-%02d%02d%02d",
+             tm_now.tm_year + 1900, tm_now.tm_mon + 1, tm_now.tm_mday,
+             tm_now.tm_hour, tm_now.tm_min, tm_now.tm_sec);
+}
+
+// mkdir -p for an sdmc path
+static void make_sd_dirs(const char* path) {
+    char tmp[FS_MAX_PATH];
+    strncpy(tmp, path, sizeof(tmp) - 1);
+    tmp[sizeof(tmp) - 1] = '\0';
+    for (char* p = strchr(tmp, '/'); p; p = strchr(p + 1, '/')) {
+        if (p > tmp && p[-1] == ':') continue;
+        *p = '\0';
+        mkdir(tmp, 0777);
+        *p = '/';
+    }
+    mkdir(tmp, 0777);
+}
+
+Result snapshotCreate(FsFileSystem* save_fs, const SnapshotSaveId* id, const char* snapshot_dir,
+                      const char* label, SnapshotStats* stats) {
+    SnapshotStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(SnapshotStats));
+
+    init_gear();
+    mutexLock(&s_store_mutex);
+    bool loaded = store_load();
+    mutexUnlock(&s_store_mutex);
+    if (!loaded) return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    make_sd_dirs(snapshot_dir);
+
+    char path[FS_MAX_PATH], tmp_path[FS_MAX_PATH + 4];
+    snprintf(path, sizeof(path), "%s/%s" SNAPSHOT_EXT, snapshot_dir, label);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    SnapshotWriter w;
+    memset(&w, 0, sizeof(w));
+    w.fs = save_fs;
+    w.stats = stats;
+    w.buffer = (u8*)malloc(READ_BUFFER_SIZE);
+    w.manifest = fopen(tmp_path, "wb");
+    if (!w.buffer || !w.manifest) {
+        if (w.manifest) fclose(w.manifest);
+        free(w.buffer);
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+    setvbuf(w.manifest, NULL, _IOFBF, 64 * 1024);
+
+    u64 start = armGetSystemTick();
+    ManifestHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = MANIFEST_MAGIC;
+    hdr.version = MANIFEST_VERSION;
+    hdr.id = *id;
+    hdr.created = (u64)time(NULL);
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, w.manifest) == 1 && snapshot_walk(&w, "");
+
+    // The header goes in last, with the final entry count
+    hdr.entry_count = w.entry_count;
+    ok = ok && fseek(w.manifest, 0, SEEK_SET) == 0 && fwrite(&hdr, sizeof(hdr), 1, w.manifest) == 1;
+    ok = (fclose(w.manifest) == 0) && ok;
+    free(w.buffer);
+    free(w.chunks);
+
+    // Chunks must be durable before a manifest may reference them
+    mutexLock(&s_store_mutex);
+    ok = ok && store_commit();
+    if (ok) {
+        remove(path);
+        ok = rename(tmp_path, path) == 0;
+    }
+    if (!ok) store_rollback();
+    mutexUnlock(&s_store_mutex);
+    if (!ok) {
+        remove(tmp_path);
+        LOG_ERROR("[SNAPSHOT] Snapshot '%s' failed", path);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+
+    LOG_INFO("[SNAPSHOT] %s: %u files, %llu KB, %u/%u chunks new (%llu KB) in %llu ms", path,
+             stats->files, (unsigned long long)(stats->bytes / 1024), stats->new_chunks, stats->chunks,
+             (unsigned long long)(stats->new_bytes / 1024),
+             (unsigned long long)(armTicksToNs(armGetSystemTick() - start) / 1000000ULL));
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Manifest loading, archive view and restore
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const char* path;           // Points into the manifest data
+    u16 path_len;
+    bool is_directory;
+    u64 size;
+    u32 first_chunk;
+    u32 chunk_count;
+    u32 header_size;
+    u64 header_offset;
+} SnapshotEntry;
+
+struct SnapshotArchive {
+    u8* data;                   // Raw manifest file
+    ManifestHeader header;
+    SnapshotEntry* entries;
+    u32 entry_count;
+    ManifestChunk* chunks;      // Copied out of data, where they are unaligned
+    u64* chunk_offsets;         // Offset of each chunk within its file
+    u32 chunk_count;
+    u64 data_end;
+    u64 total_size;
+};
+
+static u8* read_whole_file(const char* path, u64* out_size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    u8* data = size > 0 ? (u8*)malloc(size) : NULL;
+    if (data && fread(data, 1, size, f) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *out_size = data ? (u64)size : 0;
+    return data;
+}
+
+bool snapshotReadSaveId(const char* manifest_path, SnapshotSaveId* out) {
+    FILE* f = fopen(manifest_path, "rb");
+    if (!f) return false;
+    ManifestHeader hdr;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && hdr.magic == MANIFEST_MAGIC &&
+              hdr.version == MANIFEST_VERSION;
+    fclose(f);
+    if (ok) *out = hdr.id;
+    return ok;
+}
+
+void snapshotArchiveClose(SnapshotArchive* a) {
+    if (!a) return;
+    free(a->data);
+    free(a->entries);
+    free(a->chunks);
+    free(a->chunk_offsets);
+    free(a);
+}
+
+SnapshotArchive* snapshotArchiveOpen(const char* manifest_path) {
+    SnapshotArchive* a = (SnapshotArchive*)calloc(1, sizeof(SnapshotArchive));
+    if (!a) return NULL;
+
+    u64 size = 0;
+    a->data = read_whole_file(manifest_path, &size);
+    if (!a->data || size < sizeof(ManifestHeader)) {
+        snapshotArchiveClose(a);
+        return NULL;
+    }
+    memcpy(&a->header, a->data, sizeof(ManifestHeader));
+    if (a->header.magic != MANIFEST_MAGIC || a->header.version != MANIFEST_VERSION) {
+        LOG_ERROR("[SNAPSHOT] Not a snapshot manifest: %s", manifest_path);
+        snapshotArchiveClose(a);
+        return NULL;
+    }
+
+    // First pass validates and counts chunks, second pass fills the tables
+    u32 n = a->header.entry_count;
+    u64 pos = sizeof(ManifestHeader);
+    u32 total_chunks = 0;
+    for (u32 i = 0; i < n; i++) {
+        ManifestEntry e;
+        if (pos + sizeof(e) > size) break;
+        memcpy(&e, a->data + pos, sizeof(e));
+        pos += sizeof(e) + e.path_len + (u64)e.chunk_count * sizeof(ManifestChunk);
+        if (pos > size) break;
+        total_chunks += e.chunk_count;
+        a->entry_count++;
+    }
+    if (a->entry_count != n) {
+        LOG_ERROR("[SNAPSHOT] Truncated manifest: %s", manifest_path);
+        snapshotArchiveClose(a);
+        return NULL;
+    }
+
+    a->entries = (SnapshotEntry*)calloc(n ? n : 1, sizeof(SnapshotEntry));
+    a->chunks = (ManifestChunk*)calloc(total_chunks ? total_chunks : 1, sizeof(ManifestChunk));
+    a->chunk_offsets = (u64*)calloc(total_chunks ? total_chunks : 1, sizeof(u64));
+    if (!a->entries || !a->chunks || !a->chunk_offsets) {
+        snapshotArchiveClose(a);
+        return NULL;
+    }
+
+    pos = sizeof(ManifestHeader);
+    u64 offset = 0;
+    for (u32 i = 0; i < n; i++) {
+        ManifestEntry e;
+        memcpy(&e, a->data + pos, sizeof(e));
+        pos += sizeof(e);
+
+        SnapshotEntry* se = &a->entries[i];
+        se->path = (const char*)(a->data + pos);
+        se->path_len = e.path_len;
+        se->is_directory = e.is_directory != 0;
+        se->size = e.size;
+        se->first_chunk = a->chunk_count;
+        se->chunk_count = e.chunk_count;
+        pos += e.path_len;
+
+        u64 file_offset = 0;
+        for (u32 c = 0; c < e.chunk_count; c++) {
+            memcpy(&a->chunks[a->chunk_count], a->data + pos, sizeof(ManifestChunk));
+            a->chunk_offsets[a->chunk_count] = file_offset;
+            file_offset += a->chunks[a->chunk_count].length;
+            a->chunk_count++;
+            pos += sizeof(ManifestChunk);
+        }
+
+        char rel[TAR_MAX_PATH];
+        snprintf(rel, sizeof(rel), "%.*s", (int)se->path_len, se->path);
+        se->header_size = tarHeaderSize(rel, se->is_directory);
+        se->header_offset = offset;
+        offset += se->header_size + tarPaddedSize(se->size);
+    }
+    a->data_end = offset;
+    a->total_size = offset + TAR_BLOCK_SIZE * 2;
+
+    mutexLock(&s_store_mutex);
+    store_load();
+    mutexUnlock(&s_store_mutex);
+    return a;
+}
+
+u64 snapshotArchiveSize(const SnapshotArchive* a) {
+    return a ? a->total_size : 0;
+}
+
+static u32 find_entry(const SnapshotArchive* a, u64 offset) {
+    u32 lo = 0, hi = a->entry_count;
+    while (hi - lo > 1) {
+        u32 mid = (lo + hi) / 2;
+        if (a->entries[mid].header_offset <= offset) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static u32 find_chunk(const SnapshotArchive* a, const SnapshotEntry* e, u64 file_pos) {
+    u32 lo = e->first_chunk, hi = e->first_chunk + e->chunk_count;
+    while (hi - lo > 1) {
+        u32 mid = (lo + hi) / 2;
+        if (a->chunk_offsets[mid] <= file_pos) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+s64 snapshotArchiveRead(SnapshotArchive* a, u64 offset, void* buffer, u64 size) {
+    if (!a) return -1;
+    if (offset >= a->total_size) return 0;
+    if (size > a->total_size - offset) size = a->total_size - offset;
+
+    u8* out = (u8*)buffer;
+    u8 header[TAR_BLOCK_SIZE * 2 + TAR_MAX_PATH + TAR_BLOCK_SIZE];
+    u64 done = 0;
+
+    while (done < size) {
+        u64 pos = offset + done;
+        u64 want = size - done;
+
+        if (pos >= a->data_end || a->entry_count == 0) {
+            memset(out + done, 0, want);
+            done += want;
+            break;
+        }
+
+        const SnapshotEntry* e = &a->entries[find_entry(a, pos)];
+        u64 data_start = e->header_offset + e->header_size;
+        u64 n;
+
+        if (pos < data_start) {
+            char rel[TAR_MAX_PATH];
+            snprintf(rel, sizeof(rel), "%.*s", (int)e->path_len, e->path);
+            tarWriteHeader(header, rel, e->size, e->is_directory, a->header.created);
+            u64 in_header = pos - e->header_offset;
+            n = e->header_size - in_header;
+            if (n > want) n = want;
+            memcpy(out + done, header + in_header, n);
+        } else if (pos < data_start + e->size) {
+            u64 file_pos = pos - data_start;
+            u32 c = find_chunk(a, e, file_pos);
+            const ManifestChunk* mc = &a->chunks[c];
+            u32 within = (u32)(file_pos - a->chunk_offsets[c]);
+            n = mc->length - within;
+            if (n > want) n = want;
+
+            mutexLock(&s_store_mutex);
+            const ChunkLocation* loc = store_find(mc->hash);
+            bool found = loc && store_read(loc, within, out + done, (u32)n);
+            mutexUnlock(&s_store_mutex);
+            if (!found) {
+                LOG_ERROR("[SNAPSHOT] Missing chunk in '%.*s'", (int)e->path_len, e->path);
+                memset(out + done, 0, n);
+            }
+        } else {
+            n = data_start + tarPaddedSize(e->size) - pos;
+            if (n > want) n = want;
+            memset(out + done, 0, n);
+        }
+        done += n;
+    }
+    return (s64)done;
+}
+
+Result snapshotRestore(FsFileSystem* save_fs, const char* manifest_path) {
+    SnapshotArchive* a = snapshotArchiveOpen(manifest_path);
+    if (!a) return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+
+    u8* buf = (u8*)malloc(CHUNK_MAX);
+    if (!buf) {
+        snapshotArchiveClose(a);
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+
+    Result rc = fsFsCleanDirectoryRecursively(save_fs, "/");
+    for (u32 i = 0; i < a->entry_count && R_SUCCEEDED(rc); i++) {
+        const SnapshotEntry* e = &a->entries[i];
+        char path[FS_MAX_PATH];
+        snprintf(path, sizeof(path), "/%.*s", (int)e->path_len, e->path);
+
+        // Entries are stored parents first, so every directory exists before its contents
+        if (e->is_directory) {
+            rc = fsFsCreateDirectory(save_fs, path);
+            continue;
+        }
+
+        rc = fsFsCreateFile(save_fs, path, e->size, 0);
+        FsFile file;
+        if (R_SUCCEEDED(rc)) rc = fsFsOpenFile(save_fs, path, FsOpenMode_Write, &file);
+        if (R_FAILED(rc)) break;
+
+        u64 file_pos = 0;
+        for (u32 c = 0; c < e->chunk_count && R_SUCCEEDED(rc); c++) {
+            const ManifestChunk* mc = &a->chunks[e->first_chunk + c];
+            u8 hash[32];
+            mutexLock(&s_store_mutex);
+            const ChunkLocation* loc = mc->length <= CHUNK_MAX ? store_find(mc->hash) : NULL;
+            bool found = loc && store_read(loc, 0, buf, mc->length);
+            mutexUnlock(&s_store_mutex);
+            if (!found) {
+                rc = MAKERESULT(Module_Libnx, LibnxError_NotFound);
+                break;
+            }
+            sha256CalculateHash(hash, buf, mc->length);
+            if (memcmp(hash, mc->hash, sizeof(hash)) != 0) {
+                LOG_ERROR("[SNAPSHOT] Corrupt chunk in '%s'", path);
+                rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+                break;
+            }
+            rc = fsFileWrite(&file, file_pos, buf, mc->length, FsWriteOption_None);
+            file_pos += mc->length;
+        }
+        if (R_SUCCEEDED(rc)) rc = fsFileFlush(&file);
+        fsFileClose(&file);
+    }
+
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SNAPSHOT] Restore of %s failed: 0x%08X", manifest_path, rc);
+    } else {
+        LOG_INFO("[SNAPSHOT] Restored %u entries from %s", a->entry_count, manifest_path);
+    }
+    free(buf);
+    snapshotArchiveClose(a);
+    return rc;
+}
+
+// ---------------------------------------------------------------------------
+// Compaction
+//
+// Mark and sweep: every manifest under SNAPSHOT_ROOT marks the chunks it uses,
+// then packs that are mostly dead have their live chunks copied into new packs.
+// The new index is written in full and swapped in before the old packs are
+// deleted, so an interrupted compaction leaves the old store intact (plus new
+// packs nothing points at, which the next compaction deletes).
+//
+// Runs on the snapshot job thread, the only thread that adds chunks, so the
+// chunk list is stable throughout; readers only wait for single chunk copies
+// and for the final swap.
+// ---------------------------------------------------------------------------
+
+#define COMPACT_DEAD_RATIO  4       // Rewrite a pack once a quarter of it is dead
+
+static bool compact_stopped(const bool* stop) {
+    return stop && __atomic_load_n(stop, __ATOMIC_RELAXED);
+}
+
+// Mark the chunks of one manifest. Files that are not manifests mark nothing;
+// only an unreadable manifest fails, since its chunks would then be lost.
+static bool mark_manifest(const char* path, u8* live) {
+    u64 size = 0;
+    u8* data = read_whole_file(path, &size);
+    if (!data) {
+        LOG_ERROR("[SNAPSHOT] Cannot read %s, store not compacted", path);
+        return false;
+    }
+
+    ManifestHeader hdr;
+    if (size < sizeof(hdr)) {
+        free(data);
+        return true;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic != MANIFEST_MAGIC || hdr.version != MANIFEST_VERSION) {
+        free(data);
+        return true;
+    }
+
+    mutexLock(&s_store_mutex);
+    u64 pos = sizeof(ManifestHeader);
+    for (u32 i = 0; i < hdr.entry_count && pos + sizeof(ManifestEntry) <= size; i++) {
+        ManifestEntry e;
+        memcpy(&e, data + pos, sizeof(e));
+        pos += sizeof(e) + e.path_len;
+        for (u32 c = 0; c < e.chunk_count && pos + sizeof(ManifestChunk) <= size; c++) {
+            const ChunkLocation* loc = store_find(data + pos);  // hash is the first member
+            if (loc) live[loc - s_store.chunks] = 1;
+            pos += sizeof(ManifestChunk);
+        }
+    }
+    mutexUnlock(&s_store_mutex);
+
+    free(data);
+    return true;
+}
+
+// SNAPSHOT_ROOT/<title id>/<stamp>/<label>.jsnap; depth counts folders below path
+static bool mark_folder(const char* path, u32 depth, u8* live, const bool* stop) {
+    DIR* dir = opendir(path);
+    if (!dir) return true;
+
+    bool ok = true;
+    struct dirent* ent;
+    while (ok && (ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;  // Also skips the chunk store
+        if (compact_stopped(stop)) {
+            ok = false;
+            break;
+        }
+
+        char child[FS_MAX_PATH];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        size_t len = strlen(ent->d_name);
+        size_t ext = strlen(SNAPSHOT_EXT);
+
+        if (depth < 2) {
+            ok = mark_folder(child, depth + 1, live, stop);
+        } else if (len > ext && strcmp(ent->d_name + len - ext, SNAPSHOT_EXT) == 0) {
+            ok = mark_manifest(child, live);
+        }
+    }
+    closedir(dir);
+    return ok;
+}
+
+// Highest pack number on the SD card, including packs the index does not know
+static u32 highest_pack_id(void) {
+    u32 max_id = 0;
+    DIR* dir = opendir(STORE_DIR);
+    if (!dir) return 0;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        unsigned id;
+        if (sscanf(ent->d_name, "pack-%u.bin", &id) == 1 && id > max_id) max_id = id;
+    }
+    closedir(dir);
+    return max_id;
+}
+
+typedef struct {
+    u32 pack_count;             // Pack numbers 0..pack_count-1 may exist
+    u64* pack_size;
+    u64* pack_live;             // Bytes of marked chunks per pack
+    bool* rewrite;
+    u8* live;                   // Per chunk: marked by a manifest
+    u32* new_pack;              // Per chunk: pack it was copied to, ~0u if it stays put
+    u64* new_offset;
+    u32 first_new;
+    u32 new_packs;
+} Compaction;
+
+static bool in_rewritten_pack(const Compaction* cp, const ChunkLocation* c) {
+    return c->pack < cp->pack_count && cp->rewrite[c->pack];
+}
+
+// Copy the live chunks of rewritten packs into new packs above every existing one
+static Result compact_copy(Compaction* cp, u32 count, u64* moved, const bool* stop) {
+    u8* buf = (u8*)malloc(CHUNK_MAX);
+    if (!buf) return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+
+    Result rc = 0;
+    FILE* out = NULL;
+    u64 out_size = 0;
+    for (u32 i = 0; i < count && R_SUCCEEDED(rc); i++) {
+        const ChunkLocation* c = &s_store.chunks[i];
+        if (!cp->live[i] || !in_rewritten_pack(cp, c)) continue;
+        if (compact_stopped(stop) || c->length > CHUNK_MAX) {
+            rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+            break;
+        }
+
+        if (out && out_size + c->length > STORE_PACK_LIMIT) {
+            if (fclose(out) != 0) rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+            out = NULL;
+        }
+        if (!out && R_SUCCEEDED(rc)) {
+            char path[128];
+            pack_path(cp->first_new + cp->new_packs, path, sizeof(path));
+            out = fopen(path, "wb");
+            if (!out) {
+                rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+                break;
+            }
+            setvbuf(out, NULL, _IOFBF, 256 * 1024);
+            cp->new_packs++;
+            out_size = 0;
+        }
+
+        mutexLock(&s_store_mutex);
+        bool rd = store_read(c, 0, buf, c->length);
+        mutexUnlock(&s_store_mutex);
+        if (!rd || fwrite(buf, 1, c->length, out) != c->length) {
+            rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+            break;
+        }
+        cp->new_pack[i] = cp->first_new + cp->new_packs - 1;
+        cp->new_offset[i] = out_size;
+        out_size += c->length;
+        *moved += c->length;
+    }
+    if (out && fclose(out) != 0) rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+    free(buf);
+    return rc;
+}
+
+// Write the new index and swap it in with the in-memory list. Caller holds s_store_mutex.
+static bool compact_swap(Compaction* cp, u32 count) {
+    FILE* f = fopen(STORE_INDEX_TMP, "wb");
+    if (!f) return false;
+    setvbuf(f, NULL, _IOFBF, 64 * 1024);
+
+    bool ok = true;
+    for (u32 i = 0; i < count && ok; i++) {
+        ChunkLocation c = s_store.chunks[i];
+        if (cp->new_pack[i] != ~0u) {
+            c.pack = cp->new_pack[i];
+            c.offset = cp->new_offset[i];
+        } else if (in_rewritten_pack(cp, &c)) {
+            continue;  // Dead chunk of a pack that goes away
+        }
+        ok = fwrite(&c, sizeof(c), 1, f) == 1;
+    }
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || remove(STORE_INDEX_PATH) != 0) {
+        remove(STORE_INDEX_TMP);
+        return false;
+    }
+    if (rename(STORE_INDEX_TMP, STORE_INDEX_PATH) != 0) {
+        // index.tmp is complete and store_load() renames it when index.bin is missing
+        store_unload();
+        return true;
+    }
+
+    u32 kept = 0;
+    for (u32 i = 0; i < count; i++) {
+        ChunkLocation c = s_store.chunks[i];
+        if (cp->new_pack[i] != ~0u) {
+            c.pack = cp->new_pack[i];
+            c.offset = cp->new_offset[i];
+        } else if (in_rewritten_pack(cp, &c)) {
+            continue;
+        }
+        s_store.chunks[kept++] = c;
+    }
+    s_store.count = s_store.committed = kept;
+    store_rehash(s_store.table_size);
+    if (s_store.pack_in) fclose(s_store.pack_in);
+    s_store.pack_in = NULL;
+
+    // Keep appending to the newest pack that is left
+    s_store.pack_out_id = 0;
+    if (cp->new_packs) {
+        s_store.pack_out_id = cp->first_new + cp->new_packs - 1;
+    } else {
+        for (u32 p = cp->pack_count; p-- > 0; ) {
+            if (cp->pack_size[p] && !cp->rewrite[p]) {
+                s_store.pack_out_id = p;
+                break;
+            }
+        }
+    }
+    char path[128];
+    struct stat st;
+    pack_path(s_store.pack_out_id, path, sizeof(path));
+    s_store.pack_out_size = stat(path, &st) == 0 ? (u64)st.st_size : 0;
+    return true;
+}
+
+static void compact_free(Compaction* cp) {
+    free(cp->pack_size);
+    free(cp->pack_live);
+    free(cp->rewrite);
+    free(cp->live);
+    free(cp->new_pack);
+    free(cp->new_offset);
+}
+
+Result snapshotStoreCompact(const bool* stop) {
+    mutexLock(&s_store_mutex);
+    bool ok = store_load() && store_commit();
+    if (s_store.pack_out) {
+        fclose(s_store.pack_out);
+        s_store.pack_out = NULL;
+    }
+    u32 count = s_store.count;
+    mutexUnlock(&s_store_mutex);
+    if (!ok) return MAKERESULT(Module_Libnx, LibnxError_IoError);
+
+    u64 start = armGetSystemTick();
+    Compaction cp;
+    memset(&cp, 0, sizeof(cp));
+    cp.pack_count = highest_pack_id() + 1;
+    cp.first_new = cp.pack_count;
+    cp.pack_size = (u64*)calloc(cp.pack_count, sizeof(u64));
+    cp.pack_live = (u64*)calloc(cp.pack_count, sizeof(u64));
+    cp.rewrite = (bool*)calloc(cp.pack_count, sizeof(bool));
+    cp.live = (u8*)calloc(count ? count : 1, 1);
+    cp.new_pack = (u32*)malloc(sizeof(u32) * (count ? count : 1));
+    cp.new_offset = (u64*)malloc(sizeof(u64) * (count ? count : 1));
+    if (!cp.pack_size || !cp.pack_live || !cp.rewrite || !cp.live || !cp.new_pack || !cp.new_offset) {
+        compact_free(&cp);
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+    memset(cp.new_pack, 0xFF, sizeof(u32) * (count ? count : 1));
+
+    if (!mark_folder(SNAPSHOT_ROOT, 0, cp.live, stop)) {
+        if (compact_stopped(stop)) LOG_INFO("[SNAPSHOT] Store compact stopped");
+        compact_free(&cp);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+
+    for (u32 p = 0; p < cp.pack_count; p++) {
+        char path[128];
+        struct stat st;
+        pack_path(p, path, sizeof(path));
+        if (stat(path, &st) == 0) cp.pack_size[p] = (u64)st.st_size;
+    }
+    for (u32 i = 0; i < count; i++) {
+        const ChunkLocation* c = &s_store.chunks[i];
+        if (cp.live[i] && c->pack < cp.pack_count) cp.pack_live[c->pack] += c->length;
+    }
+
+    u32 rewrites = 0;
+    u64 dead = 0;
+    for (u32 p = 0; p < cp.pack_count; p++) {
+        u64 pack_dead = cp.pack_size[p] > cp.pack_live[p] ? cp.pack_size[p] - cp.pack_live[p] : 0;
+        cp.rewrite[p] = cp.pack_size[p] > 0 && pack_dead * COMPACT_DEAD_RATIO >= cp.pack_size[p];
+        if (cp.rewrite[p]) {
+            rewrites++;
+            dead += pack_dead;
+        }
+    }
+    if (rewrites == 0) {
+        LOG_INFO("[SNAPSHOT] Store compact: nothing to reclaim");
+        compact_free(&cp);
+        return 0;
+    }
+
+    u64 moved = 0;
+    Result rc = compact_copy(&cp, count, &moved, stop);
+    if (R_SUCCEEDED(rc)) {
+        mutexLock(&s_store_mutex);
+        if (!compact_swap(&cp, count)) rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+        mutexUnlock(&s_store_mutex);
+    }
+
+    // On failure the new packs are unreferenced, otherwise the rewritten ones are
+    for (u32 p = 0; p < cp.first_new + cp.new_packs; p++) {
+        bool drop = R_SUCCEEDED(rc) ? (p < cp.pack_count && cp.rewrite[p]) : p >= cp.first_new;
+        if (!drop) continue;
+        char path[128];
+        pack_path(p, path, sizeof(path));
+        remove(path);
+    }
+
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[SNAPSHOT] Store compact %s", compact_stopped(stop) ? "stopped" : "failed");
+    } else {
+        LOG_INFO("[SNAPSHOT] Store compact: %u packs rewritten, %llu KB freed, %llu KB moved in %llu ms",
+                 rewrites, (unsigned long long)(dead / 1024), (unsigned long long)(moved / 1024),
+                 (unsigned long long)(armTicksToNs(armGetSystemTick() - start) / 1000000ULL));
+    }
+    compact_free(&cp);
+    return rc;
+}
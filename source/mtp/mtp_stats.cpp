@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "mtp/mtp_stats.h"
+#include "mtp/mtp_protocol.h"
+#include "mtp/mtp_storage.h"
+#include <stdio.h>
+#include <string.h>
+
+// Live counters. Each field is only touched with relaxed atomics so the
+// protocol thread never waits on the UI.
+static MtpStatsSnapshot g_stats;
+static u64 g_reset_tick = 0;
+
+#define STAT_ADD(field, v)  __atomic_fetch_add(&(field), (v), __ATOMIC_RELAXED)
+#define STAT_LOAD(field)    __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static void statMax(u64* field, u64 v) {
+    u64 cur = __atomic_load_n(field, __ATOMIC_RELAXED);
+    while (v > cur && !__atomic_compare_exchange_n(field, &cur, v, true,
+                                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// ----------------------------------------------------------------------------
+// Names and mappings
+// ----------------------------------------------------------------------------
+
+static const u16 kOpCodes[MTP_STATS_OP_COUNT - 1] = {
+    MTP_OP_GET_DEVICE_INFO, MTP_OP_OPEN_SESSION, MTP_OP_CLOSE_SESSION,
+    MTP_OP_GET_STORAGE_IDS, MTP_OP_GET_STORAGE_INFO, MTP_OP_GET_NUM_OBJECTS,
+    MTP_OP_GET_OBJECT_HANDLES, MTP_OP_GET_OBJECT_INFO, MTP_OP_GET_OBJECT,
+    MTP_OP_SEND_OBJECT_INFO, MTP_OP_SEND_OBJECT, MTP_OP_DELETE_OBJECT,
+    MTP_OP_SET_OBJECT_PROP_VALUE,
+};
+
+static const char* const kOpNames[MTP_STATS_OP_COUNT] = {
+    "GetDeviceInfo", "OpenSession", "CloseSession",
+    "GetStorageIDs", "GetStorageInfo", "GetNumObjects",
+    "GetObjectHandles", "GetObjectInfo", "GetObject",
+    "SendObjectInfo", "SendObject", "DeleteObject",
+    "SetObjectPropValue",
+    "Unsupported",
+};
+
+static int opIndex(u16 opcode) {
+    for (int i = 0; i < MTP_STATS_OP_COUNT - 1; i++)
+        if (kOpCodes[i] == opcode) return i;
+    return MTP_STATS_OP_COUNT - 1;
+}
+
+const char* mtpOperationName(u16 opcode) {
+    return kOpNames[opIndex(opcode)];
+}
+
+const char* mtpStatsOpName(int index) {
+    if (index < 0 || index >= MTP_STATS_OP_COUNT) return "";
+    return kOpNames[index];
+}
+
+const char* mtpStatsBackendName(MtpBackend backend) {
+    static const char* const names[MTP_BACKEND_COUNT] = {
+        "SD card", "NAND", "Install", "Saves", "Album", "Gamecard", "Dump",
+    };
+    return (unsigned)backend < MTP_BACKEND_COUNT ? names[backend] : "";
+}
+
+const char* mtpStatsGaugeName(MtpGauge gauge) {
+    static const char* const names[MTP_GAUGE_COUNT] = {
+        "Event queue", "Log ring", "Install buffer",
+    };
+    return (unsigned)gauge < MTP_GAUGE_COUNT ? names[gauge] : "";
+}
+
+MtpBackend mtpStatsBackendForStorage(u32 storage_id) {
+    switch (storage_id) {
+        case MTP_STORAGE_NAND_USER:
+        case MTP_STORAGE_NAND_SYSTEM:
+        case MTP_STORAGE_INSTALLED:     return MTP_BACKEND_NAND;
+        case MTP_STORAGE_SD_INSTALL:
+        case MTP_STORAGE_NAND_INSTALL:  return MTP_BACKEND_INSTALL;
+        case MTP_STORAGE_SAVES:         return MTP_BACKEND_SAVES;
+        case MTP_STORAGE_ALBUM:         return MTP_BACKEND_ALBUM;
+        case MTP_STORAGE_GAMECARD:      return MTP_BACKEND_GAMECARD;
+        case MTP_STORAGE_DUMP:          return MTP_BACKEND_DUMP;
+        default:                        return MTP_BACKEND_SD;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Latency histogram
+// Values below 16 us get their own bucket; above that each power of two is
+// split into MTP_STATS_HIST_SUB buckets, so a bucket is within 12.5% of the
+// values it holds.
+// ----------------------------------------------------------------------------
+
+static u32 histBucket(u64 us) {
+    if (us < 2 * MTP_STATS_HIST_SUB) return (u32)us;
+    u32 msb = 63 - __builtin_clzll(us);
+    u32 sub = (u32)(us >> (msb - 3)) & (MTP_STATS_HIST_SUB - 1);
+    u32 bucket = 2 * MTP_STATS_HIST_SUB + (msb - 4) * MTP_STATS_HIST_SUB + sub;
+    return bucket < MTP_STATS_HIST_BUCKETS ? bucket : MTP_STATS_HIST_BUCKETS - 1;
+}
+
+// Largest value a bucket can hold
+static u64 histBucketUpper(u32 bucket) {
+    if (bucket < 2 * MTP_STATS_HIST_SUB) return bucket;
+    u32 msb = (bucket - 2 * MTP_STATS_HIST_SUB) / MTP_STATS_HIST_SUB + 4;
+    u32 sub = (bucket - 2 * MTP_STATS_HIST_SUB) % MTP_STATS_HIST_SUB;
+    u64 width = 1ULL << (msb - 3);
+    return (MTP_STATS_HIST_SUB + sub) * width + width - 1;
+}
+
+u64 mtpStatsPercentileUs(const MtpOpStats* op, double percentile) {
+    if (!op || op->count == 0) return 0;
+    u64 total = 0;
+    for (u32 i = 0; i < MTP_STATS_HIST_BUCKETS; i++) total += op->hist[i];
+    if (total == 0) return 0;
+
+    u64 target = (u64)(percentile / 100.0 * (double)total + 0.5);
+    if (target == 0) target = 1;
+    u64 seen = 0;
+    for (u32 i = 0; i < MTP_STATS_HIST_BUCKETS; i++) {
+        seen += op->hist[i];
+        if (seen >= target) {
+            u64 upper = histBucketUpper(i);
+            return upper < op->maxUs ? upper : op->maxUs;
+        }
+    }
+    return op->maxUs;
+}
+
+// ----------------------------------------------------------------------------
+// Writers
+// ----------------------------------------------------------------------------
+
+void mtpStatsRecordOp(u16 opcode, u64 ticks, u64 bytes) {
+    MtpOpStats* op = &g_stats.ops[opIndex(opcode)];
+    u64 us = armTicksToNs(ticks) / 1000;
+    STAT_ADD(op->count, 1);
+    STAT_ADD(op->bytes, bytes);
+    STAT_ADD(op->totalUs, us);
+    statMax(&op->maxUs, us);
+    STAT_ADD(op->hist[histBucket(us)], 1);
+}
+
+void mtpStatsRecordStorage(MtpBackend backend, bool write, u64 bytes, u64 ticks) {
+    if ((unsigned)backend >= MTP_BACKEND_COUNT) return;
+    MtpBackendStats* b = &g_stats.backends[backend];
+    u64 ns = armTicksToNs(ticks);
+    if (write) {
+        STAT_ADD(b->writes, 1);
+        STAT_ADD(b->writeBytes, bytes);
+        STAT_ADD(b->writeNs, ns);
+    } else {
+        STAT_ADD(b->reads, 1);
+        STAT_ADD(b->readBytes, bytes);
+        STAT_ADD(b->readNs, ns);
+    }
+}
+
+void mtpStatsUsbTransfer(bool in, size_t requested, size_t transferred) {
+    MtpUsbStats* usb = &g_stats.usb;
+    if (in) {
+        STAT_ADD(usb->transfersIn, 1);
+        STAT_ADD(usb->bytesIn, transferred);
+        if (transferred < requested) STAT_ADD(usb->shortIn, 1);
+    } else {
+        STAT_ADD(usb->transfersOut, 1);
+        STAT_ADD(usb->bytesOut, transferred);
+        if (transferred < requested) STAT_ADD(usb->shortOut, 1);
+    }
+}
+
+void mtpStatsUsbRetry(bool exhausted) {
+    if (exhausted) STAT_ADD(g_stats.usb.retryFailures, 1);
+    else STAT_ADD(g_stats.usb.retries, 1);
+}
+
+void mtpStatsUsbTimeout(void) {
+    STAT_ADD(g_stats.usb.timeouts, 1);
+}
+
+void mtpStatsSetGauge(MtpGauge gauge, u64 value) {
+    if ((unsigned)gauge >= MTP_GAUGE_COUNT) return;
+    __atomic_store_n(&g_stats.gauges[gauge].current, value, __ATOMIC_RELAXED);
+    statMax(&g_stats.gauges[gauge].max, value);
+}
+
+u64 mtpStatsUsbBytes(void) {
+    return STAT_LOAD(g_stats.usb.bytesIn) + STAT_LOAD(g_stats.usb.bytesOut);
+}
+
+// ----------------------------------------------------------------------------
+// Readers
+// ----------------------------------------------------------------------------
+
+// Copy field by field so every load is atomic; the snapshot as a whole may
+// mix counts from either side of an in-flight update
+static void copyCounters(u64* dst, u64* src, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+void mtpStatsSnapshot(MtpStatsSnapshot* out) {
+    if (!out) return;
+    for (int i = 0; i < MTP_STATS_OP_COUNT; i++) {
+        MtpOpStats* src = &g_stats.ops[i];
+        MtpOpStats* dst = &out->ops[i];
+        copyCounters(&dst->count, &src->count, 4);
+        for (u32 b = 0; b < MTP_STATS_HIST_BUCKETS; b++)
+            dst->hist[b] = __atomic_load_n(&src->hist[b], __ATOMIC_RELAXED);
+    }
+    copyCounters((u64*)out->backends, (u64*)g_stats.backends, MTP_BACKEND_COUNT * sizeof(MtpBackendStats) / sizeof(u64));
+    copyCounters((u64*)&out->usb, (u64*)&g_stats.usb, sizeof(g_stats.usb) / sizeof(u64));
+    copyCounters((u64*)out->gauges, (u64*)g_stats.gauges, MTP_GAUGE_COUNT * sizeof(MtpGaugeStats) / sizeof(u64));
+
+    u64 since = __atomic_load_n(&g_reset_tick, __ATOMIC_RELAXED);
+    out->elapsedNs = since ? armTicksToNs(armGetSystemTick() - since) : 0;
+}
+
+void mtpStatsReset(void) {
+    // Racing writers may land a few counts on either side; fine for stats
+    for (int i = 0; i < MTP_STATS_OP_COUNT; i++) {
+        MtpOpStats* op = &g_stats.ops[i];
+        __atomic_store_n(&op->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&op->bytes, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&op->totalUs, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&op->maxUs, 0, __ATOMIC_RELAXED);
+        for (u32 b = 0; b < MTP_STATS_HIST_BUCKETS; b++)
+            __atomic_store_n(&op->hist[b], 0, __ATOMIC_RELAXED);
+    }
+    u64* rest = (u64*)g_stats.backends;
+    size_t restWords = (sizeof(g_stats.backends) + sizeof(g_stats.usb) + sizeof(g_stats.gauges)) / sizeof(u64);
+    for (size_t i = 0; i < restWords; i++)
+        __atomic_store_n(&rest[i], 0, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&g_reset_tick, armGetSystemTick(), __ATOMIC_RELAXED);
+}
+
+static double throughputMBps(u64 bytes, u64 ns) {
+    return ns ? ((double)bytes / (1024.0 * 1024.0)) / ((double)ns / 1e9) : 0.0;
+}
+
+bool mtpStatsExportJson(const char* path) {
+    static MtpStatsSnapshot s;
+    mtpStatsSnapshot(&s);
+
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n  \"elapsed_ms\": %llu,\n  \"operations\": {\n",
+            (unsigned long long)(s.elapsedNs / 1000000));
+    bool first = true;
+    for (int i = 0; i < MTP_STATS_OP_COUNT; i++) {
+        const MtpOpStats* op = &s.ops[i];
+        if (op->count == 0) continue;
+        fprintf(f, "%s    \"%s\": {\"count\": %llu, \"bytes\": %llu, \"mean_us\": %llu, "
+                   "\"p50_us\": %llu, \"p90_us\": %llu, \"p99_us\": %llu, \"max_us\": %llu, \"histogram\": [",
+                first ? "" : ",\n", kOpNames[i],
+                (unsigned long long)op->count, (unsigned long long)op->bytes,
+                (unsigned long long)(op->totalUs / op->count),
+                (unsigned long long)mtpStatsPercentileUs(op, 50.0),
+                (unsigned long long)mtpStatsPercentileUs(op, 90.0),
+                (unsigned long long)mtpStatsPercentileUs(op, 99.0),
+                (unsigned long long)op->maxUs);
+        // Non-empty buckets only, as [upper bound in us, count]
+        bool firstBucket = true;
+        for (u32 b = 0; b < MTP_STATS_HIST_BUCKETS; b++) {
+            if (!op->hist[b]) continue;
+            fprintf(f, "%s[%llu, %u]", firstBucket ? "" : ", ",
+                    (unsigned long long)histBucketUpper(b), op->hist[b]);
+            firstBucket = false;
+        }
+        fprintf(f, "]}");
+        first = false;
+    }
+
+    fprintf(f, "\n  },\n  \"storage\": {\n");
+    for (int i = 0; i < MTP_BACKEND_COUNT; i++) {
+        const MtpBackendStats* b = &s.backends[i];
+        fprintf(f, "    \"%s\": {\"reads\": %llu, \"read_bytes\": %llu, \"read_mbps\": %.2f, "
+                   "\"writes\": %llu, \"write_bytes\": %llu, \"write_mbps\": %.2f}%s\n",
+                mtpStatsBackendName((MtpBackend)i),
+                (unsigned long long)b->reads, (unsigned long long)b->readBytes,
+                throughputMBps(b->readBytes, b->readNs),
+                (unsigned long long)b->writes, (unsigned long long)b->writeBytes,
+                throughputMBps(b->writeBytes, b->writeNs),
+                i + 1 < MTP_BACKEND_COUNT ? "," : "");
+    }
+
+    const MtpUsbStats* u = &s.usb;
+    fprintf(f, "  },\n  \"usb\": {\"bytes_in\": %llu, \"bytes_out\": %llu, \"transfers_in\": %llu, "
+               "\"transfers_out\": %llu, \"short_in\": %llu, \"short_out\": %llu, \"retries\": %llu, "
+               "\"retry_failures\": %llu, \"timeouts\": %llu},\n  \"queues\": {\n",
+            (unsigned long long)u->bytesIn, (unsigned long long)u->bytesOut,
+            (unsigned long long)u->transfersIn, (unsigned long long)u->transfersOut,
+            (unsigned long long)u->shortIn, (unsigned long long)u->shortOut,
+            (unsigned long long)u->retries, (unsigned long long)u->retryFailures,
+            (unsigned long long)u->timeouts);
+    for (int i = 0; i < MTP_GAUGE_COUNT; i++) {
+        fprintf(f, "    \"%s\": {\"current\": %llu, \"max\": %llu}%s\n",
+                mtpStatsGaugeName((MtpGauge)i),
+                (unsigned long long)s.gauges[i].current, (unsigned long long)s.gauges[i].max,
+                i + 1 < MTP_GAUGE_COUNT ? "," : "");
+    }
+    fprintf(f, "  }\n}\n");
+
+    bool ok = ferror(f) == 0;
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
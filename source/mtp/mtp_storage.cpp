@@ -7,6 +7,7 @@
 #include "core/TransferEvents.h"
 #include "core/Event.h"
 #include "core/Debug.h"
+#include "core/ThreadRoles.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -1253,7 +1254,7 @@ void mtpStorageStartBackgroundIndex(MtpStorageContext* ctx) {
     ctx->index_thread_stop = false;
     ctx->index_thread_running = true;
 
-    Result rc = threadCreate(&ctx->index_thread, index_thread_func, ctx, NULL, 0x40000, 0x2C, -2);
+    Result rc = threadCreateForRole(&ctx->index_thread, index_thread_func, ctx, 0x40000, THREAD_ROLE_BACKGROUND);
     if (R_FAILED(rc)) {
         LOG_ERROR("Failed to create index thread: 0x%08X", rc);
         ctx->index_thread_running = false;
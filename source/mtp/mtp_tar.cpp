@@ -0,0 +1,332 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "mtp/mtp_tar.h"
+#include "mtp/mtp_log.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TAR_LONGLINK_NAME "././@LongLink"
+
+static void write_octal(char* field, u32 width, u64 value) {
+    // GNU base-256 encoding for values that do not fit the octal field
+    u64 limit = 1ULL << (3 * (width - 1));
+    if (value >= limit) {
+        memset(field, 0, width);
+        field[0] = (char)0x80;
+        for (u32 i = width - 1; i > 0 && value; i--) {
+            field[i] = (char)(value & 0xFF);
+            value >>= 8;
+        }
+        return;
+    }
+    snprintf(field, width, "%0*llo", (int)(width - 1), (unsigned long long)value);
+}
+
+static u64 read_number(const char* field, u32 width) {
+    if ((u8)field[0] & 0x80) {
+        u64 value = 0;
+        for (u32 i = 1; i < width; i++) value = (value << 8) | (u8)field[i];
+        return value;
+    }
+    u64 value = 0;
+    u32 i = 0;
+    while (i < width && (field[i] == ' ' || field[i] == '\0')) i++;
+    for (; i < width && field[i] >= '0' && field[i] <= '7'; i++) {
+        value = (value << 3) | (u64)(field[i] - '0');
+    }
+    return value;
+}
+
+static u32 header_checksum(const u8* block) {
+    u32 sum = 0;
+    for (u32 i = 0; i < TAR_BLOCK_SIZE; i++) {
+        sum += (i >= 148 && i < 156) ? (u32)' ' : block[i];
+    }
+    return sum;
+}
+
+static void fill_header(u8* block, const char* name, u64 size, char typeflag, u32 mode, u64 mtime) {
+    memset(block, 0, TAR_BLOCK_SIZE);
+    char* h = (char*)block;
+
+    strncpy(h + 0, name, 100);
+    write_octal(h + 100, 8, mode);
+    write_octal(h + 108, 8, 0);
+    write_octal(h + 116, 8, 0);
+    write_octal(h + 124, 12, size);
+    write_octal(h + 136, 12, mtime);
+    h[156] = typeflag;
+    memcpy(h + 257, "ustar  ", 8);  // GNU magic + version
+    strncpy(h + 265, "root", 32);
+    strncpy(h + 297, "root", 32);
+
+    u32 sum = header_checksum(block);
+    snprintf(h + 148, 7, "%06o", sum);
+    h[155] = ' ';
+}
+
+u32 tarHeaderSize(const char* path, bool is_directory) {
+    size_t len = strlen(path) + (is_directory ? 1 : 0);
+    if (len < 100) return TAR_BLOCK_SIZE;
+    return TAR_BLOCK_SIZE * 2 + (u32)tarPaddedSize(len + 1);
+}
+
+u32 tarWriteHeader(u8* out, const char* path, u64 size, bool is_directory, u64 mtime) {
+    char name[TAR_MAX_PATH + 2];
+    snprintf(name, sizeof(name), "%s%s", path, is_directory ? "/" : "");
+    size_t len = strlen(name);
+    u32 written = 0;
+
+    if (len >= 100) {
+        fill_header(out, TAR_LONGLINK_NAME, len + 1, 'L', 0644, mtime);
+        written += TAR_BLOCK_SIZE;
+
+        u32 name_blocks = (u32)tarPaddedSize(len + 1);
+        memset(out + written, 0, name_blocks);
+        memcpy(out + written, name, len);
+        written += name_blocks;
+    }
+
+    fill_header(out + written, name, is_directory ? 0 : size,
+                is_directory ? '5' : '0', is_directory ? 0755 : 0644, mtime);
+    written += TAR_BLOCK_SIZE;
+    return written;
+}
+
+// Normalize an archive path: drop "./" and empty components, reject absolute paths and "..".
+static bool sanitize_path(const char* in, char* out, size_t out_size) {
+    if (in[0] == '/') return false;
+
+    size_t o = 0;
+    const char* p = in;
+    while (*p) {
+        const char* end = strchr(p, '/');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+
+        if (n == 2 && p[0] == '.' && p[1] == '.') return false;
+        if (n > 0 && !(n == 1 && p[0] == '.')) {
+            if (o + n + 2 > out_size) return false;
+            if (o > 0) out[o++] = '/';
+            memcpy(out + o, p, n);
+            o += n;
+        }
+
+        if (!end) break;
+        p = end + 1;
+    }
+    out[o] = '\0';
+    return true;
+}
+
+// Extract "path=" from a pax extended header into p->longname
+static void parse_pax_path(TarParser* p) {
+    char* rec = p->longname;
+    char* end = p->longname + p->longname_len;
+    p->have_longname = false;
+
+    while (rec < end) {
+        char* sp = (char*)memchr(rec, ' ', end - rec);
+        if (!sp) break;
+        u32 rec_len = (u32)strtoul(rec, NULL, 10);
+        if (rec_len == 0 || rec + rec_len > end) break;
+
+        char* kv = sp + 1;
+        char* rec_end = rec + rec_len - 1;  // Points at the trailing '\n'
+        if (rec_end > kv + 5 && strncmp(kv, "path=", 5) == 0) {
+            size_t n = rec_end - (kv + 5);
+            memmove(p->longname, kv + 5, n);
+            p->longname[n] = '\0';
+            p->have_longname = true;
+            return;
+        }
+        rec += rec_len;
+    }
+}
+
+// Move past the current entry's data into its padding (or the next header)
+static void finish_entry(TarParser* p) {
+    p->state = p->pad_remaining ? TAR_STATE_PADDING : TAR_STATE_HEADER;
+}
+
+static bool process_header(TarParser* p) {
+    const u8* block = p->block;
+    const char* h = (const char*)block;
+
+    bool all_zero = true;
+    for (u32 i = 0; i < TAR_BLOCK_SIZE; i++) {
+        if (block[i]) { all_zero = false; break; }
+    }
+    if (all_zero) {
+        if (++p->zero_blocks >= 2) p->state = TAR_STATE_END;
+        return true;
+    }
+    p->zero_blocks = 0;
+
+    if (read_number(h + 148, 8) != header_checksum(block)) {
+        LOG_ERROR("[TAR] Header checksum mismatch after %u entries", p->entry_count);
+        return false;
+    }
+
+    u64 size = read_number(h + 124, 12);
+    char type = h[156];
+    p->entry_remaining = size;
+    p->pad_remaining = tarPaddedSize(size) - size;
+
+    if (type == 'L' || type == 'x') {
+        p->name_type = type;
+        p->longname_len = 0;
+        p->state = TAR_STATE_LONGNAME;
+        if (size == 0) finish_entry(p);
+        return true;
+    }
+
+    char raw[TAR_MAX_PATH];
+    if (p->have_longname) {
+        strncpy(raw, p->longname, sizeof(raw) - 1);
+        raw[sizeof(raw) - 1] = '\0';
+        p->have_longname = false;
+    } else if (memcmp(h + 257, "ustar\0", 6) == 0 && h[345]) {
+        // POSIX ustar splits long paths into prefix + name
+        snprintf(raw, sizeof(raw), "%.155s/%.100s", h + 345, h);
+    } else {
+        snprintf(raw, sizeof(raw), "%.100s", h);
+    }
+
+    p->entry_count++;
+
+    bool is_file = (type == '0' || type == '\0' || type == '7');
+    if (!is_file && type != '5') {
+        LOG_DEBUG("[TAR] Skipping unsupported entry type '%c' for '%s'", type, raw);
+        p->state = size ? TAR_STATE_SKIP : TAR_STATE_HEADER;
+        return true;
+    }
+
+    char path[TAR_MAX_PATH];
+    if (!sanitize_path(raw, path, sizeof(path))) {
+        LOG_ERROR("[TAR] Rejected unsafe path '%s'", raw);
+        return false;
+    }
+
+    if (is_file) {
+        if (path[0] == '\0') return false;
+        if (!p->cb.on_file_begin(p->cb.user, path, size)) return false;
+        if (size == 0) {
+            if (!p->cb.on_file_end(p->cb.user)) return false;
+            finish_entry(p);
+        } else {
+            p->state = TAR_STATE_DATA;
+        }
+        return true;
+    }
+
+    if (path[0] && !p->cb.on_directory(p->cb.user, path)) return false;
+
+    // Directories normally carry no payload, but skip it if present
+    p->state = size ? TAR_STATE_SKIP : TAR_STATE_HEADER;
+    return true;
+}
+
+void tarParserInit(TarParser* p, const TarCallbacks* cb) {
+    memset(p, 0, sizeof(TarParser));
+    p->cb = *cb;
+    p->state = TAR_STATE_HEADER;
+}
+
+bool tarParserFeed(TarParser* p, const void* data, u64 size) {
+    const u8* in = (const u8*)data;
+
+    while (size > 0) {
+        switch (p->state) {
+            case TAR_STATE_HEADER: {
+                u32 n = TAR_BLOCK_SIZE - p->block_fill;
+                if (n > size) n = (u32)size;
+                memcpy(p->block + p->block_fill, in, n);
+                p->block_fill += n;
+                in += n;
+                size -= n;
+
+                if (p->block_fill == TAR_BLOCK_SIZE) {
+                    p->block_fill = 0;
+                    if (!process_header(p)) p->state = TAR_STATE_ERROR;
+                }
+                break;
+            }
+
+            case TAR_STATE_LONGNAME: {
+                u64 n = p->entry_remaining < size ? p->entry_remaining : size;
+                u64 room = sizeof(p->longname) - 1 - p->longname_len;
+                u64 keep = n < room ? n : room;
+                memcpy(p->longname + p->longname_len, in, keep);
+                p->longname_len += (u32)keep;
+                p->entry_remaining -= n;
+                in += n;
+                size -= n;
+
+                if (p->entry_remaining == 0) {
+                    p->longname[p->longname_len] = '\0';
+                    if (p->name_type == 'x') {
+                        parse_pax_path(p);
+                    } else {
+                        p->have_longname = true;
+                    }
+                    finish_entry(p);
+                }
+                break;
+            }
+
+            case TAR_STATE_DATA: {
+                u64 n = p->entry_remaining < size ? p->entry_remaining : size;
+                if (!p->cb.on_file_data(p->cb.user, in, n)) {
+                    p->state = TAR_STATE_ERROR;
+                    break;
+                }
+                p->entry_remaining -= n;
+                in += n;
+                size -= n;
+
+                if (p->entry_remaining == 0) {
+                    if (!p->cb.on_file_end(p->cb.user)) {
+                        p->state = TAR_STATE_ERROR;
+                        break;
+                    }
+                    finish_entry(p);
+                }
+                break;
+            }
+
+            case TAR_STATE_SKIP: {
+                u64 n = p->entry_remaining < size ? p->entry_remaining : size;
+                p->entry_remaining -= n;
+                in += n;
+                size -= n;
+                if (p->entry_remaining == 0) finish_entry(p);
+                break;
+            }
+
+            case TAR_STATE_PADDING: {
+                u64 n = p->pad_remaining < size ? p->pad_remaining : size;
+                p->pad_remaining -= n;
+                in += n;
+                size -= n;
+                if (p->pad_remaining == 0) p->state = TAR_STATE_HEADER;
+                break;
+            }
+
+            case TAR_STATE_END:
+                // Trailing zero records after the end marker are ignored
+                return true;
+
+            case TAR_STATE_ERROR:
+                return false;
+        }
+    }
+
+    return p->state != TAR_STATE_ERROR;
+}
+
+bool tarParserComplete(const TarParser* p) {
+    if (p->state == TAR_STATE_END) return true;
+    return p->state == TAR_STATE_HEADER && p->block_fill == 0 && !p->have_longname;
+}
@@ -3,7 +3,9 @@
 //
 #include "mtp/usb_mtp.h"
 #include "mtp/mtp_log.h"
+#include "mtp/mtp_stats.h"
 #include "core/Debug.h"
+#include "core/BufferPool.h"
 #include <string.h>
 #include <malloc.h>
 #include <stdio.h>
@@ -20,6 +22,8 @@ static UsbDsEndpoint* g_epIn = NULL;
 static UsbDsEndpoint* g_epOut = NULL;
 static UsbDsEndpoint* g_epInterrupt = NULL;
 
+static PoolBuffer* g_blockIn = NULL;
+static PoolBuffer* g_blockOut = NULL;
 static u8* g_bufferIn = NULL;
 static u8* g_bufferOut = NULL;
 
@@ -35,6 +39,12 @@ static u32 g_inflight_read_urb = 0;
 static u32 g_inflight_read_size = 0;
 static bool g_inflight_read_active = false;
 
+// Count a completed URB for the stats panel and pass its size through
+static inline u32 usbTransferDone(bool in, u32 requested, u32 transferred) {
+    mtpStatsUsbTransfer(in, requested, transferred);
+    return transferred;
+}
+
 Result usbMtpInitialize(void) {
     if (g_initialized) {
         return MAKERESULT(Module_Libnx, LibnxError_AlreadyInitialized);
@@ -263,13 +273,15 @@ Result usbMtpInitialize(void) {
         if (R_FAILED(rc)) goto cleanup;
     }
 
-    g_bufferIn = (u8*)memalign(USB_BUFFER_ALIGN, USB_BUFFER_SIZE);
-    g_bufferOut = (u8*)memalign(USB_BUFFER_ALIGN, USB_BUFFER_SIZE);
+    g_blockIn = bufferPoolAcquire(USB_BUFFER_SIZE, BUFFER_TAG_USB);
+    g_blockOut = bufferPoolAcquire(USB_BUFFER_SIZE, BUFFER_TAG_USB);
 
-    if (!g_bufferIn || !g_bufferOut) {
+    if (!g_blockIn || !g_blockOut) {
         rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
         goto cleanup;
     }
+    g_bufferIn = g_blockIn->data;
+    g_bufferOut = g_blockOut->data;
 
     // Only zero the first page — zeroing all of USB_BUFFER_SIZE would be wasteful
     memset(g_bufferIn, 0, USB_BUFFER_ALIGN);
@@ -301,14 +313,12 @@ void usbMtpExit(void) {
     usbMtpResetEndpoints();
     svcSleepThread(50000000ULL); // 50ms — let pending transfers drain
 
-    if (g_bufferIn) {
-        free(g_bufferIn);
-        g_bufferIn = NULL;
-    }
-    if (g_bufferOut) {
-        free(g_bufferOut);
-        g_bufferOut = NULL;
-    }
+    bufferRelease(g_blockIn);
+    bufferRelease(g_blockOut);
+    g_blockIn = NULL;
+    g_blockOut = NULL;
+    g_bufferIn = NULL;
+    g_bufferOut = NULL;
 
     g_epIn = NULL;
     g_epOut = NULL;
@@ -403,6 +413,7 @@ size_t usbMtpRead(void* buffer, size_t size, u64 timeout_ns) {
             rc = usbDsEndpoint_PostBufferAsync(g_epOut, g_bufferOut, chunksize, &urbId);
             if (R_FAILED(rc)) {
                 retries++;
+                mtpStatsUsbRetry(retries >= USB_MAX_RETRIES);
                 if (retries < USB_MAX_RETRIES) {
                     svcSleepThread((u64)USB_RETRY_DELAY_MS * 1000000ULL);
                     usbMtpClearStall();
@@ -459,6 +470,7 @@ size_t usbMtpRead(void* buffer, size_t size, u64 timeout_ns) {
         }
 
         if (tmp_transferred > chunksize) tmp_transferred = chunksize;
+        usbTransferDone(true, chunksize, tmp_transferred);
 
         if (tmp_transferred > 0) {
             memcpy(bufptr, g_bufferOut, tmp_transferred);
@@ -522,6 +534,7 @@ size_t usbMtpWrite(const void* buffer, size_t size, u64 timeout_ns) {
             rc = usbDsEndpoint_PostBufferAsync(g_epIn, g_bufferIn, chunksize, &urbId);
             if (R_FAILED(rc)) {
                 retries++;
+                mtpStatsUsbRetry(retries >= USB_MAX_RETRIES);
                 if (retries < USB_MAX_RETRIES) {
                     svcSleepThread((u64)USB_RETRY_DELAY_MS * 1000000ULL);
                     usbMtpClearStall();
@@ -542,6 +555,7 @@ size_t usbMtpWrite(const void* buffer, size_t size, u64 timeout_ns) {
                 usbDsEndpoint_Cancel(g_epIn);
                 eventWait(&g_epIn->CompletionEvent, 500000000ULL);
                 eventClear(&g_epIn->CompletionEvent);
+                mtpStatsUsbTimeout();
                 return total_transferred;
             }
 
@@ -582,6 +596,7 @@ size_t usbMtpWrite(const void* buffer, size_t size, u64 timeout_ns) {
         }
 
         if (tmp_transferred > chunksize) tmp_transferred = chunksize;
+        usbTransferDone(false, chunksize, tmp_transferred);
 
         bufptr += tmp_transferred;
         size -= tmp_transferred;
@@ -623,6 +638,7 @@ size_t usbMtpReadDirect(void* aligned_buffer, size_t size, u64 timeout_ns) {
         usbDsEndpoint_Cancel(g_epOut);
         eventWait(&g_epOut->CompletionEvent, 500000000ULL);
         eventClear(&g_epOut->CompletionEvent);
+        mtpStatsUsbTimeout();
         return 0;
     }
 
@@ -636,7 +652,7 @@ size_t usbMtpReadDirect(void* aligned_buffer, size_t size, u64 timeout_ns) {
         if (reportdata.report[i].id == urbId) {
             tmp_transferred = reportdata.report[i].transferredSize;
             if (tmp_transferred > chunksize) tmp_transferred = chunksize;
-            return tmp_transferred;
+            return usbTransferDone(true, chunksize, tmp_transferred);
         }
     }
 
@@ -646,7 +662,7 @@ size_t usbMtpReadDirect(void* aligned_buffer, size_t size, u64 timeout_ns) {
         return 0;
     }
     if (tmp_transferred > chunksize) tmp_transferred = chunksize;
-    return tmp_transferred;
+    return usbTransferDone(true, chunksize, tmp_transferred);
 }
 
 size_t usbMtpWriteDirect(const void* aligned_buffer, size_t size, u64 timeout_ns) {
@@ -673,6 +689,7 @@ size_t usbMtpWriteDirect(const void* aligned_buffer, size_t size, u64 timeout_ns
         usbDsEndpoint_Cancel(g_epIn);
         eventWait(&g_epIn->CompletionEvent, 500000000ULL);
         eventClear(&g_epIn->CompletionEvent);
+        mtpStatsUsbTimeout();
         return 0;
     }
 
@@ -686,7 +703,7 @@ size_t usbMtpWriteDirect(const void* aligned_buffer, size_t size, u64 timeout_ns
         if (reportdata.report[i].id == urbId) {
             tmp_transferred = reportdata.report[i].transferredSize;
             if (tmp_transferred > chunksize) tmp_transferred = chunksize;
-            return tmp_transferred;
+            return usbTransferDone(false, chunksize, tmp_transferred);
         }
     }
 
@@ -696,7 +713,7 @@ size_t usbMtpWriteDirect(const void* aligned_buffer, size_t size, u64 timeout_ns
         return 0;
     }
     if (tmp_transferred > chunksize) tmp_transferred = chunksize;
-    return tmp_transferred;
+    return usbTransferDone(false, chunksize, tmp_transferred);
 }
 
 bool usbMtpWriteDirectStart(const void* aligned_buffer, size_t size) {
@@ -732,6 +749,7 @@ size_t usbMtpWriteDirectFinish(u64 timeout_ns) {
         usbDsEndpoint_Cancel(g_epIn);
         eventWait(&g_epIn->CompletionEvent, 500000000ULL);
         eventClear(&g_epIn->CompletionEvent);
+        mtpStatsUsbTimeout();
         return 0;
     }
 
@@ -746,7 +764,7 @@ size_t usbMtpWriteDirectFinish(u64 timeout_ns) {
         if (reportdata.report[i].id == g_inflight_write_urb) {
             tmp_transferred = reportdata.report[i].transferredSize;
             if (tmp_transferred > g_inflight_write_size) tmp_transferred = g_inflight_write_size;
-            return tmp_transferred;
+            return usbTransferDone(false, g_inflight_write_size, tmp_transferred);
         }
     }
 
@@ -755,7 +773,7 @@ size_t usbMtpWriteDirectFinish(u64 timeout_ns) {
         return 0;
     }
     if (tmp_transferred > g_inflight_write_size) tmp_transferred = g_inflight_write_size;
-    return tmp_transferred;
+    return usbTransferDone(false, g_inflight_write_size, tmp_transferred);
 }
 
 bool usbMtpReadDirectStart(void* aligned_buffer, size_t size) {
@@ -791,6 +809,7 @@ size_t usbMtpReadDirectFinish(u64 timeout_ns) {
         usbDsEndpoint_Cancel(g_epOut);
         eventWait(&g_epOut->CompletionEvent, 500000000ULL);
         eventClear(&g_epOut->CompletionEvent);
+        mtpStatsUsbTimeout();
         return 0;
     }
 
@@ -805,7 +824,7 @@ size_t usbMtpReadDirectFinish(u64 timeout_ns) {
         if (reportdata.report[i].id == g_inflight_read_urb) {
             tmp_transferred = reportdata.report[i].transferredSize;
             if (tmp_transferred > g_inflight_read_size) tmp_transferred = g_inflight_read_size;
-            return tmp_transferred;
+            return usbTransferDone(true, g_inflight_read_size, tmp_transferred);
         }
     }
 
@@ -814,7 +833,7 @@ size_t usbMtpReadDirectFinish(u64 timeout_ns) {
         return 0;
     }
     if (tmp_transferred > g_inflight_read_size) tmp_transferred = g_inflight_read_size;
-    return tmp_transferred;
+    return usbTransferDone(true, g_inflight_read_size, tmp_transferred);
 }
 
 u32 usbMtpGetMaxPacketSize(void) {
@@ -7,40 +7,105 @@
 
 #include <switch.h>
 #include <ipcext/es.h>
+#include <string.h>
+
+#include "service/es.h"
+
+// -----------------------------------------------------------------------
+// Shared session
+// -----------------------------------------------------------------------
+
+// One "es" session is shared by every extended command. Callers that issue
+// many requests hold a reference for the whole run; single calls take a
+// temporary one, which is free when a longer-lived holder exists.
+static Mutex s_es_mutex;
+static Service s_es_service;
+static u32 s_es_refcount = 0;
 
 extern "C" {
 
-Result esGetTitleKey(const EsRightsId *rights_id, u32 key_generation, void *outBuf, size_t bufSize) {
-    Service esService;
-    Result rc = smGetService(&esService, "es");
-    if (R_FAILED(rc)) return rc;
+Result esExtInitialize(void) {
+    Result rc = 0;
+
+    mutexLock(&s_es_mutex);
+    if (s_es_refcount == 0)
+        rc = smGetService(&s_es_service, "es");
+    if (R_SUCCEEDED(rc))
+        s_es_refcount++;
+    mutexUnlock(&s_es_mutex);
 
+    return rc;
+}
+
+void esExtExit(void) {
+    mutexLock(&s_es_mutex);
+    if (s_es_refcount > 0 && --s_es_refcount == 0)
+        serviceClose(&s_es_service);
+    mutexUnlock(&s_es_mutex);
+}
+
+static Result es_get_title_key(const EsRightsId *rights_id, u32 key_generation, void *outBuf, size_t bufSize) {
     const struct {
         EsRightsId rights_id;
         u32 key_generation;
     } in = { *rights_id, key_generation };
 
-    rc = serviceDispatchIn(&esService, 8, in,
+    return serviceDispatchIn(&s_es_service, 8, in,
+        .buffer_attrs = { SfBufferAttr_HipcMapAlias | SfBufferAttr_Out },
+        .buffers = { { outBuf, bufSize } },
+    );
+}
+
+static Result es_get_common_ticket_data(u64 *out_size, const EsRightsId *rights_id, void *outBuf, size_t bufSize) {
+    return serviceDispatchInOut(&s_es_service, 16, *rights_id, *out_size,
         .buffer_attrs = { SfBufferAttr_HipcMapAlias | SfBufferAttr_Out },
         .buffers = { { outBuf, bufSize } },
     );
+}
+
+Result esGetTitleKey(const EsRightsId *rights_id, u32 key_generation, void *outBuf, size_t bufSize) {
+    Result rc = esExtInitialize();
+    if (R_FAILED(rc)) return rc;
+
+    rc = es_get_title_key(rights_id, key_generation, outBuf, bufSize);
 
-    serviceClose(&esService);
+    esExtExit();
     return rc;
 }
 
 Result esGetCommonTicketData(u64 *out_size, const EsRightsId *rights_id, void *outBuf, size_t bufSize) {
-    Service esService;
-    Result rc = smGetService(&esService, "es");
+    Result rc = esExtInitialize();
     if (R_FAILED(rc)) return rc;
 
-    rc = serviceDispatchInOut(&esService, 16, *rights_id, *out_size,
-        .buffer_attrs = { SfBufferAttr_HipcMapAlias | SfBufferAttr_Out },
-        .buffers = { { outBuf, bufSize } },
-    );
+    rc = es_get_common_ticket_data(out_size, rights_id, outBuf, bufSize);
 
-    serviceClose(&esService);
+    esExtExit();
     return rc;
 }
 
-} // extern "C"
\ No newline at end of file
+// ES has no multi-ticket command, so the batch variant issues one request per
+// ticket over a single session reference.
+
+Result esGetCommonTicketDataBatch(const EsRightsId *rights_ids, u32 count, void *outBuf, size_t stride,
+                                  u64 *out_sizes, Result *out_results) {
+    Result rc = esExtInitialize();
+    if (R_FAILED(rc)) return rc;
+
+    u32 failed = 0;
+    for (u32 i = 0; i < count; i++) {
+        u64 size = 0;
+        Result item_rc = es_get_common_ticket_data(&size, &rights_ids[i],
+                                                   (u8*)outBuf + i * stride, stride);
+        if (R_FAILED(item_rc)) {
+            size = 0;
+            failed++;
+        }
+        if (out_sizes) out_sizes[i] = size;
+        if (out_results) out_results[i] = item_rc;
+    }
+
+    esExtExit();
+    return failed == count && count > 0 ? MAKERESULT(Module_Libnx, LibnxError_NotFound) : 0;
+}
+
+} // extern "C"
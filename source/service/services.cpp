@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "service/services.h"
+#include "service/es.h"
+#include "mtp_log.h"
+
+#define STORAGE_SLOTS 8         // NcmStorageId values up to Any
+
+static Mutex s_mutex = {0};     // Zero-initialized is valid for libnx Mutex
+static u32 s_refs[SERVICE_COUNT];
+static bool s_open[SERVICE_COUNT];
+
+static NcmContentStorage s_storage[STORAGE_SLOTS];
+static NcmContentMetaDatabase s_meta_db[STORAGE_SLOTS];
+static bool s_storage_open[STORAGE_SLOTS];
+static bool s_meta_db_open[STORAGE_SLOTS];
+static bool s_handles_ncm;      // The handle cache holds an ncm reference of its own
+
+static const char* const kServiceNames[SERVICE_COUNT] = { "ncm", "ns", "es", "account" };
+
+static Result openService(ServiceId id) {
+    switch (id) {
+        case SERVICE_NCM:
+            return ncmInitialize();
+        case SERVICE_NS:
+            return nsInitialize();
+        case SERVICE_ES: {
+            Result rc = esInitialize();
+            if (R_FAILED(rc)) return rc;
+            rc = esExtInitialize();
+            if (R_FAILED(rc)) esExit();
+            return rc;
+        }
+        case SERVICE_ACCOUNT:
+            return accountInitialize(AccountServiceType_System);
+        default:
+            return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+}
+
+static void closeService(ServiceId id) {
+    switch (id) {
+        case SERVICE_NCM:     ncmExit(); break;
+        case SERVICE_NS:      nsExit(); break;
+        case SERVICE_ES:      esExtExit(); esExit(); break;
+        case SERVICE_ACCOUNT: accountExit(); break;
+        default: break;
+    }
+}
+
+// Caller holds s_mutex
+static Result acquireLocked(ServiceId id) {
+    if ((unsigned)id >= SERVICE_COUNT) return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+
+    if (!s_open[id]) {
+        Result rc = openService(id);
+        if (R_FAILED(rc)) {
+            LOG_ERROR("Services: Failed to open %s: 0x%08X", kServiceNames[id], rc);
+            return rc;
+        }
+        s_open[id] = true;
+        LOG_DEBUG("Services: Opened %s", kServiceNames[id]);
+    }
+    s_refs[id]++;
+    return 0;
+}
+
+Result servicesAcquire(ServiceId id) {
+    mutexLock(&s_mutex);
+    Result rc = acquireLocked(id);
+    mutexUnlock(&s_mutex);
+    return rc;
+}
+
+void servicesRelease(ServiceId id) {
+    if ((unsigned)id >= SERVICE_COUNT) return;
+
+    mutexLock(&s_mutex);
+    if (s_refs[id] > 0) s_refs[id]--;
+    else LOG_WARN("Services: %s released more often than acquired", kServiceNames[id]);
+    mutexUnlock(&s_mutex);
+}
+
+// Caller holds s_mutex
+static Result checkStorageId(NcmStorageId storage_id) {
+    if (storage_id != NcmStorageId_SdCard && storage_id != NcmStorageId_BuiltInUser &&
+        storage_id != NcmStorageId_BuiltInSystem) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+    if (!s_handles_ncm) {
+        Result rc = acquireLocked(SERVICE_NCM);
+        if (R_FAILED(rc)) return rc;
+        s_handles_ncm = true;
+    }
+    return 0;
+}
+
+Result servicesGetContentStorage(NcmStorageId storage_id, NcmContentStorage** out) {
+    mutexLock(&s_mutex);
+    Result rc = checkStorageId(storage_id);
+    if (R_SUCCEEDED(rc) && !s_storage_open[storage_id]) {
+        rc = ncmOpenContentStorage(&s_storage[storage_id], storage_id);
+        if (R_SUCCEEDED(rc)) s_storage_open[storage_id] = true;
+    }
+    mutexUnlock(&s_mutex);
+
+    *out = R_SUCCEEDED(rc) ? &s_storage[storage_id] : NULL;
+    return rc;
+}
+
+Result servicesGetContentMetaDatabase(NcmStorageId storage_id, NcmContentMetaDatabase** out) {
+    mutexLock(&s_mutex);
+    Result rc = checkStorageId(storage_id);
+    if (R_SUCCEEDED(rc) && !s_meta_db_open[storage_id]) {
+        rc = ncmOpenContentMetaDatabase(&s_meta_db[storage_id], storage_id);
+        if (R_SUCCEEDED(rc)) s_meta_db_open[storage_id] = true;
+    }
+    mutexUnlock(&s_mutex);
+
+    *out = R_SUCCEEDED(rc) ? &s_meta_db[storage_id] : NULL;
+    return rc;
+}
+
+void servicesExit(void) {
+    mutexLock(&s_mutex);
+
+    for (int i = 0; i < STORAGE_SLOTS; i++) {
+        if (s_meta_db_open[i]) ncmContentMetaDatabaseClose(&s_meta_db[i]);
+        if (s_storage_open[i]) ncmContentStorageClose(&s_storage[i]);
+        s_meta_db_open[i] = false;
+        s_storage_open[i] = false;
+    }
+    if (s_handles_ncm) {
+        s_refs[SERVICE_NCM]--;
+        s_handles_ncm = false;
+    }
+
+    for (int i = 0; i < SERVICE_COUNT; i++) {
+        if (!s_open[i]) continue;
+        if (s_refs[i]) LOG_WARN("Services: %s still has %u references at exit", kServiceNames[i], s_refs[i]);
+        closeService((ServiceId)i);
+        s_open[i] = false;
+        s_refs[i] = 0;
+    }
+
+    mutexUnlock(&s_mutex);
+}
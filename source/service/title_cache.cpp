@@ -0,0 +1,362 @@
+// SPDX-FileCopyrightText: 2026 1312delta
+// SPDX-License-Identifier: MIT
+//
+#include "service/title_cache.h"
+#include "mtp/mtp_log.h"
+#include "core/TaskPool.h"
+#include "service/services.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#define TITLE_CACHE_MAGIC       0x3243544A  // "JTC2"; JTC1 files had no versions and are rebuilt
+#define TITLE_CACHE_MAX_NAME    0x200       // NacpLanguageEntry::name
+#define TITLE_CACHE_MAX_METAS   16          // Content meta statuses read per title
+
+// Sorted by title_id. name is NULL for titles that were looked up but have no
+// NACP (not installed); those are kept for the session only and never written.
+// version is the newest installed application or patch version when the name
+// was read; entries loaded from the file are checked against it once per run.
+typedef struct {
+    u64 title_id;
+    char* name;
+    u32 version;
+    bool checked;               // Matches what is installed now
+} TitleCacheEntry;
+
+static TitleCacheEntry* s_entries = NULL;
+static u32 s_count = 0;
+static u32 s_capacity = 0;
+static bool s_loaded = false;
+static bool s_dirty = false;
+static Mutex s_mutex = {0};  // Zero-initialized is valid for libnx Mutex
+
+// Index of title_id, or of the slot it would be inserted at
+static u32 find_slot(u64 title_id, bool* found) {
+    u32 lo = 0, hi = s_count;
+    while (lo < hi) {
+        u32 mid = (lo + hi) / 2;
+        if (s_entries[mid].title_id < title_id) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = lo < s_count && s_entries[lo].title_id == title_id;
+    return lo;
+}
+
+// Insert or update an entry; takes ownership of name. Caller holds s_mutex.
+static void store_locked(u64 title_id, char* name, u32 version, bool checked) {
+    bool found = false;
+    u32 idx = find_slot(title_id, &found);
+
+    if (found) {
+        if (name || s_entries[idx].name) s_dirty = true;
+        free(s_entries[idx].name);
+        s_entries[idx].name = name;
+        s_entries[idx].version = version;
+        s_entries[idx].checked = checked;
+        return;
+    }
+
+    if (s_count >= s_capacity) {
+        u32 cap = s_capacity ? s_capacity * 2 : 256;
+        TitleCacheEntry* e = (TitleCacheEntry*)realloc(s_entries, sizeof(TitleCacheEntry) * cap);
+        if (!e) {
+            free(name);
+            return;
+        }
+        s_entries = e;
+        s_capacity = cap;
+    }
+
+    memmove(&s_entries[idx + 1], &s_entries[idx], sizeof(TitleCacheEntry) * (s_count - idx));
+    s_entries[idx].title_id = title_id;
+    s_entries[idx].name = name;
+    s_entries[idx].version = version;
+    s_entries[idx].checked = checked;
+    s_count++;
+    if (name) s_dirty = true;
+}
+
+static void load_locked(void) {
+    FILE* f = fopen(TITLE_CACHE_PATH, "rb");
+    if (!f) return;
+
+    u32 header[2];
+    if (fread(header, sizeof(header), 1, f) != 1 || header[0] != TITLE_CACHE_MAGIC) {
+        LOG_ERROR("[TITLE_CACHE] Ignoring unreadable cache file");
+        fclose(f);
+        return;
+    }
+
+    u32 loaded = 0;
+    for (u32 i = 0; i < header[1]; i++) {
+        u64 title_id;
+        u32 version;
+        u16 len;
+        if (fread(&title_id, sizeof(title_id), 1, f) != 1 || fread(&version, sizeof(version), 1, f) != 1 ||
+            fread(&len, sizeof(len), 1, f) != 1 ||
+            len == 0 || len >= TITLE_CACHE_MAX_NAME) {
+            break;
+        }
+
+        char* name = (char*)malloc(len + 1);
+        if (!name) break;
+        if (fread(name, 1, len, f) != len) {
+            free(name);
+            break;
+        }
+        name[len] = '\0';
+        store_locked(title_id, name, version, false);
+        loaded++;
+    }
+    fclose(f);
+    s_dirty = false;
+    LOG_INFO("[TITLE_CACHE] Loaded %u names", loaded);
+}
+
+static bool save_locked(void) {
+    mkdir("sdmc:/switch", 0777);
+    mkdir("sdmc:/switch/Javelin", 0777);
+
+    const char* tmp_path = TITLE_CACHE_PATH ".tmp";
+    FILE* f = fopen(tmp_path, "wb");
+    if (!f) return false;
+
+    u32 named = 0;
+    for (u32 i = 0; i < s_count; i++) {
+        if (s_entries[i].name) named++;
+    }
+
+    u32 header[2] = { TITLE_CACHE_MAGIC, named };
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1;
+    for (u32 i = 0; i < s_count && ok; i++) {
+        const TitleCacheEntry* e = &s_entries[i];
+        if (!e->name) continue;
+        u16 len = (u16)strlen(e->name);
+        ok = fwrite(&e->title_id, sizeof(e->title_id), 1, f) == 1 &&
+             fwrite(&e->version, sizeof(e->version), 1, f) == 1 &&
+             fwrite(&len, sizeof(len), 1, f) == 1 &&
+             fwrite(e->name, 1, len, f) == len;
+    }
+    ok = (fclose(f) == 0) && ok;
+
+    // Replace the old file only once the new one is complete
+    if (ok) {
+        remove(TITLE_CACHE_PATH);
+        ok = rename(tmp_path, TITLE_CACHE_PATH) == 0;
+    }
+    if (!ok) {
+        remove(tmp_path);
+        LOG_ERROR("[TITLE_CACHE] Failed to write cache file");
+    }
+    return ok;
+}
+
+void titleCacheInit(void) {
+    mutexLock(&s_mutex);
+    if (!s_loaded) {
+        load_locked();
+        s_loaded = true;
+    }
+    mutexUnlock(&s_mutex);
+}
+
+void titleCacheExit(void) {
+    titleCacheFlush();
+
+    mutexLock(&s_mutex);
+    for (u32 i = 0; i < s_count; i++) free(s_entries[i].name);
+    free(s_entries);
+    s_entries = NULL;
+    s_count = 0;
+    s_capacity = 0;
+    s_loaded = false;
+    mutexUnlock(&s_mutex);
+}
+
+void titleCacheFlush(void) {
+    mutexLock(&s_mutex);
+    if (s_dirty && save_locked()) {
+        s_dirty = false;
+    }
+    mutexUnlock(&s_mutex);
+}
+
+bool titleCacheLookup(u64 title_id, char* out, size_t out_size) {
+    mutexLock(&s_mutex);
+    bool found = false;
+    u32 idx = find_slot(title_id, &found);
+    bool named = found && s_entries[idx].name;
+    if (named) {
+        strncpy(out, s_entries[idx].name, out_size - 1);
+        out[out_size - 1] = '\0';
+    }
+    mutexUnlock(&s_mutex);
+    return named;
+}
+
+// ---------------------------------------------------------------------------
+// Fetching
+//
+// ns has no call that returns the NACP alone, so every lookup transfers the
+// full control data (NACP + icon). Each worker reuses one heap buffer for all
+// of its titles and the results are cached, so this happens once per title.
+// Cached names are revalidated once per run with the much smaller content meta
+// status list: a new update, or a title reinstalled at another version, gets
+// its name read again, and a title that is gone is dropped from the file.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const u64* ids;
+    u32 count;
+    u32 next;                   // Next index to claim (guarded by s_mutex)
+    const TaskCancelToken* cancel;  // Optional; stops claiming titles once fired
+} FetchQueue;
+
+static char* fetch_name(NsApplicationControlData* ctrl, u64 title_id) {
+    u64 actual = 0;
+    Result rc = nsGetApplicationControlData(NsApplicationControlSource_Storage, title_id,
+                                            ctrl, sizeof(*ctrl), &actual);
+    if (R_FAILED(rc) || actual < sizeof(ctrl->nacp)) return NULL;
+
+    for (int i = 0; i < 16; i++) {
+        const char* name = ctrl->nacp.lang[i].name;
+        if (name[0]) {
+            size_t len = strnlen(name, sizeof(ctrl->nacp.lang[i].name));
+            char* out = (char*)malloc(len + 1);
+            if (out) {
+                memcpy(out, name, len);
+                out[len] = '\0';
+            }
+            return out;
+        }
+    }
+    return NULL;
+}
+
+// Newest installed application or patch version; false if nothing is installed
+static bool installed_version(u64 title_id, u32* out) {
+    NsApplicationContentMetaStatus list[TITLE_CACHE_MAX_METAS];
+    s32 count = 0;
+    Result rc = nsListApplicationContentMetaStatus(title_id, 0, list, TITLE_CACHE_MAX_METAS, &count);
+    if (R_FAILED(rc)) return false;
+
+    bool installed = false;
+    *out = 0;
+    for (s32 i = 0; i < count; i++) {
+        if (list[i].meta_type != NcmContentMetaType_Application &&
+            list[i].meta_type != NcmContentMetaType_Patch) {
+            continue;
+        }
+        if (list[i].version > *out) *out = list[i].version;
+        installed = true;
+    }
+    return installed;
+}
+
+static void fetch_worker(void* arg) {
+    FetchQueue* q = (FetchQueue*)arg;
+
+    NsApplicationControlData* ctrl = (NsApplicationControlData*)malloc(sizeof(NsApplicationControlData));
+    if (!ctrl) return;
+
+    while (true) {
+        if (taskCancelled(q->cancel)) break;
+
+        mutexLock(&s_mutex);
+        u32 idx = q->next < q->count ? q->next++ : q->count;
+        mutexUnlock(&s_mutex);
+        if (idx >= q->count) break;
+
+        u64 title_id = q->ids[idx];
+        u32 version = 0;
+        bool installed = installed_version(title_id, &version);
+
+        // A cached name for the same installed version is still current
+        mutexLock(&s_mutex);
+        bool found = false;
+        u32 slot = find_slot(title_id, &found);
+        bool current = installed && found && s_entries[slot].name && s_entries[slot].version == version;
+        if (current) s_entries[slot].checked = true;
+        mutexUnlock(&s_mutex);
+        if (current) continue;
+
+        char* name = installed ? fetch_name(ctrl, title_id) : NULL;
+
+        mutexLock(&s_mutex);
+        store_locked(title_id, name, version, true);
+        mutexUnlock(&s_mutex);
+    }
+
+    free(ctrl);
+}
+
+void titleCacheFetch(const u64* title_ids, u32 count) {
+    titleCacheFetchCancellable(title_ids, count, NULL);
+}
+
+void titleCacheFetchCancellable(const u64* title_ids, u32 count, const TaskCancelToken* cancel) {
+    if (!title_ids || count == 0 || taskCancelled(cancel)) return;
+    titleCacheInit();
+
+    // Only titles not looked up or revalidated this run, each once
+    u64* pending = (u64*)malloc(sizeof(u64) * count);
+    if (!pending) return;
+
+    u32 pending_count = 0;
+    mutexLock(&s_mutex);
+    for (u32 i = 0; i < count; i++) {
+        bool found = false;
+        u32 idx = find_slot(title_ids[i], &found);
+        if (found && s_entries[idx].checked) continue;
+
+        bool dup = false;
+        for (u32 j = 0; j < pending_count && !dup; j++) dup = pending[j] == title_ids[i];
+        if (!dup) pending[pending_count++] = title_ids[i];
+    }
+    mutexUnlock(&s_mutex);
+
+    if (pending_count == 0) {
+        free(pending);
+        return;
+    }
+
+    u64 start = armGetSystemTick();
+    Result rc = servicesAcquire(SERVICE_NS);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("[TITLE_CACHE] ns unavailable: 0x%08X", rc);
+        free(pending);
+        return;
+    }
+
+    FetchQueue queue = { pending, pending_count, 0, cancel };
+    Task* helpers[TITLE_CACHE_WORKERS];
+    u32 submitted = 0;
+    u32 wanted = pending_count < TITLE_CACHE_WORKERS ? pending_count : TITLE_CACHE_WORKERS;
+
+    for (u32 i = 1; i < wanted; i++) {
+        helpers[submitted++] = taskSubmit(fetch_worker, &queue, TASK_PRIORITY_NORMAL, NULL);
+    }
+
+    // The calling thread works the queue too, so progress never depends on the pool
+    fetch_worker(&queue);
+
+    for (u32 i = 0; i < submitted; i++) {
+        taskWait(helpers[i]);
+        taskRelease(helpers[i]);
+    }
+    servicesRelease(SERVICE_NS);
+
+    u32 resolved = queue.next < pending_count ? queue.next : pending_count;
+    LOG_INFO("[TITLE_CACHE] Resolved %u of %u titles with %u jobs in %llu ms", resolved, pending_count, submitted + 1,
+             (unsigned long long)(armTicksToNs(armGetSystemTick() - start) / 1000000ULL));
+    free(pending);
+    titleCacheFlush();
+}
+
+bool titleCacheGetName(u64 title_id, char* out, size_t out_size) {
+    if (titleCacheLookup(title_id, out, out_size)) return true;
+    titleCacheFetch(&title_id, 1);
+    return titleCacheLookup(title_id, out, out_size);
+}
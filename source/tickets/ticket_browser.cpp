@@ -7,11 +7,14 @@
 extern "C" {
 #include "ipcext/es.h"
 #include "service/es.h"
+#include "service/title_cache.h"
+#include "service/services.h"
 #include <switch/services/ns.h>
 #include <switch/crypto/aes.h>
 }
 #include "core/GuiEvents.h"
 #include "core/GuiManager.h"
+#include "core/ThreadRoles.h"
 #include "imgui.h"
 #include <cstdio>
 #include <cstring>
@@ -143,38 +146,14 @@ static void formatRightsId(const EsRightsId* id, char* out) {
     }
 }
 
-static bool tryResolveName(u64 id, NsApplicationControlData* ctrl, char* outName, size_t outSize) {
-    u64 actual = 0;
-    Result rc = nsGetApplicationControlData(NsApplicationControlSource_Storage, id, ctrl, sizeof(*ctrl), &actual);
-    if (R_SUCCEEDED(rc) && actual >= sizeof(ctrl->nacp)) {
-        for (int k = 0; k < 16; k++) {
-            if (ctrl->nacp.lang[k].name[0]) {
-                strncpy(outName, ctrl->nacp.lang[k].name, outSize - 1);
-                outName[outSize - 1] = '\0';
-                return true;
-            }
-        }
-    }
-    return false;
-}
+// Cached name of a ticket's title, falling back to its base application
+static bool lookupTicketName(u64 titleId, char* outName, size_t outSize) {
+    // Try exact title ID first
+    if (titleCacheLookup(titleId, outName, outSize)) return true;
 
-static void resolveTicketName(u64 titleId, char* outName, size_t outSize) {
-    NsApplicationControlData* ctrl = (NsApplicationControlData*)malloc(sizeof(NsApplicationControlData));
-    if (ctrl) {
-        // Try exact title ID first
-        if (tryResolveName(titleId, ctrl, outName, outSize)) {
-            free(ctrl);
-            return;
-        }
-        // Try base application ID (mask off lower 13 bits for DLC/update)
-        u64 baseId = titleId & 0xFFFFFFFFFFFFE000ULL;
-        if (baseId != titleId && tryResolveName(baseId, ctrl, outName, outSize)) {
-            free(ctrl);
-            return;
-        }
-        free(ctrl);
-    }
-    snprintf(outName, outSize, "%016llX", (unsigned long long)titleId);
+    // Try base application ID (mask off lower 13 bits for DLC/update)
+    u64 baseId = titleId & 0xFFFFFFFFFFFFE000ULL;
+    return baseId != titleId && titleCacheLookup(baseId, outName, outSize);
 }
 
 // -----------------------------------------------------------------------
@@ -191,18 +170,13 @@ static bool fetchTicketDetail(TicketBrowserState* state, int index) {
     detail.is_common = !entry.isPersonalized;
 
     if (detail.is_common) {
-        Result rc = esInitialize();
-        if (R_FAILED(rc)) return false;
-
+        // The browser holds the shared ES session, so this is a single IPC
         u8* tikBuf = (u8*)malloc(SIGNED_TIK_MAX_SIZE);
-        if (!tikBuf) {
-            esExit();
-            return false;
-        }
+        if (!tikBuf) return false;
         memset(tikBuf, 0, SIGNED_TIK_MAX_SIZE);
 
         u64 out_size = 0;
-        rc = esGetCommonTicketData(&out_size, &entry.rightsId, tikBuf, SIGNED_TIK_MAX_SIZE);
+        Result rc = esGetCommonTicketData(&out_size, &entry.rightsId, tikBuf, SIGNED_TIK_MAX_SIZE);
         if (R_SUCCEEDED(rc) && out_size >= sizeof(TikCommonBlock)) {
             // Check if data starts with signature type or issuer
             LOG_DEBUG("Ticket Browser: out_size=0x%lX", out_size);
@@ -325,7 +299,6 @@ static bool fetchTicketDetail(TicketBrowserState* state, int index) {
         }
 
         free(tikBuf);
-        esExit();
     } else {
         // Personalized - no cmd 17 on modern FW, just mark as loaded with basic info
         detail.loaded = true;
@@ -335,93 +308,151 @@ static bool fetchTicketDetail(TicketBrowserState* state, int index) {
 }
 
 // -----------------------------------------------------------------------
-// Public API
+// Background loader
 // -----------------------------------------------------------------------
 
-void ticketBrowserInit(TicketBrowserState* state) {
-    state->initialized = false;
-    state->loading = false;
-    state->selectedFilter = 0;
-    memset(state->searchBuf, 0, sizeof(state->searchBuf));
-    state->tickets.clear();
-    state->selectedTicket = -1;
-    state->showDetailPopup = false;
-    memset(&state->detail, 0, sizeof(state->detail));
+#define TICKET_PUBLISH_BATCH 128    // Tickets handed to the UI at a time
+#define TICKET_NAME_BATCH    64     // Tickets per title cache fetch
+
+// The loader polls the token before every title it names, so the wait here is
+// at most the NACP reads already in flight
+static void stopTicketLoader(TicketBrowserState* state) {
+    TicketLoader& ld = state->loader;
+    if (!ld.running) return;
+    taskCancel(&ld.cancel);
+    if (ld.task) {
+        taskWait(ld.task);
+        taskRelease(ld.task);
+        ld.task = nullptr;
+    }
+    ld.running = false;
 }
 
-void ticketBrowserRefresh(TicketBrowserState* state) {
-    state->loading = true;
-    state->tickets.clear();
-    state->selectedTicket = -1;
-    state->showDetailPopup = false;
+static void publishTickets(TicketLoader& ld, const TicketEntry* entries, size_t count, u32 named) {
+    mutexLock(&ld.mutex);
+    ld.incoming.insert(ld.incoming.end(), entries, entries + count);
+    ld.listed += (u32)count;
+    ld.named += named;
+    mutexUnlock(&ld.mutex);
+}
 
-    Result rc = nsInitialize();
-    if (R_FAILED(rc)) {
-        showError(TR("tickets.ns_init_failed"));
-        state->loading = false;
-        return;
+// List one kind of ticket into all, publishing batches as they are built.
+// Tickets without a cached name are added to unnamed.
+static void loadTicketList(TicketLoader& ld, bool personalized, std::vector<TicketEntry>& all,
+                           std::vector<u32>& unnamed) {
+    u32 count = personalized ? esCountPersonalizedTicket() : esCountCommonTicket();
+    if (count == 0) return;
+
+    EsRightsId* ids = (EsRightsId*)malloc(count * sizeof(EsRightsId));
+    if (!ids) return;
+
+    u32 written = 0;
+    Result rc = personalized ? esListPersonalizedTicket(&written, ids, count * sizeof(EsRightsId))
+                             : esListCommonTicket(&written, ids, count * sizeof(EsRightsId));
+    if (R_FAILED(rc)) written = 0;
+
+    for (u32 i = 0; i < written && !taskCancelled(&ld.cancel); i += TICKET_PUBLISH_BATCH) {
+        size_t first = all.size();
+        u32 named = 0;
+        for (u32 j = i; j < written && j < i + TICKET_PUBLISH_BATCH; j++) {
+            TicketEntry entry;
+            entry.titleId = esGetRightsIdApplicationId(&ids[j]);
+            entry.keyGeneration = esGetRightsIdKeyGeneration(&ids[j]);
+            entry.isPersonalized = personalized;
+            entry.rightsId = ids[j];
+            formatRightsId(&ids[j], entry.rightsIdStr);
+            if (lookupTicketName(entry.titleId, entry.titleName, sizeof(entry.titleName))) {
+                named++;
+            } else {
+                snprintf(entry.titleName, sizeof(entry.titleName), "%016llX", (unsigned long long)entry.titleId);
+                unnamed.push_back((u32)all.size());
+            }
+            all.push_back(entry);
+        }
+        publishTickets(ld, &all[first], all.size() - first, named);
     }
+    free(ids);
+}
 
-    rc = esInitialize();
-    if (R_FAILED(rc)) {
-        showError(TR("tickets.es_init_failed"));
-        state->loading = false;
-        return;
-    }
+static void ticketLoaderTask(void* arg) {
+    TicketLoader& ld = *(TicketLoader*)arg;
+    std::vector<TicketEntry> all;
+    std::vector<u32> unnamed;
+
+    // Everything ES knows is listed first, with the names already in the cache
+    loadTicketList(ld, false, all, unnamed);
+    loadTicketList(ld, true, all, unnamed);
+
+    // The rest of the names, a batch at a time so the list fills in progressively
+    std::vector<u64> ids;
+    for (size_t i = 0; i < unnamed.size() && !taskCancelled(&ld.cancel); i += TICKET_NAME_BATCH) {
+        size_t end = std::min(unnamed.size(), i + TICKET_NAME_BATCH);
+        ids.clear();
+        for (size_t j = i; j < end; j++) {
+            u64 titleId = all[unnamed[j]].titleId;
+            ids.push_back(titleId);
+            ids.push_back(titleId & 0xFFFFFFFFFFFFE000ULL);
+        }
+        titleCacheFetchCancellable(ids.data(), (u32)ids.size(), &ld.cancel);
 
-    u32 commonCount = esCountCommonTicket();
-    if (commonCount > 0) {
-        EsRightsId* commonIds = (EsRightsId*)malloc(commonCount * sizeof(EsRightsId));
-        if (commonIds) {
-            u32 written = 0;
-            rc = esListCommonTicket(&written, commonIds, commonCount * sizeof(EsRightsId));
-            if (R_SUCCEEDED(rc)) {
-                for (u32 i = 0; i < written; i++) {
-                    TicketEntry entry;
-                    entry.titleId = esGetRightsIdApplicationId(&commonIds[i]);
-                    entry.keyGeneration = esGetRightsIdKeyGeneration(&commonIds[i]);
-                    entry.isPersonalized = false;
-                    entry.rightsId = commonIds[i];
-                    formatRightsId(&commonIds[i], entry.rightsIdStr);
-                    resolveTicketName(entry.titleId, entry.titleName, sizeof(entry.titleName));
-                    state->tickets.push_back(entry);
-                }
+        std::vector<TicketNameUpdate> updates;
+        char name[sizeof(all[0].titleName)];
+        for (size_t j = i; j < end; j++) {
+            if (lookupTicketName(all[unnamed[j]].titleId, name, sizeof(name))) {
+                updates.push_back({ unnamed[j], name });
             }
-            free(commonIds);
         }
+
+        mutexLock(&ld.mutex);
+        ld.named += (u32)updates.size();
+        ld.names.insert(ld.names.end(), updates.begin(), updates.end());
+        mutexUnlock(&ld.mutex);
     }
 
-    u32 personalCount = esCountPersonalizedTicket();
-    if (personalCount > 0) {
-        EsRightsId* personalIds = (EsRightsId*)malloc(personalCount * sizeof(EsRightsId));
-        if (personalIds) {
-            u32 written = 0;
-            rc = esListPersonalizedTicket(&written, personalIds, personalCount * sizeof(EsRightsId));
-            if (R_SUCCEEDED(rc)) {
-                for (u32 i = 0; i < written; i++) {
-                    TicketEntry entry;
-                    entry.titleId = esGetRightsIdApplicationId(&personalIds[i]);
-                    entry.keyGeneration = esGetRightsIdKeyGeneration(&personalIds[i]);
-                    entry.isPersonalized = true;
-                    entry.rightsId = personalIds[i];
-                    formatRightsId(&personalIds[i], entry.rightsIdStr);
-                    resolveTicketName(entry.titleId, entry.titleName, sizeof(entry.titleName));
-                    state->tickets.push_back(entry);
-                }
-            }
-            free(personalIds);
+    mutexLock(&ld.mutex);
+    ld.finished = true;
+    mutexUnlock(&ld.mutex);
+}
+
+// Merge what the loader produced since the last frame (UI thread)
+static void pollTicketLoader(TicketBrowserState* state) {
+    TicketLoader& ld = state->loader;
+    if (!ld.running) return;
+
+    mutexLock(&ld.mutex);
+    state->tickets.insert(state->tickets.end(), ld.incoming.begin(), ld.incoming.end());
+    ld.incoming.clear();
+    // Until loading ends the list is in load order, so the index is the position
+    for (const TicketNameUpdate& u : ld.names) {
+        if (u.index < state->tickets.size()) {
+            TicketEntry& entry = state->tickets[u.index];
+            snprintf(entry.titleName, sizeof(entry.titleName), "%s", u.name.c_str());
         }
     }
+    ld.names.clear();
+    bool finished = ld.finished;
+    mutexUnlock(&ld.mutex);
+
+    if (!finished) return;
+    stopTicketLoader(state);
 
-    esExit();
-    nsExit();
+    // Sort once at the end, keeping the selection on the same ticket
+    EsRightsId selected = {};
+    bool hasSelection = state->selectedTicket >= 0 && state->selectedTicket < (int)state->tickets.size();
+    if (hasSelection) selected = state->tickets[state->selectedTicket].rightsId;
 
     std::sort(state->tickets.begin(), state->tickets.end(),
         [](const TicketEntry& a, const TicketEntry& b) {
             return strcmp(a.titleName, b.titleName) < 0;
         });
 
-    state->initialized = true;
+    state->selectedTicket = -1;
+    for (int i = 0; hasSelection && i < (int)state->tickets.size(); i++) {
+        if (memcmp(&state->tickets[i].rightsId, &selected, sizeof(selected)) == 0) {
+            state->selectedTicket = i;
+            break;
+        }
+    }
     state->loading = false;
 
     char msg[128];
@@ -429,9 +460,347 @@ void ticketBrowserRefresh(TicketBrowserState* state) {
     showSuccess(msg);
 }
 
+// -----------------------------------------------------------------------
+// title.keys export
+// -----------------------------------------------------------------------
+
+#define TITLEKEY_EXPORT_PATH  "/switch/title.keys"
+#define TITLEKEY_EXPORT_BATCH 32    // Tickets fetched per ES batch
+#define TITLEKEK_COUNT        0x20
+
+// Every titlekek in prod.keys, parsed in one pass. Returns how many were found.
+static u32 load_titlekeks(u8 keys[TITLEKEK_COUNT][0x10], bool present[TITLEKEK_COUNT]) {
+    memset(present, 0, TITLEKEK_COUNT * sizeof(bool));
+
+    FILE* fp = fopen("/switch/prod.keys", "r");
+    if (!fp) return 0;
+
+    u32 found = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        trim_whitespace(line);
+        if (line[0] == '\0' || line[0] == ';' || line[0] == '#') continue;
+
+        char* eq = strchr(line, '=');
+        if (!eq) continue;
+
+        *eq = '\0';
+        char* name = line;
+        char* value = eq + 1;
+        trim_whitespace(name);
+        trim_whitespace(value);
+
+        if (strncasecmp(name, "titlekek_", 9) != 0 || strlen(name) != 11) continue;
+        char* end = NULL;
+        unsigned long gen = strtoul(name + 9, &end, 16);
+        if (*end != '\0' || gen >= TITLEKEK_COUNT || present[gen]) continue;
+
+        if (hex_to_bytes(value, keys[gen], 0x10) == 0x10) {
+            present[gen] = true;
+            found++;
+        }
+    }
+
+    fclose(fp);
+    return found;
+}
+
+static void lower_hex(const u8* data, u32 len, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (u32 i = 0; i < len; i++) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0xF];
+    }
+    out[len * 2] = '\0';
+}
+
+static void setExportTotal(TicketExportJob& job, u32 total) {
+    mutexLock(&job.mutex);
+    job.total = total;
+    mutexUnlock(&job.mutex);
+}
+
+struct TitleKeyExportScratch {
+    Aes128Context kek[TITLEKEK_COUNT];
+    u8 kekKeys[TITLEKEK_COUNT][0x10];
+    bool hasKek[TITLEKEK_COUNT];
+    u8 tickets[TITLEKEY_EXPORT_BATCH][SIGNED_TIK_MAX_SIZE];
+    u64 sizes[TITLEKEY_EXPORT_BATCH];
+    Result results[TITLEKEY_EXPORT_BATCH];
+    char lines[TITLEKEY_EXPORT_BATCH * 70];
+};
+
+// Unwrap one common ticket's title key into "rightsid = titlekey\n".
+// Returns the line length, or 0 if the ticket has no usable key.
+static u32 formatTitleKeyLine(TitleKeyExportScratch* s, const EsRightsId* id, const u8* tik, u64 size,
+                              char* out) {
+    const u32 body_offset = 0x140;
+    if (size < body_offset + 0x180) return 0;
+
+    const u8* body = tik + body_offset;
+    if (body[0x141] != 0) return 0;             // Personalized: key is RSA-wrapped
+
+    // The title key is wrapped with the titlekek of the ticket's own key generation
+    u8 gen = body[0x145];
+    if (gen >= TITLEKEK_COUNT || !s->hasKek[gen]) return 0;
+
+    u8 titlekey[0x10];
+    aes128DecryptBlock(&s->kek[gen], titlekey, body + 0x40);
+
+    char idHex[33];
+    char keyHex[33];
+    lower_hex(id->fs_id.c, 0x10, idHex);
+    lower_hex(titlekey, 0x10, keyHex);
+    memcpy(out, idHex, 32);
+    memcpy(out + 32, " = ", 3);
+    memcpy(out + 35, keyHex, 32);
+    out[67] = '\n';
+    return 68;
+}
+
+static void titleKeyExportThread(void* arg) {
+    TicketExportJob& job = *(TicketExportJob*)arg;
+    const char* tmp_path = TITLEKEY_EXPORT_PATH ".tmp";
+    Result rc = 0;
+    u32 exported = 0;
+    EsRightsId* ids = NULL;
+    FILE* f = NULL;
+
+    TitleKeyExportScratch* s = (TitleKeyExportScratch*)malloc(sizeof(TitleKeyExportScratch));
+    u32 count = esCountCommonTicket();
+    u32 written = 0;
+
+    if (!s) {
+        rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        goto done;
+    }
+
+    // Key schedules are expanded once per generation, not per ticket
+    if (load_titlekeks(s->kekKeys, s->hasKek) == 0) {
+        rc = MAKERESULT(Module_Libnx, LibnxError_NotFound);
+        goto done;
+    }
+    for (u32 g = 0; g < TITLEKEK_COUNT; g++) {
+        if (s->hasKek[g]) aes128ContextCreate(&s->kek[g], s->kekKeys[g], false);
+    }
+
+    if (count > 0) {
+        ids = (EsRightsId*)malloc(count * sizeof(EsRightsId));
+        if (!ids) {
+            rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+            goto done;
+        }
+        rc = esListCommonTicket(&written, ids, count * sizeof(EsRightsId));
+        if (R_FAILED(rc)) goto done;
+    }
+    setExportTotal(job, written);
+
+    f = fopen(tmp_path, "w");
+    if (!f) {
+        rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+        goto done;
+    }
+
+    for (u32 i = 0; i < written && !job.cancel; i += TITLEKEY_EXPORT_BATCH) {
+        u32 n = std::min<u32>(TITLEKEY_EXPORT_BATCH, written - i);
+        esGetCommonTicketDataBatch(&ids[i], n, s->tickets, SIGNED_TIK_MAX_SIZE, s->sizes, s->results);
+
+        u32 len = 0;
+        u32 keys = 0;
+        for (u32 j = 0; j < n; j++) {
+            if (R_FAILED(s->results[j])) continue;
+            u32 line = formatTitleKeyLine(s, &ids[i + j], s->tickets[j], s->sizes[j], s->lines + len);
+            if (line > 0) keys++;
+            len += line;
+        }
+        if (len > 0 && fwrite(s->lines, 1, len, f) != len) {
+            rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+            break;
+        }
+        exported += keys;
+
+        mutexLock(&job.mutex);
+        job.done = i + n;
+        job.exported = exported;
+        mutexUnlock(&job.mutex);
+    }
+
+    if (fclose(f) != 0 && R_SUCCEEDED(rc)) rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+
+    // Replace the old file only once the new one is complete; a cancelled
+    // export, or one that found no key, leaves the previous one in place
+    if (job.cancel || exported == 0) {
+        remove(tmp_path);
+    } else if (R_SUCCEEDED(rc)) {
+        remove(TITLEKEY_EXPORT_PATH);
+        if (rename(tmp_path, TITLEKEY_EXPORT_PATH) != 0)
+            rc = MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    if (R_FAILED(rc)) remove(tmp_path);
+
+done:
+    if (R_SUCCEEDED(rc) && exported == 0) {
+        LOG_ERROR("Ticket Browser: No title key exported from %u common tickets, title.keys left as is", written);
+    } else if (R_SUCCEEDED(rc)) {
+        LOG_INFO("Ticket Browser: Exported %u title keys from %u common tickets", exported, written);
+    } else {
+        LOG_ERROR("Ticket Browser: title.keys export failed: 0x%08X", rc);
+    }
+
+    free(ids);
+    free(s);
+
+    mutexLock(&job.mutex);
+    job.exported = exported;
+    job.result = rc;
+    job.finished = true;
+    mutexUnlock(&job.mutex);
+}
+
+static void stopTitleKeyExport(TicketBrowserState* state) {
+    TicketExportJob& job = state->exportJob;
+    if (!job.running) return;
+    job.cancel = true;
+    if (job.threadStarted) {
+        threadWaitForExit(&job.thread);
+        threadClose(&job.thread);
+        job.threadStarted = false;
+    }
+    job.running = false;
+}
+
+static void startTitleKeyExport(TicketBrowserState* state) {
+    TicketExportJob& job = state->exportJob;
+    if (job.running || !state->servicesOpen) return;
+
+    job.cancel = false;
+    job.finished = false;
+    job.total = 0;
+    job.done = 0;
+    job.exported = 0;
+    job.result = 0;
+    job.running = true;
+
+    Result rc = threadCreateForRole(&job.thread, titleKeyExportThread, &job, 0x20000, THREAD_ROLE_IO);
+    if (R_SUCCEEDED(rc)) {
+        rc = threadStart(&job.thread);
+        if (R_FAILED(rc)) threadClose(&job.thread);
+    }
+    job.threadStarted = R_SUCCEEDED(rc);
+    if (!job.threadStarted) {
+        LOG_ERROR("Ticket Browser: Failed to start export thread: 0x%08X", rc);
+        titleKeyExportThread(&job);
+    }
+}
+
+// Report a finished export (UI thread)
+static void pollTitleKeyExport(TicketBrowserState* state) {
+    TicketExportJob& job = state->exportJob;
+    if (!job.running) return;
+
+    mutexLock(&job.mutex);
+    bool finished = job.finished;
+    u32 exported = job.exported;
+    Result rc = job.result;
+    mutexUnlock(&job.mutex);
+
+    if (!finished) return;
+    stopTitleKeyExport(state);
+
+    char msg[256];
+    if (R_SUCCEEDED(rc) && exported == 0) {
+        showError(TR("tickets.export_empty"));
+    } else if (R_SUCCEEDED(rc)) {
+        snprintf(msg, sizeof(msg), TR("tickets.export_done"), exported, TITLEKEY_EXPORT_PATH);
+        showSuccess(msg);
+    } else if (rc == MAKERESULT(Module_Libnx, LibnxError_NotFound)) {
+        showError(TR("tickets.export_no_keys"));
+    } else {
+        showError(TR("tickets.export_failed"));
+    }
+}
+
+// -----------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------
+
+void ticketBrowserInit(TicketBrowserState* state) {
+    state->initialized = false;
+    state->loading = false;
+    state->servicesOpen = false;
+    state->selectedFilter = 0;
+    memset(state->searchBuf, 0, sizeof(state->searchBuf));
+    state->tickets.clear();
+    state->selectedTicket = -1;
+    state->showDetailPopup = false;
+    memset(&state->detail, 0, sizeof(state->detail));
+
+    TicketLoader& ld = state->loader;
+    ld.running = false;
+    ld.task = nullptr;
+    taskCancelReset(&ld.cancel);
+    ld.finished = false;
+    ld.listed = 0;
+    ld.named = 0;
+    mutexInit(&ld.mutex);
+
+    TicketExportJob& job = state->exportJob;
+    job.running = false;
+    job.threadStarted = false;
+    job.cancel = false;
+    job.finished = false;
+    mutexInit(&job.mutex);
+}
+
+void ticketBrowserRefresh(TicketBrowserState* state) {
+    stopTicketLoader(state);
+
+    state->tickets.clear();
+    state->selectedTicket = -1;
+    state->showDetailPopup = false;
+
+    // References are held until the browser exits; refreshes and detail lookups reuse them
+    if (!state->servicesOpen) {
+        if (R_FAILED(servicesAcquire(SERVICE_NS))) {
+            showError(TR("tickets.ns_init_failed"));
+            return;
+        }
+        if (R_FAILED(servicesAcquire(SERVICE_ES))) {
+            servicesRelease(SERVICE_NS);
+            showError(TR("tickets.es_init_failed"));
+            return;
+        }
+        state->servicesOpen = true;
+    }
+
+    TicketLoader& ld = state->loader;
+    taskCancelReset(&ld.cancel);
+    ld.finished = false;
+    ld.incoming.clear();
+    ld.names.clear();
+    ld.listed = 0;
+    ld.named = 0;
+
+    state->initialized = true;
+    state->loading = true;
+    ld.running = true;
+
+    // Runs inline if the pool cannot take it; the next poll merges everything at once
+    ld.task = taskSubmit(ticketLoaderTask, &ld, TASK_PRIORITY_HIGH, &ld.cancel);
+}
+
 void ticketBrowserExit(TicketBrowserState* state) {
+    stopTitleKeyExport(state);
+    stopTicketLoader(state);
     state->tickets.clear();
     state->initialized = false;
+    state->loading = false;
+
+    if (state->servicesOpen) {
+        servicesRelease(SERVICE_ES);
+        servicesRelease(SERVICE_NS);
+        state->servicesOpen = false;
+    }
 }
 
 // -----------------------------------------------------------------------
@@ -591,10 +960,10 @@ static void renderDetailPopup(TicketBrowserState* state) {
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.6f, 0.15f, 0.15f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.8f, 0.2f, 0.2f, 1.0f));
         if (ImGui::Button(TR("tickets.delete"), ImVec2(120, 35))) {
-            Result rc = esInitialize();
+            Result rc = servicesAcquire(SERVICE_ES);
             if (R_SUCCEEDED(rc)) {
                 rc = esDeleteTicket(&entry.rightsId);
-                esExit();
+                servicesRelease(SERVICE_ES);
                 if (R_SUCCEEDED(rc)) {
                     showSuccess(TR("tickets.delete_success"));
                     ImGui::CloseCurrentPopup();
@@ -627,6 +996,8 @@ static void renderDetailPopup(TicketBrowserState* state) {
 void renderTicketScreen(TicketBrowserState* state) {
     float windowWidth = ImGui::GetContentRegionAvail().x;
 
+    pollTicketLoader(state);
+    pollTitleKeyExport(state);
     if (!state->initialized && !state->loading) {
         ticketBrowserRefresh(state);
     }
@@ -647,10 +1018,6 @@ void renderTicketScreen(TicketBrowserState* state) {
         if (ImGui::Button(TR("tickets.load"), ImVec2(btnWidth, 45))) {
             ticketBrowserRefresh(state);
         }
-    } else if (state->loading) {
-        const char* loadMsg = TR("tickets.loading");
-        ImGui::SetCursorPosX((windowWidth - ImGui::CalcTextSize(loadMsg).x) / 2);
-        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "%s", loadMsg);
     } else {
         ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 4.0f);
 
@@ -678,6 +1045,22 @@ void renderTicketScreen(TicketBrowserState* state) {
             ticketBrowserRefresh(state);
         }
 
+        ImGui::SameLine();
+        bool exporting = state->exportJob.running;
+        ImGui::BeginDisabled(exporting);
+        if (ImGui::Button(TR("tickets.export_keys"), ImVec2(200, 35))) {
+            startTitleKeyExport(state);
+        }
+        ImGui::EndDisabled();
+        if (exporting) {
+            mutexLock(&state->exportJob.mutex);
+            u32 done = state->exportJob.done;
+            u32 total = state->exportJob.total;
+            mutexUnlock(&state->exportJob.mutex);
+            ImGui::SameLine();
+            ImGui::ProgressBar(total > 0 ? (float)done / (float)total : 0.0f, ImVec2(200, 35));
+        }
+
         ImGui::Spacing();
 
         int filteredCount = 0;
@@ -690,6 +1073,15 @@ void renderTicketScreen(TicketBrowserState* state) {
         }
 
         ImGui::Text(TR("tickets.showing"), filteredCount, state->tickets.size());
+        if (state->loading) {
+            // The list stays usable while the loader fills it in
+            mutexLock(&state->loader.mutex);
+            u32 named = state->loader.named;
+            u32 listed = state->loader.listed;
+            mutexUnlock(&state->loader.mutex);
+            ImGui::SameLine(0, 20);
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "%s %u/%u", TR("tickets.loading"), named, listed);
+        }
         ImGui::Spacing();
 
         ImGui::BeginChild("TicketList", ImVec2(0, -50), ImGuiChildFlags_Borders | ImGuiChildFlags_NavFlattened);
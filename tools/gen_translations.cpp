@@ -5,6 +5,7 @@
  * Generate embedded translations C++ source from JSON files.
  * Scans romfs/javelin/i18n/ for *.json files and creates embedded translation arrays.
  * en.json is the source of truth - all other languages fall back to English for missing keys.
+ * Keys become a StringId enum and each language a flat string table indexed by it.
  *
  * Compile with: g++ -std=c++17 -O2 tools/gen_translations.cpp -o build/gen_translations
  */
@@ -229,23 +230,64 @@ struct LanguageData {
     std::map<std::string, std::string> translations;
 };
 
-std::string generateHeader() {
+// Enum identifier for a key: "mtp.start" -> mtp_start
+std::string keyToIdentifier(const std::string& key) {
+    std::string result;
+    for (char c : key) {
+        bool alnum = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        result += alnum ? c : '_';
+    }
+    if (result.empty() || (result[0] >= '0' && result[0] <= '9')) result = "_" + result;
+    return result;
+}
+
+std::string generateHeader(const std::map<std::string, std::string>& enTranslations) {
     std::stringstream ss;
     ss << "// Auto-generated by tools/gen_translations.cpp\n";
     ss << "// DO NOT EDIT - Generated from " << ROMFS_DIR << "/*.json\n\n";
     ss << "#pragma once\n\n";
-    ss << "#include <vector>\n";
-    ss << "#include <unordered_map>\n";
-    ss << "#include <string>\n\n";
+    ss << "#include <cstddef>\n";
+    ss << "#include <cstdint>\n\n";
     ss << "namespace Javelin {\n\n";
+
+    // Ids follow the sorted key order so kStringKeys can be binary searched
+    ss << "enum class StringId : uint16_t {\n";
+    for (const auto& entry : enTranslations) {
+        ss << "    " << keyToIdentifier(entry.first) << ",\n";
+    }
+    ss << "};\n\n";
+    ss << "inline constexpr size_t kStringCount = " << enTranslations.size() << ";\n\n";
+
+    ss << "inline constexpr const char* kStringKeys[kStringCount] = {\n";
+    for (const auto& entry : enTranslations) {
+        ss << "    \"" << escapeCString(entry.first) << "\",\n";
+    }
+    ss << "};\n\n";
+
     ss << "struct EmbeddedLanguage {\n";
     ss << "    const char* code;\n";
     ss << "    const char* name;\n";
-    ss << "    const char* const* keys;\n";
-    ss << "    const char* const* values;\n";
+    ss << "    const char* const* strings;     // kStringCount entries, English where untranslated\n";
     ss << "};\n\n";
-    ss << "const std::vector<EmbeddedLanguage>& getEmbeddedLanguages();\n\n";
-    ss << "std::unordered_map<std::string, std::string> getEmbeddedTranslations(const char* langCode);\n\n";
+    ss << "extern const EmbeddedLanguage kEmbeddedLanguages[];\n";
+    ss << "extern const size_t kEmbeddedLanguageCount;\n\n";
+
+    ss << "constexpr int compareStringKeys(const char* a, const char* b) {\n";
+    ss << "    while (*a && *a == *b) { a++; b++; }\n";
+    ss << "    return (int)(unsigned char)*a - (int)(unsigned char)*b;\n";
+    ss << "}\n\n";
+    ss << "// Index of a key in kStringKeys, or -1. Usable in constant expressions.\n";
+    ss << "constexpr int findStringId(const char* key) {\n";
+    ss << "    int lo = 0, hi = (int)kStringCount - 1;\n";
+    ss << "    while (lo <= hi) {\n";
+    ss << "        int mid = (lo + hi) / 2;\n";
+    ss << "        int cmp = compareStringKeys(kStringKeys[mid], key);\n";
+    ss << "        if (cmp == 0) return mid;\n";
+    ss << "        if (cmp < 0) lo = mid + 1;\n";
+    ss << "        else hi = mid - 1;\n";
+    ss << "    }\n";
+    ss << "    return -1;\n";
+    ss << "}\n\n";
     ss << "} // namespace Javelin\n";
     return ss.str();
 }
@@ -255,59 +297,28 @@ std::string generateSource(const std::vector<LanguageData>& languages) {
 
     ss << "// Auto-generated by tools/gen_translations.cpp\n";
     ss << "// DO NOT EDIT - Generated from " << ROMFS_DIR << "/*.json\n\n";
-    ss << "#include \"i18n/EmbeddedTranslations.h\"\n";
-    ss << "#include <string>\n";
-    ss << "#include <vector>\n";
-    ss << "#include <cstring>\n\n";
+    ss << "#include \"i18n/EmbeddedTranslations.h\"\n\n";
     ss << "namespace Javelin {\n\n";
 
+    // Every table has one entry per English key, in StringId order
     for (const auto& lang : languages) {
         std::string codeId = codeToIdentifier(lang.code);
 
-        ss << "// " << lang.name << " (" << lang.code << ") - " << lang.translations.size() << " strings\n";
-        ss << "static const char* const " << codeId << "_keys[] = {\n";
-        for (const auto& entry : lang.translations) {
-            ss << "    \"" << escapeCString(entry.first) << "\",\n";
-        }
-        ss << "    nullptr\n";
-        ss << "};\n\n";
-
-        ss << "static const char* const " << codeId << "_values[] = {\n";
+        ss << "// " << lang.name << " (" << lang.code << ")\n";
+        ss << "static const char* const " << codeId << "_strings[kStringCount] = {\n";
         for (const auto& entry : lang.translations) {
             ss << "    \"" << escapeCString(entry.second) << "\",\n";
         }
-        ss << "    nullptr\n";
         ss << "};\n\n";
     }
 
-    ss << "const std::vector<EmbeddedLanguage>& getEmbeddedLanguages() {\n";
-    ss << "    static std::vector<EmbeddedLanguage> langs;\n";
-    ss << "    if (langs.empty()) {\n";
+    ss << "const EmbeddedLanguage kEmbeddedLanguages[] = {\n";
     for (const auto& lang : languages) {
-        std::string codeId = codeToIdentifier(lang.code);
-        ss << "        langs.push_back(EmbeddedLanguage{\"" << lang.code
-           << "\", \"" << escapeCString(lang.name) << "\", " << codeId
-           << "_keys, " << codeId << "_values});\n";
-    }
-    ss << "    }\n";
-    ss << "    return langs;\n";
-    ss << "}\n\n";
-
-    ss << "std::unordered_map<std::string, std::string> getEmbeddedTranslations(const char* langCode) {\n";
-    ss << "    std::unordered_map<std::string, std::string> result;\n\n";
-
-    for (const auto& lang : languages) {
-        ss << "    if (strcmp(langCode, \"" << lang.code << "\") == 0) {\n";
-        for (const auto& entry : lang.translations) {
-            ss << "        result[\"" << escapeCString(entry.first) << "\"] = \""
-               << escapeCString(entry.second) << "\";\n";
-        }
-        ss << "        return result;\n";
-        ss << "    }\n\n";
+        ss << "    {\"" << lang.code << "\", \"" << escapeCString(lang.name) << "\", "
+           << codeToIdentifier(lang.code) << "_strings},\n";
     }
-
-    ss << "    return result;\n";
-    ss << "}\n\n";
+    ss << "};\n\n";
+    ss << "const size_t kEmbeddedLanguageCount = " << languages.size() << ";\n\n";
     ss << "} // namespace Javelin\n";
 
     return ss.str();
@@ -371,27 +382,47 @@ int main(int argc, char* argv[]) {
             if (readFile(jsonPath, jsonContent)) {
                 std::map<std::string, std::string> trans;
                 if (parseJsonTranslations(jsonContent, trans)) {
-                    // Fill in missing keys from English
-                    for (const auto& entry : enTranslations) {
-                        if (trans.find(entry.first) == trans.end()) {
-                            trans[entry.first] = entry.second;
+                    // Keys English does not have are dropped; missing ones fall back to English
+                    size_t translated = 0;
+                    lang.translations = enTranslations;
+                    for (auto& entry : lang.translations) {
+                        auto it = trans.find(entry.first);
+                        if (it != trans.end()) {
+                            entry.second = it->second;
+                            translated++;
                         }
                     }
-                    lang.translations = trans;
                     std::cout << "[gen_translations] Loaded " << code << ": "
-                              << trans.size() << " strings" << std::endl;
+                              << translated << "/" << enTranslations.size() << " strings" << std::endl;
                 } else {
                     std::cout << "[gen_translations] Warning: Failed to parse " << code
                               << ".json, using English" << std::endl;
                     lang.translations = enTranslations;
                 }
+            } else {
+                lang.translations = enTranslations;
             }
         }
 
         languages.push_back(lang);
     }
 
-    std::string headerContent = generateHeader();
+    // Enum names must stay unique after punctuation is folded to '_'
+    {
+        std::map<std::string, std::string> seen;
+        for (const auto& entry : enTranslations) {
+            std::string id = keyToIdentifier(entry.first);
+            auto it = seen.find(id);
+            if (it != seen.end()) {
+                std::cerr << "[gen_translations] Error: keys \"" << it->second << "\" and \""
+                          << entry.first << "\" both map to " << id << std::endl;
+                return 1;
+            }
+            seen[id] = entry.first;
+        }
+    }
+
+    std::string headerContent = generateHeader(enTranslations);
     if (writeFile(headerFile, headerContent)) {
         std::cout << "[gen_translations] Generated " << headerFile << std::endl;
     } else {